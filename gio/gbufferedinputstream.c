@@ -53,22 +53,61 @@
  * buffered input stream's buffer, use
  * g_buffered_input_stream_set_buffer_size(). Note that the buffer's size
  * cannot be reduced below the size of the data within the buffer.
+ *
+ * For reading large amounts of data sequentially, the buffer can grow
+ * on its own with #GBufferedInputStream:adaptive, and the next fill can
+ * be read in the background while the current one is being consumed
+ * with #GBufferedInputStream:readahead.
  */
 
 
 #define DEFAULT_BUFFER_SIZE 4096
 
+/* In adaptive mode, the buffer doubles after this many fills in a row
+ * that found it (nearly) drained, up to the maximum size */
+#define ADAPTIVE_GROW_AFTER 2
+#define ADAPTIVE_MAX_BUFFER_SIZE (1024 * 1024)
+
+/* Handing a block over from the readahead thread costs a few
+ * microseconds, so read ahead at least this much at a time */
+#define READAHEAD_MIN_BLOCK_SIZE (128 * 1024)
+
+typedef enum {
+  READAHEAD_IDLE,
+  READAHEAD_RUNNING,
+  READAHEAD_DONE
+} ReadaheadState;
+
 struct _GBufferedInputStreamPrivate {
   guint8 *buffer;
   gsize   len;
   gsize   pos;
   gsize   end;
   GAsyncReadyCallback outstanding_callback;
+
+  gboolean adaptive;
+  gboolean last_fill_full;
+  guint    sequential_fills;
+
+  /* The readahead fields are written by the readahead thread while
+   * readahead_state is READAHEAD_RUNNING, and by the stream otherwise */
+  gboolean readahead;
+  gint     readahead_state;  /* (atomic) ReadaheadState */
+  GMutex   readahead_lock;
+  GCond    readahead_cond;
+  guint8  *readahead_buffer;
+  gsize    readahead_len;
+  gsize    readahead_pos;
+  gsize    readahead_end;
+  GError  *readahead_error;
+  GCancellable *readahead_cancellable;
 };
 
 enum {
   PROP_0,
-  PROP_BUFSIZE
+  PROP_BUFSIZE,
+  PROP_ADAPTIVE,
+  PROP_READAHEAD
 };
 
 static void g_buffered_input_stream_set_property  (GObject      *object,
@@ -101,6 +140,9 @@ static gssize g_buffered_input_stream_read             (GInputStream          *s
                                                         gsize                  count,
                                                         GCancellable          *cancellable,
                                                         GError               **error);
+static gboolean g_buffered_input_stream_close          (GInputStream          *stream,
+                                                        GCancellable          *cancellable,
+                                                        GError               **error);
 static gssize g_buffered_input_stream_real_fill        (GBufferedInputStream  *stream,
                                                         gssize                 count,
                                                         GCancellable          *cancellable,
@@ -131,6 +173,13 @@ static gboolean g_buffered_input_stream_truncate            (GSeekable       *se
 							     GError         **error);
 
 static void compact_buffer (GBufferedInputStream *stream);
+static void readahead_wait (GBufferedInputStream *stream,
+                            GCancellable         *cancellable);
+static void readahead_discard (GBufferedInputStream *stream);
+static gssize fill_buffer (GBufferedInputStream  *stream,
+                           gssize                 count,
+                           GCancellable          *cancellable,
+                           GError               **error);
 
 G_DEFINE_TYPE_WITH_CODE (GBufferedInputStream,
 			 g_buffered_input_stream,
@@ -156,6 +205,7 @@ g_buffered_input_stream_class_init (GBufferedInputStreamClass *klass)
   istream_class->skip_async  = g_buffered_input_stream_skip_async;
   istream_class->skip_finish = g_buffered_input_stream_skip_finish;
   istream_class->read_fn = g_buffered_input_stream_read;
+  istream_class->close_fn = g_buffered_input_stream_close;
 
   bstream_class = G_BUFFERED_INPUT_STREAM_CLASS (klass);
   bstream_class->fill = g_buffered_input_stream_real_fill;
@@ -173,6 +223,53 @@ g_buffered_input_stream_class_init (GBufferedInputStreamClass *klass)
                                                       G_PARAM_READWRITE | G_PARAM_CONSTRUCT |
                                                       G_PARAM_STATIC_NAME|G_PARAM_STATIC_NICK|G_PARAM_STATIC_BLURB));
 
+  /**
+   * GBufferedInputStream:adaptive:
+   *
+   * Whether the buffer grows when the stream is read sequentially.
+   *
+   * When this is %TRUE and the buffer keeps being emptied before it is
+   * filled again, its size is doubled, up to 1 megabyte, so that large
+   * sequential reads take fewer reads from the base stream. The
+   * #GBufferedInputStream:buffer-size property reflects the current size.
+   *
+   * Since: 2.76
+   */
+  g_object_class_install_property (object_class,
+                                   PROP_ADAPTIVE,
+                                   g_param_spec_boolean ("adaptive",
+                                                         P_("Adaptive"),
+                                                         P_("Whether the buffer grows on sequential reads"),
+                                                         FALSE,
+                                                         G_PARAM_READWRITE |
+                                                         G_PARAM_STATIC_STRINGS | G_PARAM_EXPLICIT_NOTIFY));
+
+  /**
+   * GBufferedInputStream:readahead:
+   *
+   * Whether the next fill of the buffer is read in the background.
+   *
+   * When this is %TRUE, each synchronous fill of the buffer starts reading
+   * the next block of the base stream in a worker thread, so that the read
+   * overlaps with the processing of the current data. The following fills
+   * then take data from that block instead of blocking on the base stream,
+   * if it has arrived. Blocks are at least 128 kilobytes, or the buffer
+   * size if that is larger.
+   *
+   * This reads ahead of what has been consumed, so it is not suitable for
+   * base streams that are also used directly, or that block waiting for
+   * data which the reader of this stream must first react to.
+   *
+   * Since: 2.76
+   */
+  g_object_class_install_property (object_class,
+                                   PROP_READAHEAD,
+                                   g_param_spec_boolean ("readahead",
+                                                         P_("Readahead"),
+                                                         P_("Whether the next fill is read in the background"),
+                                                         FALSE,
+                                                         G_PARAM_READWRITE |
+                                                         G_PARAM_STATIC_STRINGS | G_PARAM_EXPLICIT_NOTIFY));
 
 }
 
@@ -242,6 +339,104 @@ g_buffered_input_stream_set_buffer_size (GBufferedInputStream *stream,
   g_object_notify (G_OBJECT (stream), "buffer-size");
 }
 
+/**
+ * g_buffered_input_stream_get_adaptive:
+ * @stream: a #GBufferedInputStream
+ *
+ * Gets whether the buffer of @stream grows when it is read sequentially.
+ * See #GBufferedInputStream:adaptive.
+ *
+ * Returns: %TRUE if the buffer size is adaptive
+ *
+ * Since: 2.76
+ */
+gboolean
+g_buffered_input_stream_get_adaptive (GBufferedInputStream *stream)
+{
+  g_return_val_if_fail (G_IS_BUFFERED_INPUT_STREAM (stream), FALSE);
+
+  return stream->priv->adaptive;
+}
+
+/**
+ * g_buffered_input_stream_set_adaptive:
+ * @stream: a #GBufferedInputStream
+ * @adaptive: whether the buffer size should be adaptive
+ *
+ * Sets whether the buffer of @stream grows when it is read sequentially.
+ * See #GBufferedInputStream:adaptive.
+ *
+ * Since: 2.76
+ */
+void
+g_buffered_input_stream_set_adaptive (GBufferedInputStream *stream,
+                                      gboolean              adaptive)
+{
+  GBufferedInputStreamPrivate *priv;
+
+  g_return_if_fail (G_IS_BUFFERED_INPUT_STREAM (stream));
+
+  priv = stream->priv;
+  adaptive = !!adaptive;
+
+  if (priv->adaptive == adaptive)
+    return;
+
+  priv->adaptive = adaptive;
+  priv->sequential_fills = 0;
+  g_object_notify (G_OBJECT (stream), "adaptive");
+}
+
+/**
+ * g_buffered_input_stream_get_readahead:
+ * @stream: a #GBufferedInputStream
+ *
+ * Gets whether @stream reads its next fill in the background.
+ * See #GBufferedInputStream:readahead.
+ *
+ * Returns: %TRUE if readahead is enabled
+ *
+ * Since: 2.76
+ */
+gboolean
+g_buffered_input_stream_get_readahead (GBufferedInputStream *stream)
+{
+  g_return_val_if_fail (G_IS_BUFFERED_INPUT_STREAM (stream), FALSE);
+
+  return stream->priv->readahead;
+}
+
+/**
+ * g_buffered_input_stream_set_readahead:
+ * @stream: a #GBufferedInputStream
+ * @readahead: whether to read the next fill in the background
+ *
+ * Sets whether @stream reads its next fill in the background.
+ * See #GBufferedInputStream:readahead.
+ *
+ * Disabling readahead does not drop data that has already been read
+ * ahead; it is still returned by the following reads.
+ *
+ * Since: 2.76
+ */
+void
+g_buffered_input_stream_set_readahead (GBufferedInputStream *stream,
+                                       gboolean              readahead)
+{
+  GBufferedInputStreamPrivate *priv;
+
+  g_return_if_fail (G_IS_BUFFERED_INPUT_STREAM (stream));
+
+  priv = stream->priv;
+  readahead = !!readahead;
+
+  if (priv->readahead == readahead)
+    return;
+
+  priv->readahead = readahead;
+  g_object_notify (G_OBJECT (stream), "readahead");
+}
+
 static void
 g_buffered_input_stream_set_property (GObject      *object,
                                       guint         prop_id,
@@ -258,6 +453,14 @@ g_buffered_input_stream_set_property (GObject      *object,
       g_buffered_input_stream_set_buffer_size (bstream, g_value_get_uint (value));
       break;
 
+    case PROP_ADAPTIVE:
+      g_buffered_input_stream_set_adaptive (bstream, g_value_get_boolean (value));
+      break;
+
+    case PROP_READAHEAD:
+      g_buffered_input_stream_set_readahead (bstream, g_value_get_boolean (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -282,6 +485,14 @@ g_buffered_input_stream_get_property (GObject    *object,
       g_value_set_uint (value, priv->len);
       break;
 
+    case PROP_ADAPTIVE:
+      g_value_set_boolean (value, priv->adaptive);
+      break;
+
+    case PROP_READAHEAD:
+      g_value_set_boolean (value, priv->readahead);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -299,6 +510,13 @@ g_buffered_input_stream_finalize (GObject *object)
 
   g_free (priv->buffer);
 
+  /* The readahead thread holds a reference, so it is not running */
+  g_free (priv->readahead_buffer);
+  g_clear_error (&priv->readahead_error);
+  g_clear_object (&priv->readahead_cancellable);
+  g_mutex_clear (&priv->readahead_lock);
+  g_cond_clear (&priv->readahead_cond);
+
   G_OBJECT_CLASS (g_buffered_input_stream_parent_class)->finalize (object);
 }
 
@@ -317,6 +535,9 @@ static void
 g_buffered_input_stream_init (GBufferedInputStream *stream)
 {
   stream->priv = g_buffered_input_stream_get_instance_private (stream);
+
+  g_mutex_init (&stream->priv->readahead_lock);
+  g_cond_init (&stream->priv->readahead_cond);
 }
 
 
@@ -646,11 +867,267 @@ compact_buffer (GBufferedInputStream *stream)
   priv->end = current_size;
 }
 
+/* Returns whether data may have been read from the base stream ahead of
+ * the buffer, in which case the base stream must not be used directly */
+static gboolean
+readahead_in_use (GBufferedInputStream *stream)
+{
+  return stream->priv->readahead ||
+         g_atomic_int_get (&stream->priv->readahead_state) != READAHEAD_IDLE;
+}
+
+static void
+readahead_thread (gpointer data,
+                  gpointer user_data)
+{
+  GBufferedInputStream *stream = data;
+  GBufferedInputStreamPrivate *priv = stream->priv;
+  GInputStream *base_stream;
+  GError *error = NULL;
+  gssize nread;
+
+  base_stream = G_FILTER_INPUT_STREAM (stream)->base_stream;
+  nread = g_input_stream_read (base_stream,
+                               priv->readahead_buffer,
+                               priv->readahead_len,
+                               priv->readahead_cancellable,
+                               &error);
+
+  g_mutex_lock (&priv->readahead_lock);
+  priv->readahead_pos = 0;
+  priv->readahead_end = MAX (nread, 0);
+  priv->readahead_error = error;
+  g_atomic_int_set (&priv->readahead_state, READAHEAD_DONE);
+  g_cond_broadcast (&priv->readahead_cond);
+  g_mutex_unlock (&priv->readahead_lock);
+
+  g_object_unref (stream);
+}
+
+/* Starts reading the next block of the base stream in the background.
+ * Not a GTask: nothing would free it in programs that only use the
+ * synchronous API and never run the main context. */
+static void
+readahead_start (GBufferedInputStream *stream)
+{
+  static GThreadPool *pool = NULL;
+  GBufferedInputStreamPrivate *priv = stream->priv;
+
+  if (!priv->readahead ||
+      g_atomic_int_get (&priv->readahead_state) != READAHEAD_IDLE ||
+      g_input_stream_is_closed (G_FILTER_INPUT_STREAM (stream)->base_stream))
+    return;
+
+  if (g_once_init_enter (&pool))
+    g_once_init_leave (&pool, g_thread_pool_new (readahead_thread, NULL, -1, FALSE, NULL));
+
+  if (priv->readahead_len != MAX (priv->len, READAHEAD_MIN_BLOCK_SIZE))
+    {
+      g_free (priv->readahead_buffer);
+      priv->readahead_len = MAX (priv->len, READAHEAD_MIN_BLOCK_SIZE);
+      priv->readahead_buffer = g_malloc (priv->readahead_len);
+    }
+
+  g_clear_object (&priv->readahead_cancellable);
+  priv->readahead_cancellable = g_cancellable_new ();
+
+  g_atomic_int_set (&priv->readahead_state, READAHEAD_RUNNING);
+  g_thread_pool_push (pool, g_object_ref (stream), NULL);
+}
+
+static void
+readahead_cancelled_cb (GCancellable *cancellable,
+                        gpointer      user_data)
+{
+  g_cancellable_cancel (G_CANCELLABLE (user_data));
+}
+
+/* Waits for a running readahead to finish. Cancelling @cancellable
+ * cancels the readahead. */
+static void
+readahead_wait (GBufferedInputStream *stream,
+                GCancellable         *cancellable)
+{
+  GBufferedInputStreamPrivate *priv = stream->priv;
+  gulong handler_id = 0;
+
+  if (g_atomic_int_get (&priv->readahead_state) != READAHEAD_RUNNING)
+    return;
+
+  if (cancellable)
+    handler_id = g_cancellable_connect (cancellable,
+                                        G_CALLBACK (readahead_cancelled_cb),
+                                        priv->readahead_cancellable, NULL);
+
+  g_mutex_lock (&priv->readahead_lock);
+  while (g_atomic_int_get (&priv->readahead_state) == READAHEAD_RUNNING)
+    g_cond_wait (&priv->readahead_cond, &priv->readahead_lock);
+  g_mutex_unlock (&priv->readahead_lock);
+
+  g_cancellable_disconnect (cancellable, handler_id);
+}
+
+/* Stops a running readahead, for operations which can't usefully wait
+ * for the base stream, such as closing or seeking. A read which was
+ * cancelled returns nothing, so it is forgotten rather than reported;
+ * one which completed anyway keeps its data. */
+static void
+readahead_cancel (GBufferedInputStream *stream)
+{
+  GBufferedInputStreamPrivate *priv = stream->priv;
+
+  if (g_atomic_int_get (&priv->readahead_state) != READAHEAD_RUNNING)
+    return;
+
+  g_cancellable_cancel (priv->readahead_cancellable);
+  readahead_wait (stream, NULL);
+
+  if (g_error_matches (priv->readahead_error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    {
+      g_clear_error (&priv->readahead_error);
+      priv->readahead_pos = priv->readahead_end = 0;
+      g_atomic_int_set (&priv->readahead_state, READAHEAD_IDLE);
+    }
+}
+
+/* Returns how many bytes have been read ahead and not consumed. A
+ * running readahead is waited for rather than cancelled, as callers such
+ * as tell() would otherwise throw away the overlap with the base stream
+ * every time they are called. */
+static gsize
+readahead_get_available (GBufferedInputStream *stream)
+{
+  GBufferedInputStreamPrivate *priv = stream->priv;
+
+  readahead_wait (stream, NULL);
+
+  if (g_atomic_int_get (&priv->readahead_state) != READAHEAD_DONE)
+    return 0;
+
+  return priv->readahead_end - priv->readahead_pos;
+}
+
+/* Drops any data that has been read ahead, eg before seeking */
+static void
+readahead_discard (GBufferedInputStream *stream)
+{
+  GBufferedInputStreamPrivate *priv = stream->priv;
+
+  readahead_cancel (stream);
+
+  g_clear_error (&priv->readahead_error);
+  priv->readahead_pos = priv->readahead_end = 0;
+  g_atomic_int_set (&priv->readahead_state, READAHEAD_IDLE);
+}
+
+/* Moves up to @count bytes from the readahead into the buffer, waiting
+ * for them if needed, and starts the next readahead once it is used up */
+static gssize
+fill_from_readahead (GBufferedInputStream  *stream,
+                     gsize                  count,
+                     GCancellable          *cancellable,
+                     GError               **error)
+{
+  GBufferedInputStreamPrivate *priv = stream->priv;
+  gsize available;
+  gsize nread;
+
+  readahead_wait (stream, cancellable);
+
+  if (priv->readahead_error)
+    {
+      g_propagate_error (error, g_steal_pointer (&priv->readahead_error));
+      g_atomic_int_set (&priv->readahead_state, READAHEAD_IDLE);
+      return -1;
+    }
+
+  available = priv->readahead_end - priv->readahead_pos;
+
+  if (available == 0)
+    {
+      /* End of stream */
+      g_atomic_int_set (&priv->readahead_state, READAHEAD_IDLE);
+      return 0;
+    }
+
+  if (priv->pos == priv->end && priv->readahead_pos == 0 &&
+      count >= available && priv->readahead_len == priv->len)
+    {
+      /* The buffer is empty, so swap it for the readahead one rather
+       * than copying */
+      guint8 *buffer = priv->buffer;
+
+      priv->buffer = priv->readahead_buffer;
+      priv->readahead_buffer = buffer;
+      priv->pos = 0;
+      priv->end = available;
+      nread = available;
+    }
+  else
+    {
+      nread = MIN (count, available);
+
+      if (priv->len - priv->end < nread)
+        compact_buffer (stream);
+
+      memcpy (priv->buffer + priv->end,
+              priv->readahead_buffer + priv->readahead_pos,
+              nread);
+      priv->end += nread;
+    }
+
+  priv->readahead_pos += nread;
+
+  if (priv->readahead_pos == priv->readahead_end)
+    {
+      g_atomic_int_set (&priv->readahead_state, READAHEAD_IDLE);
+      readahead_start (stream);
+    }
+
+  return nread;
+}
+
+/* Grows the buffer in adaptive mode, if the previous fill was consumed
+ * (nearly) entirely and more data could have been read at once */
+static void
+adapt_buffer_size (GBufferedInputStream *stream)
+{
+  GBufferedInputStreamPrivate *priv = stream->priv;
+
+  if (!priv->adaptive)
+    return;
+
+  if (priv->last_fill_full && priv->end - priv->pos <= priv->len / 4)
+    priv->sequential_fills++;
+  else
+    priv->sequential_fills = 0;
+
+  if (priv->sequential_fills >= ADAPTIVE_GROW_AFTER &&
+      priv->len < ADAPTIVE_MAX_BUFFER_SIZE)
+    {
+      g_buffered_input_stream_set_buffer_size (stream, MIN (priv->len * 2, ADAPTIVE_MAX_BUFFER_SIZE));
+      priv->sequential_fills = 0;
+    }
+}
+
 static gssize
 g_buffered_input_stream_real_fill (GBufferedInputStream  *stream,
                                    gssize                 count,
                                    GCancellable          *cancellable,
                                    GError               **error)
+{
+  adapt_buffer_size (stream);
+
+  return fill_buffer (stream, count, cancellable, error);
+}
+
+/* The fill itself, without adapting the buffer size, which notifies
+ * and so must not be done from fill_from_readahead_thread() */
+static gssize
+fill_buffer (GBufferedInputStream  *stream,
+             gssize                 count,
+             GCancellable          *cancellable,
+             GError               **error)
 {
   GBufferedInputStreamPrivate *priv;
   GInputStream *base_stream;
@@ -667,6 +1144,13 @@ g_buffered_input_stream_real_fill (GBufferedInputStream  *stream,
   /* Never fill more than can fit in the buffer */
   count = MIN ((gsize) count, priv->len - in_buffer);
 
+  if (g_atomic_int_get (&priv->readahead_state) != READAHEAD_IDLE)
+    {
+      nread = fill_from_readahead (stream, count, cancellable, error);
+      priv->last_fill_full = (nread > 0 && (gsize) nread == (gsize) count);
+      return nread;
+    }
+
   /* If requested length does not fit at end, compact */
   if (priv->len - priv->end < (gsize) count)
     compact_buffer (stream);
@@ -681,6 +1165,11 @@ g_buffered_input_stream_real_fill (GBufferedInputStream  *stream,
   if (nread > 0)
     priv->end += nread;
 
+  priv->last_fill_full = (nread > 0 && nread == count);
+
+  if (nread > 0)
+    readahead_start (stream);
+
   return nread;
 }
 
@@ -720,7 +1209,7 @@ g_buffered_input_stream_skip (GInputStream  *stream,
   if (bytes_skipped > 0)
     error = NULL; /* Ignore further errors if we already read some data */
 
-  if (count > priv->len)
+  if (count > priv->len && !readahead_in_use (bstream))
     {
       /* Large request, shortcut buffer */
 
@@ -741,7 +1230,7 @@ g_buffered_input_stream_skip (GInputStream  *stream,
     }
 
   class = G_BUFFERED_INPUT_STREAM_GET_CLASS (stream);
-  nread = class->fill (bstream, priv->len, cancellable, error);
+  nread = class->fill (bstream, -1, cancellable, error);
 
   if (nread < 0)
     {
@@ -799,7 +1288,7 @@ g_buffered_input_stream_read (GInputStream *stream,
   if (bytes_read > 0)
     error = NULL; /* Ignore further errors if we already read some data */
 
-  if (count > priv->len)
+  if (count > priv->len && !readahead_in_use (bstream))
     {
       /* Large request, shortcut buffer */
 
@@ -821,7 +1310,7 @@ g_buffered_input_stream_read (GInputStream *stream,
     }
 
   class = G_BUFFERED_INPUT_STREAM_GET_CLASS (stream);
-  nread = class->fill (bstream, priv->len, cancellable, error);
+  nread = class->fill (bstream, -1, cancellable, error);
   if (nread < 0)
     {
       if (bytes_read == 0)
@@ -840,6 +1329,16 @@ g_buffered_input_stream_read (GInputStream *stream,
   return bytes_read;
 }
 
+static gboolean
+g_buffered_input_stream_close (GInputStream  *stream,
+                               GCancellable  *cancellable,
+                               GError       **error)
+{
+  readahead_discard (G_BUFFERED_INPUT_STREAM (stream));
+
+  return G_INPUT_STREAM_CLASS (g_buffered_input_stream_parent_class)->close_fn (stream, cancellable, error);
+}
+
 static goffset
 g_buffered_input_stream_tell (GSeekable *seekable)
 {
@@ -858,7 +1357,7 @@ g_buffered_input_stream_tell (GSeekable *seekable)
     return 0;
   base_stream_seekable = G_SEEKABLE (base_stream);
   
-  available = priv->end - priv->pos;
+  available = priv->end - priv->pos + readahead_get_available (bstream);
   base_offset = g_seekable_tell (base_stream_seekable);
 
   return base_offset - available;
@@ -908,14 +1407,18 @@ g_buffered_input_stream_seek (GSeekable     *seekable,
 	}
       else
 	{
-	  offset -= priv->end - priv->pos;
+	  readahead_cancel (bstream);
+	  offset -= priv->end - priv->pos + readahead_get_available (bstream);
 	}
     }
 
+  readahead_cancel (bstream);
+
   if (g_seekable_seek (base_stream_seekable, offset, type, cancellable, error))
     {
       priv->pos = 0;
       priv->end = 0;
+      readahead_discard (bstream);
       return TRUE;
     }
   else
@@ -1008,7 +1511,7 @@ g_buffered_input_stream_read_byte (GBufferedInputStream  *stream,
   priv->end = 0;
 
   class = G_BUFFERED_INPUT_STREAM_GET_CLASS (stream);
-  nread = class->fill (stream, priv->len, cancellable, error);
+  nread = class->fill (stream, -1, cancellable, error);
 
   if (cancellable)
     g_cancellable_pop_current (cancellable);
@@ -1056,6 +1559,24 @@ fill_async_callback (GObject      *source_object,
   g_object_unref (task);
 }
 
+static void
+fill_from_readahead_thread (GTask        *task,
+                            gpointer      source_object,
+                            gpointer      task_data,
+                            GCancellable *cancellable)
+{
+  GError *error = NULL;
+  gssize nread;
+
+  nread = fill_buffer (source_object,
+                       (gssize) GPOINTER_TO_SIZE (task_data),
+                       cancellable, &error);
+  if (nread < 0)
+    g_task_return_error (task, error);
+  else
+    g_task_return_int (task, nread);
+}
+
 static void
 g_buffered_input_stream_real_fill_async (GBufferedInputStream *stream,
                                          gssize                count,
@@ -1071,6 +1592,21 @@ g_buffered_input_stream_real_fill_async (GBufferedInputStream *stream,
 
   priv = stream->priv;
 
+  task = g_task_new (stream, cancellable, callback, user_data);
+  g_task_set_source_tag (task, g_buffered_input_stream_real_fill_async);
+
+  if (g_atomic_int_get (&priv->readahead_state) != READAHEAD_IDLE)
+    {
+      /* Data has been read ahead already, and waiting for it blocks.
+       * The buffer size is adapted here, in the thread the stream is used
+       * from, rather than in the worker thread. */
+      adapt_buffer_size (stream);
+      g_task_set_task_data (task, GSIZE_TO_POINTER (count), NULL);
+      g_task_run_in_thread (task, fill_from_readahead_thread);
+      g_object_unref (task);
+      return;
+    }
+
   if (count == -1)
     count = priv->len;
 
@@ -1083,9 +1619,6 @@ g_buffered_input_stream_real_fill_async (GBufferedInputStream *stream,
   if (priv->len - priv->end < (gsize) count)
     compact_buffer (stream);
 
-  task = g_task_new (stream, cancellable, callback, user_data);
-  g_task_set_source_tag (task, g_buffered_input_stream_real_fill_async);
-
   base_stream = G_FILTER_INPUT_STREAM (stream)->base_stream;
   g_input_stream_read_async (base_stream,
                              priv->buffer + priv->end,
@@ -1245,7 +1778,7 @@ g_buffered_input_stream_skip_async (GInputStream        *stream,
   data->bytes_skipped = available;
   data->count = count;
 
-  if (count > priv->len)
+  if (count > priv->len && !readahead_in_use (bstream))
     {
       /* Large request, shortcut buffer */
       base_stream = G_FILTER_INPUT_STREAM (stream)->base_stream;
@@ -1263,7 +1796,7 @@ g_buffered_input_stream_skip_async (GInputStream        *stream,
   else
     {
       class = G_BUFFERED_INPUT_STREAM_GET_CLASS (stream);
-      class->fill_async (bstream, priv->len, io_priority, cancellable,
+      class->fill_async (bstream, -1, io_priority, cancellable,
                          skip_fill_buffer_callback, task);
     }
 }
@@ -97,6 +97,16 @@ gsize         g_buffered_input_stream_get_buffer_size (GBufferedInputStream  *st
 GIO_AVAILABLE_IN_ALL
 void          g_buffered_input_stream_set_buffer_size (GBufferedInputStream  *stream,
 						       gsize                  size);
+GIO_AVAILABLE_IN_2_76
+gboolean      g_buffered_input_stream_get_adaptive    (GBufferedInputStream  *stream);
+GIO_AVAILABLE_IN_2_76
+void          g_buffered_input_stream_set_adaptive    (GBufferedInputStream  *stream,
+						       gboolean               adaptive);
+GIO_AVAILABLE_IN_2_76
+gboolean      g_buffered_input_stream_get_readahead   (GBufferedInputStream  *stream);
+GIO_AVAILABLE_IN_2_76
+void          g_buffered_input_stream_set_readahead   (GBufferedInputStream  *stream,
+						       gboolean               readahead);
 GIO_AVAILABLE_IN_ALL
 gsize         g_buffered_input_stream_get_available   (GBufferedInputStream  *stream);
 GIO_AVAILABLE_IN_ALL
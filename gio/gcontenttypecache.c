@@ -0,0 +1,250 @@
+/* GIO - GLib Input, Output and Streaming Library
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+
+#include "gcontenttypecache.h"
+
+/* A process-wide cache of the content types found by sniffing the
+ * contents of local files. Sniffing means opening the file, reading its
+ * first few kilobytes and running the magic rules over them, which is by
+ * far the most expensive part of querying standard::content-type. File
+ * managers list the same directories over and over, so remembering the
+ * result for as long as the file is unchanged saves most of that work.
+ *
+ * The cache holds at most max_entries entries, and evicts the least
+ * recently used one when full. The limit defaults to DEFAULT_MAX_ENTRIES
+ * and can be changed with the GIO_CONTENT_TYPE_CACHE_SIZE environment
+ * variable; setting it to 0 disables the cache.
+ */
+
+#define DEFAULT_MAX_ENTRIES 4096
+
+typedef struct
+{
+  GContentTypeCacheKey key;  /* owns key.basename */
+  const char *content_type;  /* interned */
+  GList link;                /* in lru, with data pointing to the entry */
+} CacheEntry;
+
+static GMutex cache_lock;
+static GHashTable *cache = NULL;  /* (element-type GContentTypeCacheKey CacheEntry) */
+static GQueue lru = G_QUEUE_INIT; /* most recently used first */
+static guint max_entries = 0;
+static guint64 n_hits = 0;
+static guint64 n_misses = 0;
+
+static guint
+cache_key_hash (gconstpointer p)
+{
+  const GContentTypeCacheKey *key = p;
+  guint hash;
+
+  hash = (guint) (key->ino ^ (key->ino >> 32));
+  hash = hash * 31 + (guint) (key->dev ^ (key->dev >> 32));
+  hash = hash * 31 + (guint) key->mtime;
+  hash = hash * 31 + key->mtime_nsec;
+  hash = hash * 31 + (guint) key->size;
+  hash = hash * 31 + g_str_hash (key->basename);
+
+  return hash;
+}
+
+static gboolean
+cache_key_equal (gconstpointer a,
+                 gconstpointer b)
+{
+  const GContentTypeCacheKey *key_a = a;
+  const GContentTypeCacheKey *key_b = b;
+
+  return key_a->ino == key_b->ino &&
+         key_a->dev == key_b->dev &&
+         key_a->mtime == key_b->mtime &&
+         key_a->mtime_nsec == key_b->mtime_nsec &&
+         key_a->size == key_b->size &&
+         g_str_equal (key_a->basename, key_b->basename);
+}
+
+static void
+cache_entry_free (gpointer data)
+{
+  CacheEntry *entry = data;
+
+  g_free ((char *) entry->key.basename);
+  g_free (entry);
+}
+
+static void
+reset_cache_locked (guint new_max_entries)
+{
+  if (cache == NULL)
+    cache = g_hash_table_new_full (cache_key_hash, cache_key_equal, NULL, cache_entry_free);
+
+  /* Entries are only linked into lru, so there is nothing to free there */
+  g_queue_init (&lru);
+  g_hash_table_remove_all (cache);
+
+  max_entries = new_max_entries;
+  n_hits = 0;
+  n_misses = 0;
+}
+
+static void
+ensure_cache_locked (void)
+{
+  const char *env;
+  guint size = DEFAULT_MAX_ENTRIES;
+
+  if (cache != NULL)
+    return;
+
+  env = g_getenv ("GIO_CONTENT_TYPE_CACHE_SIZE");
+  if (env != NULL)
+    size = (guint) strtoul (env, NULL, 10);
+
+  reset_cache_locked (size);
+}
+
+/*
+ * _g_content_type_cache_lookup:
+ * @key: the file to look up
+ *
+ * Looks up the content type previously sniffed for the file identified
+ * by @key, and counts a hit or a miss.
+ *
+ * Returns: (nullable): an interned content type, or %NULL if the file
+ *     is not in the cache
+ */
+const char *
+_g_content_type_cache_lookup (const GContentTypeCacheKey *key)
+{
+  CacheEntry *entry;
+  const char *content_type = NULL;
+
+  g_mutex_lock (&cache_lock);
+  ensure_cache_locked ();
+
+  if (max_entries > 0)
+    {
+      entry = g_hash_table_lookup (cache, key);
+      if (entry != NULL)
+        {
+          n_hits++;
+          g_queue_unlink (&lru, &entry->link);
+          g_queue_push_head_link (&lru, &entry->link);
+          content_type = entry->content_type;
+        }
+      else
+        n_misses++;
+    }
+
+  g_mutex_unlock (&cache_lock);
+
+  return content_type;
+}
+
+/*
+ * _g_content_type_cache_insert:
+ * @key: the file that was sniffed
+ * @content_type: the content type found
+ *
+ * Remembers @content_type for the file identified by @key, evicting the
+ * least recently used entry if the cache is full.
+ */
+void
+_g_content_type_cache_insert (const GContentTypeCacheKey *key,
+                              const char                 *content_type)
+{
+  CacheEntry *entry;
+
+  g_mutex_lock (&cache_lock);
+  ensure_cache_locked ();
+
+  if (max_entries == 0)
+    {
+      g_mutex_unlock (&cache_lock);
+      return;
+    }
+
+  entry = g_hash_table_lookup (cache, key);
+  if (entry != NULL)
+    {
+      entry->content_type = g_intern_string (content_type);
+      g_queue_unlink (&lru, &entry->link);
+      g_queue_push_head_link (&lru, &entry->link);
+      g_mutex_unlock (&cache_lock);
+      return;
+    }
+
+  while (g_hash_table_size (cache) >= max_entries)
+    {
+      GList *oldest = g_queue_pop_tail_link (&lru);
+      CacheEntry *old_entry = oldest->data;
+
+      g_hash_table_remove (cache, &old_entry->key);
+    }
+
+  entry = g_new0 (CacheEntry, 1);
+  entry->key = *key;
+  entry->key.basename = g_strdup (key->basename);
+  entry->content_type = g_intern_string (content_type);
+  entry->link.data = entry;
+
+  g_hash_table_insert (cache, &entry->key, entry);
+  g_queue_push_head_link (&lru, &entry->link);
+
+  g_mutex_unlock (&cache_lock);
+}
+
+/*
+ * _g_content_type_cache_get_stats:
+ * @hits: (out) (optional): return location for the number of hits
+ * @misses: (out) (optional): return location for the number of misses
+ *
+ * Gets the number of lookups that were, and weren't, answered from the
+ * cache since it was created or last reset.
+ */
+void
+_g_content_type_cache_get_stats (guint64 *hits,
+                                 guint64 *misses)
+{
+  g_mutex_lock (&cache_lock);
+
+  if (hits != NULL)
+    *hits = n_hits;
+  if (misses != NULL)
+    *misses = n_misses;
+
+  g_mutex_unlock (&cache_lock);
+}
+
+/*
+ * _g_content_type_cache_reset:
+ * @new_max_entries: the new maximum number of entries, or 0 to disable the cache
+ *
+ * Drops all the entries and statistics, and changes the size of the cache.
+ */
+void
+_g_content_type_cache_reset (guint new_max_entries)
+{
+  g_mutex_lock (&cache_lock);
+  reset_cache_locked (new_max_entries);
+  g_mutex_unlock (&cache_lock);
+}
@@ -0,0 +1,57 @@
+/* GIO - GLib Input, Output and Streaming Library
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __G_CONTENT_TYPE_CACHE_H__
+#define __G_CONTENT_TYPE_CACHE_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/*
+ * GContentTypeCacheKey:
+ * @dev: device the file lives on
+ * @ino: inode number of the file
+ * @mtime: modification time of the file, in seconds
+ * @mtime_nsec: nanosecond part of the modification time
+ * @size: size of the file in bytes
+ * @basename: name of the file, as the guess depends on it too
+ *
+ * Identifies one version of a file for the purposes of the content type
+ * cache. If any of these change, the file is sniffed again.
+ */
+typedef struct
+{
+  guint64 dev;
+  guint64 ino;
+  gint64 mtime;
+  guint32 mtime_nsec;
+  guint64 size;
+  const char *basename;
+} GContentTypeCacheKey;
+
+const char *_g_content_type_cache_lookup    (const GContentTypeCacheKey *key);
+void        _g_content_type_cache_insert    (const GContentTypeCacheKey *key,
+                                             const char                 *content_type);
+void        _g_content_type_cache_get_stats (guint64                    *hits,
+                                             guint64                    *misses);
+void        _g_content_type_cache_reset     (guint                       new_max_entries);
+
+G_END_DECLS
+
+#endif /* __G_CONTENT_TYPE_CACHE_H__ */
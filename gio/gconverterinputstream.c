@@ -43,6 +43,9 @@
  *
  * As of GLib 2.34, #GConverterInputStream implements
  * #GPollableInputStream.
+ *
+ * As of GLib 2.76, the size of its internal buffers can be set with the
+ * #GConverterInputStream:buffer-size property.
  **/
 
 #define INITIAL_BUFFER_SIZE 4096
@@ -52,6 +55,7 @@ typedef struct {
   gsize start;
   gsize end;
   gsize size;
+  gsize initial_size;
 } Buffer;
 
 struct _GConverterInputStreamPrivate {
@@ -59,13 +63,15 @@ struct _GConverterInputStreamPrivate {
   gboolean finished;
   gboolean need_input;
   GConverter *converter;
+  gsize buffer_size;
   Buffer input_buffer;
   Buffer converted_buffer;
 };
 
 enum {
   PROP_0,
-  PROP_CONVERTER
+  PROP_CONVERTER,
+  PROP_BUFFER_SIZE
 };
 
 static void   g_converter_input_stream_set_property (GObject       *object,
@@ -126,6 +132,26 @@ g_converter_input_stream_class_init (GConverterInputStreamClass *klass)
 							G_PARAM_CONSTRUCT_ONLY|
 							G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GConverterInputStream:buffer-size:
+   *
+   * The initial size of the internal buffers, in bytes.
+   * The converted data is read from the base stream in chunks of at least
+   * this size, so larger values mean fewer reads from the base stream and
+   * fewer calls to the converter when reading large amounts of data.
+   *
+   * Since: 2.76
+   */
+  g_object_class_install_property (object_class,
+                                   PROP_BUFFER_SIZE,
+                                   g_param_spec_uint ("buffer-size",
+                                                      P_("Buffer size"),
+                                                      P_("The initial size of the internal buffers"),
+                                                      1, G_MAXUINT, INITIAL_BUFFER_SIZE,
+                                                      G_PARAM_READWRITE |
+                                                      G_PARAM_CONSTRUCT_ONLY |
+                                                      G_PARAM_STATIC_STRINGS));
+
 }
 
 static void
@@ -171,6 +197,12 @@ g_converter_input_stream_set_property (GObject      *object,
       cstream->priv->converter = g_value_dup_object (value);
       break;
 
+    case PROP_BUFFER_SIZE:
+      cstream->priv->buffer_size = g_value_get_uint (value);
+      cstream->priv->input_buffer.initial_size = cstream->priv->buffer_size;
+      cstream->priv->converted_buffer.initial_size = cstream->priv->buffer_size;
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -196,6 +228,10 @@ g_converter_input_stream_get_property (GObject    *object,
       g_value_set_object (value, priv->converter);
       break;
 
+    case PROP_BUFFER_SIZE:
+      g_value_set_uint (value, priv->buffer_size);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -291,7 +327,7 @@ grow_buffer (Buffer *buffer)
   gsize size, in_buffer;
 
   if (buffer->size == 0)
-    size = INITIAL_BUFFER_SIZE;
+    size = buffer->initial_size;
   else
     size = buffer->size * 2;
 
@@ -358,7 +394,7 @@ fill_input_buffer (GConverterInputStream  *stream,
 
   priv = stream->priv;
 
-  buffer_ensure_space (&priv->input_buffer, at_least_size);
+  buffer_ensure_space (&priv->input_buffer, MAX (at_least_size, priv->buffer_size));
 
   base_stream = G_FILTER_INPUT_STREAM (stream)->base_stream;
   nread = g_pollable_stream_read (base_stream,
@@ -531,7 +567,7 @@ read_internal (GInputStream *stream,
 	  /* Need more data */
 	  my_error2 = NULL;
 	  nread = fill_input_buffer (cstream,
-				     buffer_data_size (&priv->input_buffer) + 4096,
+				     buffer_data_size (&priv->input_buffer) + priv->buffer_size,
 				     blocking,
 				     cancellable,
 				     &my_error2);
@@ -652,3 +688,22 @@ g_converter_input_stream_get_converter (GConverterInputStream *converter_stream)
 {
   return converter_stream->priv->converter;
 }
+
+/**
+ * g_converter_input_stream_get_buffer_size:
+ * @converter_stream: a #GConverterInputStream
+ *
+ * Gets the initial size of the internal buffers of @converter_stream,
+ * as set with the #GConverterInputStream:buffer-size property.
+ *
+ * Returns: the buffer size, in bytes
+ *
+ * Since: 2.76
+ */
+gsize
+g_converter_input_stream_get_buffer_size (GConverterInputStream *converter_stream)
+{
+  g_return_val_if_fail (G_IS_CONVERTER_INPUT_STREAM (converter_stream), 0);
+
+  return converter_stream->priv->buffer_size;
+}
@@ -76,6 +76,8 @@ GInputStream          *g_converter_input_stream_new           (GInputStream
                                                                GConverter            *converter);
 GIO_AVAILABLE_IN_ALL
 GConverter            *g_converter_input_stream_get_converter (GConverterInputStream *converter_stream);
+GIO_AVAILABLE_IN_2_76
+gsize                  g_converter_input_stream_get_buffer_size (GConverterInputStream *converter_stream);
 
 G_END_DECLS
 
@@ -52,12 +52,14 @@ typedef struct {
   gsize start;
   gsize end;
   gsize size;
+  gsize initial_size;
 } Buffer;
 
 struct _GConverterOutputStreamPrivate {
   gboolean at_output_end;
   gboolean finished;
   GConverter *converter;
+  gsize buffer_size;
   Buffer output_buffer; /* To be converted and written */
   Buffer converted_buffer; /* Already converted */
 };
@@ -77,7 +79,8 @@ struct _GConverterOutputStreamPrivate {
 
 enum {
   PROP_0,
-  PROP_CONVERTER
+  PROP_CONVERTER,
+  PROP_BUFFER_SIZE
 };
 
 static void   g_converter_output_stream_set_property (GObject        *object,
@@ -143,6 +146,25 @@ g_converter_output_stream_class_init (GConverterOutputStreamClass *klass)
 							G_PARAM_CONSTRUCT_ONLY|
 							G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GConverterOutputStream:buffer-size:
+   *
+   * The initial size of the internal buffers, in bytes.
+   * Larger values avoid growing the buffers step by step when large
+   * amounts of data are written at once.
+   *
+   * Since: 2.76
+   */
+  g_object_class_install_property (object_class,
+                                   PROP_BUFFER_SIZE,
+                                   g_param_spec_uint ("buffer-size",
+                                                      P_("Buffer size"),
+                                                      P_("The initial size of the internal buffers"),
+                                                      1, G_MAXUINT, INITIAL_BUFFER_SIZE,
+                                                      G_PARAM_READWRITE |
+                                                      G_PARAM_CONSTRUCT_ONLY |
+                                                      G_PARAM_STATIC_STRINGS));
+
 }
 
 static void
@@ -188,6 +210,12 @@ g_converter_output_stream_set_property (GObject      *object,
       cstream->priv->converter = g_value_dup_object (value);
       break;
 
+    case PROP_BUFFER_SIZE:
+      cstream->priv->buffer_size = g_value_get_uint (value);
+      cstream->priv->output_buffer.initial_size = cstream->priv->buffer_size;
+      cstream->priv->converted_buffer.initial_size = cstream->priv->buffer_size;
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -213,6 +241,10 @@ g_converter_output_stream_get_property (GObject    *object,
       g_value_set_object (value, priv->converter);
       break;
 
+    case PROP_BUFFER_SIZE:
+      g_value_set_uint (value, priv->buffer_size);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -297,7 +329,7 @@ grow_buffer (Buffer *buffer)
   gsize size, in_buffer;
 
   if (buffer->size == 0)
-    size = INITIAL_BUFFER_SIZE;
+    size = buffer->initial_size;
   else
     size = buffer->size * 2;
 
@@ -691,3 +723,22 @@ g_converter_output_stream_get_converter (GConverterOutputStream *converter_strea
 {
   return converter_stream->priv->converter;
 }
+
+/**
+ * g_converter_output_stream_get_buffer_size:
+ * @converter_stream: a #GConverterOutputStream
+ *
+ * Gets the initial size of the internal buffers of @converter_stream,
+ * as set with the #GConverterOutputStream:buffer-size property.
+ *
+ * Returns: the buffer size, in bytes
+ *
+ * Since: 2.76
+ */
+gsize
+g_converter_output_stream_get_buffer_size (GConverterOutputStream *converter_stream)
+{
+  g_return_val_if_fail (G_IS_CONVERTER_OUTPUT_STREAM (converter_stream), 0);
+
+  return converter_stream->priv->buffer_size;
+}
@@ -76,6 +76,8 @@ GOutputStream          *g_converter_output_stream_new           (GOutputStream
                                                                  GConverter            *converter);
 GIO_AVAILABLE_IN_ALL
 GConverter             *g_converter_output_stream_get_converter (GConverterOutputStream *converter_stream);
+GIO_AVAILABLE_IN_2_76
+gsize                   g_converter_output_stream_get_buffer_size (GConverterOutputStream *converter_stream);
 
 G_END_DECLS
 
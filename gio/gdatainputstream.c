@@ -32,6 +32,17 @@
 
 #include <string.h>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SCAN_USE_SSE2
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define SCAN_USE_NEON
+#elif defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#define SCAN_USE_WASM_SIMD128
+#endif
+
 /**
  * SECTION:gdatainputstream
  * @short_description: Data Input Stream
@@ -623,6 +634,114 @@ g_data_input_stream_read_uint64 (GDataInputStream  *stream,
   return 0;
 }
 
+/* Returns the index of the first byte in @buffer that is equal to one of
+ * the @n_chars bytes in @chars, or @len if there is none.
+ *
+ * Reading lines from big files spends most of its time here, so the common
+ * cases are vectorised: a single byte is left to memchr(), which the C
+ * library already optimises for the CPU it runs on, and up to four bytes
+ * are compared 16 at a time with SSE2, NEON or WebAssembly SIMD where the
+ * compiler targets them. Larger sets use a lookup table. */
+static gsize
+find_first_of (const guint8 *buffer,
+               gsize         len,
+               const guint8 *chars,
+               gsize         n_chars)
+{
+  gsize i = 0;
+
+  if (n_chars == 0 || len == 0)
+    return len;
+
+  if (n_chars == 1)
+    {
+      const guint8 *p = memchr (buffer, chars[0], len);
+      return p != NULL ? (gsize) (p - buffer) : len;
+    }
+
+  if (n_chars <= 4)
+    {
+      /* Repeat the last char to fill the unused comparisons */
+      guint8 c0 = chars[0];
+      guint8 c1 = chars[1];
+      guint8 c2 = chars[MIN (2, n_chars - 1)];
+      guint8 c3 = chars[MIN (3, n_chars - 1)];
+
+#if defined(SCAN_USE_SSE2)
+      __m128i v0 = _mm_set1_epi8 ((char) c0);
+      __m128i v1 = _mm_set1_epi8 ((char) c1);
+      __m128i v2 = _mm_set1_epi8 ((char) c2);
+      __m128i v3 = _mm_set1_epi8 ((char) c3);
+
+      for (; i + 16 <= len; i += 16)
+        {
+          __m128i v = _mm_loadu_si128 ((const __m128i *) (buffer + i));
+          __m128i eq = _mm_or_si128 (_mm_or_si128 (_mm_cmpeq_epi8 (v, v0), _mm_cmpeq_epi8 (v, v1)),
+                                     _mm_or_si128 (_mm_cmpeq_epi8 (v, v2), _mm_cmpeq_epi8 (v, v3)));
+          int mask = _mm_movemask_epi8 (eq);
+
+          if (mask != 0)
+            return i + g_bit_nth_lsf ((gulong) mask, -1);
+        }
+#elif defined(SCAN_USE_NEON)
+      uint8x16_t v0 = vdupq_n_u8 (c0);
+      uint8x16_t v1 = vdupq_n_u8 (c1);
+      uint8x16_t v2 = vdupq_n_u8 (c2);
+      uint8x16_t v3 = vdupq_n_u8 (c3);
+
+      for (; i + 16 <= len; i += 16)
+        {
+          uint8x16_t v = vld1q_u8 (buffer + i);
+          uint8x16_t eq = vorrq_u8 (vorrq_u8 (vceqq_u8 (v, v0), vceqq_u8 (v, v1)),
+                                    vorrq_u8 (vceqq_u8 (v, v2), vceqq_u8 (v, v3)));
+
+          /* Found something in these 16 bytes; the loop below finds it */
+          if (vmaxvq_u8 (eq) != 0)
+            break;
+        }
+#elif defined(SCAN_USE_WASM_SIMD128)
+      v128_t v0 = wasm_u8x16_splat (c0);
+      v128_t v1 = wasm_u8x16_splat (c1);
+      v128_t v2 = wasm_u8x16_splat (c2);
+      v128_t v3 = wasm_u8x16_splat (c3);
+
+      for (; i + 16 <= len; i += 16)
+        {
+          v128_t v = wasm_v128_load (buffer + i);
+          v128_t eq = wasm_v128_or (wasm_v128_or (wasm_i8x16_eq (v, v0), wasm_i8x16_eq (v, v1)),
+                                    wasm_v128_or (wasm_i8x16_eq (v, v2), wasm_i8x16_eq (v, v3)));
+          guint32 mask = wasm_i8x16_bitmask (eq);
+
+          if (mask != 0)
+            return i + g_bit_nth_lsf ((gulong) mask, -1);
+        }
+#endif
+
+      for (; i < len; i++)
+        {
+          guint8 c = buffer[i];
+
+          if (c == c0 || c == c1 || c == c2 || c == c3)
+            return i;
+        }
+
+      return len;
+    }
+  else
+    {
+      guint8 is_stop_char[256] = { 0, };
+
+      for (i = 0; i < n_chars; i++)
+        is_stop_char[chars[i]] = 1;
+
+      for (i = 0; i < len; i++)
+        if (is_stop_char[buffer[i]])
+          return i;
+
+      return len;
+    }
+}
+
 static gssize
 scan_for_newline (GDataInputStream *stream,
 		  gsize            *checked_out,
@@ -631,96 +750,231 @@ scan_for_newline (GDataInputStream *stream,
 {
   GBufferedInputStream *bstream;
   GDataInputStreamPrivate *priv;
-  const char *buffer;
-  gsize start, end, peeked;
+  const guint8 *buffer;
+  gsize start, peeked;
   gsize i;
-  gssize found_pos;
-  int newline_len;
-  gsize available, checked;
+  gsize available;
   gboolean last_saw_cr;
 
   priv = stream->priv;
   
   bstream = G_BUFFERED_INPUT_STREAM (stream);
 
-  checked = *checked_out;
   last_saw_cr = *last_saw_cr_out;
-  found_pos = -1;
-  newline_len = 0;
   
-  start = checked;
-  buffer = (const char*)g_buffered_input_stream_peek_buffer (bstream, &available) + start;
-  end = available;
-  peeked = end - start;
+  start = *checked_out;
+  buffer = (const guint8 *) g_buffered_input_stream_peek_buffer (bstream, &available) + start;
+  peeked = available > start ? available - start : 0;
+
+  if (peeked == 0)
+    return -1;
+
+  switch (priv->newline_type)
+    {
+    case G_DATA_STREAM_NEWLINE_TYPE_LF:
+      i = find_first_of (buffer, peeked, (const guint8 *) "\n", 1);
+      if (i < peeked)
+        {
+          *newline_len_out = 1;
+          return start + i;
+        }
+      break;
+
+    case G_DATA_STREAM_NEWLINE_TYPE_CR:
+      i = find_first_of (buffer, peeked, (const guint8 *) "\r", 1);
+      if (i < peeked)
+        {
+          *newline_len_out = 1;
+          return start + i;
+        }
+      break;
+
+    case G_DATA_STREAM_NEWLINE_TYPE_CR_LF:
+      /* Look for each LF in turn, and check what comes before it, which
+       * may be the last byte of the previous scan */
+      for (i = 0; i < peeked; i++)
+        {
+          i += find_first_of (buffer + i, peeked - i, (const guint8 *) "\n", 1);
+          if (i == peeked)
+            break;
+
+          if (i == 0 ? last_saw_cr : buffer[i - 1] == '\r')
+            {
+              *newline_len_out = 2;
+              return start + i - 1;
+            }
+        }
+      break;
+
+    default:
+    case G_DATA_STREAM_NEWLINE_TYPE_ANY:
+      /* A CR at the end of the previous scan is a line end on its own,
+       * unless this scan starts with the LF that goes with it */
+      if (last_saw_cr)
+        {
+          *newline_len_out = buffer[0] == '\n' ? 2 : 1;
+          return start - 1;
+        }
+
+      i = find_first_of (buffer, peeked, (const guint8 *) "\n\r", 2);
+      if (i < peeked)
+        {
+          if (buffer[i] == '\n')
+            {
+              *newline_len_out = 1;
+              return start + i;
+            }
+
+          /* Don't decide what a CR at the very end means until we see
+           * the next byte */
+          if (i + 1 < peeked)
+            {
+              *newline_len_out = buffer[i + 1] == '\n' ? 2 : 1;
+              return start + i;
+            }
+        }
+      break;
+    }
+
+  *checked_out = available;
+  *last_saw_cr_out = (buffer[peeked - 1] == '\r');
+  return -1;
+}
+		  
+
+static gssize
+scan_for_chars (GDataInputStream *stream,
+		gsize            *checked_out,
+		const char       *stop_chars,
+                gsize             stop_chars_len)
+{
+  GBufferedInputStream *bstream;
+  const guint8 *buffer;
+  gsize start, peeked;
+  gsize i;
+  gsize available;
+
+  bstream = G_BUFFERED_INPUT_STREAM (stream);
+
+  start = *checked_out;
+  buffer = (const guint8 *) g_buffered_input_stream_peek_buffer (bstream, &available) + start;
+  peeked = available > start ? available - start : 0;
+
+  i = find_first_of (buffer, peeked, (const guint8 *) stop_chars, stop_chars_len);
+  if (i < peeked)
+    return start + i;
+
+  *checked_out = MAX (available, start);
+  return -1;
+}
+
+/* Fills the buffer of @stream until it contains a whole line, growing it
+ * if needed. Returns the length of the line, storing the length of its
+ * newline in @newline_len_out, or -1 on errors and at the end of the
+ * stream, setting @error only for the former. */
+static gssize
+fill_until_newline (GDataInputStream  *stream,
+                    int               *newline_len_out,
+                    GCancellable      *cancellable,
+                    GError           **error)
+{
+  GBufferedInputStream *bstream;
+  gsize checked;
+  gboolean last_saw_cr;
+  gssize found_pos;
+  gssize res;
+  int newline_len;
 
-  for (i = 0; checked < available && i < peeked; i++)
+  bstream = G_BUFFERED_INPUT_STREAM (stream);
+
+  newline_len = 0;
+  checked = 0;
+  last_saw_cr = FALSE;
+
+  while ((found_pos = scan_for_newline (stream, &checked, &last_saw_cr, &newline_len)) == -1)
     {
-      switch (priv->newline_type)
+      if (g_buffered_input_stream_get_available (bstream) ==
+	  g_buffered_input_stream_get_buffer_size (bstream))
+	g_buffered_input_stream_set_buffer_size (bstream,
+						 2 * g_buffered_input_stream_get_buffer_size (bstream));
+
+      res = g_buffered_input_stream_fill (bstream, -1, cancellable, error);
+      if (res < 0)
+	return -1;
+      if (res == 0)
 	{
-	case G_DATA_STREAM_NEWLINE_TYPE_LF:
-	  if (buffer[i] == 10)
-	    {
-	      found_pos = start + i;
-	      newline_len = 1;
-	    }
-	  break;
-	case G_DATA_STREAM_NEWLINE_TYPE_CR:
-	  if (buffer[i] == 13)
-	    {
-	      found_pos = start + i;
-	      newline_len = 1;
-	    }
-	  break;
-	case G_DATA_STREAM_NEWLINE_TYPE_CR_LF:
-	  if (last_saw_cr && buffer[i] == 10)
-	    {
-	      found_pos = start + i - 1;
-	      newline_len = 2;
-	    }
-	  break;
-	default:
-	case G_DATA_STREAM_NEWLINE_TYPE_ANY:
-	  if (buffer[i] == 10) /* LF */
-	    {
-	      if (last_saw_cr)
-		{
-		  /* CR LF */
-		  found_pos = start + i - 1;
-		  newline_len = 2;
-		}
-	      else
-		{
-		  /* LF */
-		  found_pos = start + i;
-		  newline_len = 1;
-		}
-	    }
-	  else if (last_saw_cr)
-	    {
-	      /* Last was cr, this is not LF, end is CR */
-	      found_pos = start + i - 1;
-	      newline_len = 1;
-	    }
-	  /* Don't check for CR here, instead look at last_saw_cr on next byte */
+	  /* End of stream */
+	  if (g_buffered_input_stream_get_available (bstream) == 0)
+	    return -1;
+
+	  found_pos = checked;
+	  newline_len = 0;
 	  break;
 	}
-	
-      last_saw_cr = (buffer[i] == 13);
+    }
 
-      if (found_pos != -1)
-	{
-	  *newline_len_out = newline_len;
-	  return found_pos;
-	}
+  *newline_len_out = newline_len;
+  return found_pos;
+}
+
+/* Like fill_until_newline(), but until the buffer contains one of
+ * @stop_chars, which is not part of the returned length. */
+static gssize
+fill_until_chars (GDataInputStream  *stream,
+                  const char        *stop_chars,
+                  gsize              stop_chars_len,
+                  GCancellable      *cancellable,
+                  GError           **error)
+{
+  GBufferedInputStream *bstream;
+  gsize checked;
+  gssize found_pos;
+  gssize res;
+
+  bstream = G_BUFFERED_INPUT_STREAM (stream);
+
+  checked = 0;
+
+  while ((found_pos = scan_for_chars (stream, &checked, stop_chars, stop_chars_len)) == -1)
+    {
+      if (g_buffered_input_stream_get_available (bstream) ==
+          g_buffered_input_stream_get_buffer_size (bstream))
+        g_buffered_input_stream_set_buffer_size (bstream,
+                                                 2 * g_buffered_input_stream_get_buffer_size (bstream));
+
+      res = g_buffered_input_stream_fill (bstream, -1, cancellable, error);
+      if (res < 0)
+        return -1;
+      if (res == 0)
+        {
+          /* End of stream */
+          if (g_buffered_input_stream_get_available (bstream) == 0)
+            return -1;
+
+          found_pos = checked;
+          break;
+        }
     }
 
-  checked = end;
+  return found_pos;
+}
 
-  *checked_out = checked;
-  *last_saw_cr_out = last_saw_cr;
-  return -1;
+/* Skips @count bytes that are already in the buffer of @stream, and
+ * returns where they were. The buffer is only compacted when it is next
+ * filled, so they stay there until then. */
+static const char *
+consume_buffer (GDataInputStream *stream,
+                gsize             count)
+{
+  const char *buffer;
+  gssize res;
+
+  buffer = g_buffered_input_stream_peek_buffer (G_BUFFERED_INPUT_STREAM (stream), NULL);
+  res = g_input_stream_skip (G_INPUT_STREAM (stream), count, NULL, NULL);
+  g_warn_if_fail (res == (gssize) count);
+
+  return buffer;
 }
-		  
 
 /**
  * g_data_input_stream_read_line:
@@ -750,9 +1004,6 @@ g_data_input_stream_read_line (GDataInputStream  *stream,
 			       GCancellable      *cancellable,
 			       GError           **error)
 {
-  GBufferedInputStream *bstream;
-  gsize checked;
-  gboolean last_saw_cr;
   gssize found_pos;
   gssize res;
   int newline_len;
@@ -760,38 +1011,12 @@ g_data_input_stream_read_line (GDataInputStream  *stream,
   
   g_return_val_if_fail (G_IS_DATA_INPUT_STREAM (stream), NULL);  
 
-  bstream = G_BUFFERED_INPUT_STREAM (stream);
-
-  newline_len = 0;
-  checked = 0;
-  last_saw_cr = FALSE;
-
-  while ((found_pos = scan_for_newline (stream, &checked, &last_saw_cr, &newline_len)) == -1)
+  found_pos = fill_until_newline (stream, &newline_len, cancellable, error);
+  if (found_pos < 0)
     {
-      if (g_buffered_input_stream_get_available (bstream) ==
-	  g_buffered_input_stream_get_buffer_size (bstream))
-	g_buffered_input_stream_set_buffer_size (bstream,
-						 2 * g_buffered_input_stream_get_buffer_size (bstream));
-
-      res = g_buffered_input_stream_fill (bstream, -1, cancellable, error);
-      if (res < 0)
-	return NULL;
-      if (res == 0)
-	{
-	  /* End of stream */
-	  if (g_buffered_input_stream_get_available (bstream) == 0)
-	    {
-	      if (length)
-		*length = 0;
-	      return NULL;
-	    }
-	  else
-	    {
-	      found_pos = checked;
-	      newline_len = 0;
-	      break;
-	    }
-	}
+      if (length)
+        *length = 0;
+      return NULL;
     }
 
   line = g_malloc (found_pos + newline_len + 1);
@@ -808,6 +1033,135 @@ g_data_input_stream_read_line (GDataInputStream  *stream,
   return line;
 }
 
+/**
+ * g_data_input_stream_read_line_borrowed:
+ * @stream: a given #GDataInputStream.
+ * @length: (out): a #gsize to get the length of the line
+ * @cancellable: (nullable): optional #GCancellable object, %NULL to ignore.
+ * @error: #GError for error reporting.
+ *
+ * Reads a line from the data input stream, like
+ * g_data_input_stream_read_line(), but without copying it. The line is
+ * returned as a pointer into the buffer of @stream, which stays valid
+ * only until the next operation on @stream.
+ *
+ * The returned line is not nul-terminated: use @length. An empty line
+ * is returned as a non-%NULL pointer with a @length of 0.
+ *
+ * Returns: (nullable) (transfer none) (array length=length) (element-type guint8):
+ *  the line that was read in (without the newlines). On an error, it
+ *  will return %NULL and @error will be set. If there's no content to
+ *  read, it will still return %NULL, but @error won't be set.
+ *
+ * Since: 2.76
+ **/
+const char *
+g_data_input_stream_read_line_borrowed (GDataInputStream  *stream,
+                                        gsize             *length,
+                                        GCancellable      *cancellable,
+                                        GError           **error)
+{
+  gssize found_pos;
+  int newline_len;
+
+  g_return_val_if_fail (G_IS_DATA_INPUT_STREAM (stream), NULL);
+  g_return_val_if_fail (length != NULL, NULL);
+
+  *length = 0;
+
+  found_pos = fill_until_newline (stream, &newline_len, cancellable, error);
+  if (found_pos < 0)
+    return NULL;
+
+  *length = found_pos;
+  return consume_buffer (stream, found_pos + newline_len);
+}
+
+/**
+ * g_data_input_stream_read_lines_borrowed:
+ * @stream: a given #GDataInputStream.
+ * @lines: (out caller-allocates) (array length=n_lines): an array to
+ *   store pointers to the lines in
+ * @lengths: (out caller-allocates) (array length=n_lines): an array to
+ *   store the lengths of the lines in
+ * @n_lines: the number of elements in @lines and @lengths
+ * @cancellable: (nullable): optional #GCancellable object, %NULL to ignore.
+ * @error: #GError for error reporting.
+ *
+ * Reads up to @n_lines lines from the data input stream without copying
+ * them, like g_data_input_stream_read_line_borrowed().
+ *
+ * This blocks only until one line is available. The lines that follow it
+ * are returned as well if they are already complete in the buffer, so a
+ * caller typically gets all the lines of a buffer fill at once.
+ *
+ * The lines point into the buffer of @stream and stay valid only until
+ * the next operation on @stream. They are not nul-terminated.
+ *
+ * Returns: the number of lines stored in @lines and @lengths. On an
+ *   error, it will return 0 and @error will be set. If there's no
+ *   content to read, it will still return 0, but @error won't be set.
+ *
+ * Since: 2.76
+ **/
+gsize
+g_data_input_stream_read_lines_borrowed (GDataInputStream  *stream,
+                                         const char       **lines,
+                                         gsize             *lengths,
+                                         gsize              n_lines,
+                                         GCancellable      *cancellable,
+                                         GError           **error)
+{
+  GBufferedInputStream *bstream;
+  const char *buffer;
+  gsize available, checked, consumed;
+  gboolean last_saw_cr;
+  gssize found_pos;
+  int newline_len;
+  gsize n;
+
+  g_return_val_if_fail (G_IS_DATA_INPUT_STREAM (stream), 0);
+  g_return_val_if_fail (n_lines == 0 || (lines != NULL && lengths != NULL), 0);
+
+  if (n_lines == 0)
+    return 0;
+
+  bstream = G_BUFFERED_INPUT_STREAM (stream);
+
+  found_pos = fill_until_newline (stream, &newline_len, cancellable, error);
+  if (found_pos < 0)
+    return 0;
+
+  buffer = g_buffered_input_stream_peek_buffer (bstream, &available);
+
+  lines[0] = buffer;
+  lengths[0] = found_pos;
+  consumed = found_pos + newline_len;
+
+  /* Take the complete lines that follow from the buffer, without
+   * reading any more. scan_for_newline() works relative to the start of
+   * the buffer, so start it where the last line ended. */
+  for (n = 1; n < n_lines && consumed < available; n++)
+    {
+      checked = consumed;
+      last_saw_cr = FALSE;
+      found_pos = scan_for_newline (stream, &checked, &last_saw_cr, &newline_len);
+
+      /* An ANY newline that is a CR at the end of the buffer is not known
+       * to be complete yet either */
+      if (found_pos == -1)
+        break;
+
+      lines[n] = buffer + consumed;
+      lengths[n] = found_pos - consumed;
+      consumed = found_pos + newline_len;
+    }
+
+  consume_buffer (stream, consumed);
+
+  return n;
+}
+
 /**
  * g_data_input_stream_read_line_utf8:
  * @stream: a given #GDataInputStream.
@@ -854,45 +1208,6 @@ g_data_input_stream_read_line_utf8 (GDataInputStream  *stream,
   return res;
 }
 
-static gssize
-scan_for_chars (GDataInputStream *stream,
-		gsize            *checked_out,
-		const char       *stop_chars,
-                gsize             stop_chars_len)
-{
-  GBufferedInputStream *bstream;
-  const char *buffer;
-  gsize start, end, peeked;
-  gsize i;
-  gsize available, checked;
-  const char *stop_char;
-  const char *stop_end;
-
-  bstream = G_BUFFERED_INPUT_STREAM (stream);
-  stop_end = stop_chars + stop_chars_len;
-
-  checked = *checked_out;
-
-  start = checked;
-  buffer = (const char *)g_buffered_input_stream_peek_buffer (bstream, &available) + start;
-  end = available;
-  peeked = end - start;
-
-  for (i = 0; checked < available && i < peeked; i++)
-    {
-      for (stop_char = stop_chars; stop_char != stop_end; stop_char++)
-	{
-	  if (buffer[i] == *stop_char)
-	    return (start + i);
-	}
-    }
-
-  checked = end;
-
-  *checked_out = checked;
-  return -1;
-}
-
 /**
  * g_data_input_stream_read_until:
  * @stream: a given #GDataInputStream.
@@ -1340,8 +1655,6 @@ g_data_input_stream_read_upto (GDataInputStream  *stream,
                                GCancellable      *cancellable,
                                GError           **error)
 {
-  GBufferedInputStream *bstream;
-  gsize checked;
   gssize found_pos;
   gssize res;
   char *data_until;
@@ -1354,35 +1667,13 @@ g_data_input_stream_read_upto (GDataInputStream  *stream,
   else
     stop_chars_len_unsigned = (gsize) stop_chars_len;
 
-  bstream = G_BUFFERED_INPUT_STREAM (stream);
-
-  checked = 0;
-
-  while ((found_pos = scan_for_chars (stream, &checked, stop_chars, stop_chars_len_unsigned)) == -1)
+  found_pos = fill_until_chars (stream, stop_chars, stop_chars_len_unsigned,
+                                cancellable, error);
+  if (found_pos < 0)
     {
-      if (g_buffered_input_stream_get_available (bstream) ==
-          g_buffered_input_stream_get_buffer_size (bstream))
-        g_buffered_input_stream_set_buffer_size (bstream,
-                                                 2 * g_buffered_input_stream_get_buffer_size (bstream));
-
-      res = g_buffered_input_stream_fill (bstream, -1, cancellable, error);
-      if (res < 0)
-        return NULL;
-      if (res == 0)
-        {
-          /* End of stream */
-          if (g_buffered_input_stream_get_available (bstream) == 0)
-            {
-              if (length)
-                *length = 0;
-              return NULL;
-            }
-          else
-            {
-              found_pos = checked;
-              break;
-            }
-        }
+      if (length)
+        *length = 0;
+      return NULL;
     }
 
   data_until = g_malloc (found_pos + 1);
@@ -1399,6 +1690,57 @@ g_data_input_stream_read_upto (GDataInputStream  *stream,
   return data_until;
 }
 
+/**
+ * g_data_input_stream_read_upto_borrowed:
+ * @stream: a #GDataInputStream
+ * @stop_chars: characters to terminate the read
+ * @stop_chars_len: length of @stop_chars. May be -1 if @stop_chars is
+ *     nul-terminated
+ * @length: (out): a #gsize to get the length of the data read in
+ * @cancellable: (nullable): optional #GCancellable object, %NULL to ignore
+ * @error: #GError for error reporting
+ *
+ * Reads data from the stream until it finds any of the stop characters,
+ * like g_data_input_stream_read_upto(), but without copying it. The data
+ * is returned as a pointer into the buffer of @stream, which stays valid
+ * only until the next operation on @stream.
+ *
+ * The returned data is not nul-terminated: use @length.
+ *
+ * Returns: (nullable) (transfer none) (array length=length) (element-type guint8):
+ *     the data that was read before encountering any of the stop
+ *     characters. This function will return %NULL on an error, and at
+ *     the end of the stream without setting @error.
+ *
+ * Since: 2.76
+ */
+const char *
+g_data_input_stream_read_upto_borrowed (GDataInputStream  *stream,
+                                        const gchar       *stop_chars,
+                                        gssize             stop_chars_len,
+                                        gsize             *length,
+                                        GCancellable      *cancellable,
+                                        GError           **error)
+{
+  gssize found_pos;
+
+  g_return_val_if_fail (G_IS_DATA_INPUT_STREAM (stream), NULL);
+  g_return_val_if_fail (length != NULL, NULL);
+
+  if (stop_chars_len < 0)
+    stop_chars_len = strlen (stop_chars);
+
+  *length = 0;
+
+  found_pos = fill_until_chars (stream, stop_chars, stop_chars_len,
+                                cancellable, error);
+  if (found_pos < 0)
+    return NULL;
+
+  *length = found_pos;
+  return consume_buffer (stream, found_pos);
+}
+
 /**
  * g_data_input_stream_read_upto_async:
  * @stream: a #GDataInputStream
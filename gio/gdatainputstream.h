@@ -121,6 +121,18 @@ char *                 g_data_input_stream_read_line_utf8       (GDataInputStrea
 								 gsize                   *length,
 								 GCancellable            *cancellable,
 								 GError                 **error);
+GIO_AVAILABLE_IN_2_76
+const char *           g_data_input_stream_read_line_borrowed   (GDataInputStream        *stream,
+                                                                 gsize                   *length,
+                                                                 GCancellable            *cancellable,
+                                                                 GError                 **error);
+GIO_AVAILABLE_IN_2_76
+gsize                  g_data_input_stream_read_lines_borrowed  (GDataInputStream        *stream,
+                                                                 const char             **lines,
+                                                                 gsize                   *lengths,
+                                                                 gsize                    n_lines,
+                                                                 GCancellable            *cancellable,
+                                                                 GError                 **error);
 GIO_AVAILABLE_IN_ALL
 void                   g_data_input_stream_read_line_async      (GDataInputStream        *stream,
                                                                  gint                     io_priority,
@@ -163,6 +175,13 @@ char *                 g_data_input_stream_read_upto            (GDataInputStrea
                                                                  gsize                   *length,
                                                                  GCancellable            *cancellable,
                                                                  GError                 **error);
+GIO_AVAILABLE_IN_2_76
+const char *           g_data_input_stream_read_upto_borrowed   (GDataInputStream        *stream,
+                                                                 const gchar             *stop_chars,
+                                                                 gssize                   stop_chars_len,
+                                                                 gsize                   *length,
+                                                                 GCancellable            *cancellable,
+                                                                 GError                 **error);
 GIO_AVAILABLE_IN_ALL
 void                   g_data_input_stream_read_upto_async      (GDataInputStream        *stream,
                                                                  const gchar             *stop_chars,
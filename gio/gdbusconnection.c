@@ -1597,45 +1597,21 @@ g_dbus_connection_get_last_serial (GDBusConnection *connection)
 
 /* ---------------------------------------------------------------------------------------------------- */
 
-/* Can be called by any thread, with the connection lock held */
-static gboolean
-g_dbus_connection_send_message_unlocked (GDBusConnection   *connection,
-                                         GDBusMessage      *message,
-                                         GDBusSendMessageFlags flags,
-                                         guint32           *out_serial,
-                                         GError           **error)
+/* Can be called by any thread, with the connection lock held
+ *
+ * Assigns a serial to @message, whose wire representation is @blob,
+ * writes it to @blob and locks @message.
+ */
+static guint32
+g_dbus_connection_assign_serial_unlocked (GDBusConnection       *connection,
+                                          GDBusMessage          *message,
+                                          GDBusSendMessageFlags  flags,
+                                          guchar                *blob)
 {
-  guchar *blob;
-  gsize blob_size;
   guint32 serial_to_use;
 
   CONNECTION_ENSURE_LOCK (connection);
 
-  g_return_val_if_fail (G_IS_DBUS_CONNECTION (connection), FALSE);
-  g_return_val_if_fail (G_IS_DBUS_MESSAGE (message), FALSE);
-
-  /* TODO: check all necessary headers are present */
-
-  if (out_serial != NULL)
-    *out_serial = 0;
-
-  /* If we're in initable_init(), don't check for being initialized, to avoid
-   * chicken-and-egg problems. initable_init() is responsible for setting up
-   * our prerequisites (mainly connection->worker), and only calling us
-   * from its own thread (so no memory barrier is needed).
-   */
-  if (!check_unclosed (connection,
-                       (flags & SEND_MESSAGE_FLAGS_INITIALIZING) ? MAY_BE_UNINITIALIZED : 0,
-                       error))
-    return FALSE;
-
-  blob = g_dbus_message_to_blob (message,
-                                 &blob_size,
-                                 connection->capabilities,
-                                 error);
-  if (blob == NULL)
-    return FALSE;
-
   if (flags & G_DBUS_SEND_MESSAGE_FLAGS_PRESERVE_SERIAL)
     serial_to_use = g_dbus_message_get_serial (message);
   else
@@ -1664,9 +1640,6 @@ g_dbus_connection_send_message_unlocked (GDBusConnection   *connection,
 
   /* TODO: use connection->auth to encode the blob */
 
-  if (out_serial != NULL)
-    *out_serial = serial_to_use;
-
   /* store used serial for the current thread */
   /* TODO: watch the thread disposal and remove associated record
    *       from hashtable
@@ -1681,6 +1654,84 @@ g_dbus_connection_send_message_unlocked (GDBusConnection   *connection,
 
   g_dbus_message_lock (message);
 
+  return serial_to_use;
+}
+
+/* Can be called by any thread, with the connection lock held
+ *
+ * Assigns a serial to @message, locks it and returns its wire
+ * representation, ready to be handed over to the worker.
+ */
+static guchar *
+g_dbus_connection_encode_message_unlocked (GDBusConnection   *connection,
+                                           GDBusMessage      *message,
+                                           GDBusSendMessageFlags flags,
+                                           guint32           *out_serial,
+                                           gsize             *out_blob_size,
+                                           GError           **error)
+{
+  guchar *blob;
+  gsize blob_size;
+  guint32 serial_to_use;
+
+  CONNECTION_ENSURE_LOCK (connection);
+
+  /* TODO: check all necessary headers are present */
+
+  if (out_serial != NULL)
+    *out_serial = 0;
+
+  /* If we're in initable_init(), don't check for being initialized, to avoid
+   * chicken-and-egg problems. initable_init() is responsible for setting up
+   * our prerequisites (mainly connection->worker), and only calling us
+   * from its own thread (so no memory barrier is needed).
+   */
+  if (!check_unclosed (connection,
+                       (flags & SEND_MESSAGE_FLAGS_INITIALIZING) ? MAY_BE_UNINITIALIZED : 0,
+                       error))
+    return NULL;
+
+  blob = g_dbus_message_to_blob (message,
+                                 &blob_size,
+                                 connection->capabilities,
+                                 error);
+  if (blob == NULL)
+    return NULL;
+
+  serial_to_use = g_dbus_connection_assign_serial_unlocked (connection, message, flags, blob);
+
+  if (out_serial != NULL)
+    *out_serial = serial_to_use;
+
+  *out_blob_size = blob_size;
+  return blob;
+}
+
+/* Can be called by any thread, with the connection lock held */
+static gboolean
+g_dbus_connection_send_message_unlocked (GDBusConnection   *connection,
+                                         GDBusMessage      *message,
+                                         GDBusSendMessageFlags flags,
+                                         guint32           *out_serial,
+                                         GError           **error)
+{
+  guchar *blob;
+  gsize blob_size;
+
+  CONNECTION_ENSURE_LOCK (connection);
+
+  g_return_val_if_fail (G_IS_DBUS_CONNECTION (connection), FALSE);
+  g_return_val_if_fail (G_IS_DBUS_MESSAGE (message), FALSE);
+
+  blob = g_dbus_connection_encode_message_unlocked (connection,
+                                                    message,
+                                                    flags,
+                                                    out_serial,
+                                                    &blob_size,
+                                                    error);
+  if (blob == NULL)
+    return FALSE;
+
   _g_dbus_worker_send_message (connection->worker,
                                message,
                                (gchar*) blob, /* transfer ownership */
@@ -1756,6 +1807,14 @@ typedef struct
   GSource *timeout_source;
 
   gboolean delivered;
+
+  /* Only used for batches sent with g_dbus_connection_send_messages_with_reply():
+   * the messages have consecutive serials starting at @serial, and each entry
+   * still pending in map_method_serial_to_task holds a reference to the task.
+   */
+  GDBusMessage **replies;
+  guint n_messages;
+  guint n_pending;
 } SendMessageData;
 
 /* Can be called from any thread with or without lock held */
@@ -1765,6 +1824,15 @@ send_message_data_free (SendMessageData *data)
   g_assert (data->timeout_source == NULL);
   g_assert (data->cancellable_handler_id == 0);
 
+  if (data->replies != NULL)
+    {
+      guint n;
+
+      for (n = 0; n < data->n_messages; n++)
+        g_clear_object (&data->replies[n]);
+      g_free (data->replies);
+    }
+
   g_slice_free (SendMessageData, data);
 }
 
@@ -1794,7 +1862,22 @@ send_message_with_reply_cleanup (GTask *task, gboolean remove)
       data->cancellable_handler_id = 0;
     }
 
-  if (remove)
+  if (remove && data->replies != NULL)
+    {
+      guint n;
+
+      /* Drop the references held by the calls still waiting for a reply;
+       * ours keeps @task alive until the end of this function.
+       */
+      for (n = 0; n < data->n_messages; n++)
+        {
+          if (data->replies[n] == NULL &&
+              g_hash_table_remove (connection->map_method_serial_to_task,
+                                   GUINT_TO_POINTER (data->serial + n)))
+            g_object_unref (task);
+        }
+    }
+  else if (remove)
     {
       gboolean removed = g_hash_table_remove (connection->map_method_serial_to_task,
                                               GUINT_TO_POINTER (data->serial));
@@ -1806,6 +1889,47 @@ send_message_with_reply_cleanup (GTask *task, gboolean remove)
 
 /* ---------------------------------------------------------------------------------------------------- */
 
+/* Called from GDBus worker thread with lock held; @task is (transfer full),
+ * that is, the reference held by the entry for @reply in
+ * map_method_serial_to_task.
+ */
+static void
+send_message_batch_deliver_reply_unlocked (GTask        *task,
+                                           GDBusMessage *reply)
+{
+  GDBusConnection *connection = g_task_get_source_object (task);
+  SendMessageData *data = g_task_get_task_data (task);
+  guint32 reply_serial;
+  guint n;
+
+  reply_serial = g_dbus_message_get_reply_serial (reply);
+  n = reply_serial - data->serial;
+  g_assert (n < data->n_messages);
+
+  g_hash_table_remove (connection->map_method_serial_to_task,
+                       GUINT_TO_POINTER (reply_serial));
+
+  if (!data->delivered && data->replies[n] == NULL)
+    {
+      data->replies[n] = g_object_ref (reply);
+      data->n_pending--;
+
+      if (data->n_pending == 0)
+        {
+          GPtrArray *replies;
+
+          replies = g_ptr_array_new_full (data->n_messages, g_object_unref);
+          for (n = 0; n < data->n_messages; n++)
+            g_ptr_array_add (replies, g_object_ref (data->replies[n]));
+
+          g_task_return_pointer (task, replies, (GDestroyNotify) g_ptr_array_unref);
+          send_message_with_reply_cleanup (task, TRUE);
+        }
+    }
+
+  g_object_unref (task);
+}
+
 /* Called from GDBus worker thread with lock held; @task is (transfer full). */
 static void
 send_message_data_deliver_reply_unlocked (GTask           *task,
@@ -1813,6 +1937,12 @@ send_message_data_deliver_reply_unlocked (GTask           *task,
 {
   SendMessageData *data = g_task_get_task_data (task);
 
+  if (data->replies != NULL)
+    {
+      send_message_batch_deliver_reply_unlocked (task, reply);
+      return;
+    }
+
   if (data->delivered)
     goto out;
 
@@ -2067,6 +2197,208 @@ g_dbus_connection_send_message_with_reply_finish (GDBusConnection  *connection,
 
 /* ---------------------------------------------------------------------------------------------------- */
 
+/**
+ * g_dbus_connection_send_messages_with_reply:
+ * @connection: a #GDBusConnection
+ * @messages: (array length=n_messages): method call messages to send
+ * @n_messages: the number of messages in @messages, at least one
+ * @timeout_msec: the timeout in milliseconds for the whole batch, -1 to use
+ *     the default timeout or %G_MAXINT for no timeout
+ * @cancellable: (nullable): a #GCancellable or %NULL
+ * @callback: (nullable): a #GAsyncReadyCallback to call when all replies
+ *     have arrived or %NULL if you don't care about the result
+ * @user_data: The data to pass to @callback
+ *
+ * Asynchronously sends a batch of method calls to the peer represented by
+ * @connection and waits for all of their replies.
+ *
+ * This is equivalent to calling g_dbus_connection_send_message_with_reply()
+ * for each of @messages, except that the messages are assigned consecutive
+ * serial numbers and handed to the transport together, so that they are
+ * pipelined into as few writes as possible. Instead of one completion per
+ * message, @callback is invoked once, after the last reply arrived. You can
+ * then call g_dbus_connection_send_messages_with_reply_finish() to get the
+ * replies in the same order as @messages.
+ *
+ * Each of @messages must be an unlocked message of type
+ * %G_DBUS_MESSAGE_TYPE_METHOD_CALL which expects a reply. If any of them
+ * cannot be serialized, none of them is sent and the operation fails.
+ *
+ * The batch fails as a whole: if @connection is closed, @cancellable is
+ * cancelled or not all replies arrived within @timeout_msec, the operation
+ * fails with %G_IO_ERROR_CLOSED, %G_IO_ERROR_CANCELLED or
+ * %G_IO_ERROR_TIMED_OUT respectively, and any late replies are ignored.
+ *
+ * This is an asynchronous method. When the operation is finished, @callback
+ * will be invoked in the
+ * [thread-default main context][g-main-context-push-thread-default]
+ * of the thread you are calling this method from.
+ *
+ * Since: 2.76
+ */
+void
+g_dbus_connection_send_messages_with_reply (GDBusConnection      *connection,
+                                            GDBusMessage        **messages,
+                                            guint                 n_messages,
+                                            gint                  timeout_msec,
+                                            GCancellable         *cancellable,
+                                            GAsyncReadyCallback   callback,
+                                            gpointer              user_data)
+{
+  GTask *task;
+  SendMessageData *data;
+  gchar **blobs;
+  gsize *blob_sizes;
+  GError *error = NULL;
+  guint n;
+
+  g_return_if_fail (G_IS_DBUS_CONNECTION (connection));
+  g_return_if_fail (messages != NULL);
+  g_return_if_fail (n_messages > 0);
+  g_return_if_fail (timeout_msec >= 0 || timeout_msec == -1);
+  for (n = 0; n < n_messages; n++)
+    {
+      g_return_if_fail (G_IS_DBUS_MESSAGE (messages[n]));
+      g_return_if_fail (!g_dbus_message_get_locked (messages[n]));
+      g_return_if_fail (g_dbus_message_get_message_type (messages[n]) == G_DBUS_MESSAGE_TYPE_METHOD_CALL);
+      g_return_if_fail (!(g_dbus_message_get_flags (messages[n]) & G_DBUS_MESSAGE_FLAGS_NO_REPLY_EXPECTED));
+    }
+
+  if (timeout_msec == -1)
+    timeout_msec = 25 * 1000;
+
+  data = g_slice_new0 (SendMessageData);
+  data->replies = g_new0 (GDBusMessage *, n_messages);
+  data->n_messages = n_messages;
+  data->n_pending = n_messages;
+
+  /* This reference is dropped by send_message_with_reply_cleanup() */
+  task = g_task_new (connection, cancellable, callback, user_data);
+  g_task_set_source_tag (task, g_dbus_connection_send_messages_with_reply);
+  g_task_set_task_data (task, data, (GDestroyNotify) send_message_data_free);
+
+  if (g_task_return_error_if_cancelled (task))
+    {
+      g_object_unref (task);
+      return;
+    }
+
+  blobs = g_new (gchar *, n_messages);
+  blob_sizes = g_new (gsize, n_messages);
+
+  CONNECTION_LOCK (connection);
+
+  /* Serialize all the messages before touching any of them, so that a
+   * failure leaves them all unlocked and consumes no serials */
+  if (check_unclosed (connection, 0, &error))
+    {
+      for (n = 0; n < n_messages; n++)
+        {
+          blobs[n] = (gchar *) g_dbus_message_to_blob (messages[n],
+                                                       &blob_sizes[n],
+                                                       connection->capabilities,
+                                                       &error);
+          if (blobs[n] == NULL)
+            break;
+        }
+    }
+  else
+    n = 0;
+
+  if (error != NULL)
+    {
+      CONNECTION_UNLOCK (connection);
+
+      while (n > 0)
+        g_free (blobs[--n]);
+      g_free (blobs);
+      g_free (blob_sizes);
+
+      g_task_return_error (task, error);
+      g_object_unref (task);
+      return;
+    }
+
+  /* Serials are handed out under the lock, so they are consecutive */
+  for (n = 0; n < n_messages; n++)
+    {
+      guint32 serial;
+
+      serial = g_dbus_connection_assign_serial_unlocked (connection,
+                                                         messages[n],
+                                                         G_DBUS_SEND_MESSAGE_FLAGS_NONE,
+                                                         (guchar *) blobs[n]);
+      if (n == 0)
+        data->serial = serial;
+      g_assert (serial == data->serial + n);
+    }
+
+  _g_dbus_worker_send_messages (connection->worker,
+                                messages,
+                                blobs, /* transfer ownership of the elements */
+                                blob_sizes,
+                                n_messages);
+  g_free (blobs);
+  g_free (blob_sizes);
+
+  if (cancellable != NULL)
+    {
+      data->cancellable_handler_id = g_cancellable_connect (cancellable,
+                                                            G_CALLBACK (send_message_with_reply_cancelled_cb),
+                                                            g_object_ref (task),
+                                                            g_object_unref);
+    }
+
+  if (timeout_msec != G_MAXINT)
+    {
+      data->timeout_source = g_timeout_source_new (timeout_msec);
+      g_source_set_static_name (data->timeout_source, "[gio] g_dbus_connection_send_messages_with_reply");
+      g_task_attach_source (task, data->timeout_source,
+                            (GSourceFunc) send_message_with_reply_timeout_cb);
+      g_source_unref (data->timeout_source);
+    }
+
+  for (n = 0; n < n_messages; n++)
+    g_hash_table_insert (connection->map_method_serial_to_task,
+                         GUINT_TO_POINTER (data->serial + n),
+                         g_object_ref (task));
+
+  CONNECTION_UNLOCK (connection);
+}
+
+/**
+ * g_dbus_connection_send_messages_with_reply_finish:
+ * @connection: a #GDBusConnection
+ * @res: a #GAsyncResult obtained from the #GAsyncReadyCallback passed to
+ *     g_dbus_connection_send_messages_with_reply()
+ * @error: return location for error or %NULL
+ *
+ * Finishes an operation started with g_dbus_connection_send_messages_with_reply().
+ *
+ * Note that @error is only set if a local in-process error occurred. Each
+ * of the returned messages may be of type %G_DBUS_MESSAGE_TYPE_ERROR; use
+ * g_dbus_message_to_gerror() to transcode those to a #GError.
+ *
+ * Returns: (transfer container) (element-type GDBusMessage): the locked
+ *     replies, in the order of the messages passed to
+ *     g_dbus_connection_send_messages_with_reply(), or %NULL if @error is set
+ *
+ * Since: 2.76
+ */
+GPtrArray *
+g_dbus_connection_send_messages_with_reply_finish (GDBusConnection  *connection,
+                                                   GAsyncResult     *res,
+                                                   GError          **error)
+{
+  g_return_val_if_fail (G_IS_DBUS_CONNECTION (connection), NULL);
+  g_return_val_if_fail (g_task_is_valid (res, connection), NULL);
+  g_return_val_if_fail (error == NULL || *error == NULL, NULL);
+
+  return g_task_propagate_pointer (G_TASK (res), error);
+}
+
+/* ---------------------------------------------------------------------------------------------------- */
+
 typedef struct
 {
   GAsyncResult *res;
@@ -2398,6 +2730,23 @@ cancel_method_on_close (gpointer key, gpointer value, gpointer user_data)
   GTask *task = value;
   SendMessageData *data = g_task_get_task_data (task);
 
+  if (data->replies != NULL)
+    {
+      /* Each pending call of a batch holds its own reference to @task, so
+       * the batch is failed once and every entry is dropped.
+       */
+      if (!data->delivered)
+        {
+          g_task_return_new_error (task,
+                                   G_IO_ERROR,
+                                   G_IO_ERROR_CLOSED,
+                                   _("The connection is closed"));
+          send_message_with_reply_cleanup (task, FALSE);
+        }
+      g_object_unref (task);
+      return TRUE;
+    }
+
   if (data->delivered)
     return FALSE;
 
@@ -180,6 +180,18 @@ GDBusMessage    *g_dbus_connection_send_message_with_reply_sync   (GDBusConnecti
                                                                    volatile guint32    *out_serial,
                                                                    GCancellable        *cancellable,
                                                                    GError             **error);
+GIO_AVAILABLE_IN_2_76
+void             g_dbus_connection_send_messages_with_reply       (GDBusConnection     *connection,
+                                                                   GDBusMessage       **messages,
+                                                                   guint                n_messages,
+                                                                   gint                 timeout_msec,
+                                                                   GCancellable        *cancellable,
+                                                                   GAsyncReadyCallback  callback,
+                                                                   gpointer             user_data);
+GIO_AVAILABLE_IN_2_76
+GPtrArray       *g_dbus_connection_send_messages_with_reply_finish (GDBusConnection     *connection,
+                                                                   GAsyncResult        *res,
+                                                                   GError             **error);
 
 /* ---------------------------------------------------------------------------------------------------- */
 
@@ -890,6 +890,10 @@ struct _MessageToWriteData
 {
   GDBusWorker  *worker;
   GDBusMessage *message;
+  /* (element-type GDBusMessage) (nullable): when several messages are
+   * pipelined into one @blob, all of them in wire order; @message is
+   * then the first element */
+  GPtrArray    *pipelined;
   gchar        *blob;
   gsize         blob_size;
 
@@ -903,6 +907,8 @@ message_to_write_data_free (MessageToWriteData *data)
   _g_dbus_worker_unref (data->worker);
   if (data->message)
     g_object_unref (data->message);
+  if (data->pipelined)
+    g_ptr_array_unref (data->pipelined);
   g_free (data->blob);
   g_slice_free (MessageToWriteData, data);
 }
@@ -1254,13 +1260,32 @@ message_written_unlocked (GDBusWorker *worker,
     {
       gchar *s;
       _g_dbus_debug_print_lock ();
-      g_print ("========================================================================\n"
-               "GDBus-debug:Message:\n"
-               "  >>>> SENT D-Bus message (%" G_GSIZE_FORMAT " bytes)\n",
-               message_data->blob_size);
-      s = g_dbus_message_print (message_data->message, 2);
-      g_print ("%s", s);
-      g_free (s);
+      if (message_data->pipelined != NULL)
+        {
+          guint n;
+
+          g_print ("========================================================================\n"
+                   "GDBus-debug:Message:\n"
+                   "  >>>> SENT %u pipelined D-Bus messages (%" G_GSIZE_FORMAT " bytes)\n",
+                   message_data->pipelined->len,
+                   message_data->blob_size);
+          for (n = 0; n < message_data->pipelined->len; n++)
+            {
+              s = g_dbus_message_print (g_ptr_array_index (message_data->pipelined, n), 2);
+              g_print ("%s", s);
+              g_free (s);
+            }
+        }
+      else
+        {
+          g_print ("========================================================================\n"
+                   "GDBus-debug:Message:\n"
+                   "  >>>> SENT D-Bus message (%" G_GSIZE_FORMAT " bytes)\n",
+                   message_data->blob_size);
+          s = g_dbus_message_print (message_data->message, 2);
+          g_print ("%s", s);
+          g_free (s);
+        }
       if (G_UNLIKELY (_g_dbus_debug_payload ()))
         {
           s = _g_dbus_hexdump (message_data->blob, message_data->blob_size, 2);
@@ -1425,6 +1450,96 @@ iostream_close_cb (GObject      *source_object,
   _g_dbus_worker_unref (worker);
 }
 
+/* called in private thread shared by all GDBusConnection instances
+ *
+ * Runs the outgoing filters over every message of a pipelined write and
+ * re-encodes the blob if any of them altered or dropped a message.
+ *
+ * write-lock is not held on entry
+ * output_pending is PENDING_WRITE on entry
+ *
+ * Returns: %FALSE if the filters dropped every message
+ */
+static gboolean
+filter_pipelined_messages (GDBusWorker        *worker,
+                           MessageToWriteData *data)
+{
+  GPtrArray *filtered;
+  GByteArray *blob;
+  gboolean altered;
+  guint n;
+
+  altered = FALSE;
+  filtered = g_ptr_array_new_full (data->pipelined->len, g_object_unref);
+  for (n = 0; n < data->pipelined->len; n++)
+    {
+      GDBusMessage *old_message = g_ptr_array_index (data->pipelined, n);
+      GDBusMessage *message;
+
+      message = _g_dbus_worker_emit_message_about_to_be_sent (worker, g_object_ref (old_message));
+      if (message != old_message)
+        altered = TRUE;
+      if (message != NULL)
+        g_ptr_array_add (filtered, message);
+    }
+
+  if (!altered)
+    {
+      /* filters had no effect - do nothing */
+      g_ptr_array_unref (filtered);
+      return TRUE;
+    }
+
+  if (filtered->len == 0)
+    {
+      /* filters dropped all messages */
+      g_ptr_array_unref (filtered);
+      return FALSE;
+    }
+
+  /* filters altered some messages -> re-encode all of them */
+  blob = g_byte_array_sized_new (data->blob_size);
+  for (n = 0; n < filtered->len; n++)
+    {
+      GDBusMessage *message = g_ptr_array_index (filtered, n);
+      guchar *new_blob;
+      gsize new_blob_size;
+      GError *error = NULL;
+
+      new_blob = g_dbus_message_to_blob (message,
+                                         &new_blob_size,
+                                         worker->capabilities,
+                                         &error);
+      if (new_blob == NULL)
+        {
+          /* as for single messages, complain on stderr and send the old
+           * messages instead
+           */
+          g_warning ("Error encoding GDBusMessage with serial %d altered by filter function: %s",
+                     g_dbus_message_get_serial (message),
+                     error->message);
+          g_error_free (error);
+          g_byte_array_unref (blob);
+          g_ptr_array_unref (filtered);
+          return TRUE;
+        }
+
+      g_byte_array_append (blob, new_blob, new_blob_size);
+      g_free (new_blob);
+    }
+
+  g_free (data->blob);
+  data->blob_size = blob->len;
+  data->blob = (gchar *) g_byte_array_free (blob, FALSE);
+
+  g_object_unref (data->message);
+  data->message = g_object_ref (g_ptr_array_index (filtered, 0));
+  g_ptr_array_unref (data->pipelined);
+  data->pipelined = filtered;
+
+  return TRUE;
+}
+
 /* called in private thread shared by all GDBusConnection instances
  *
  * write-lock is not held on entry
@@ -1496,6 +1611,24 @@ continue_writing (GDBusWorker *worker)
       gsize new_blob_size;
       GError *error;
 
+      if (data->pipelined != NULL)
+        {
+          if (!filter_pipelined_messages (worker, data))
+            {
+              g_mutex_lock (&worker->write_lock);
+              worker->output_pending = PENDING_NONE;
+              g_mutex_unlock (&worker->write_lock);
+              message_to_write_data_free (data);
+              goto write_next;
+            }
+
+          write_message_async (worker,
+                               data,
+                               write_message_cb,
+                               data);
+          return;
+        }
+
       old_message = data->message;
       data->message = _g_dbus_worker_emit_message_about_to_be_sent (worker, data->message);
       if (data->message == old_message)
@@ -1650,6 +1783,97 @@ _g_dbus_worker_send_message (GDBusWorker    *worker,
   g_mutex_unlock (&worker->write_lock);
 }
 
+#ifdef G_OS_UNIX
+static gboolean
+message_has_unix_fds (GDBusMessage *message)
+{
+  GUnixFDList *fd_list = g_dbus_message_get_unix_fd_list (message);
+
+  return fd_list != NULL && g_unix_fd_list_get_length (fd_list) > 0;
+}
+#else
+#define message_has_unix_fds(message) FALSE
+#endif
+
+/* can be called from any thread - steals the blobs (but not the @blobs array)
+ *
+ * Queues all of @messages with a single wakeup of the worker thread.
+ * Consecutive messages without file descriptors attached are pipelined:
+ * their blobs are concatenated and written out in as few writes as the
+ * transport allows.
+ *
+ * write_lock is not held on entry
+ * output_pending may be anything
+ */
+void
+_g_dbus_worker_send_messages (GDBusWorker   *worker,
+                              GDBusMessage **messages,
+                              gchar        **blobs,
+                              const gsize   *blob_lens,
+                              guint          n_messages)
+{
+  GQueue to_write = G_QUEUE_INIT;
+  guint n;
+
+  g_return_if_fail (n_messages > 0);
+
+  n = 0;
+  while (n < n_messages)
+    {
+      MessageToWriteData *data;
+      guint end;
+
+      g_return_if_fail (G_IS_DBUS_MESSAGE (messages[n]));
+      g_return_if_fail (blobs[n] != NULL);
+      g_return_if_fail (blob_lens[n] > 16);
+
+      end = n + 1;
+      if (!message_has_unix_fds (messages[n]))
+        {
+          while (end < n_messages && !message_has_unix_fds (messages[end]))
+            end++;
+        }
+
+      data = g_slice_new0 (MessageToWriteData);
+      data->worker = _g_dbus_worker_ref (worker);
+      data->message = g_object_ref (messages[n]);
+
+      if (end - n == 1)
+        {
+          data->blob = blobs[n]; /* steal! */
+          data->blob_size = blob_lens[n];
+        }
+      else
+        {
+          gsize offset;
+          guint i;
+
+          data->pipelined = g_ptr_array_new_full (end - n, g_object_unref);
+          for (i = n; i < end; i++)
+            data->blob_size += blob_lens[i];
+          data->blob = g_malloc (data->blob_size);
+
+          offset = 0;
+          for (i = n; i < end; i++)
+            {
+              g_ptr_array_add (data->pipelined, g_object_ref (messages[i]));
+              memcpy (data->blob + offset, blobs[i], blob_lens[i]);
+              offset += blob_lens[i];
+              g_free (blobs[i]);
+            }
+        }
+
+      g_queue_push_tail (&to_write, data);
+      n = end;
+    }
+
+  g_mutex_lock (&worker->write_lock);
+  while (to_write.length > 1)
+    g_queue_push_tail (worker->write_queue, g_queue_pop_head (&to_write));
+  schedule_writing_unlocked (worker, g_queue_pop_head (&to_write), NULL, NULL);
+  g_mutex_unlock (&worker->write_lock);
+}
+
 /* ---------------------------------------------------------------------------------------------------- */
 
 GDBusWorker *
@@ -61,6 +61,13 @@ void         _g_dbus_worker_send_message (GDBusWorker    *worker,
                                           gchar          *blob,
                                           gsize           blob_len);
 
+/* can be called from any thread - steals blobs */
+void         _g_dbus_worker_send_messages (GDBusWorker   *worker,
+                                           GDBusMessage **messages,
+                                           gchar        **blobs,
+                                           const gsize   *blob_lens,
+                                           guint          n_messages);
+
 /* can be called from any thread */
 void         _g_dbus_worker_stop         (GDBusWorker    *worker);
 
@@ -32,11 +32,14 @@
 #define BTRFS_IOC_CLONE _IOW(BTRFS_IOCTL_MAGIC, 9, int)
 #endif
 
-#ifdef HAVE_SPLICE
+#if defined(HAVE_SPLICE) || defined(HAVE_COPY_FILE_RANGE)
 #include <sys/stat.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <errno.h>
+#endif
+
+#ifdef HAVE_SPLICE
 
 /*
  * We duplicate the following Linux kernel header defines here so we can still
@@ -3148,6 +3151,103 @@ splice_stream_with_progress (GInputStream           *in,
 }
 #endif
 
+#ifdef HAVE_COPY_FILE_RANGE
+/* Size of each copy_file_range() call, which bounds how long cancellation
+ * and progress reporting can be delayed */
+#define COPY_FILE_RANGE_CHUNK_SIZE (16 * 1024 * 1024)
+
+static gboolean
+copy_file_range_with_progress (GInputStream           *in,
+                               GOutputStream          *out,
+                               GCancellable           *cancellable,
+                               GFileProgressCallback   progress_callback,
+                               gpointer                progress_callback_data,
+                               GError                **error)
+{
+  goffset total_size;
+  off_t offset_in;
+  off_t offset_out;
+  int fd_in, fd_out;
+
+  fd_in = g_file_descriptor_based_get_fd (G_FILE_DESCRIPTOR_BASED (in));
+  fd_out = g_file_descriptor_based_get_fd (G_FILE_DESCRIPTOR_BASED (out));
+
+  total_size = -1;
+  /* avoid performance impact of querying total size when it's not needed */
+  if (progress_callback)
+    {
+      struct stat sbuf;
+
+      if (fstat (fd_in, &sbuf) == 0)
+        total_size = sbuf.st_size;
+    }
+
+  if (total_size == -1)
+    total_size = 0;
+
+  /* Explicit offsets leave the file positions of both descriptors alone,
+   * so the other strategies can start over if this one isn’t supported. */
+  offset_in = offset_out = 0;
+  while (TRUE)
+    {
+      ssize_t n_copied;
+
+      if (g_cancellable_set_error_if_cancelled (cancellable, error))
+        return FALSE;
+
+      n_copied = copy_file_range (fd_in, &offset_in, fd_out, &offset_out,
+                                  COPY_FILE_RANGE_CHUNK_SIZE, 0);
+
+      if (n_copied == -1)
+        {
+          int errsv = errno;
+
+          if (errsv == EINTR)
+            continue;
+
+          /* Only fall back if nothing was copied yet; a failure part way
+           * through is a real error. */
+          if (offset_in == 0 &&
+              (errsv == ENOSYS || errsv == EXDEV || errsv == EINVAL ||
+               errsv == EOPNOTSUPP || errsv == EBADF || errsv == EPERM))
+            g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                                 _("Copy (copy_file_range) is not supported"));
+          else
+            g_set_error (error, G_IO_ERROR,
+                         g_io_error_from_errno (errsv),
+                         _("Error copying file: %s"),
+                         g_strerror (errsv));
+
+          return FALSE;
+        }
+
+      if (n_copied == 0)
+        {
+          /* Some pseudo file systems report files as empty to
+           * copy_file_range() even though they can be read, so leave those
+           * to the other strategies. */
+          if (offset_in == 0)
+            {
+              g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                                   _("Copy (copy_file_range) is not supported"));
+              return FALSE;
+            }
+
+          break;
+        }
+
+      if (progress_callback)
+        progress_callback (offset_in, total_size, progress_callback_data);
+    }
+
+  /* Make sure we send full copied size */
+  if (progress_callback)
+    progress_callback (offset_in, total_size, progress_callback_data);
+
+  return TRUE;
+}
+#endif
+
 #ifdef __linux__
 static gboolean
 btrfs_reflink_with_progress (GInputStream           *in,
@@ -3361,6 +3461,33 @@ file_copy_fallback (GFile                  *source,
   if (!out)
     goto out;
 
+#ifdef HAVE_COPY_FILE_RANGE
+  if (G_IS_FILE_DESCRIPTOR_BASED (in) && G_IS_FILE_DESCRIPTOR_BASED (out))
+    {
+      GError *copy_file_range_err = NULL;
+
+      if (!copy_file_range_with_progress (in, out, cancellable,
+                                          progress_callback, progress_callback_data,
+                                          &copy_file_range_err))
+        {
+          if (g_error_matches (copy_file_range_err, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED))
+            {
+              g_clear_error (&copy_file_range_err);
+            }
+          else
+            {
+              g_propagate_error (error, copy_file_range_err);
+              goto out;
+            }
+        }
+      else
+        {
+          ret = TRUE;
+          goto out;
+        }
+    }
+#endif
+
 #ifdef __linux__
   if (G_IS_FILE_DESCRIPTOR_BASED (in) && G_IS_FILE_DESCRIPTOR_BASED (out))
     {
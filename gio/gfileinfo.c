@@ -97,10 +97,19 @@ typedef struct {
   guint32 attribute_id_counter;
 } NSInfo;
 
-G_LOCK_DEFINE_STATIC (attribute_hash);
+/* ns_hash, attribute_hash and global_attributes are only modified with
+ * attribute_lock held for writing. The namespaces and attributes registered
+ * in ensure_attribute_hash() are also copied to known_ns_hash and
+ * known_attribute_hash, which are never modified afterwards and so can be
+ * read without taking the lock. This keeps threads that enumerate files in
+ * parallel from contending on the lock for the common attributes.
+ */
+static GRWLock attribute_lock;
 static int namespace_id_counter = 0;
 static GHashTable *ns_hash = NULL;
 static GHashTable *attribute_hash = NULL;
+static GHashTable *known_ns_hash = NULL;
+static GHashTable *known_attribute_hash = NULL;
 static char ***global_attributes = NULL;
 
 /* Attribute ids are 32bit, we split it up like this:
@@ -176,10 +185,27 @@ _lookup_attribute (const char *attribute)
   return attr_id;
 }
 
+static GHashTable *
+copy_hash_table (GHashTable *table)
+{
+  GHashTable *copy;
+  GHashTableIter iter;
+  gpointer key, value;
+
+  copy = g_hash_table_new (g_str_hash, g_str_equal);
+  g_hash_table_iter_init (&iter, table);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    g_hash_table_insert (copy, key, value);
+
+  return copy;
+}
+
 static void
 ensure_attribute_hash (void)
 {
-  if (attribute_hash != NULL)
+  static gsize initialized = 0;
+
+  if (!g_once_init_enter (&initialized))
     return;
 
   ns_hash = g_hash_table_new (g_str_hash, g_str_equal);
@@ -278,6 +304,11 @@ ensure_attribute_hash (void)
   REGISTER_ATTRIBUTE (TRASH_DELETION_DATE);
 
 #undef REGISTER_ATTRIBUTE
+
+  known_ns_hash = copy_hash_table (ns_hash);
+  known_attribute_hash = copy_hash_table (attribute_hash);
+
+  g_once_init_leave (&initialized, 1);
 }
 
 static guint32
@@ -286,16 +317,24 @@ lookup_namespace (const char *namespace)
   NSInfo *ns_info;
   guint32 id;
 
-  G_LOCK (attribute_hash);
-
   ensure_attribute_hash ();
 
-  ns_info = _lookup_namespace (namespace);
-  id = 0;
-  if (ns_info)
-    id = ns_info->id;
+  ns_info = g_hash_table_lookup (known_ns_hash, namespace);
+  if (ns_info != NULL)
+    return ns_info->id;
+
+  g_rw_lock_reader_lock (&attribute_lock);
+  ns_info = g_hash_table_lookup (ns_hash, namespace);
+  id = (ns_info != NULL) ? ns_info->id : 0;
+  g_rw_lock_reader_unlock (&attribute_lock);
 
-  G_UNLOCK (attribute_hash);
+  if (id != 0)
+    return id;
+
+  g_rw_lock_writer_lock (&attribute_lock);
+  ns_info = _lookup_namespace (namespace);
+  id = ns_info->id;
+  g_rw_lock_writer_unlock (&attribute_lock);
 
   return id;
 }
@@ -304,9 +343,13 @@ static char *
 get_attribute_for_id (int attribute)
 {
   char *s;
-  G_LOCK (attribute_hash);
+
+  ensure_attribute_hash ();
+
+  g_rw_lock_reader_lock (&attribute_lock);
   s = global_attributes[GET_NS (attribute)][GET_ID (attribute)];
-  G_UNLOCK (attribute_hash);
+  g_rw_lock_reader_unlock (&attribute_lock);
+
   return s;
 }
 
@@ -315,12 +358,24 @@ lookup_attribute (const char *attribute)
 {
   guint32 attr_id;
 
-  G_LOCK (attribute_hash);
   ensure_attribute_hash ();
 
-  attr_id = _lookup_attribute (attribute);
+  attr_id = GPOINTER_TO_UINT (g_hash_table_lookup (known_attribute_hash, attribute));
+  if (attr_id != 0)
+    return attr_id;
+
+  g_rw_lock_reader_lock (&attribute_lock);
+  attr_id = GPOINTER_TO_UINT (g_hash_table_lookup (attribute_hash, attribute));
+  g_rw_lock_reader_unlock (&attribute_lock);
+
+  if (attr_id != 0)
+    return attr_id;
 
-  G_UNLOCK (attribute_hash);
+  /* _lookup_attribute() checks again, in case another thread added the
+   * attribute since we dropped the reader lock */
+  g_rw_lock_writer_lock (&attribute_lock);
+  attr_id = _lookup_attribute (attribute);
+  g_rw_lock_writer_unlock (&attribute_lock);
 
   return attr_id;
 }
@@ -1488,7 +1543,6 @@ g_file_info_set_attribute_int64  (GFileInfo  *info,
 GDateTime *
 g_file_info_get_deletion_date (GFileInfo *info)
 {
-  static guint32 attr = 0;
   GFileAttributeValue *value;
   const char *date_str;
   GTimeZone *local_tz = NULL;
@@ -1496,10 +1550,7 @@ g_file_info_get_deletion_date (GFileInfo *info)
 
   g_return_val_if_fail (G_IS_FILE_INFO (info), FALSE);
 
-  if (attr == 0)
-    attr = lookup_attribute (G_FILE_ATTRIBUTE_TRASH_DELETION_DATE);
-
-  value = g_file_info_find_value (info, attr);
+  value = g_file_info_find_value (info, G_FILE_ATTRIBUTE_ID_TRASH_DELETION_DATE);
   date_str = _g_file_attribute_value_get_string (value);
   if (!date_str)
     return NULL;
@@ -1523,15 +1574,11 @@ g_file_info_get_deletion_date (GFileInfo *info)
 GFileType
 g_file_info_get_file_type (GFileInfo *info)
 {
-  static guint32 attr = 0;
   GFileAttributeValue *value;
 
   g_return_val_if_fail (G_IS_FILE_INFO (info), G_FILE_TYPE_UNKNOWN);
 
-  if (attr == 0)
-    attr = lookup_attribute (G_FILE_ATTRIBUTE_STANDARD_TYPE);
-
-  value = g_file_info_find_value (info, attr);
+  value = g_file_info_find_value (info, G_FILE_ATTRIBUTE_ID_STANDARD_TYPE);
   return (GFileType)_g_file_attribute_value_get_uint32 (value);
 }
 
@@ -1546,15 +1593,11 @@ g_file_info_get_file_type (GFileInfo *info)
 gboolean
 g_file_info_get_is_hidden (GFileInfo *info)
 {
-  static guint32 attr = 0;
   GFileAttributeValue *value;
 
   g_return_val_if_fail (G_IS_FILE_INFO (info), FALSE);
 
-  if (attr == 0)
-    attr = lookup_attribute (G_FILE_ATTRIBUTE_STANDARD_IS_HIDDEN);
-
-  value = g_file_info_find_value (info, attr);
+  value = g_file_info_find_value (info, G_FILE_ATTRIBUTE_ID_STANDARD_IS_HIDDEN);
   return (GFileType)_g_file_attribute_value_get_boolean (value);
 }
 
@@ -1569,15 +1612,11 @@ g_file_info_get_is_hidden (GFileInfo *info)
 gboolean
 g_file_info_get_is_backup (GFileInfo *info)
 {
-  static guint32 attr = 0;
   GFileAttributeValue *value;
 
   g_return_val_if_fail (G_IS_FILE_INFO (info), FALSE);
 
-  if (attr == 0)
-    attr = lookup_attribute (G_FILE_ATTRIBUTE_STANDARD_IS_BACKUP);
-
-  value = g_file_info_find_value (info, attr);
+  value = g_file_info_find_value (info, G_FILE_ATTRIBUTE_ID_STANDARD_IS_BACKUP);
   return (GFileType)_g_file_attribute_value_get_boolean (value);
 }
 
@@ -1592,15 +1631,11 @@ g_file_info_get_is_backup (GFileInfo *info)
 gboolean
 g_file_info_get_is_symlink (GFileInfo *info)
 {
-  static guint32 attr = 0;
   GFileAttributeValue *value;
 
   g_return_val_if_fail (G_IS_FILE_INFO (info), FALSE);
 
-  if (attr == 0)
-    attr = lookup_attribute (G_FILE_ATTRIBUTE_STANDARD_IS_SYMLINK);
-
-  value = g_file_info_find_value (info, attr);
+  value = g_file_info_find_value (info, G_FILE_ATTRIBUTE_ID_STANDARD_IS_SYMLINK);
   return (GFileType)_g_file_attribute_value_get_boolean (value);
 }
 
@@ -1615,15 +1650,11 @@ g_file_info_get_is_symlink (GFileInfo *info)
 const char *
 g_file_info_get_name (GFileInfo *info)
 {
-  static guint32 attr = 0;
   GFileAttributeValue *value;
 
   g_return_val_if_fail (G_IS_FILE_INFO (info), NULL);
 
-  if (attr == 0)
-    attr = lookup_attribute (G_FILE_ATTRIBUTE_STANDARD_NAME);
-
-  value = g_file_info_find_value (info, attr);
+  value = g_file_info_find_value (info, G_FILE_ATTRIBUTE_ID_STANDARD_NAME);
   return _g_file_attribute_value_get_byte_string (value);
 }
 
@@ -1638,15 +1669,11 @@ g_file_info_get_name (GFileInfo *info)
 const char *
 g_file_info_get_display_name (GFileInfo *info)
 {
-  static guint32 attr = 0;
   GFileAttributeValue *value;
 
   g_return_val_if_fail (G_IS_FILE_INFO (info), NULL);
 
-  if (attr == 0)
-    attr = lookup_attribute (G_FILE_ATTRIBUTE_STANDARD_DISPLAY_NAME);
-
-  value = g_file_info_find_value (info, attr);
+  value = g_file_info_find_value (info, G_FILE_ATTRIBUTE_ID_STANDARD_DISPLAY_NAME);
   return _g_file_attribute_value_get_string (value);
 }
 
@@ -1661,15 +1688,11 @@ g_file_info_get_display_name (GFileInfo *info)
 const char *
 g_file_info_get_edit_name (GFileInfo *info)
 {
-  static guint32 attr = 0;
   GFileAttributeValue *value;
 
   g_return_val_if_fail (G_IS_FILE_INFO (info), NULL);
 
-  if (attr == 0)
-    attr = lookup_attribute (G_FILE_ATTRIBUTE_STANDARD_EDIT_NAME);
-
-  value = g_file_info_find_value (info, attr);
+  value = g_file_info_find_value (info, G_FILE_ATTRIBUTE_ID_STANDARD_EDIT_NAME);
   return _g_file_attribute_value_get_string (value);
 }
 
@@ -1684,16 +1707,12 @@ g_file_info_get_edit_name (GFileInfo *info)
 GIcon *
 g_file_info_get_icon (GFileInfo *info)
 {
-  static guint32 attr = 0;
   GFileAttributeValue *value;
   GObject *obj;
 
   g_return_val_if_fail (G_IS_FILE_INFO (info), NULL);
 
-  if (attr == 0)
-    attr = lookup_attribute (G_FILE_ATTRIBUTE_STANDARD_ICON);
-
-  value = g_file_info_find_value (info, attr);
+  value = g_file_info_find_value (info, G_FILE_ATTRIBUTE_ID_STANDARD_ICON);
   obj = _g_file_attribute_value_get_object (value);
   if (G_IS_ICON (obj))
     return G_ICON (obj);
@@ -1713,16 +1732,12 @@ g_file_info_get_icon (GFileInfo *info)
 GIcon *
 g_file_info_get_symbolic_icon (GFileInfo *info)
 {
-  static guint32 attr = 0;
   GFileAttributeValue *value;
   GObject *obj;
 
   g_return_val_if_fail (G_IS_FILE_INFO (info), NULL);
 
-  if (attr == 0)
-    attr = lookup_attribute (G_FILE_ATTRIBUTE_STANDARD_SYMBOLIC_ICON);
-
-  value = g_file_info_find_value (info, attr);
+  value = g_file_info_find_value (info, G_FILE_ATTRIBUTE_ID_STANDARD_SYMBOLIC_ICON);
   obj = _g_file_attribute_value_get_object (value);
   if (G_IS_ICON (obj))
     return G_ICON (obj);
@@ -1741,15 +1756,11 @@ g_file_info_get_symbolic_icon (GFileInfo *info)
 const char *
 g_file_info_get_content_type (GFileInfo *info)
 {
-  static guint32 attr = 0;
   GFileAttributeValue *value;
 
   g_return_val_if_fail (G_IS_FILE_INFO (info), NULL);
 
-  if (attr == 0)
-    attr = lookup_attribute (G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE);
-
-  value = g_file_info_find_value (info, attr);
+  value = g_file_info_find_value (info, G_FILE_ATTRIBUTE_ID_STANDARD_CONTENT_TYPE);
   return _g_file_attribute_value_get_string (value);
 }
 
@@ -1766,15 +1777,11 @@ g_file_info_get_content_type (GFileInfo *info)
 goffset
 g_file_info_get_size (GFileInfo *info)
 {
-  static guint32 attr = 0;
   GFileAttributeValue *value;
 
   g_return_val_if_fail (G_IS_FILE_INFO (info), (goffset) 0);
 
-  if (attr == 0)
-    attr = lookup_attribute (G_FILE_ATTRIBUTE_STANDARD_SIZE);
-
-  value = g_file_info_find_value (info, attr);
+  value = g_file_info_find_value (info, G_FILE_ATTRIBUTE_ID_STANDARD_SIZE);
   return (goffset) _g_file_attribute_value_get_uint64 (value);
 }
 
@@ -1794,21 +1801,14 @@ void
 g_file_info_get_modification_time (GFileInfo *info,
 				   GTimeVal  *result)
 {
-  static guint32 attr_mtime = 0, attr_mtime_usec;
   GFileAttributeValue *value;
 
   g_return_if_fail (G_IS_FILE_INFO (info));
   g_return_if_fail (result != NULL);
 
-  if (attr_mtime == 0)
-    {
-      attr_mtime = lookup_attribute (G_FILE_ATTRIBUTE_TIME_MODIFIED);
-      attr_mtime_usec = lookup_attribute (G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC);
-    }
-
-  value = g_file_info_find_value (info, attr_mtime);
+  value = g_file_info_find_value (info, G_FILE_ATTRIBUTE_ID_TIME_MODIFIED);
   result->tv_sec = _g_file_attribute_value_get_uint64 (value);
-  value = g_file_info_find_value (info, attr_mtime_usec);
+  value = g_file_info_find_value (info, G_FILE_ATTRIBUTE_ID_TIME_MODIFIED_USEC);
   result->tv_usec = _g_file_attribute_value_get_uint32 (value);
 }
 G_GNUC_END_IGNORE_DEPRECATIONS
@@ -1833,25 +1833,18 @@ G_GNUC_END_IGNORE_DEPRECATIONS
 GDateTime *
 g_file_info_get_modification_date_time (GFileInfo *info)
 {
-  static guint32 attr_mtime = 0, attr_mtime_usec;
   GFileAttributeValue *value, *value_usec;
   GDateTime *dt = NULL, *dt2 = NULL;
 
   g_return_val_if_fail (G_IS_FILE_INFO (info), NULL);
 
-  if (attr_mtime == 0)
-    {
-      attr_mtime = lookup_attribute (G_FILE_ATTRIBUTE_TIME_MODIFIED);
-      attr_mtime_usec = lookup_attribute (G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC);
-    }
-
-  value = g_file_info_find_value (info, attr_mtime);
+  value = g_file_info_find_value (info, G_FILE_ATTRIBUTE_ID_TIME_MODIFIED);
   if (value == NULL)
     return NULL;
 
   dt = g_date_time_new_from_unix_utc (_g_file_attribute_value_get_uint64 (value));
 
-  value_usec = g_file_info_find_value (info, attr_mtime_usec);
+  value_usec = g_file_info_find_value (info, G_FILE_ATTRIBUTE_ID_TIME_MODIFIED_USEC);
   if (value_usec == NULL)
     return g_steal_pointer (&dt);
 
@@ -1881,25 +1874,18 @@ g_file_info_get_modification_date_time (GFileInfo *info)
 GDateTime *
 g_file_info_get_access_date_time (GFileInfo *info)
 {
-  static guint32 attr_atime = 0, attr_atime_usec;
   GFileAttributeValue *value, *value_usec;
   GDateTime *dt = NULL, *dt2 = NULL;
 
   g_return_val_if_fail (G_IS_FILE_INFO (info), NULL);
 
-  if (attr_atime == 0)
-    {
-      attr_atime = lookup_attribute (G_FILE_ATTRIBUTE_TIME_ACCESS);
-      attr_atime_usec = lookup_attribute (G_FILE_ATTRIBUTE_TIME_ACCESS_USEC);
-    }
-
-  value = g_file_info_find_value (info, attr_atime);
+  value = g_file_info_find_value (info, G_FILE_ATTRIBUTE_ID_TIME_ACCESS);
   if (value == NULL)
     return NULL;
 
   dt = g_date_time_new_from_unix_utc (_g_file_attribute_value_get_uint64 (value));
 
-  value_usec = g_file_info_find_value (info, attr_atime_usec);
+  value_usec = g_file_info_find_value (info, G_FILE_ATTRIBUTE_ID_TIME_ACCESS_USEC);
   if (value_usec == NULL)
     return g_steal_pointer (&dt);
 
@@ -1929,25 +1915,18 @@ g_file_info_get_access_date_time (GFileInfo *info)
 GDateTime *
 g_file_info_get_creation_date_time (GFileInfo *info)
 {
-  static guint32 attr_ctime = 0, attr_ctime_usec;
   GFileAttributeValue *value, *value_usec;
   GDateTime *dt = NULL, *dt2 = NULL;
 
   g_return_val_if_fail (G_IS_FILE_INFO (info), NULL);
 
-  if (attr_ctime == 0)
-    {
-      attr_ctime = lookup_attribute (G_FILE_ATTRIBUTE_TIME_CREATED);
-      attr_ctime_usec = lookup_attribute (G_FILE_ATTRIBUTE_TIME_CREATED_USEC);
-    }
-
-  value = g_file_info_find_value (info, attr_ctime);
+  value = g_file_info_find_value (info, G_FILE_ATTRIBUTE_ID_TIME_CREATED);
   if (value == NULL)
     return NULL;
 
   dt = g_date_time_new_from_unix_utc (_g_file_attribute_value_get_uint64 (value));
 
-  value_usec = g_file_info_find_value (info, attr_ctime_usec);
+  value_usec = g_file_info_find_value (info, G_FILE_ATTRIBUTE_ID_TIME_CREATED_USEC);
   if (value_usec == NULL)
     return g_steal_pointer (&dt);
 
@@ -1968,15 +1947,11 @@ g_file_info_get_creation_date_time (GFileInfo *info)
 const char *
 g_file_info_get_symlink_target (GFileInfo *info)
 {
-  static guint32 attr = 0;
   GFileAttributeValue *value;
 
   g_return_val_if_fail (G_IS_FILE_INFO (info), NULL);
 
-  if (attr == 0)
-    attr = lookup_attribute (G_FILE_ATTRIBUTE_STANDARD_SYMLINK_TARGET);
-
-  value = g_file_info_find_value (info, attr);
+  value = g_file_info_find_value (info, G_FILE_ATTRIBUTE_ID_STANDARD_SYMLINK_TARGET);
   return _g_file_attribute_value_get_byte_string (value);
 }
 
@@ -1992,15 +1967,11 @@ g_file_info_get_symlink_target (GFileInfo *info)
 const char *
 g_file_info_get_etag (GFileInfo *info)
 {
-  static guint32 attr = 0;
   GFileAttributeValue *value;
 
   g_return_val_if_fail (G_IS_FILE_INFO (info), NULL);
 
-  if (attr == 0)
-    attr = lookup_attribute (G_FILE_ATTRIBUTE_ETAG_VALUE);
-
-  value = g_file_info_find_value (info, attr);
+  value = g_file_info_find_value (info, G_FILE_ATTRIBUTE_ID_ETAG_VALUE);
   return _g_file_attribute_value_get_string (value);
 }
 
@@ -2016,15 +1987,11 @@ g_file_info_get_etag (GFileInfo *info)
 gint32
 g_file_info_get_sort_order (GFileInfo *info)
 {
-  static guint32 attr = 0;
   GFileAttributeValue *value;
 
   g_return_val_if_fail (G_IS_FILE_INFO (info), 0);
 
-  if (attr == 0)
-    attr = lookup_attribute (G_FILE_ATTRIBUTE_STANDARD_SORT_ORDER);
-
-  value = g_file_info_find_value (info, attr);
+  value = g_file_info_find_value (info, G_FILE_ATTRIBUTE_ID_STANDARD_SORT_ORDER);
   return _g_file_attribute_value_get_int32 (value);
 }
 
@@ -2041,15 +2008,11 @@ void
 g_file_info_set_file_type (GFileInfo *info,
 			   GFileType  type)
 {
-  static guint32 attr = 0;
   GFileAttributeValue *value;
 
   g_return_if_fail (G_IS_FILE_INFO (info));
 
-  if (attr == 0)
-    attr = lookup_attribute (G_FILE_ATTRIBUTE_STANDARD_TYPE);
-
-  value = g_file_info_create_value (info, attr);
+  value = g_file_info_create_value (info, G_FILE_ATTRIBUTE_ID_STANDARD_TYPE);
   if (value)
     _g_file_attribute_value_set_uint32 (value, type);
 }
@@ -2066,15 +2029,11 @@ void
 g_file_info_set_is_hidden (GFileInfo *info,
 			   gboolean   is_hidden)
 {
-  static guint32 attr = 0;
   GFileAttributeValue *value;
 
   g_return_if_fail (G_IS_FILE_INFO (info));
 
-  if (attr == 0)
-    attr = lookup_attribute (G_FILE_ATTRIBUTE_STANDARD_IS_HIDDEN);
-
-  value = g_file_info_create_value (info, attr);
+  value = g_file_info_create_value (info, G_FILE_ATTRIBUTE_ID_STANDARD_IS_HIDDEN);
   if (value)
     _g_file_attribute_value_set_boolean (value, is_hidden);
 }
@@ -2091,15 +2050,11 @@ void
 g_file_info_set_is_symlink (GFileInfo *info,
 			    gboolean   is_symlink)
 {
-  static guint32 attr = 0;
   GFileAttributeValue *value;
 
   g_return_if_fail (G_IS_FILE_INFO (info));
 
-  if (attr == 0)
-    attr = lookup_attribute (G_FILE_ATTRIBUTE_STANDARD_IS_SYMLINK);
-
-  value = g_file_info_create_value (info, attr);
+  value = g_file_info_create_value (info, G_FILE_ATTRIBUTE_ID_STANDARD_IS_SYMLINK);
   if (value)
     _g_file_attribute_value_set_boolean (value, is_symlink);
 }
@@ -2116,16 +2071,12 @@ void
 g_file_info_set_name (GFileInfo  *info,
 		      const char *name)
 {
-  static guint32 attr = 0;
   GFileAttributeValue *value;
 
   g_return_if_fail (G_IS_FILE_INFO (info));
   g_return_if_fail (name != NULL);
 
-  if (attr == 0)
-    attr = lookup_attribute (G_FILE_ATTRIBUTE_STANDARD_NAME);
-
-  value = g_file_info_create_value (info, attr);
+  value = g_file_info_create_value (info, G_FILE_ATTRIBUTE_ID_STANDARD_NAME);
   if (value)
     _g_file_attribute_value_set_byte_string (value, name);
 }
@@ -2142,16 +2093,12 @@ void
 g_file_info_set_display_name (GFileInfo  *info,
 			      const char *display_name)
 {
-  static guint32 attr = 0;
   GFileAttributeValue *value;
 
   g_return_if_fail (G_IS_FILE_INFO (info));
   g_return_if_fail (display_name != NULL);
 
-  if (attr == 0)
-    attr = lookup_attribute (G_FILE_ATTRIBUTE_STANDARD_DISPLAY_NAME);
-
-  value = g_file_info_create_value (info, attr);
+  value = g_file_info_create_value (info, G_FILE_ATTRIBUTE_ID_STANDARD_DISPLAY_NAME);
   if (value)
     _g_file_attribute_value_set_string (value, display_name);
 }
@@ -2168,16 +2115,12 @@ void
 g_file_info_set_edit_name (GFileInfo  *info,
 			   const char *edit_name)
 {
-  static guint32 attr = 0;
   GFileAttributeValue *value;
 
   g_return_if_fail (G_IS_FILE_INFO (info));
   g_return_if_fail (edit_name != NULL);
 
-  if (attr == 0)
-    attr = lookup_attribute (G_FILE_ATTRIBUTE_STANDARD_EDIT_NAME);
-
-  value = g_file_info_create_value (info, attr);
+  value = g_file_info_create_value (info, G_FILE_ATTRIBUTE_ID_STANDARD_EDIT_NAME);
   if (value)
     _g_file_attribute_value_set_string (value, edit_name);
 }
@@ -2194,16 +2137,12 @@ void
 g_file_info_set_icon (GFileInfo *info,
 		      GIcon     *icon)
 {
-  static guint32 attr = 0;
   GFileAttributeValue *value;
 
   g_return_if_fail (G_IS_FILE_INFO (info));
   g_return_if_fail (G_IS_ICON (icon));
 
-  if (attr == 0)
-    attr = lookup_attribute (G_FILE_ATTRIBUTE_STANDARD_ICON);
-
-  value = g_file_info_create_value (info, attr);
+  value = g_file_info_create_value (info, G_FILE_ATTRIBUTE_ID_STANDARD_ICON);
   if (value)
     _g_file_attribute_value_set_object (value, G_OBJECT (icon));
 }
@@ -2222,16 +2161,12 @@ void
 g_file_info_set_symbolic_icon (GFileInfo *info,
                                GIcon     *icon)
 {
-  static guint32 attr = 0;
   GFileAttributeValue *value;
 
   g_return_if_fail (G_IS_FILE_INFO (info));
   g_return_if_fail (G_IS_ICON (icon));
 
-  if (attr == 0)
-    attr = lookup_attribute (G_FILE_ATTRIBUTE_STANDARD_SYMBOLIC_ICON);
-
-  value = g_file_info_create_value (info, attr);
+  value = g_file_info_create_value (info, G_FILE_ATTRIBUTE_ID_STANDARD_SYMBOLIC_ICON);
   if (value)
     _g_file_attribute_value_set_object (value, G_OBJECT (icon));
 }
@@ -2248,16 +2183,12 @@ void
 g_file_info_set_content_type (GFileInfo  *info,
 			      const char *content_type)
 {
-  static guint32 attr = 0;
   GFileAttributeValue *value;
 
   g_return_if_fail (G_IS_FILE_INFO (info));
   g_return_if_fail (content_type != NULL);
 
-  if (attr == 0)
-    attr = lookup_attribute (G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE);
-
-  value = g_file_info_create_value (info, attr);
+  value = g_file_info_create_value (info, G_FILE_ATTRIBUTE_ID_STANDARD_CONTENT_TYPE);
   if (value)
     _g_file_attribute_value_set_string (value, content_type);
 }
@@ -2274,15 +2205,11 @@ void
 g_file_info_set_size (GFileInfo *info,
 		      goffset    size)
 {
-  static guint32 attr = 0;
   GFileAttributeValue *value;
 
   g_return_if_fail (G_IS_FILE_INFO (info));
 
-  if (attr == 0)
-    attr = lookup_attribute (G_FILE_ATTRIBUTE_STANDARD_SIZE);
-
-  value = g_file_info_create_value (info, attr);
+  value = g_file_info_create_value (info, G_FILE_ATTRIBUTE_ID_STANDARD_SIZE);
   if (value)
     _g_file_attribute_value_set_uint64 (value, size);
 }
@@ -2306,28 +2233,20 @@ void
 g_file_info_set_modification_time (GFileInfo *info,
 				   GTimeVal  *mtime)
 {
-  static guint32 attr_mtime = 0, attr_mtime_usec = 0, attr_mtime_nsec = 0;
   GFileAttributeValue *value;
 
   g_return_if_fail (G_IS_FILE_INFO (info));
   g_return_if_fail (mtime != NULL);
 
-  if (attr_mtime == 0)
-    {
-      attr_mtime = lookup_attribute (G_FILE_ATTRIBUTE_TIME_MODIFIED);
-      attr_mtime_usec = lookup_attribute (G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC);
-      attr_mtime_nsec = lookup_attribute (G_FILE_ATTRIBUTE_TIME_MODIFIED_NSEC);
-    }
-
-  value = g_file_info_create_value (info, attr_mtime);
+  value = g_file_info_create_value (info, G_FILE_ATTRIBUTE_ID_TIME_MODIFIED);
   if (value)
     _g_file_attribute_value_set_uint64 (value, mtime->tv_sec);
-  value = g_file_info_create_value (info, attr_mtime_usec);
+  value = g_file_info_create_value (info, G_FILE_ATTRIBUTE_ID_TIME_MODIFIED_USEC);
   if (value)
     _g_file_attribute_value_set_uint32 (value, mtime->tv_usec);
 
   /* nsecs can’t be known from a #GTimeVal, so remove them */
-  g_file_info_remove_value (info, attr_mtime_nsec);
+  g_file_info_remove_value (info, G_FILE_ATTRIBUTE_ID_TIME_MODIFIED_NSEC);
 }
 G_GNUC_END_IGNORE_DEPRECATIONS
 
@@ -2348,28 +2267,20 @@ void
 g_file_info_set_modification_date_time (GFileInfo *info,
                                         GDateTime *mtime)
 {
-  static guint32 attr_mtime = 0, attr_mtime_usec = 0, attr_mtime_nsec = 0;
   GFileAttributeValue *value;
 
   g_return_if_fail (G_IS_FILE_INFO (info));
   g_return_if_fail (mtime != NULL);
 
-  if (attr_mtime == 0)
-    {
-      attr_mtime = lookup_attribute (G_FILE_ATTRIBUTE_TIME_MODIFIED);
-      attr_mtime_usec = lookup_attribute (G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC);
-      attr_mtime_nsec = lookup_attribute (G_FILE_ATTRIBUTE_TIME_MODIFIED_NSEC);
-    }
-
-  value = g_file_info_create_value (info, attr_mtime);
+  value = g_file_info_create_value (info, G_FILE_ATTRIBUTE_ID_TIME_MODIFIED);
   if (value)
     _g_file_attribute_value_set_uint64 (value, g_date_time_to_unix (mtime));
-  value = g_file_info_create_value (info, attr_mtime_usec);
+  value = g_file_info_create_value (info, G_FILE_ATTRIBUTE_ID_TIME_MODIFIED_USEC);
   if (value)
     _g_file_attribute_value_set_uint32 (value, g_date_time_get_microsecond (mtime));
 
   /* nsecs can’t be known from a #GDateTime, so remove them */
-  g_file_info_remove_value (info, attr_mtime_nsec);
+  g_file_info_remove_value (info, G_FILE_ATTRIBUTE_ID_TIME_MODIFIED_NSEC);
 }
 
 /**
@@ -2389,28 +2300,20 @@ void
 g_file_info_set_access_date_time (GFileInfo *info,
                                   GDateTime *atime)
 {
-  static guint32 attr_atime = 0, attr_atime_usec = 0, attr_atime_nsec = 0;
   GFileAttributeValue *value;
 
   g_return_if_fail (G_IS_FILE_INFO (info));
   g_return_if_fail (atime != NULL);
 
-  if (attr_atime == 0)
-    {
-      attr_atime = lookup_attribute (G_FILE_ATTRIBUTE_TIME_ACCESS);
-      attr_atime_usec = lookup_attribute (G_FILE_ATTRIBUTE_TIME_ACCESS_USEC);
-      attr_atime_nsec = lookup_attribute (G_FILE_ATTRIBUTE_TIME_ACCESS_NSEC);
-    }
-
-  value = g_file_info_create_value (info, attr_atime);
+  value = g_file_info_create_value (info, G_FILE_ATTRIBUTE_ID_TIME_ACCESS);
   if (value)
     _g_file_attribute_value_set_uint64 (value, g_date_time_to_unix (atime));
-  value = g_file_info_create_value (info, attr_atime_usec);
+  value = g_file_info_create_value (info, G_FILE_ATTRIBUTE_ID_TIME_ACCESS_USEC);
   if (value)
     _g_file_attribute_value_set_uint32 (value, g_date_time_get_microsecond (atime));
 
   /* nsecs can’t be known from a #GDateTime, so remove them */
-  g_file_info_remove_value (info, attr_atime_nsec);
+  g_file_info_remove_value (info, G_FILE_ATTRIBUTE_ID_TIME_ACCESS_NSEC);
 }
 
 /**
@@ -2430,28 +2333,20 @@ void
 g_file_info_set_creation_date_time (GFileInfo *info,
                                     GDateTime *creation_time)
 {
-  static guint32 attr_ctime = 0, attr_ctime_usec = 0, attr_ctime_nsec = 0;
   GFileAttributeValue *value;
 
   g_return_if_fail (G_IS_FILE_INFO (info));
   g_return_if_fail (creation_time != NULL);
 
-  if (attr_ctime == 0)
-    {
-      attr_ctime = lookup_attribute (G_FILE_ATTRIBUTE_TIME_CREATED);
-      attr_ctime_usec = lookup_attribute (G_FILE_ATTRIBUTE_TIME_CREATED_USEC);
-      attr_ctime_nsec = lookup_attribute (G_FILE_ATTRIBUTE_TIME_CREATED_NSEC);
-    }
-
-  value = g_file_info_create_value (info, attr_ctime);
+  value = g_file_info_create_value (info, G_FILE_ATTRIBUTE_ID_TIME_CREATED);
   if (value)
     _g_file_attribute_value_set_uint64 (value, g_date_time_to_unix (creation_time));
-  value = g_file_info_create_value (info, attr_ctime_usec);
+  value = g_file_info_create_value (info, G_FILE_ATTRIBUTE_ID_TIME_CREATED_USEC);
   if (value)
     _g_file_attribute_value_set_uint32 (value, g_date_time_get_microsecond (creation_time));
 
   /* nsecs can’t be known from a #GDateTime, so remove them */
-  g_file_info_remove_value (info, attr_ctime_nsec);
+  g_file_info_remove_value (info, G_FILE_ATTRIBUTE_ID_TIME_CREATED_NSEC);
 }
 
 /**
@@ -2466,16 +2361,12 @@ void
 g_file_info_set_symlink_target (GFileInfo  *info,
 				const char *symlink_target)
 {
-  static guint32 attr = 0;
   GFileAttributeValue *value;
 
   g_return_if_fail (G_IS_FILE_INFO (info));
   g_return_if_fail (symlink_target != NULL);
 
-  if (attr == 0)
-    attr = lookup_attribute (G_FILE_ATTRIBUTE_STANDARD_SYMLINK_TARGET);
-
-  value = g_file_info_create_value (info, attr);
+  value = g_file_info_create_value (info, G_FILE_ATTRIBUTE_ID_STANDARD_SYMLINK_TARGET);
   if (value)
     _g_file_attribute_value_set_byte_string (value, symlink_target);
 }
@@ -2492,15 +2383,11 @@ void
 g_file_info_set_sort_order (GFileInfo *info,
 			    gint32     sort_order)
 {
-  static guint32 attr = 0;
   GFileAttributeValue *value;
 
   g_return_if_fail (G_IS_FILE_INFO (info));
 
-  if (attr == 0)
-    attr = lookup_attribute (G_FILE_ATTRIBUTE_STANDARD_SORT_ORDER);
-
-  value = g_file_info_create_value (info, attr);
+  value = g_file_info_create_value (info, G_FILE_ATTRIBUTE_ID_STANDARD_SORT_ORDER);
   if (value)
     _g_file_attribute_value_set_int32 (value, sort_order);
 }
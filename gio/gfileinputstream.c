@@ -76,6 +76,7 @@ static GFileInfo *g_file_input_stream_real_query_info_finish (GFileInputStream
 
 struct _GFileInputStreamPrivate {
   GAsyncReadyCallback outstanding_callback;
+  guint map_reads : 1;
 };
 
 G_DEFINE_TYPE_WITH_CODE (GFileInputStream, g_file_input_stream, G_TYPE_INPUT_STREAM,
@@ -107,6 +108,49 @@ g_file_input_stream_init (GFileInputStream *stream)
   stream->priv = g_file_input_stream_get_instance_private (stream);
 }
 
+/**
+ * g_file_input_stream_set_map_reads:
+ * @stream: a #GFileInputStream
+ * @map_reads: whether reads may return mapped data
+ *
+ * Sets whether g_input_stream_read_bytes() on @stream may return slices
+ * of a read-only mapping of the file instead of copies of the data.
+ *
+ * This is only a hint. Streams on local files honour it for large reads
+ * from large regular files, where it saves copying the data; all other
+ * reads are copied as usual. The returned #GBytes must not be accessed
+ * once the file has been truncated, which is why this is off by default.
+ *
+ * Since: 2.76
+ **/
+void
+g_file_input_stream_set_map_reads (GFileInputStream *stream,
+                                   gboolean          map_reads)
+{
+  g_return_if_fail (G_IS_FILE_INPUT_STREAM (stream));
+
+  stream->priv->map_reads = !!map_reads;
+}
+
+/**
+ * g_file_input_stream_get_map_reads:
+ * @stream: a #GFileInputStream
+ *
+ * Gets whether g_input_stream_read_bytes() on @stream may return mapped
+ * data. See g_file_input_stream_set_map_reads().
+ *
+ * Returns: %TRUE if reads may return mapped data
+ *
+ * Since: 2.76
+ **/
+gboolean
+g_file_input_stream_get_map_reads (GFileInputStream *stream)
+{
+  g_return_val_if_fail (G_IS_FILE_INPUT_STREAM (stream), FALSE);
+
+  return stream->priv->map_reads;
+}
+
 /**
  * g_file_input_stream_query_info:
  * @stream: a #GFileInputStream.
@@ -111,6 +111,12 @@ GFileInfo *g_file_input_stream_query_info_finish (GFileInputStream     *stream,
 						  GAsyncResult         *result,
 						  GError              **error);
 
+GIO_AVAILABLE_IN_2_76
+void       g_file_input_stream_set_map_reads     (GFileInputStream     *stream,
+						  gboolean              map_reads);
+GIO_AVAILABLE_IN_2_76
+gboolean   g_file_input_stream_get_map_reads     (GFileInputStream     *stream);
+
 G_END_DECLS
 
 #endif /* __G_FILE_FILE_INPUT_STREAM_H__ */
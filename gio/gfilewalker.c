@@ -0,0 +1,595 @@
+/* GIO - GLib Input, Output and Streaming Library
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gfilewalker.h"
+#include "gcancellable.h"
+#include "gfile.h"
+#include "gfileenumerator.h"
+#include "gfileinfo.h"
+#include "gioerror.h"
+#include "gtask.h"
+
+/**
+ * SECTION:gfilewalker
+ * @title: GFileWalker
+ * @short_description: Recursive directory traversal
+ * @include: gio/gio.h
+ * @see_also: #GFileEnumerator
+ *
+ * #GFileWalker traverses a directory tree, reading several directories at
+ * once from a bounded pool of worker threads. Each directory is read with
+ * a synchronous #GFileEnumerator in one of the workers, so a walk costs
+ * neither a #GTask nor a main loop round trip per directory, as nesting
+ * calls to g_file_enumerate_children_async() does. For local files this
+ * uses the batched directory reading of the local file enumerator.
+ *
+ * The files found are delivered in batches to the thread-default main
+ * context of the caller of g_file_walker_walk_async(), in no particular
+ * order.
+ *
+ * A filter set with g_file_walker_set_filter() can skip files, and skip
+ * whole subtrees by rejecting their directory.
+ *
+ * Symbolic links to directories are reported, but never descended into,
+ * so walks can’t loop. Subdirectories which can’t be read because they
+ * are not accessible or were deleted during the walk are skipped; any
+ * other error ends the walk.
+ *
+ * Since: 2.76
+ */
+
+/**
+ * GFileWalker:
+ *
+ * An opaque object to walk a directory tree.
+ *
+ * Since: 2.76
+ */
+
+#define DEFAULT_BATCH_SIZE 256
+
+/* Needed to decide whether to descend into a directory */
+#define WALK_ATTRIBUTES \
+    G_FILE_ATTRIBUTE_STANDARD_NAME "," \
+    G_FILE_ATTRIBUTE_STANDARD_TYPE "," \
+    G_FILE_ATTRIBUTE_STANDARD_IS_SYMLINK
+
+struct _GFileWalker
+{
+  GObject parent_instance;
+
+  GFile *root;  /* (owned) */
+  char *attributes;  /* (owned), the requested ones plus WALK_ATTRIBUTES */
+  GFileQueryInfoFlags flags;
+
+  GFileWalkerFilterFunc filter;
+  gpointer filter_data;
+  GDestroyNotify filter_data_free_func;
+
+  guint max_threads;
+  guint batch_size;
+
+  gboolean walking;
+};
+
+G_DEFINE_TYPE (GFileWalker, g_file_walker, G_TYPE_OBJECT)
+
+typedef struct
+{
+  GPtrArray *files;  /* (element-type GFile) (owned) */
+  GPtrArray *infos;  /* (element-type GFileInfo) (owned) */
+} WalkBatch;
+
+typedef struct
+{
+  GFileWalker *walker;  /* (unowned), the source object of @task */
+  GTask *task;  /* (owned) until the walk completes */
+  GMainContext *context;  /* (owned) */
+  GCancellable *cancellable;  /* (owned) (nullable) */
+  GFileWalkerBatchFunc batch_func;
+  gpointer batch_data;
+
+  GThreadPool *pool;  /* (owned) (element-type GFile) */
+  gint stopped;  /* (atomic) */
+
+  GMutex lock;
+  /* the following are protected by @lock */
+  guint n_pending_directories;  /* queued on @pool or being read */
+  GQueue batches;  /* (element-type WalkBatch) waiting to be delivered */
+  GSource *dispatch_source;  /* (owned) (nullable), set while scheduled */
+  GError *error;  /* (owned) (nullable), the error which stopped the walk */
+  gboolean done;
+} WalkData;
+
+static WalkBatch *
+walk_batch_new (guint size)
+{
+  WalkBatch *batch = g_new (WalkBatch, 1);
+
+  batch->files = g_ptr_array_new_full (size, g_object_unref);
+  batch->infos = g_ptr_array_new_full (size, g_object_unref);
+
+  return batch;
+}
+
+static void
+walk_batch_free (WalkBatch *batch)
+{
+  g_ptr_array_unref (batch->files);
+  g_ptr_array_unref (batch->infos);
+  g_free (batch);
+}
+
+static void
+walk_data_free (WalkData *walk)
+{
+  g_assert (walk->pool == NULL);
+  g_assert (walk->dispatch_source == NULL);
+
+  g_queue_clear_full (&walk->batches, (GDestroyNotify) walk_batch_free);
+  g_clear_error (&walk->error);
+  g_mutex_clear (&walk->lock);
+  g_clear_object (&walk->cancellable);
+  g_main_context_unref (walk->context);
+  g_free (walk);
+}
+
+static void
+walk_complete (WalkData *walk)
+{
+  GTask *task;
+
+  /* All the workers are done, but make sure they have returned */
+  g_thread_pool_free (g_steal_pointer (&walk->pool), FALSE, TRUE);
+
+  walk->walker->walking = FALSE;
+
+  /* This frees @walk */
+  task = g_steal_pointer (&walk->task);
+  if (walk->error != NULL)
+    g_task_return_error (task, g_steal_pointer (&walk->error));
+  else
+    g_task_return_boolean (task, TRUE);
+  g_object_unref (task);
+}
+
+static gboolean
+walk_dispatch (gpointer user_data)
+{
+  WalkData *walk = user_data;
+  GQueue batches;
+  WalkBatch *batch;
+  gboolean done;
+
+  g_mutex_lock (&walk->lock);
+  batches = walk->batches;
+  g_queue_init (&walk->batches);
+  g_clear_pointer (&walk->dispatch_source, g_source_unref);
+  done = walk->done;
+  g_mutex_unlock (&walk->lock);
+
+  while ((batch = g_queue_pop_head (&batches)) != NULL)
+    {
+      if (walk->batch_func != NULL)
+        walk->batch_func (walk->walker,
+                          (GFile **) batch->files->pdata,
+                          (GFileInfo **) batch->infos->pdata,
+                          batch->files->len,
+                          walk->batch_data);
+      walk_batch_free (batch);
+    }
+
+  if (done)
+    walk_complete (walk);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* Must be called with @walk->lock held */
+static void
+walk_schedule_dispatch_unlocked (WalkData *walk)
+{
+  if (walk->dispatch_source != NULL)
+    return;
+
+  walk->dispatch_source = g_idle_source_new ();
+  g_source_set_priority (walk->dispatch_source, g_task_get_priority (walk->task));
+  g_source_set_callback (walk->dispatch_source, walk_dispatch, walk, NULL);
+  g_source_set_static_name (walk->dispatch_source, "[gio] GFileWalker batch");
+  g_source_attach (walk->dispatch_source, walk->context);
+}
+
+static void
+walk_push_batch (WalkData  *walk,
+                 WalkBatch *batch  /* (transfer full) */)
+{
+  g_mutex_lock (&walk->lock);
+  g_queue_push_tail (&walk->batches, batch);
+  walk_schedule_dispatch_unlocked (walk);
+  g_mutex_unlock (&walk->lock);
+}
+
+static void
+walk_queue_directory (WalkData *walk,
+                      GFile    *directory)
+{
+  g_mutex_lock (&walk->lock);
+  walk->n_pending_directories++;
+  g_mutex_unlock (&walk->lock);
+
+  g_thread_pool_push (walk->pool, g_object_ref (directory), NULL);
+}
+
+static gboolean
+walk_is_stopped (WalkData *walk)
+{
+  return g_atomic_int_get (&walk->stopped) ||
+         g_cancellable_is_cancelled (walk->cancellable);
+}
+
+/* Runs in the worker threads of @walk->pool */
+static void
+walk_directory (gpointer data,
+                gpointer user_data)
+{
+  GFile *directory = data;
+  WalkData *walk = user_data;
+  GFileWalker *walker = walk->walker;
+  GFileEnumerator *enumerator = NULL;
+  WalkBatch *batch = NULL;
+  GError *local_error = NULL;
+
+  if (walk_is_stopped (walk))
+    goto out;
+
+  enumerator = g_file_enumerate_children (directory, walker->attributes, walker->flags,
+                                          walk->cancellable, &local_error);
+  if (enumerator == NULL)
+    goto out;
+
+  while (TRUE)
+    {
+      GFileInfo *info;
+      GFile *child;
+
+      info = g_file_enumerator_next_file (enumerator, walk->cancellable, &local_error);
+      if (info == NULL)
+        break;
+
+      child = g_file_enumerator_get_child (enumerator, info);
+
+      if (walker->filter != NULL &&
+          !walker->filter (walker, child, info, walker->filter_data))
+        {
+          g_object_unref (child);
+          g_object_unref (info);
+          continue;
+        }
+
+      if (g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY &&
+          !g_file_info_get_is_symlink (info))
+        walk_queue_directory (walk, child);
+
+      if (batch == NULL)
+        batch = walk_batch_new (walker->batch_size);
+
+      g_ptr_array_add (batch->files, child);
+      g_ptr_array_add (batch->infos, info);
+
+      if (batch->files->len >= walker->batch_size)
+        {
+          walk_push_batch (walk, g_steal_pointer (&batch));
+
+          if (walk_is_stopped (walk))
+            break;
+        }
+    }
+
+  g_file_enumerator_close (enumerator, NULL, NULL);
+  g_object_unref (enumerator);
+
+out:
+  /* Unreadable subdirectories don’t spoil the whole walk */
+  if (local_error != NULL && directory != walker->root &&
+      (g_error_matches (local_error, G_IO_ERROR, G_IO_ERROR_PERMISSION_DENIED) ||
+       g_error_matches (local_error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND)))
+    g_clear_error (&local_error);
+
+  g_mutex_lock (&walk->lock);
+
+  if (local_error != NULL)
+    {
+      if (walk->error == NULL)
+        walk->error = g_steal_pointer (&local_error);
+      else
+        g_clear_error (&local_error);
+
+      g_atomic_int_set (&walk->stopped, TRUE);
+    }
+
+  if (batch != NULL)
+    g_queue_push_tail (&walk->batches, g_steal_pointer (&batch));
+
+  if (--walk->n_pending_directories == 0)
+    walk->done = TRUE;
+
+  if (walk->done || walk->batches.length > 0)
+    walk_schedule_dispatch_unlocked (walk);
+
+  g_mutex_unlock (&walk->lock);
+
+  g_object_unref (directory);
+}
+
+static void
+g_file_walker_finalize (GObject *object)
+{
+  GFileWalker *walker = G_FILE_WALKER (object);
+
+  if (walker->filter_data_free_func != NULL)
+    walker->filter_data_free_func (walker->filter_data);
+
+  g_object_unref (walker->root);
+  g_free (walker->attributes);
+
+  G_OBJECT_CLASS (g_file_walker_parent_class)->finalize (object);
+}
+
+static void
+g_file_walker_class_init (GFileWalkerClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->finalize = g_file_walker_finalize;
+}
+
+static void
+g_file_walker_init (GFileWalker *walker)
+{
+  walker->max_threads = g_get_num_processors ();
+  walker->batch_size = DEFAULT_BATCH_SIZE;
+}
+
+/**
+ * g_file_walker_new:
+ * @root: the directory to walk
+ * @attributes: an attribute query string, as for g_file_query_info()
+ * @flags: a set of #GFileQueryInfoFlags
+ *
+ * Creates a #GFileWalker to walk the directory tree under @root. The
+ * #GFileInfo of each file found has the attributes matched by
+ * @attributes, and also %G_FILE_ATTRIBUTE_STANDARD_NAME,
+ * %G_FILE_ATTRIBUTE_STANDARD_TYPE and
+ * %G_FILE_ATTRIBUTE_STANDARD_IS_SYMLINK, which are needed for the walk.
+ *
+ * Returns: (transfer full): a new #GFileWalker
+ *
+ * Since: 2.76
+ */
+GFileWalker *
+g_file_walker_new (GFile               *root,
+                   const char          *attributes,
+                   GFileQueryInfoFlags  flags)
+{
+  GFileWalker *walker;
+
+  g_return_val_if_fail (G_IS_FILE (root), NULL);
+
+  walker = g_object_new (G_TYPE_FILE_WALKER, NULL);
+  walker->root = g_object_ref (root);
+  if (attributes != NULL && *attributes != '\0')
+    walker->attributes = g_strconcat (attributes, ",", WALK_ATTRIBUTES, NULL);
+  else
+    walker->attributes = g_strdup (WALK_ATTRIBUTES);
+  walker->flags = flags;
+
+  return walker;
+}
+
+/**
+ * g_file_walker_set_filter:
+ * @walker: a #GFileWalker
+ * @filter: (nullable) (scope notified): the filter function, or %NULL to
+ *   keep all files
+ * @user_data: (closure): user data to pass to @filter
+ * @user_data_free_func: (nullable): function to free @user_data
+ *
+ * Sets the function deciding which files are reported and which
+ * directories are descended into. See #GFileWalkerFilterFunc.
+ *
+ * This must not be called while a walk is in progress.
+ *
+ * Since: 2.76
+ */
+void
+g_file_walker_set_filter (GFileWalker           *walker,
+                          GFileWalkerFilterFunc  filter,
+                          gpointer               user_data,
+                          GDestroyNotify         user_data_free_func)
+{
+  g_return_if_fail (G_IS_FILE_WALKER (walker));
+  g_return_if_fail (!walker->walking);
+
+  if (walker->filter_data_free_func != NULL)
+    walker->filter_data_free_func (walker->filter_data);
+
+  walker->filter = filter;
+  walker->filter_data = user_data;
+  walker->filter_data_free_func = user_data_free_func;
+}
+
+/**
+ * g_file_walker_set_max_threads:
+ * @walker: a #GFileWalker
+ * @max_threads: the maximum number of directories to read at once
+ *
+ * Sets how many worker threads @walker may use. The default is the
+ * number of processors.
+ *
+ * This must not be called while a walk is in progress.
+ *
+ * Since: 2.76
+ */
+void
+g_file_walker_set_max_threads (GFileWalker *walker,
+                               guint        max_threads)
+{
+  g_return_if_fail (G_IS_FILE_WALKER (walker));
+  g_return_if_fail (!walker->walking);
+  g_return_if_fail (max_threads > 0);
+
+  walker->max_threads = max_threads;
+}
+
+/**
+ * g_file_walker_get_max_threads:
+ * @walker: a #GFileWalker
+ *
+ * Gets the value set with g_file_walker_set_max_threads().
+ *
+ * Returns: the maximum number of worker threads of @walker
+ *
+ * Since: 2.76
+ */
+guint
+g_file_walker_get_max_threads (GFileWalker *walker)
+{
+  g_return_val_if_fail (G_IS_FILE_WALKER (walker), 0);
+
+  return walker->max_threads;
+}
+
+/**
+ * g_file_walker_set_batch_size:
+ * @walker: a #GFileWalker
+ * @batch_size: the maximum number of files per batch
+ *
+ * Sets the maximum number of files passed to each call of the
+ * #GFileWalkerBatchFunc. Batches may be smaller, as each worker hands
+ * over what it found when it finishes a directory. The default is 256.
+ *
+ * This must not be called while a walk is in progress.
+ *
+ * Since: 2.76
+ */
+void
+g_file_walker_set_batch_size (GFileWalker *walker,
+                              guint        batch_size)
+{
+  g_return_if_fail (G_IS_FILE_WALKER (walker));
+  g_return_if_fail (!walker->walking);
+  g_return_if_fail (batch_size > 0);
+
+  walker->batch_size = batch_size;
+}
+
+/**
+ * g_file_walker_get_batch_size:
+ * @walker: a #GFileWalker
+ *
+ * Gets the value set with g_file_walker_set_batch_size().
+ *
+ * Returns: the maximum number of files per batch
+ *
+ * Since: 2.76
+ */
+guint
+g_file_walker_get_batch_size (GFileWalker *walker)
+{
+  g_return_val_if_fail (G_IS_FILE_WALKER (walker), 0);
+
+  return walker->batch_size;
+}
+
+/**
+ * g_file_walker_walk_async:
+ * @walker: a #GFileWalker
+ * @cancellable: (nullable): optional #GCancellable object, %NULL to ignore
+ * @batch_func: (nullable) (scope call): function to call with each batch
+ *   of files found
+ * @batch_data: (closure batch_func): user data to pass to @batch_func
+ * @callback: (scope async): a #GAsyncReadyCallback to call when the walk
+ *   is complete
+ * @user_data: (closure callback): user data to pass to @callback
+ *
+ * Walks the directory tree under the root of @walker. The root itself is
+ * not reported. @batch_func is called in the thread-default main context
+ * of the caller with the files found, and @callback once the walk is
+ * complete, after the last call to @batch_func.
+ *
+ * Only one walk can be in progress on @walker at a time.
+ *
+ * Since: 2.76
+ */
+void
+g_file_walker_walk_async (GFileWalker          *walker,
+                          GCancellable         *cancellable,
+                          GFileWalkerBatchFunc  batch_func,
+                          gpointer              batch_data,
+                          GAsyncReadyCallback   callback,
+                          gpointer              user_data)
+{
+  WalkData *walk;
+
+  g_return_if_fail (G_IS_FILE_WALKER (walker));
+  g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+  g_return_if_fail (!walker->walking);
+
+  walk = g_new0 (WalkData, 1);
+  walk->walker = walker;
+  walk->task = g_task_new (walker, cancellable, callback, user_data);
+  g_task_set_source_tag (walk->task, g_file_walker_walk_async);
+  g_task_set_task_data (walk->task, walk, (GDestroyNotify) walk_data_free);
+  walk->context = g_main_context_ref_thread_default ();
+  walk->cancellable = cancellable ? g_object_ref (cancellable) : NULL;
+  walk->batch_func = batch_func;
+  walk->batch_data = batch_data;
+  g_mutex_init (&walk->lock);
+  g_queue_init (&walk->batches);
+
+  walk->pool = g_thread_pool_new (walk_directory, walk, (gint) walker->max_threads, FALSE, NULL);
+  walker->walking = TRUE;
+
+  walk_queue_directory (walk, walker->root);
+}
+
+/**
+ * g_file_walker_walk_finish:
+ * @walker: a #GFileWalker
+ * @result: a #GAsyncResult
+ * @error: a #GError location to store the error occurring, or %NULL to
+ *   ignore
+ *
+ * Finishes a walk started with g_file_walker_walk_async().
+ *
+ * Returns: %TRUE if the whole tree was walked, %FALSE on error
+ *
+ * Since: 2.76
+ */
+gboolean
+g_file_walker_walk_finish (GFileWalker   *walker,
+                           GAsyncResult  *result,
+                           GError       **error)
+{
+  g_return_val_if_fail (G_IS_FILE_WALKER (walker), FALSE);
+  g_return_val_if_fail (g_task_is_valid (result, walker), FALSE);
+
+  return g_task_propagate_boolean (G_TASK (result), error);
+}
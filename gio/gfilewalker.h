@@ -0,0 +1,114 @@
+/* GIO - GLib Input, Output and Streaming Library
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __G_FILE_WALKER_H__
+#define __G_FILE_WALKER_H__
+
+#if !defined (__GIO_GIO_H_INSIDE__) && !defined (GIO_COMPILATION)
+#error "Only <gio/gio.h> can be included directly."
+#endif
+
+#include <gio/giotypes.h>
+
+G_BEGIN_DECLS
+
+#define G_TYPE_FILE_WALKER (g_file_walker_get_type ())
+GIO_AVAILABLE_IN_2_76
+G_DECLARE_FINAL_TYPE (GFileWalker, g_file_walker, G, FILE_WALKER, GObject)
+
+/**
+ * GFileWalkerFilterFunc:
+ * @walker: the #GFileWalker
+ * @file: the file found
+ * @info: the #GFileInfo of @file
+ * @user_data: user data passed to g_file_walker_set_filter()
+ *
+ * Decides whether @file is reported by @walker. If @file is a directory,
+ * this also decides whether it is descended into.
+ *
+ * This function is called from the worker threads of @walker, and may be
+ * called from several of them at the same time.
+ *
+ * Returns: %TRUE to keep @file, %FALSE to skip it
+ *
+ * Since: 2.76
+ */
+typedef gboolean (*GFileWalkerFilterFunc) (GFileWalker *walker,
+                                           GFile       *file,
+                                           GFileInfo   *info,
+                                           gpointer     user_data);
+
+/**
+ * GFileWalkerBatchFunc:
+ * @walker: the #GFileWalker
+ * @files: (array length=n_files): the files found
+ * @infos: (array length=n_files): the #GFileInfo of each of @files
+ * @n_files: the number of elements in @files and @infos
+ * @user_data: user data passed to g_file_walker_walk_async()
+ *
+ * Receives a batch of files found by @walker, in the thread-default main
+ * context of the caller of g_file_walker_walk_async(). @files and @infos
+ * are only valid for the duration of the call; take references on the
+ * elements to keep them.
+ *
+ * Since: 2.76
+ */
+typedef void (*GFileWalkerBatchFunc) (GFileWalker  *walker,
+                                      GFile       **files,
+                                      GFileInfo   **infos,
+                                      guint         n_files,
+                                      gpointer      user_data);
+
+GIO_AVAILABLE_IN_2_76
+GFileWalker *   g_file_walker_new                 (GFile                  *root,
+                                                   const char             *attributes,
+                                                   GFileQueryInfoFlags     flags);
+
+GIO_AVAILABLE_IN_2_76
+void            g_file_walker_set_filter          (GFileWalker            *walker,
+                                                   GFileWalkerFilterFunc   filter,
+                                                   gpointer                user_data,
+                                                   GDestroyNotify          user_data_free_func);
+
+GIO_AVAILABLE_IN_2_76
+void            g_file_walker_set_max_threads     (GFileWalker            *walker,
+                                                   guint                   max_threads);
+GIO_AVAILABLE_IN_2_76
+guint           g_file_walker_get_max_threads     (GFileWalker            *walker);
+
+GIO_AVAILABLE_IN_2_76
+void            g_file_walker_set_batch_size      (GFileWalker            *walker,
+                                                   guint                   batch_size);
+GIO_AVAILABLE_IN_2_76
+guint           g_file_walker_get_batch_size      (GFileWalker            *walker);
+
+GIO_AVAILABLE_IN_2_76
+void            g_file_walker_walk_async          (GFileWalker            *walker,
+                                                   GCancellable           *cancellable,
+                                                   GFileWalkerBatchFunc    batch_func,
+                                                   gpointer                batch_data,
+                                                   GAsyncReadyCallback     callback,
+                                                   gpointer                user_data);
+GIO_AVAILABLE_IN_2_76
+gboolean        g_file_walker_walk_finish         (GFileWalker            *walker,
+                                                   GAsyncResult           *result,
+                                                   GError                **error);
+
+G_END_DECLS
+
+#endif /* __G_FILE_WALKER_H__ */
@@ -62,6 +62,10 @@ static gssize   g_input_stream_real_skip         (GInputStream         *stream,
 						  gsize                 count,
 						  GCancellable         *cancellable,
 						  GError              **error);
+static GBytes  *g_input_stream_real_read_bytes   (GInputStream         *stream,
+						  gsize                 count,
+						  GCancellable         *cancellable,
+						  GError              **error);
 static void     g_input_stream_real_read_async   (GInputStream         *stream,
 						  void                 *buffer,
 						  gsize                 count,
@@ -112,6 +116,7 @@ g_input_stream_class_init (GInputStreamClass *klass)
   gobject_class->dispose = g_input_stream_dispose;
   
   klass->skip = g_input_stream_real_skip;
+  klass->read_bytes = g_input_stream_real_read_bytes;
   klass->read_async = g_input_stream_real_read_async;
   klass->read_finish = g_input_stream_real_read_finish;
   klass->skip_async = g_input_stream_real_skip_async;
@@ -308,6 +313,13 @@ g_input_stream_read_all (GInputStream  *stream,
  *
  * On error %NULL is returned and @error is set accordingly.
  *
+ * Since 2.76, streams can implement #GInputStreamClass.read_bytes to
+ * return data they already hold without copying it. For example, if
+ * g_file_input_stream_set_map_reads() has been called on a stream
+ * returned by g_file_read() on a local file, large reads from large
+ * files return part of a read-only mapping of the file. The returned
+ * #GBytes must then not be accessed once the file has been truncated.
+ *
  * Returns: (transfer full): a new #GBytes, or %NULL on error
  *
  * Since: 2.34
@@ -318,11 +330,60 @@ g_input_stream_read_bytes (GInputStream  *stream,
 			   GCancellable  *cancellable,
 			   GError       **error)
 {
+  GInputStreamClass *class;
+  GBytes *bytes;
+
+  g_return_val_if_fail (G_IS_INPUT_STREAM (stream), NULL);
+
+  if (count == 0)
+    return g_bytes_new_static ("", 0);
+
+  if (((gssize) count) < 0)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+		   _("Too large count value passed to %s"), G_STRFUNC);
+      return NULL;
+    }
+
+  class = G_INPUT_STREAM_GET_CLASS (stream);
+
+  if (!g_input_stream_set_pending (stream, error))
+    return NULL;
+
+  if (cancellable)
+    g_cancellable_push_current (cancellable);
+
+  bytes = class->read_bytes (stream, count, cancellable, error);
+
+  if (cancellable)
+    g_cancellable_pop_current (cancellable);
+
+  g_input_stream_clear_pending (stream);
+
+  return bytes;
+}
+
+static GBytes *
+g_input_stream_real_read_bytes (GInputStream  *stream,
+				gsize          count,
+				GCancellable  *cancellable,
+				GError       **error)
+{
+  GInputStreamClass *class;
   guchar *buf;
   gssize nread;
 
+  class = G_INPUT_STREAM_GET_CLASS (stream);
+
+  if (class->read_fn == NULL)
+    {
+      g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                           _("Input stream doesn’t implement read"));
+      return NULL;
+    }
+
   buf = g_malloc (count);
-  nread = g_input_stream_read (stream, buf, count, cancellable, error);
+  nread = class->read_fn (stream, buf, count, cancellable, error);
   if (nread == -1)
     {
       g_free (buf);
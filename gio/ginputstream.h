@@ -102,9 +102,13 @@ struct _GInputStreamClass
                              GAsyncResult        *result,
                              GError             **error);
 
+  GBytes * (* read_bytes)   (GInputStream        *stream,
+                             gsize                count,
+                             GCancellable        *cancellable,
+                             GError             **error);
+
   /*< private >*/
   /* Padding for future expansion */
-  void (*_g_reserved1) (void);
   void (*_g_reserved2) (void);
   void (*_g_reserved3) (void);
   void (*_g_reserved4) (void);
@@ -148,6 +148,7 @@ G_DEFINE_AUTOPTR_CLEANUP_FUNC(GTlsFileDatabase, g_object_unref)
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GTlsInteraction, g_object_unref)
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GTlsPassword, g_object_unref)
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GTlsServerConnection, g_object_unref)
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(GUdpSegmentMessage, g_object_unref)
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GVfs, g_object_unref)
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GVolume, g_object_unref)
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(GVolumeMonitor, g_object_unref)
@@ -88,6 +88,7 @@
 #include <gio/gfilemonitor.h>
 #include <gio/gfilenamecompleter.h>
 #include <gio/gfileoutputstream.h>
+#include <gio/gfilewalker.h>
 #include <gio/gfilterinputstream.h>
 #include <gio/gfilteroutputstream.h>
 #include <gio/gicon.h>
@@ -169,6 +170,7 @@
 #include <gio/gtlsinteraction.h>
 #include <gio/gtlspassword.h>
 #include <gio/gtlsserverconnection.h>
+#include <gio/gudpsegmentmessage.h>
 #include <gio/gunixconnection.h>
 #include <gio/gunixcredentialsmessage.h>
 #include <gio/gunixfdlist.h>
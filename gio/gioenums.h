@@ -788,6 +788,9 @@ typedef enum {
  * GResourceFlags:
  * @G_RESOURCE_FLAGS_NONE: No flags set.
  * @G_RESOURCE_FLAGS_COMPRESSED: The file is compressed.
+ * @G_RESOURCE_FLAGS_COMPRESSED_LZ4: The file is compressed with LZ4 rather
+ *   than zlib. Always set together with %G_RESOURCE_FLAGS_COMPRESSED.
+ *   Since: 2.76
  *
  * GResourceFlags give information about a particular file inside a resource
  * bundle.
@@ -796,7 +799,8 @@ typedef enum {
  **/
 typedef enum {
   G_RESOURCE_FLAGS_NONE       = 0,
-  G_RESOURCE_FLAGS_COMPRESSED = (1<<0)
+  G_RESOURCE_FLAGS_COMPRESSED = (1<<0),
+  G_RESOURCE_FLAGS_COMPRESSED_LZ4 GIO_AVAILABLE_ENUMERATOR_IN_2_76 = (1<<1)
 } GResourceFlags;
 
 /**
@@ -37,6 +37,21 @@ gboolean g_output_stream_async_close_is_via_threads (GOutputStream *stream);
 void g_socket_connection_set_cached_remote_address (GSocketConnection *connection,
                                                     GSocketAddress    *address);
 
+gssize g_socket_send_bytes_with_blocking (GSocket       *socket,
+                                          GBytes        *bytes,
+                                          gboolean       blocking,
+                                          GCancellable  *cancellable,
+                                          GError       **error);
+
+gboolean g_socket_set_reuse_port (GSocket  *socket,
+                                  gboolean  reuse_port);
+
+void g_socket_listener_set_shards (GSocketListener *listener,
+                                   guint            n_shards);
+GPtrArray *g_socket_listener_get_shard_sockets (GSocketListener *listener,
+                                                guint            shard);
+GObject *g_socket_listener_get_source_object (GSocket *socket);
+
 /* POSIX defines IOV_MAX/UIO_MAXIOV as the maximum number of iovecs that can
  * be sent in one go. We define our own version of it here as there are two
  * possible names, and also define a fall-back value if none of the constants
@@ -496,6 +496,30 @@ struct _GInputMessage {
   guint                   *num_control_messages;
 };
 
+/**
+ * GSocketReceiveMessagesSourceFunc:
+ * @socket: the #GSocket
+ * @messages: (array length=num_messages): the messages that were received
+ * @num_messages: the number of messages in @messages
+ * @error: (nullable): the error that occurred while receiving, if any
+ * @user_data: data passed in by the user.
+ *
+ * This is the function type of the callback used for the #GSource
+ * returned by g_socket_create_receive_messages_source().
+ *
+ * @messages, the buffers they point to and their addresses are owned by
+ * the source, and are only valid until the callback returns.
+ *
+ * Returns: it should return %FALSE if the source should be removed.
+ *
+ * Since: 2.76
+ */
+typedef gboolean (*GSocketReceiveMessagesSourceFunc) (GSocket       *socket,
+                                                      GInputMessage *messages,
+                                                      guint          num_messages,
+                                                      const GError  *error,
+                                                      gpointer       user_data);
+
 /**
  * GOutputVector:
  * @buffer: Pointer to a buffer of data to read.
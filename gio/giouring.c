@@ -0,0 +1,525 @@
+/* GIO - GLib Input, Output and Streaming Library
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "giouring.h"
+
+/* Asynchronous reads and writes on local files are normally done by
+ * running read() or write() in a GTask thread, so each of them costs two
+ * thread hops. On Linux, we can instead submit them to an io_uring and
+ * get the completion on the task's main context, through an eventfd
+ * registered with the ring.
+ *
+ * There is one ring per GMainContext, created the first time a task
+ * belonging to that context needs one, and kept in a GSource attached to
+ * the context. Every GTask holds a reference on its context, so the ring
+ * can't go away while an operation is in flight.
+ *
+ * When io_uring can't be used (old kernel, seccomp, or GIO_USE_IO_URING=0
+ * in the environment) or the ring is full, the functions below return
+ * %FALSE and the caller falls back to a thread.
+ */
+
+#ifdef HAVE_IO_URING
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include "gioerror.h"
+#include "glibintl.h"
+
+#define RING_ENTRIES 64
+
+/* The kernel makes the completion queue twice as large as the submission
+ * queue; we never let more operations than that be in flight, so that
+ * their completions always fit */
+#define MAX_IN_FLIGHT (RING_ENTRIES * 2)
+
+/* Same limit as read() and write() apply to a single call */
+#define MAX_IO_SIZE 0x7ffff000
+
+typedef struct
+{
+  GSource source;
+
+  GMainContext *context;  /* (unowned) */
+  GMutex lock;
+  int ring_fd;
+  int event_fd;
+
+  void *sq_ring;
+  gsize sq_ring_size;
+  void *cq_ring;
+  gsize cq_ring_size;
+  struct io_uring_sqe *sqes;
+  gsize sqes_size;
+
+  guint *sq_tail;
+  guint *sq_mask;
+  guint *sq_array;
+  guint *cq_head;
+  guint *cq_tail;
+  guint *cq_mask;
+  struct io_uring_cqe *cqes;
+  guint cq_entries;
+
+  guint n_in_flight;  /* protected by lock */
+} GIOURing;
+
+typedef struct
+{
+  GTask *task;  /* (owned) */
+  gboolean is_write;
+} GIOURingOp;
+
+G_LOCK_DEFINE_STATIC (rings);
+static GHashTable *rings = NULL;  /* (element-type GMainContext GIOURing) */
+static gboolean rings_failed = FALSE;
+
+static int
+io_uring_setup (unsigned int            entries,
+                struct io_uring_params *params)
+{
+  return (int) syscall (__NR_io_uring_setup, entries, params);
+}
+
+static int
+io_uring_enter (int          ring_fd,
+                unsigned int to_submit,
+                unsigned int min_complete,
+                unsigned int flags)
+{
+  return (int) syscall (__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+static int
+io_uring_register (int          ring_fd,
+                   unsigned int opcode,
+                   void        *arg,
+                   unsigned int nr_args)
+{
+  return (int) syscall (__NR_io_uring_register, ring_fd, opcode, arg, nr_args);
+}
+
+static void
+complete_op (GIOURingOp *op,
+             int         res)
+{
+  if (res < 0)
+    {
+      int errsv = -res;
+
+      if (op->is_write)
+        g_task_return_new_error (op->task, G_IO_ERROR,
+                                 g_io_error_from_errno (errsv),
+                                 _("Error writing to file: %s"),
+                                 g_strerror (errsv));
+      else
+        g_task_return_new_error (op->task, G_IO_ERROR,
+                                 g_io_error_from_errno (errsv),
+                                 _("Error reading from file: %s"),
+                                 g_strerror (errsv));
+    }
+  else
+    g_task_return_int (op->task, res);
+
+  g_object_unref (op->task);
+  g_free (op);
+}
+
+static gboolean
+ring_source_dispatch (GSource     *source,
+                      GSourceFunc  callback,
+                      gpointer     user_data)
+{
+  GIOURing *ring = (GIOURing *) source;
+  struct {
+    GIOURingOp *op;
+    int res;
+  } completed[MAX_IN_FLIGHT];
+  guint n_completed = 0;
+  guint64 value;
+  guint head, tail, i;
+
+  /* Clear the eventfd before looking at the completion queue, so that a
+   * completion posted after we looked wakes us up again */
+  if (read (ring->event_fd, &value, sizeof (value)) < 0 && errno != EAGAIN)
+    g_warning ("Error reading io_uring eventfd: %s", g_strerror (errno));
+
+  g_mutex_lock (&ring->lock);
+
+  head = *ring->cq_head;
+  tail = (guint) g_atomic_int_get ((gint *) ring->cq_tail);
+
+  while (head != tail && n_completed < G_N_ELEMENTS (completed))
+    {
+      struct io_uring_cqe *cqe = &ring->cqes[head & *ring->cq_mask];
+
+      completed[n_completed].op = (GIOURingOp *) (guintptr) cqe->user_data;
+      completed[n_completed].res = cqe->res;
+      n_completed++;
+      head++;
+    }
+
+  g_atomic_int_set ((gint *) ring->cq_head, (gint) head);
+  ring->n_in_flight -= n_completed;
+
+  g_mutex_unlock (&ring->lock);
+
+  /* Return the tasks without holding the lock, as their callbacks may
+   * well start new operations */
+  for (i = 0; i < n_completed; i++)
+    complete_op (completed[i].op, completed[i].res);
+
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+ring_source_finalize (GSource *source)
+{
+  GIOURing *ring = (GIOURing *) source;
+
+  /* A ring that failed to set up was never added, and is freed by
+   * get_ring() with the lock held */
+  if (ring->context != NULL)
+    {
+      G_LOCK (rings);
+      if (rings != NULL && g_hash_table_lookup (rings, ring->context) == ring)
+        g_hash_table_remove (rings, ring->context);
+      G_UNLOCK (rings);
+    }
+
+  g_warn_if_fail (ring->n_in_flight == 0);
+
+  if (ring->sqes != NULL)
+    munmap (ring->sqes, ring->sqes_size);
+  if (ring->cq_ring != NULL && ring->cq_ring != ring->sq_ring)
+    munmap (ring->cq_ring, ring->cq_ring_size);
+  if (ring->sq_ring != NULL)
+    munmap (ring->sq_ring, ring->sq_ring_size);
+  if (ring->event_fd >= 0)
+    close (ring->event_fd);
+  if (ring->ring_fd >= 0)
+    close (ring->ring_fd);
+
+  g_mutex_clear (&ring->lock);
+}
+
+static GSourceFuncs ring_source_funcs =
+{
+  NULL,
+  NULL,
+  ring_source_dispatch,
+  ring_source_finalize,
+  NULL,
+  NULL,
+};
+
+static gboolean
+ring_map (GIOURing               *ring,
+          struct io_uring_params *params)
+{
+  ring->sq_ring_size = params->sq_off.array + params->sq_entries * sizeof (guint);
+  ring->cq_ring_size = params->cq_off.cqes + params->cq_entries * sizeof (struct io_uring_cqe);
+
+  if (params->features & IORING_FEAT_SINGLE_MMAP)
+    ring->sq_ring_size = ring->cq_ring_size = MAX (ring->sq_ring_size, ring->cq_ring_size);
+
+  ring->sq_ring = mmap (NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, ring->ring_fd, IORING_OFF_SQ_RING);
+  if (ring->sq_ring == MAP_FAILED)
+    {
+      ring->sq_ring = NULL;
+      return FALSE;
+    }
+
+  if (params->features & IORING_FEAT_SINGLE_MMAP)
+    ring->cq_ring = ring->sq_ring;
+  else
+    {
+      ring->cq_ring = mmap (NULL, ring->cq_ring_size, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_POPULATE, ring->ring_fd, IORING_OFF_CQ_RING);
+      if (ring->cq_ring == MAP_FAILED)
+        {
+          ring->cq_ring = NULL;
+          return FALSE;
+        }
+    }
+
+  ring->sqes_size = params->sq_entries * sizeof (struct io_uring_sqe);
+  ring->sqes = mmap (NULL, ring->sqes_size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, ring->ring_fd, IORING_OFF_SQES);
+  if (ring->sqes == MAP_FAILED)
+    {
+      ring->sqes = NULL;
+      return FALSE;
+    }
+
+  ring->sq_tail = (guint *) ((char *) ring->sq_ring + params->sq_off.tail);
+  ring->sq_mask = (guint *) ((char *) ring->sq_ring + params->sq_off.ring_mask);
+  ring->sq_array = (guint *) ((char *) ring->sq_ring + params->sq_off.array);
+  ring->cq_head = (guint *) ((char *) ring->cq_ring + params->cq_off.head);
+  ring->cq_tail = (guint *) ((char *) ring->cq_ring + params->cq_off.tail);
+  ring->cq_mask = (guint *) ((char *) ring->cq_ring + params->cq_off.ring_mask);
+  ring->cqes = (struct io_uring_cqe *) ((char *) ring->cq_ring + params->cq_off.cqes);
+  ring->cq_entries = params->cq_entries;
+
+  return TRUE;
+}
+
+/* Returns a new ring, not attached to any context yet, or %NULL with
+ * the error in @errsv if io_uring is not usable */
+static GIOURing *
+ring_new (int *errsv)
+{
+  GSource *source;
+  GIOURing *ring;
+  struct io_uring_params params;
+
+  source = g_source_new (&ring_source_funcs, sizeof (GIOURing));
+  g_source_set_static_name (source, "[gio] io_uring");
+  ring = (GIOURing *) source;
+  g_mutex_init (&ring->lock);
+  ring->event_fd = -1;
+
+  memset (&params, 0, sizeof (params));
+  ring->ring_fd = io_uring_setup (RING_ENTRIES, &params);
+
+  if (ring->ring_fd < 0)
+    goto fail;
+
+  /* Reads and writes must use the file position, like read() and write() */
+  if (!(params.features & IORING_FEAT_RW_CUR_POS))
+    {
+      errno = EINVAL;
+      goto fail;
+    }
+
+  if (!ring_map (ring, &params))
+    goto fail;
+
+  ring->event_fd = eventfd (0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (ring->event_fd < 0 ||
+      io_uring_register (ring->ring_fd, IORING_REGISTER_EVENTFD, &ring->event_fd, 1) < 0)
+    goto fail;
+
+  g_source_add_unix_fd (source, ring->event_fd, G_IO_IN);
+
+  return ring;
+
+fail:
+  *errsv = errno;
+  g_source_unref (source);
+  return NULL;
+}
+
+/* Whether io_uring may be tried at all. Whether the kernel supports it
+ * is only found out when the first ring is created, in get_ring() */
+static gboolean
+io_uring_enabled (void)
+{
+  static gsize enabled = 0;
+
+  if (g_once_init_enter (&enabled))
+    {
+      const char *env = g_getenv ("GIO_USE_IO_URING");
+
+      g_once_init_leave (&enabled, (env == NULL || g_strcmp0 (env, "0") != 0) ? 2 : 1);
+    }
+
+  return enabled == 2;
+}
+
+static GIOURing *
+get_ring (GMainContext *context)
+{
+  GIOURing *ring = NULL;
+  int errsv;
+
+  if (!io_uring_enabled ())
+    return NULL;
+
+  if (context == NULL)
+    context = g_main_context_default ();
+
+  G_LOCK (rings);
+
+  if (rings == NULL)
+    rings = g_hash_table_new (NULL, NULL);
+
+  ring = g_hash_table_lookup (rings, context);
+  if (ring == NULL && !rings_failed)
+    {
+      ring = ring_new (&errsv);
+      if (ring != NULL)
+        {
+          ring->context = context;
+          g_hash_table_insert (rings, context, ring);
+
+          /* The context owns the ring from now on */
+          g_source_attach ((GSource *) ring, context);
+          g_source_unref ((GSource *) ring);
+        }
+      /* Only give up on io_uring for good if the kernel doesn't support
+       * it or doesn't let us use it. Running out of file descriptors or
+       * memory is temporary, and the next operation tries again. */
+      else if (errsv == ENOSYS || errsv == EPERM || errsv == EINVAL)
+        rings_failed = TRUE;
+    }
+
+  G_UNLOCK (rings);
+
+  return ring;
+}
+
+static gboolean
+submit_op (int          fd,
+           int          opcode,
+           const void  *buffer,
+           gsize        count,
+           GTask       *task)
+{
+  GIOURing *ring;
+  GIOURingOp *op;
+  struct io_uring_sqe *sqe;
+  guint tail, index;
+  int ret;
+
+  ring = get_ring (g_task_get_context (task));
+  if (ring == NULL)
+    return FALSE;
+
+  g_mutex_lock (&ring->lock);
+
+  /* Never have more operations in flight than the completion queue can
+   * hold; the caller can always use a thread instead */
+  if (ring->n_in_flight >= MIN (ring->cq_entries, MAX_IN_FLIGHT))
+    {
+      g_mutex_unlock (&ring->lock);
+      return FALSE;
+    }
+
+  op = g_new (GIOURingOp, 1);
+  op->task = g_object_ref (task);
+  op->is_write = (opcode == IORING_OP_WRITE);
+
+  tail = *ring->sq_tail;
+  index = tail & *ring->sq_mask;
+  sqe = &ring->sqes[index];
+  memset (sqe, 0, sizeof (*sqe));
+  sqe->opcode = opcode;
+  sqe->fd = fd;
+  sqe->off = (guint64) -1;
+  sqe->addr = (guintptr) buffer;
+  sqe->len = (guint32) MIN (count, MAX_IO_SIZE);
+  sqe->user_data = (guintptr) op;
+  ring->sq_array[index] = index;
+
+  g_atomic_int_set ((gint *) ring->sq_tail, (gint) (tail + 1));
+
+  do
+    ret = io_uring_enter (ring->ring_fd, 1, 0, 0);
+  while (ret < 0 && errno == EINTR);
+
+  if (ret != 1)
+    {
+      /* The kernel did not take the entry, so take it back */
+      g_atomic_int_set ((gint *) ring->sq_tail, (gint) tail);
+      g_mutex_unlock (&ring->lock);
+
+      g_object_unref (op->task);
+      g_free (op);
+      return FALSE;
+    }
+
+  ring->n_in_flight++;
+
+  g_mutex_unlock (&ring->lock);
+
+  return TRUE;
+}
+
+/*
+ * _g_io_uring_read:
+ * @fd: file descriptor to read from, at its current position
+ * @buffer: buffer to read into, which must stay valid until @task returns
+ * @count: number of bytes to read
+ * @task: the task to return the number of bytes read, or an error, on
+ *
+ * Submits a read() of @fd to the io_uring of the task's context.
+ *
+ * Returns: %TRUE if @task will be returned once the read is complete,
+ *     %FALSE if the caller should do the read some other way
+ */
+gboolean
+_g_io_uring_read (int    fd,
+                  void  *buffer,
+                  gsize  count,
+                  GTask *task)
+{
+  return submit_op (fd, IORING_OP_READ, buffer, count, task);
+}
+
+/*
+ * _g_io_uring_write:
+ * @fd: file descriptor to write to, at its current position
+ * @buffer: data to write, which must stay valid until @task returns
+ * @count: number of bytes to write
+ * @task: the task to return the number of bytes written, or an error, on
+ *
+ * Submits a write() to @fd to the io_uring of the task's context.
+ *
+ * Returns: %TRUE if @task will be returned once the write is complete,
+ *     %FALSE if the caller should do the write some other way
+ */
+gboolean
+_g_io_uring_write (int         fd,
+                   const void *buffer,
+                   gsize       count,
+                   GTask      *task)
+{
+  return submit_op (fd, IORING_OP_WRITE, buffer, count, task);
+}
+
+#else /* !HAVE_IO_URING */
+
+gboolean
+_g_io_uring_read (int    fd,
+                  void  *buffer,
+                  gsize  count,
+                  GTask *task)
+{
+  return FALSE;
+}
+
+gboolean
+_g_io_uring_write (int         fd,
+                   const void *buffer,
+                   gsize       count,
+                   GTask      *task)
+{
+  return FALSE;
+}
+
+#endif /* HAVE_IO_URING */
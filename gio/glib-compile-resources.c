@@ -41,12 +41,24 @@
 #include <gio/gzlibcompressor.h>
 #include <gio/gconverteroutputstream.h>
 
+#ifdef HAVE_LZ4
+#include <lz4.h>
+#include <lz4hc.h>
+#endif
+
 #include <glib.h>
 #include "gvdb/gvdb-builder.h"
 
 #include "gconstructor_as_data.h"
 #include "glib/glib-private.h"
 
+typedef enum
+{
+  COMPRESSION_NONE,
+  COMPRESSION_ZLIB,
+  COMPRESSION_LZ4
+} Compression;
+
 typedef struct
 {
   char *filename;
@@ -54,6 +66,11 @@ typedef struct
   gsize content_size;
   gsize size;
   guint32 flags;
+
+  /* how to produce @content, see file_data_process() */
+  char *preproc_options;
+  Compression compression;
+  GError *error;
 } FileData;
 
 typedef struct
@@ -67,25 +84,79 @@ typedef struct
 
   /* per file */
   char *alias;
-  gboolean compressed;
+  Compression compression;
   char *preproc_options;
 
   GString *string;  /* non-NULL when accepting text */
+
+  /* --jobs */
+  GThreadPool *pool;
+  GPtrArray *jobs;  /* FileData being processed by @pool, in document order */
 } ParseState;
 
 static gchar **sourcedirs = NULL;
 static gchar *xmllint = NULL;
 static gchar *jsonformat = NULL;
 static gchar *gdk_pixbuf_pixdata = NULL;
+static gint n_jobs = 1;
 
 static void
 file_data_free (FileData *data)
 {
   g_free (data->filename);
   g_free (data->content);
+  g_free (data->preproc_options);
+  g_clear_error (&data->error);
   g_free (data);
 }
 
+/* The `compressed` attribute takes a boolean, which selects zlib for
+ * backwards compatibility, or the name of the compression format. */
+static gboolean
+parse_compression (const gchar  *element_name,
+                   const gchar  *value,
+                   Compression  *compression,
+                   GError      **error)
+{
+  const gchar * const true_values[] = { "true", "t", "yes", "y", "1", "zlib", NULL };
+  const gchar * const false_values[] = { "false", "f", "no", "n", "0", NULL };
+  gsize i;
+
+  *compression = COMPRESSION_NONE;
+
+  if (value == NULL)
+    return TRUE;
+
+  for (i = 0; false_values[i] != NULL; i++)
+    if (g_ascii_strcasecmp (value, false_values[i]) == 0)
+      return TRUE;
+
+  for (i = 0; true_values[i] != NULL; i++)
+    if (g_ascii_strcasecmp (value, true_values[i]) == 0)
+      {
+        *compression = COMPRESSION_ZLIB;
+        return TRUE;
+      }
+
+  if (g_ascii_strcasecmp (value, "lz4") == 0)
+    {
+#ifdef HAVE_LZ4
+      *compression = COMPRESSION_LZ4;
+      return TRUE;
+#else
+      g_set_error (error, G_MARKUP_ERROR, G_MARKUP_ERROR_INVALID_CONTENT,
+                   _("LZ4 compression is not supported by this build of glib-compile-resources"));
+      return FALSE;
+#endif
+    }
+
+  g_set_error (error, G_MARKUP_ERROR, G_MARKUP_ERROR_INVALID_CONTENT,
+               _("Element <%s>: invalid value “%s” for attribute “compressed”; "
+                 "expected a boolean, “zlib” or “lz4”"),
+               element_name, value);
+  return FALSE;
+}
+
 static void
 start_element (GMarkupParseContext  *context,
 	       const gchar          *element_name,
@@ -129,10 +200,13 @@ start_element (GMarkupParseContext  *context,
     {
       if (strcmp (element_name, "file") == 0)
 	{
+	  const gchar *compressed = NULL;
+
 	  COLLECT (OPTIONAL | STRDUP, "alias", &state->alias,
-		   OPTIONAL | BOOL, "compressed", &state->compressed,
+		   OPTIONAL | STRING, "compressed", &compressed,
                    OPTIONAL | STRDUP, "preprocess", &state->preproc_options);
 	  state->string = g_string_new ("");
+	  parse_compression (element_name, compressed, &state->compression, error);
 	  return;
 	}
     }
@@ -197,6 +271,333 @@ find_file (const gchar *filename)
     return NULL;
 }
 
+/* Reads the contents of @data->filename into @data, running the requested
+ * preprocessors and compression. With --jobs this runs in a worker thread,
+ * so it must not touch the parse state. */
+static gboolean
+file_data_process (FileData  *data,
+                   GError   **error)
+{
+  GError *my_error = NULL;
+  gchar *real_file = g_strdup (data->filename);
+  char *tmp_file = NULL;
+  gboolean ret = FALSE;
+
+  if (data->preproc_options)
+    {
+      gchar **options;
+      guint i;
+      gboolean xml_stripblanks = FALSE;
+      gboolean json_stripblanks = FALSE;
+      gboolean to_pixdata = FALSE;
+
+      options = g_strsplit (data->preproc_options, ",", -1);
+
+      for (i = 0; options[i]; i++)
+        {
+          if (!strcmp (options[i], "xml-stripblanks"))
+            xml_stripblanks = TRUE;
+          else if (!strcmp (options[i], "to-pixdata"))
+            to_pixdata = TRUE;
+          else if (!strcmp (options[i], "json-stripblanks"))
+            json_stripblanks = TRUE;
+          else
+            {
+              g_set_error (error, G_MARKUP_ERROR, G_MARKUP_ERROR_INVALID_CONTENT,
+                           _("Unknown processing option “%s”"), options[i]);
+              g_strfreev (options);
+              goto cleanup;
+            }
+        }
+      g_strfreev (options);
+
+      if (xml_stripblanks)
+        {
+          /* This is not fatal: pretty-printed XML is still valid XML */
+          if (xmllint == NULL)
+            {
+              static gint xmllint_warned = FALSE;
+
+              /* Only warn once */
+              if (g_atomic_int_compare_and_exchange (&xmllint_warned, FALSE, TRUE))
+                {
+                  /* Translators: the first %s is a gresource XML attribute,
+                   * the second %s is an environment variable, and the third
+                   * %s is a command line tool
+                   */
+                  char *warn = g_strdup_printf (_("%s preprocessing requested, but %s is not set, and %s is not in PATH"),
+                                                "xml-stripblanks",
+                                                "XMLLINT",
+                                                "xmllint");
+                  g_printerr ("%s\n", warn);
+                  g_free (warn);
+                }
+            }
+          else
+            {
+              GSubprocess *proc;
+              int fd;
+
+              fd = g_file_open_tmp ("resource-XXXXXXXX", &tmp_file, error);
+              if (fd < 0)
+                goto cleanup;
+
+              close (fd);
+
+              proc = g_subprocess_new (G_SUBPROCESS_FLAGS_STDOUT_SILENCE, error,
+                                       xmllint, "--nonet", "--noblanks", "--output", tmp_file, real_file, NULL);
+              g_free (real_file);
+              real_file = NULL;
+
+              if (!proc)
+                goto cleanup;
+
+              if (!g_subprocess_wait_check (proc, NULL, error))
+                {
+                  g_object_unref (proc);
+                  goto cleanup;
+                }
+
+              g_object_unref (proc);
+
+              real_file = g_strdup (tmp_file);
+            }
+        }
+
+      if (json_stripblanks)
+        {
+          /* As above, this is not fatal: pretty-printed JSON is still
+           * valid JSON
+           */
+          if (jsonformat == NULL)
+            {
+              static gint jsonformat_warned = FALSE;
+
+              /* Only warn once */
+              if (g_atomic_int_compare_and_exchange (&jsonformat_warned, FALSE, TRUE))
+                {
+                  /* Translators: the first %s is a gresource XML attribute,
+                   * the second %s is an environment variable, and the third
+                   * %s is a command line tool
+                   */
+                  char *warn = g_strdup_printf (_("%s preprocessing requested, but %s is not set, and %s is not in PATH"),
+                                                "json-stripblanks",
+                                                "JSON_GLIB_FORMAT",
+                                                "json-glib-format");
+                  g_printerr ("%s\n", warn);
+                  g_free (warn);
+                }
+            }
+          else
+            {
+              GSubprocess *proc;
+              int fd;
+
+              fd = g_file_open_tmp ("resource-XXXXXXXX", &tmp_file, error);
+              if (fd < 0)
+                goto cleanup;
+
+              close (fd);
+
+              proc = g_subprocess_new (G_SUBPROCESS_FLAGS_STDOUT_SILENCE, error,
+                                       jsonformat, "--output", tmp_file, real_file, NULL);
+              g_free (real_file);
+              real_file = NULL;
+
+              if (!proc)
+                goto cleanup;
+
+              if (!g_subprocess_wait_check (proc, NULL, error))
+                {
+                  g_object_unref (proc);
+                  goto cleanup;
+                }
+
+              g_object_unref (proc);
+
+              real_file = g_strdup (tmp_file);
+            }
+        }
+
+      if (to_pixdata)
+        {
+          GSubprocess *proc;
+          int fd;
+
+          /* This is a fatal error: if to-pixdata is used it means that
+           * the code loading the GResource expects a specific data format
+           */
+          if (gdk_pixbuf_pixdata == NULL)
+            {
+              /* Translators: the first %s is a gresource XML attribute,
+               * the second %s is an environment variable, and the third
+               * %s is a command line tool
+               */
+              g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                           _("%s preprocessing requested, but %s is not set, and %s is not in PATH"),
+                           "to-pixdata",
+                           "GDK_PIXBUF_PIXDATA",
+                           "gdk-pixbuf-pixdata");
+              goto cleanup;
+            }
+
+          fd = g_file_open_tmp ("resource-XXXXXXXX", &tmp_file, error);
+          if (fd < 0)
+            goto cleanup;
+
+          close (fd);
+
+          proc = g_subprocess_new (G_SUBPROCESS_FLAGS_STDOUT_SILENCE, error,
+                                   gdk_pixbuf_pixdata, real_file, tmp_file, NULL);
+          g_free (real_file);
+          real_file = NULL;
+
+          if (!g_subprocess_wait_check (proc, NULL, error))
+            {
+              g_object_unref (proc);
+              goto cleanup;
+            }
+
+          g_object_unref (proc);
+
+          real_file = g_strdup (tmp_file);
+        }
+    }
+
+  if (!g_file_get_contents (real_file, &data->content, &data->size, &my_error))
+    {
+      g_set_error (error, G_MARKUP_ERROR, G_MARKUP_ERROR_INVALID_CONTENT,
+                   _("Error reading file %s: %s"),
+                   real_file, my_error->message);
+      g_clear_error (&my_error);
+      goto cleanup;
+    }
+  /* Include zero termination in content_size for uncompressed files (but not in size) */
+  data->content_size = data->size + 1;
+
+  if (data->compression == COMPRESSION_ZLIB)
+    {
+      GOutputStream *out = g_memory_output_stream_new (NULL, 0, g_realloc, g_free);
+      GZlibCompressor *compressor =
+        g_zlib_compressor_new (G_ZLIB_COMPRESSOR_FORMAT_ZLIB, 9);
+      GOutputStream *out2 = g_converter_output_stream_new (out, G_CONVERTER (compressor));
+
+      if (!g_output_stream_write_all (out2, data->content, data->size,
+                                      NULL, NULL, NULL) ||
+          !g_output_stream_close (out2, NULL, NULL))
+        {
+          g_set_error (error, G_MARKUP_ERROR, G_MARKUP_ERROR_INVALID_CONTENT,
+                       _("Error compressing file %s"),
+                       real_file);
+          g_object_unref (compressor);
+          g_object_unref (out);
+          g_object_unref (out2);
+          goto cleanup;
+        }
+
+      g_free (data->content);
+      data->content_size = g_memory_output_stream_get_data_size (G_MEMORY_OUTPUT_STREAM (out));
+      data->content = g_memory_output_stream_steal_data (G_MEMORY_OUTPUT_STREAM (out));
+
+      g_object_unref (compressor);
+      g_object_unref (out);
+      g_object_unref (out2);
+
+      data->flags |= G_RESOURCE_FLAGS_COMPRESSED;
+    }
+#ifdef HAVE_LZ4
+  else if (data->compression == COMPRESSION_LZ4)
+    {
+      char *compressed;
+      int bound, compressed_size = 0;
+
+      bound = data->size <= LZ4_MAX_INPUT_SIZE ? LZ4_compressBound ((int) data->size) : 0;
+      if (bound > 0)
+        {
+          compressed = g_malloc (bound);
+          compressed_size = LZ4_compress_HC (data->content, compressed,
+                                             (int) data->size, bound,
+                                             LZ4HC_CLEVEL_MAX);
+        }
+      else
+        compressed = NULL;
+
+      if (compressed_size <= 0)
+        {
+          g_set_error (error, G_MARKUP_ERROR, G_MARKUP_ERROR_INVALID_CONTENT,
+                       _("Error compressing file %s"),
+                       real_file);
+          g_free (compressed);
+          goto cleanup;
+        }
+
+      g_free (data->content);
+      data->content_size = compressed_size;
+      data->content = g_realloc (compressed, compressed_size);
+
+      data->flags |= G_RESOURCE_FLAGS_COMPRESSED | G_RESOURCE_FLAGS_COMPRESSED_LZ4;
+    }
+#endif
+
+  ret = TRUE;
+
+cleanup:
+  g_free (real_file);
+
+  if (tmp_file)
+    {
+      unlink (tmp_file);
+      g_free (tmp_file);
+    }
+
+  return ret;
+}
+
+static void
+file_data_process_func (gpointer data,
+                        gpointer user_data)
+{
+  FileData *file_data = data;
+
+  file_data_process (file_data, &file_data->error);
+}
+
+/* Waits for the files queued by end_element() to be processed, and
+ * reports the error of the first failed one in document order, so that
+ * the outcome doesn't depend on how the jobs were scheduled. */
+static gboolean
+finish_file_jobs (ParseState  *state,
+                  GError     **error)
+{
+  gboolean ret = TRUE;
+  guint i;
+
+  if (state->pool == NULL)
+    return TRUE;
+
+  g_thread_pool_free (state->pool, FALSE, TRUE);
+  state->pool = NULL;
+
+  for (i = 0; i < state->jobs->len; i++)
+    {
+      FileData *data = g_ptr_array_index (state->jobs, i);
+
+      if (data->error == NULL)
+        continue;
+
+      if (ret)
+        g_propagate_error (error, g_steal_pointer (&data->error));
+      else
+        g_clear_error (&data->error);
+
+      ret = FALSE;
+    }
+
+  g_clear_pointer (&state->jobs, g_ptr_array_unref);
+
+  return ret;
+}
+
 static void
 end_element (GMarkupParseContext  *context,
 	     const gchar          *element_name,
@@ -204,7 +605,6 @@ end_element (GMarkupParseContext  *context,
 	     GError              **error)
 {
   ParseState *state = user_data;
-  GError *my_error = NULL;
 
   if (strcmp (element_name, "gresource") == 0)
     {
@@ -218,7 +618,6 @@ end_element (GMarkupParseContext  *context,
       gchar *real_file = NULL;
       gchar *key;
       FileData *data = NULL;
-      char *tmp_file = NULL;
 
       file = state->string->str;
       key = file;
@@ -268,232 +667,18 @@ end_element (GMarkupParseContext  *context,
       if (!state->collect_data)
         goto done;
 
-      if (state->preproc_options)
-        {
-          gchar **options;
-          guint i;
-          gboolean xml_stripblanks = FALSE;
-          gboolean json_stripblanks = FALSE;
-          gboolean to_pixdata = FALSE;
-
-          options = g_strsplit (state->preproc_options, ",", -1);
+      data->preproc_options = g_steal_pointer (&state->preproc_options);
+      data->compression = state->compression;
 
-          for (i = 0; options[i]; i++)
-            {
-              if (!strcmp (options[i], "xml-stripblanks"))
-                xml_stripblanks = TRUE;
-              else if (!strcmp (options[i], "to-pixdata"))
-                to_pixdata = TRUE;
-              else if (!strcmp (options[i], "json-stripblanks"))
-                json_stripblanks = TRUE;
-              else
-                {
-                  g_set_error (error, G_MARKUP_ERROR, G_MARKUP_ERROR_INVALID_CONTENT,
-                               _("Unknown processing option “%s”"), options[i]);
-                  g_strfreev (options);
-                  goto cleanup;
-                }
-            }
-          g_strfreev (options);
-
-          if (xml_stripblanks)
-            {
-              /* This is not fatal: pretty-printed XML is still valid XML */
-              if (xmllint == NULL)
-                {
-                  static gboolean xmllint_warned = FALSE;
-
-                  if (!xmllint_warned)
-                    {
-                      /* Translators: the first %s is a gresource XML attribute,
-                       * the second %s is an environment variable, and the third
-                       * %s is a command line tool
-                       */
-                      char *warn = g_strdup_printf (_("%s preprocessing requested, but %s is not set, and %s is not in PATH"),
-                                                    "xml-stripblanks",
-                                                    "XMLLINT",
-                                                    "xmllint");
-                      g_printerr ("%s\n", warn);
-                      g_free (warn);
-
-                      /* Only warn once */
-                      xmllint_warned = TRUE;
-                    }
-                }
-              else
-                {
-                  GSubprocess *proc;
-                  int fd;
-
-                  fd = g_file_open_tmp ("resource-XXXXXXXX", &tmp_file, error);
-                  if (fd < 0)
-                    goto cleanup;
-
-                  close (fd);
-
-                  proc = g_subprocess_new (G_SUBPROCESS_FLAGS_STDOUT_SILENCE, error,
-                                           xmllint, "--nonet", "--noblanks", "--output", tmp_file, real_file, NULL);
-                  g_free (real_file);
-                  real_file = NULL;
-
-                  if (!proc)
-                    goto cleanup;
-
-                  if (!g_subprocess_wait_check (proc, NULL, error))
-                    {
-                      g_object_unref (proc);
-                      goto cleanup;
-                    }
-
-                  g_object_unref (proc);
-
-                  real_file = g_strdup (tmp_file);
-                }
-            }
-
-          if (json_stripblanks)
-            {
-              /* As above, this is not fatal: pretty-printed JSON is still
-               * valid JSON
-               */
-              if (jsonformat == NULL)
-                {
-                  static gboolean jsonformat_warned = FALSE;
-
-                  if (!jsonformat_warned)
-                    {
-                      /* Translators: the first %s is a gresource XML attribute,
-                       * the second %s is an environment variable, and the third
-                       * %s is a command line tool
-                       */
-                      char *warn = g_strdup_printf (_("%s preprocessing requested, but %s is not set, and %s is not in PATH"),
-                                                    "json-stripblanks",
-                                                    "JSON_GLIB_FORMAT",
-                                                    "json-glib-format");
-                      g_printerr ("%s\n", warn);
-                      g_free (warn);
-
-                      /* Only warn once */
-                      jsonformat_warned = TRUE;
-                    }
-                }
-              else
-                {
-                  GSubprocess *proc;
-                  int fd;
-
-                  fd = g_file_open_tmp ("resource-XXXXXXXX", &tmp_file, error);
-                  if (fd < 0)
-                    goto cleanup;
-
-                  close (fd);
-
-                  proc = g_subprocess_new (G_SUBPROCESS_FLAGS_STDOUT_SILENCE, error,
-                                           jsonformat, "--output", tmp_file, real_file, NULL);
-                  g_free (real_file);
-                  real_file = NULL;
-
-                  if (!proc)
-                    goto cleanup;
-
-                  if (!g_subprocess_wait_check (proc, NULL, error))
-                    {
-                      g_object_unref (proc);
-                      goto cleanup;
-                    }
-
-                  g_object_unref (proc);
-
-                  real_file = g_strdup (tmp_file);
-                }
-            }
-
-          if (to_pixdata)
-            {
-	      GSubprocess *proc;
-              int fd;
-
-              /* This is a fatal error: if to-pixdata is used it means that
-               * the code loading the GResource expects a specific data format
-               */
-              if (gdk_pixbuf_pixdata == NULL)
-                {
-                  /* Translators: the first %s is a gresource XML attribute,
-                   * the second %s is an environment variable, and the third
-                   * %s is a command line tool
-                   */
-                  g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
-                               _("%s preprocessing requested, but %s is not set, and %s is not in PATH"),
-                               "to-pixdata",
-                               "GDK_PIXBUF_PIXDATA",
-                               "gdk-pixbuf-pixdata");
-                  goto cleanup;
-                }
-
-              fd = g_file_open_tmp ("resource-XXXXXXXX", &tmp_file, error);
-              if (fd < 0)
-                goto cleanup;
-
-              close (fd);
-
-              proc = g_subprocess_new (G_SUBPROCESS_FLAGS_STDOUT_SILENCE, error,
-                                       gdk_pixbuf_pixdata, real_file, tmp_file, NULL);
-              g_free (real_file);
-              real_file = NULL;
-
-	      if (!g_subprocess_wait_check (proc, NULL, error))
-		{
-		  g_object_unref (proc);
-                  goto cleanup;
-		}
-
-	      g_object_unref (proc);
-
-              real_file = g_strdup (tmp_file);
-            }
-	}
-
-      if (!g_file_get_contents (real_file, &data->content, &data->size, &my_error))
-	{
-	  g_set_error (error, G_MARKUP_ERROR, G_MARKUP_ERROR_INVALID_CONTENT,
-		       _("Error reading file %s: %s"),
-		       real_file, my_error->message);
-	  g_clear_error (&my_error);
-	  goto cleanup;
-	}
-      /* Include zero termination in content_size for uncompressed files (but not in size) */
-      data->content_size = data->size + 1;
-
-      if (state->compressed)
-	{
-	  GOutputStream *out = g_memory_output_stream_new (NULL, 0, g_realloc, g_free);
-	  GZlibCompressor *compressor =
-	    g_zlib_compressor_new (G_ZLIB_COMPRESSOR_FORMAT_ZLIB, 9);
-	  GOutputStream *out2 = g_converter_output_stream_new (out, G_CONVERTER (compressor));
-
-	  if (!g_output_stream_write_all (out2, data->content, data->size,
-					  NULL, NULL, NULL) ||
-	      !g_output_stream_close (out2, NULL, NULL))
-	    {
-	      g_set_error (error, G_MARKUP_ERROR, G_MARKUP_ERROR_INVALID_CONTENT,
-			   _("Error compressing file %s"),
-			   real_file);
-              g_object_unref (compressor);
-              g_object_unref (out);
-              g_object_unref (out2);
-              goto cleanup;
-	    }
-
-	  g_free (data->content);
-	  data->content_size = g_memory_output_stream_get_data_size (G_MEMORY_OUTPUT_STREAM (out));
-	  data->content = g_memory_output_stream_steal_data (G_MEMORY_OUTPUT_STREAM (out));
-
-	  g_object_unref (compressor);
-	  g_object_unref (out);
-	  g_object_unref (out2);
-
-	  data->flags |= G_RESOURCE_FLAGS_COMPRESSED;
-	}
+      if (state->pool != NULL)
+        {
+          /* The contents are filled in by a worker thread while parsing
+           * goes on; see finish_file_jobs() */
+          g_ptr_array_add (state->jobs, data);
+          g_thread_pool_push (state->pool, data, NULL);
+        }
+      else if (!file_data_process (data, error))
+        goto cleanup;
 
 done:
       g_hash_table_insert (state->table, key, data);
@@ -511,12 +696,6 @@ done:
 
       g_free (real_file);
 
-      if (tmp_file)
-        {
-          unlink (tmp_file);
-          g_free (tmp_file);
-        }
-
       if (data != NULL)
         file_data_free (data);
     }
@@ -558,6 +737,7 @@ parse_resource_file (const gchar *filename,
   GError *error = NULL;
   gchar *contents;
   GHashTable *table = NULL;
+  gboolean parsed;
   gsize size;
 
   if (!g_file_get_contents (filename, &contents, &size, &error))
@@ -570,13 +750,26 @@ parse_resource_file (const gchar *filename,
   state.collect_data = collect_data;
   state.table = g_hash_table_ref (files);
 
+  if (collect_data && n_jobs != 1)
+    {
+      state.pool = g_thread_pool_new (file_data_process_func, NULL,
+                                      n_jobs, FALSE, NULL);
+      state.jobs = g_ptr_array_new ();
+    }
+
   context = g_markup_parse_context_new (&parser,
 					G_MARKUP_TREAT_CDATA_AS_TEXT |
 					G_MARKUP_PREFIX_ERROR_POSITION,
 					&state, NULL);
 
-  if (!g_markup_parse_context_parse (context, contents, size, &error) ||
-      !g_markup_parse_context_end_parse (context, &error))
+  parsed = g_markup_parse_context_parse (context, contents, size, &error) &&
+           g_markup_parse_context_end_parse (context, &error);
+
+  /* Always wait for the jobs, as they reference entries of the table */
+  if (!finish_file_jobs (&state, parsed ? &error : NULL))
+    parsed = FALSE;
+
+  if (!parsed)
     {
       g_printerr ("%s: %s.\n", filename, error->message);
       g_clear_error (&error);
@@ -832,6 +1025,7 @@ main (int argc, char **argv)
     { "external-data", 0, 0, G_OPTION_ARG_NONE, &external_data, N_("Don’t embed resource data in the C file; assume it's linked externally instead"), NULL },
     { "c-name", 0, 0, G_OPTION_ARG_STRING, &c_name, N_("C identifier name used for the generated source code"), NULL },
     { "compiler", 'C', 0, G_OPTION_ARG_STRING, &compiler, N_("The target C compiler (default: the CC environment variable)"), NULL },
+    { "jobs", 'j', 0, G_OPTION_ARG_INT, &n_jobs, N_("Number of files to preprocess and compress in parallel, or 0 for one per processor (default: 1)"), N_("N") },
     G_OPTION_ENTRY_NULL
   };
 
@@ -884,6 +1078,15 @@ main (int argc, char **argv)
       return 1;
     }
 
+  if (n_jobs == 0)
+    n_jobs = g_get_num_processors ();
+  if (n_jobs < 1)
+    {
+      g_printerr (_("The number of jobs must be at least 1, or 0 for one per processor\n"));
+      g_free (c_name);
+      return 1;
+    }
+
   if (internal)
     linkage = "G_GNUC_INTERNAL";
 
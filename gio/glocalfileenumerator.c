@@ -44,12 +44,36 @@
 #include <dirent.h>
 #include <errno.h>
 
+/* On Linux, read entries with getdents64() directly, into a buffer much
+ * larger than the one readdir() uses, and keep the names in that buffer
+ * rather than duplicating each of them. */
+#if defined(__linux__) && defined(HAVE_STRUCT_DIRENT_D_TYPE)
+#include <sys/syscall.h>
+#include <unistd.h>
+#ifdef SYS_getdents64
+#define USE_GETDENTS64
+#endif
+#endif
+
 typedef struct {
   char *name;
   long inode;
   GFileType type;
 } DirEntry;
 
+#ifdef USE_GETDENTS64
+#define GETDENTS64_BUFFER_SIZE (256 * 1024)
+
+/* See getdents64(2) */
+typedef struct {
+  guint64 d_ino;
+  gint64 d_off;
+  unsigned short d_reclen;
+  unsigned char d_type;
+  char d_name[];
+} LinuxDirent64;
+#endif
+
 #endif
 
 struct _GLocalFileEnumerator
@@ -72,6 +96,10 @@ struct _GLocalFileEnumerator
   DirEntry *entries;
   int entries_pos;
   gboolean at_end;
+#ifdef USE_GETDENTS64
+  char *dirent_buffer;  /* (owned), holds the names in @entries */
+  gsize n_entries_allocated;
+#endif
 #endif
   
   gboolean follow_symlinks;
@@ -92,6 +120,10 @@ static void
 free_entries (GLocalFileEnumerator *local)
 {
 #ifndef USE_GDIR
+#ifdef USE_GETDENTS64
+  g_free (local->entries);
+  g_free (local->dirent_buffer);
+#else
   int i;
 
   if (local->entries != NULL)
@@ -102,6 +134,7 @@ free_entries (GLocalFileEnumerator *local)
       g_free (local->entries);
     }
 #endif
+#endif
 }
 
 static void
@@ -301,12 +334,78 @@ file_type_from_dirent (char d_type)
 }
 #endif
 
+#ifdef USE_GETDENTS64
+/* Reads the next batch of entries, which is as many as fit in one
+ * getdents64() call. The names point into @local->dirent_buffer, so they
+ * stay valid until the next batch is read. */
+static void
+read_entries_getdents64 (GLocalFileEnumerator *local)
+{
+  int fd = dirfd (local->dir);
+  gsize i = 0;
+
+  if (local->dirent_buffer == NULL)
+    local->dirent_buffer = g_malloc (GETDENTS64_BUFFER_SIZE);
+
+  /* A batch may hold nothing but “.” and “..”, so keep reading until there
+   * is something to return or the end is reached */
+  while (i == 0)
+    {
+      long n_read;
+      long pos;
+
+      do
+        n_read = syscall (SYS_getdents64, fd, local->dirent_buffer, GETDENTS64_BUFFER_SIZE);
+      while (n_read == -1 && errno == EINTR);
+
+      /* Errors end the enumeration, as they do with readdir() */
+      if (n_read <= 0)
+        break;
+
+      for (pos = 0; pos < n_read;)
+        {
+          LinuxDirent64 *entry = (LinuxDirent64 *) (local->dirent_buffer + pos);
+
+          pos += entry->d_reclen;
+
+          if (0 == strcmp (entry->d_name, ".") ||
+              0 == strcmp (entry->d_name, ".."))
+            continue;
+
+          if (i + 1 >= local->n_entries_allocated)
+            {
+              local->n_entries_allocated = MAX (CHUNK_SIZE + 1, local->n_entries_allocated * 2);
+              local->entries = g_renew (DirEntry, local->entries, local->n_entries_allocated);
+            }
+
+          local->entries[i].name = entry->d_name;
+          local->entries[i].inode = entry->d_ino;
+          local->entries[i].type = file_type_from_dirent (entry->d_type);
+          i++;
+        }
+    }
+
+  if (local->entries == NULL)
+    {
+      local->n_entries_allocated = 1;
+      local->entries = g_new (DirEntry, 1);
+    }
+
+  local->entries[i].name = NULL;
+  local->entries_pos = 0;
+
+  qsort (local->entries, i, sizeof (DirEntry), sort_by_inode);
+}
+#endif
+
 static const char *
 next_file_helper (GLocalFileEnumerator *local, GFileType *file_type)
 {
+#ifndef USE_GETDENTS64
   struct dirent *entry;
-  const char *filename;
   int i;
+#endif
+  const char *filename;
 
   if (local->at_end)
     return NULL;
@@ -314,6 +413,9 @@ next_file_helper (GLocalFileEnumerator *local, GFileType *file_type)
   if (local->entries == NULL ||
       (local->entries[local->entries_pos].name == NULL))
     {
+#ifdef USE_GETDENTS64
+      read_entries_getdents64 (local);
+#else
       if (local->entries == NULL)
 	local->entries = g_new (DirEntry, CHUNK_SIZE + 1);
       else
@@ -348,6 +450,7 @@ next_file_helper (GLocalFileEnumerator *local, GFileType *file_type)
       local->entries_pos = 0;
       
       qsort (local->entries, i, sizeof (DirEntry), sort_by_inode);
+#endif
     }
 
   filename = local->entries[local->entries_pos].name;
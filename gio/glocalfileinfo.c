@@ -98,6 +98,7 @@
 #include "gioerror.h"
 #include "gthemedicon.h"
 #include "gcontenttypeprivate.h"
+#include "gcontenttypecache.h"
 #include "glibintl.h"
 
 
@@ -1391,6 +1392,28 @@ get_content_type (const char          *basename,
 	  int errsv;
 #endif
 	  int fd;
+	  GContentTypeCacheKey cache_key = { 0, };
+
+	  /* Sniffing is expensive, so reuse the result from an earlier query
+	   * of the same, unmodified, file if there was one */
+	  if (statbuf != NULL)
+	    {
+	      const char *cached;
+
+	      cache_key.dev = _g_stat_dev (statbuf);
+	      cache_key.ino = _g_stat_ino (statbuf);
+	      cache_key.mtime = _g_stat_mtime (statbuf);
+	      cache_key.mtime_nsec = _g_stat_mtim_nsec (statbuf);
+	      cache_key.size = _g_stat_size (statbuf);
+	      cache_key.basename = basename;
+
+	      cached = _g_content_type_cache_lookup (&cache_key);
+	      if (cached != NULL)
+		{
+		  g_free (content_type);
+		  return g_strdup (cached);
+		}
+	    }
 
 	  sniff_length = _g_unix_content_type_get_sniff_len ();
 	  if (sniff_length == 0 || sniff_length > 4096)
@@ -1413,6 +1436,9 @@ get_content_type (const char          *basename,
 		{
 		  g_free (content_type);
 		  content_type = g_content_type_guess (basename, sniff_buffer, res, NULL);
+
+		  if (statbuf != NULL)
+		    _g_content_type_cache_insert (&cache_key, content_type);
 		}
 	    }
 	}
@@ -37,9 +37,13 @@
 
 #ifdef G_OS_UNIX
 #include <unistd.h>
+#ifdef HAVE_MADVISE
+#include <sys/mman.h>
+#endif
 #ifndef G_PLATFORM_WASM
 #include "glib-unix.h"
 #include "gfiledescriptorbased.h"
+#include "giouring.h"
 #endif /*!G_PLATFORM_WASM*/
 #endif /*G_OS_UNIX*/
 
@@ -47,9 +51,19 @@
 #include <io.h>
 #endif
 
+/* When g_file_input_stream_set_map_reads() has been called, reads of at
+ * least MAPPED_READ_MIN_COUNT bytes from a regular file of at least
+ * MAPPED_READ_MIN_FILE_SIZE bytes with g_input_stream_read_bytes() return
+ * slices of a mapping of the file, rather than copying the data out of it.
+ * Below that, the page faults cost more than the copy. */
+#define MAPPED_READ_MIN_COUNT (64 * 1024)
+#define MAPPED_READ_MIN_FILE_SIZE (1024 * 1024)
+
 struct _GLocalFileInputStreamPrivate {
   int fd;
   guint do_close : 1;
+  guint mapping_tried : 1;
+  GBytes *mapped;  /* (nullable) (owned) the whole file, once mapped */
 };
 
 #if defined(G_OS_UNIX) && !defined(G_PLATFORM_WASM)
@@ -73,6 +87,10 @@ static gssize     g_local_file_input_stream_read       (GInputStream      *strea
 							gsize              count,
 							GCancellable      *cancellable,
 							GError           **error);
+static GBytes    *g_local_file_input_stream_read_bytes (GInputStream      *stream,
+							gsize              count,
+							GCancellable      *cancellable,
+							GError           **error);
 static gboolean   g_local_file_input_stream_close      (GInputStream      *stream,
 							GCancellable      *cancellable,
 							GError           **error);
@@ -89,6 +107,25 @@ static GFileInfo *g_local_file_input_stream_query_info (GFileInputStream  *strea
 							GError           **error);
 #if defined(G_OS_UNIX) && !defined(G_PLATFORM_WASM)
 static int        g_local_file_input_stream_get_fd     (GFileDescriptorBased *stream);
+static void       g_local_file_input_stream_read_async  (GInputStream        *stream,
+							 void                *buffer,
+							 gsize                count,
+							 int                  io_priority,
+							 GCancellable        *cancellable,
+							 GAsyncReadyCallback  callback,
+							 gpointer             user_data);
+static gssize     g_local_file_input_stream_read_finish (GInputStream        *stream,
+							 GAsyncResult        *result,
+							 GError             **error);
+static void       g_local_file_input_stream_skip_async  (GInputStream        *stream,
+							 gsize                count,
+							 int                  io_priority,
+							 GCancellable        *cancellable,
+							 GAsyncReadyCallback  callback,
+							 gpointer             user_data);
+static gssize     g_local_file_input_stream_skip_finish (GInputStream        *stream,
+							 GAsyncResult        *result,
+							 GError             **error);
 #endif
 
 void
@@ -105,11 +142,23 @@ g_local_file_input_stream_class_init (GLocalFileInputStreamClass *klass)
   GFileInputStreamClass *file_stream_class = G_FILE_INPUT_STREAM_CLASS (klass);
 
   stream_class->read_fn = g_local_file_input_stream_read;
+  stream_class->read_bytes = g_local_file_input_stream_read_bytes;
   stream_class->close_fn = g_local_file_input_stream_close;
   file_stream_class->tell = g_local_file_input_stream_tell;
   file_stream_class->can_seek = g_local_file_input_stream_can_seek;
   file_stream_class->seek = g_local_file_input_stream_seek;
   file_stream_class->query_info = g_local_file_input_stream_query_info;
+
+#if defined(G_OS_UNIX) && !defined(G_PLATFORM_WASM)
+  /* Submit asynchronous reads to io_uring where it is available, and do
+   * them in a thread otherwise. Skipping is done in a thread explicitly,
+   * as the default implementation would otherwise read and discard the
+   * data instead of seeking. */
+  stream_class->read_async = g_local_file_input_stream_read_async;
+  stream_class->read_finish = g_local_file_input_stream_read_finish;
+  stream_class->skip_async = g_local_file_input_stream_skip_async;
+  stream_class->skip_finish = g_local_file_input_stream_skip_finish;
+#endif
 }
 
 #if defined(G_OS_UNIX) && !defined(G_PLATFORM_WASM)
@@ -139,6 +188,86 @@ _g_local_file_input_stream_new (int fd)
   return G_FILE_INPUT_STREAM (stream);
 }
 
+/*
+ * read_mapped:
+ * @in: a #GLocalFileInputStream
+ * @count: maximum number of bytes to read
+ * @bytes: (out) (transfer full): return location for the data read
+ *
+ * If g_file_input_stream_set_map_reads() has been called on @in, reads
+ * up to @count bytes from its current position without copying them, by
+ * returning a slice of a read-only mapping of the whole file. The file is
+ * mapped on the first such read, with a hint to the kernel that it will
+ * be read sequentially, and the position of @in is moved forward as if
+ * the data had been read.
+ *
+ * This only works for large regular files and large reads; in all other
+ * cases, and past the end of the mapping if the file has grown since, it
+ * returns %FALSE and the caller should read the data normally. As with
+ * any #GMappedFile, the data must not be accessed after the file has been
+ * truncated by someone else. The stream drops its reference to the
+ * mapping when it is closed; slices already returned keep it alive.
+ *
+ * Returns: %TRUE if @bytes was set
+ */
+static gboolean
+read_mapped (GLocalFileInputStream  *in,
+             gsize                   count,
+             GBytes                **bytes)
+{
+#if defined(G_OS_UNIX) && !defined(G_PLATFORM_WASM)
+  GLocalFileInputStreamPrivate *priv = in->priv;
+  goffset position;
+  gsize size, n;
+
+  if (!g_file_input_stream_get_map_reads (G_FILE_INPUT_STREAM (in)) ||
+      count < MAPPED_READ_MIN_COUNT)
+    return FALSE;
+
+  if (priv->mapped == NULL)
+    {
+      GMappedFile *mapped_file;
+      GStatBuf buf;
+
+      if (priv->mapping_tried)
+        return FALSE;
+      priv->mapping_tried = TRUE;
+
+      if (fstat (priv->fd, &buf) != 0 ||
+          !S_ISREG (buf.st_mode) ||
+          buf.st_size < MAPPED_READ_MIN_FILE_SIZE)
+        return FALSE;
+
+      mapped_file = g_mapped_file_new_from_fd (priv->fd, FALSE, NULL);
+      if (mapped_file == NULL)
+        return FALSE;
+
+#ifdef HAVE_MADVISE
+      (void) madvise (g_mapped_file_get_contents (mapped_file),
+                      g_mapped_file_get_length (mapped_file),
+                      MADV_SEQUENTIAL);
+#endif
+
+      priv->mapped = g_mapped_file_get_bytes (mapped_file);
+      g_mapped_file_unref (mapped_file);
+    }
+
+  position = lseek (priv->fd, 0, SEEK_CUR);
+  size = g_bytes_get_size (priv->mapped);
+  if (position < 0 || (guint64) position >= size)
+    return FALSE;
+
+  n = MIN (count, size - position);
+  if (lseek (priv->fd, position + n, SEEK_SET) < 0)
+    return FALSE;
+
+  *bytes = g_bytes_new_from_bytes (priv->mapped, position, n);
+  return TRUE;
+#else
+  return FALSE;
+#endif
+}
+
 static gssize
 g_local_file_input_stream_read (GInputStream  *stream,
 				void          *buffer,
@@ -176,6 +305,138 @@ g_local_file_input_stream_read (GInputStream  *stream,
   return res;
 }
 
+static GBytes *
+g_local_file_input_stream_read_bytes (GInputStream  *stream,
+				      gsize          count,
+				      GCancellable  *cancellable,
+				      GError       **error)
+{
+  GBytes *bytes;
+
+  if (g_cancellable_set_error_if_cancelled (cancellable, error))
+    return NULL;
+
+  if (read_mapped (G_LOCAL_FILE_INPUT_STREAM (stream), count, &bytes))
+    return bytes;
+
+  return G_INPUT_STREAM_CLASS (g_local_file_input_stream_parent_class)->read_bytes (stream, count,
+                                                                                    cancellable, error);
+}
+
+#if defined(G_OS_UNIX) && !defined(G_PLATFORM_WASM)
+typedef struct {
+  void *buffer;
+  gsize count;
+} ReadData;
+
+static void
+read_async_thread (GTask        *task,
+                   gpointer      source_object,
+                   gpointer      task_data,
+                   GCancellable *cancellable)
+{
+  ReadData *data = task_data;
+  GError *error = NULL;
+  gssize nread;
+
+  nread = g_local_file_input_stream_read (source_object, data->buffer, data->count,
+                                          cancellable, &error);
+  if (nread == -1)
+    g_task_return_error (task, error);
+  else
+    g_task_return_int (task, nread);
+}
+
+static void
+g_local_file_input_stream_read_async (GInputStream        *stream,
+                                      void                *buffer,
+                                      gsize                count,
+                                      int                  io_priority,
+                                      GCancellable        *cancellable,
+                                      GAsyncReadyCallback  callback,
+                                      gpointer             user_data)
+{
+  GLocalFileInputStream *file;
+  GTask *task;
+
+  file = G_LOCAL_FILE_INPUT_STREAM (stream);
+
+  task = g_task_new (stream, cancellable, callback, user_data);
+  g_task_set_source_tag (task, g_local_file_input_stream_read_async);
+  g_task_set_priority (task, io_priority);
+
+  if (g_task_return_error_if_cancelled (task))
+    ;
+  else if (!_g_io_uring_read (file->priv->fd, buffer, count, task))
+    {
+      ReadData *data = g_new (ReadData, 1);
+
+      data->buffer = buffer;
+      data->count = count;
+      g_task_set_task_data (task, data, g_free);
+      g_task_run_in_thread (task, read_async_thread);
+    }
+
+  g_object_unref (task);
+}
+
+static gssize
+g_local_file_input_stream_read_finish (GInputStream  *stream,
+                                       GAsyncResult  *result,
+                                       GError       **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, stream), -1);
+
+  return g_task_propagate_int (G_TASK (result), error);
+}
+
+static void
+skip_async_thread (GTask        *task,
+                   gpointer      source_object,
+                   gpointer      task_data,
+                   GCancellable *cancellable)
+{
+  GError *error = NULL;
+  gssize nskipped;
+
+  nskipped = G_INPUT_STREAM_GET_CLASS (source_object)->skip (source_object,
+                                                             GPOINTER_TO_SIZE (task_data),
+                                                             cancellable, &error);
+  if (nskipped == -1)
+    g_task_return_error (task, error);
+  else
+    g_task_return_int (task, nskipped);
+}
+
+static void
+g_local_file_input_stream_skip_async (GInputStream        *stream,
+                                      gsize                count,
+                                      int                  io_priority,
+                                      GCancellable        *cancellable,
+                                      GAsyncReadyCallback  callback,
+                                      gpointer             user_data)
+{
+  GTask *task;
+
+  task = g_task_new (stream, cancellable, callback, user_data);
+  g_task_set_source_tag (task, g_local_file_input_stream_skip_async);
+  g_task_set_priority (task, io_priority);
+  g_task_set_task_data (task, GSIZE_TO_POINTER (count), NULL);
+  g_task_run_in_thread (task, skip_async_thread);
+  g_object_unref (task);
+}
+
+static gssize
+g_local_file_input_stream_skip_finish (GInputStream  *stream,
+                                       GAsyncResult  *result,
+                                       GError       **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, stream), -1);
+
+  return g_task_propagate_int (G_TASK (result), error);
+}
+#endif
+
 static gboolean
 g_local_file_input_stream_close (GInputStream  *stream,
 				 GCancellable  *cancellable,
@@ -185,6 +446,9 @@ g_local_file_input_stream_close (GInputStream  *stream,
 
   file = G_LOCAL_FILE_INPUT_STREAM (stream);
 
+  /* Slices handed out by read_bytes() hold their own reference */
+  g_clear_pointer (&file->priv->mapped, g_bytes_unref);
+
   if (!file->priv->do_close)
     return TRUE;
 
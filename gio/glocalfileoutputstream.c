@@ -46,6 +46,7 @@
 #include <unistd.h>
 #ifndef G_PLATFORM_WASM
 #include "gfiledescriptorbased.h"
+#include "giouring.h"
 #include <sys/uio.h>
 #endif /*!G_PLATFORM_WASM*/
 #endif /*G_OS_UNIX*/
@@ -141,6 +142,16 @@ static gboolean   g_local_file_output_stream_truncate     (GFileOutputStream  *s
 							   GError            **error);
 #if defined(G_OS_UNIX) && !defined(G_PLATFORM_WASM)
 static int        g_local_file_output_stream_get_fd       (GFileDescriptorBased *stream);
+static void       g_local_file_output_stream_write_async  (GOutputStream       *stream,
+							   const void          *buffer,
+							   gsize                count,
+							   int                  io_priority,
+							   GCancellable        *cancellable,
+							   GAsyncReadyCallback  callback,
+							   gpointer             user_data);
+static gssize     g_local_file_output_stream_write_finish (GOutputStream       *stream,
+							   GAsyncResult        *result,
+							   GError             **error);
 #endif
 
 static void
@@ -179,6 +190,13 @@ g_local_file_output_stream_class_init (GLocalFileOutputStreamClass *klass)
   file_stream_class->seek = g_local_file_output_stream_seek;
   file_stream_class->can_truncate = g_local_file_output_stream_can_truncate;
   file_stream_class->truncate_fn = g_local_file_output_stream_truncate;
+
+#if defined(G_OS_UNIX) && !defined(G_PLATFORM_WASM)
+  /* Submit asynchronous writes to io_uring where it is available, and do
+   * them in a thread otherwise */
+  stream_class->write_async = g_local_file_output_stream_write_async;
+  stream_class->write_finish = g_local_file_output_stream_write_finish;
+#endif
 }
 
 #if defined(G_OS_UNIX) && !defined(G_PLATFORM_WASM)
@@ -233,6 +251,77 @@ g_local_file_output_stream_write (GOutputStream  *stream,
   return res;
 }
 
+#if defined(G_OS_UNIX) && !defined(G_PLATFORM_WASM)
+typedef struct {
+  const void *buffer;
+  gsize count;
+} WriteData;
+
+static void
+write_async_thread (GTask        *task,
+                    gpointer      source_object,
+                    gpointer      task_data,
+                    GCancellable *cancellable)
+{
+  WriteData *data = task_data;
+  GError *error = NULL;
+  gssize nwritten;
+
+  nwritten = g_local_file_output_stream_write (source_object, data->buffer, data->count,
+                                               cancellable, &error);
+  if (nwritten == -1)
+    g_task_return_error (task, error);
+  else
+    g_task_return_int (task, nwritten);
+}
+
+static void
+g_local_file_output_stream_write_async (GOutputStream       *stream,
+                                        const void          *buffer,
+                                        gsize                count,
+                                        int                  io_priority,
+                                        GCancellable        *cancellable,
+                                        GAsyncReadyCallback  callback,
+                                        gpointer             user_data)
+{
+  GLocalFileOutputStream *file;
+  GTask *task;
+
+  file = G_LOCAL_FILE_OUTPUT_STREAM (stream);
+
+  task = g_task_new (stream, cancellable, callback, user_data);
+  g_task_set_source_tag (task, g_local_file_output_stream_write_async);
+  g_task_set_priority (task, io_priority);
+  /* Like the default implementation, report what was written even if
+   * the operation was cancelled in the meantime */
+  g_task_set_check_cancellable (task, FALSE);
+
+  if (g_task_return_error_if_cancelled (task))
+    ;
+  else if (!_g_io_uring_write (file->priv->fd, buffer, count, task))
+    {
+      WriteData *data = g_new (WriteData, 1);
+
+      data->buffer = buffer;
+      data->count = count;
+      g_task_set_task_data (task, data, g_free);
+      g_task_run_in_thread (task, write_async_thread);
+    }
+
+  g_object_unref (task);
+}
+
+static gssize
+g_local_file_output_stream_write_finish (GOutputStream  *stream,
+                                         GAsyncResult   *result,
+                                         GError        **error)
+{
+  g_return_val_if_fail (g_task_is_valid (result, stream), -1);
+
+  return g_task_propagate_int (G_TASK (result), error);
+}
+#endif
+
 /* On Windows there is no equivalent API for files. The closest API to that is
  * WriteFileGather() but it is useless in general: it requires, among other
  * things, that each chunk is the size of a whole page and in memory aligned
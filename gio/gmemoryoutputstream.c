@@ -45,6 +45,16 @@
  *
  * As of GLib 2.34, #GMemoryOutputStream trivially implements
  * #GPollableOutputStream: it always polls as ready.
+ *
+ * As of GLib 2.76, a #GMemoryOutputStream created with
+ * g_memory_output_stream_new_chunked() keeps its data in a list of
+ * fixed-size chunks rather than in one buffer. Growing it never copies
+ * what was already written, which makes a difference for large outputs.
+ * The data can be taken as one #GBytes per chunk with
+ * g_memory_output_stream_steal_chunks(), or is copied to a single buffer
+ * once by the functions that return the whole data, such as
+ * g_memory_output_stream_get_data() or
+ * g_memory_output_stream_steal_as_bytes().
  */
 
 #define MIN_ARRAY_SIZE  16
@@ -55,7 +65,8 @@ enum {
   PROP_SIZE,
   PROP_DATA_SIZE,
   PROP_REALLOC_FUNCTION,
-  PROP_DESTROY_FUNCTION
+  PROP_DESTROY_FUNCTION,
+  PROP_CHUNK_SIZE
 };
 
 struct _GMemoryOutputStreamPrivate
@@ -68,6 +79,11 @@ struct _GMemoryOutputStreamPrivate
 
   GReallocFunc   realloc_fn;
   GDestroyNotify destroy;
+
+  gsize          chunk_size; /* Size of each chunk in chunked mode, 0 otherwise */
+  GPtrArray     *chunks; /* Chunks of chunk_size bytes making up the data, in chunked
+                            mode and until the data is flattened. len is then the
+                            total size of the chunks. */
 };
 
 static void     g_memory_output_stream_set_property (GObject      *object,
@@ -78,6 +94,7 @@ static void     g_memory_output_stream_get_property (GObject      *object,
                                                      guint         prop_id,
                                                      GValue       *value,
                                                      GParamSpec   *pspec);
+static void     g_memory_output_stream_constructed  (GObject      *object);
 static void     g_memory_output_stream_finalize     (GObject      *object);
 
 static gssize   g_memory_output_stream_write       (GOutputStream *stream,
@@ -85,6 +102,12 @@ static gssize   g_memory_output_stream_write       (GOutputStream *stream,
                                                     gsize          count,
                                                     GCancellable  *cancellable,
                                                     GError       **error);
+static gboolean g_memory_output_stream_writev      (GOutputStream        *stream,
+                                                    const GOutputVector  *vectors,
+                                                    gsize                 n_vectors,
+                                                    gsize                *bytes_written,
+                                                    GCancellable         *cancellable,
+                                                    GError              **error);
 
 static gboolean g_memory_output_stream_close       (GOutputStream  *stream,
                                                     GCancellable   *cancellable,
@@ -138,11 +161,13 @@ g_memory_output_stream_class_init (GMemoryOutputStreamClass *klass)
   gobject_class = G_OBJECT_CLASS (klass);
   gobject_class->set_property = g_memory_output_stream_set_property;
   gobject_class->get_property = g_memory_output_stream_get_property;
+  gobject_class->constructed  = g_memory_output_stream_constructed;
   gobject_class->finalize     = g_memory_output_stream_finalize;
 
   ostream_class = G_OUTPUT_STREAM_CLASS (klass);
 
   ostream_class->write_fn = g_memory_output_stream_write;
+  ostream_class->writev_fn = g_memory_output_stream_writev;
   ostream_class->close_fn = g_memory_output_stream_close;
   ostream_class->close_async  = g_memory_output_stream_close_async;
   ostream_class->close_finish = g_memory_output_stream_close_finish;
@@ -223,6 +248,24 @@ g_memory_output_stream_class_init (GMemoryOutputStreamClass *klass)
                                                          P_("Function called with the buffer as argument when the stream is destroyed."),
                                                          G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY |
                                                          G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GMemoryOutputStream:chunk-size:
+   *
+   * If non-zero, the size of the chunks the stream keeps its data in.
+   * It can not be combined with #GMemoryOutputStream:data.
+   * See g_memory_output_stream_new_chunked().
+   *
+   * Since: 2.76
+   **/
+  g_object_class_install_property (gobject_class,
+                                   PROP_CHUNK_SIZE,
+                                   g_param_spec_ulong ("chunk-size",
+                                                       P_("Chunk Size"),
+                                                       P_("Size of the chunks the data is kept in, or 0."),
+                                                       0, G_MAXULONG, 0,
+                                                       G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY |
+                                                       G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -259,6 +302,9 @@ g_memory_output_stream_set_property (GObject      *object,
     case PROP_DESTROY_FUNCTION:
       priv->destroy = g_value_get_pointer (value);
       break;
+    case PROP_CHUNK_SIZE:
+      priv->chunk_size = g_value_get_ulong (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -280,7 +326,7 @@ g_memory_output_stream_get_property (GObject      *object,
   switch (prop_id)
     {
     case PROP_DATA:
-      g_value_set_pointer (value, priv->data);
+      g_value_set_pointer (value, g_memory_output_stream_get_data (stream));
       break;
     case PROP_SIZE:
       g_value_set_ulong (value, priv->len);
@@ -294,12 +340,45 @@ g_memory_output_stream_get_property (GObject      *object,
     case PROP_DESTROY_FUNCTION:
       g_value_set_pointer (value, priv->destroy);
       break;
+    case PROP_CHUNK_SIZE:
+      g_value_set_ulong (value, priv->chunk_size);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
     }
 }
 
+static void
+g_memory_output_stream_constructed (GObject *object)
+{
+  GMemoryOutputStream        *stream;
+  GMemoryOutputStreamPrivate *priv;
+
+  stream = G_MEMORY_OUTPUT_STREAM (object);
+  priv = stream->priv;
+
+  /* The chunks, and the buffer they are flattened to, always come from
+   * g_malloc(), so a caller-supplied buffer can not be used with them.
+   * Keep the buffer, which the stream owns now, and ignore the chunk size
+   * rather than leak it. */
+  if (priv->chunk_size > 0 && priv->data != NULL)
+    {
+      g_critical ("%s: 'chunk-size' can not be combined with 'data'", G_STRFUNC);
+      priv->chunk_size = 0;
+    }
+
+  if (priv->chunk_size > 0)
+    {
+      priv->len = 0;
+      priv->realloc_fn = g_realloc;
+      priv->destroy = g_free;
+      priv->chunks = g_ptr_array_new_with_free_func (g_free);
+    }
+
+  G_OBJECT_CLASS (g_memory_output_stream_parent_class)->constructed (object);
+}
+
 static void
 g_memory_output_stream_finalize (GObject *object)
 {
@@ -311,6 +390,7 @@ g_memory_output_stream_finalize (GObject *object)
   
   if (priv->destroy)
     priv->destroy (priv->data);
+  g_clear_pointer (&priv->chunks, g_ptr_array_unref);
 
   G_OBJECT_CLASS (g_memory_output_stream_parent_class)->finalize (object);
 }
@@ -420,6 +500,106 @@ g_memory_output_stream_new_resizable (void)
   return g_memory_output_stream_new (NULL, 0, g_realloc, g_free);
 }
 
+/**
+ * g_memory_output_stream_new_chunked:
+ * @chunk_size: the size of each chunk, in bytes
+ *
+ * Creates a new resizable #GMemoryOutputStream that keeps its data in
+ * chunks of @chunk_size bytes, allocated with g_malloc() as the stream
+ * grows. Unlike with g_memory_output_stream_new_resizable(), the data
+ * already written is never copied to a bigger buffer, and the memory in
+ * use is never more than one chunk above the size of the data.
+ *
+ * The chunks can be taken from the stream without copying them with
+ * g_memory_output_stream_steal_chunks(). The first call to
+ * g_memory_output_stream_get_data(), g_memory_output_stream_steal_data()
+ * or g_memory_output_stream_steal_as_bytes() instead copies the data to a
+ * single buffer, after which the stream behaves like one created with
+ * g_memory_output_stream_new_resizable().
+ *
+ * Returns: a new #GMemoryOutputStream
+ *
+ * Since: 2.76
+ */
+GOutputStream *
+g_memory_output_stream_new_chunked (gsize chunk_size)
+{
+  g_return_val_if_fail (chunk_size > 0, NULL);
+
+  return g_object_new (G_TYPE_MEMORY_OUTPUT_STREAM,
+                       "chunk-size", (gulong) chunk_size,
+                       NULL);
+}
+
+/* Copies @count bytes of @buffer to the chunks at @offset, or zeroes them
+ * if @buffer is %NULL, adding chunks as needed */
+static void
+chunks_fill (GMemoryOutputStreamPrivate *priv,
+             gsize                       offset,
+             const guint8               *buffer,
+             gsize                       count)
+{
+  while (count > 0)
+    {
+      gsize index = offset / priv->chunk_size;
+      gsize chunk_offset = offset % priv->chunk_size;
+      gsize n = MIN (count, priv->chunk_size - chunk_offset);
+      guint8 *chunk;
+
+      while (priv->chunks->len <= index)
+        {
+          g_ptr_array_add (priv->chunks, g_malloc (priv->chunk_size));
+          priv->len += priv->chunk_size;
+        }
+
+      chunk = g_ptr_array_index (priv->chunks, index);
+      if (buffer != NULL)
+        {
+          memcpy (chunk + chunk_offset, buffer, n);
+          buffer += n;
+        }
+      else
+        memset (chunk + chunk_offset, 0, n);
+
+      offset += n;
+      count -= n;
+    }
+}
+
+/* Copies the chunks to a single buffer, after which the stream is an
+ * ordinary resizable one */
+static void
+chunks_flatten (GMemoryOutputStreamPrivate *priv)
+{
+  gsize offset, i;
+
+  if (priv->chunks == NULL)
+    return;
+
+  if (priv->valid_len > priv->chunk_size)
+    {
+      priv->data = g_malloc (priv->valid_len);
+      priv->len = priv->valid_len;
+
+      for (offset = 0, i = 0; offset < priv->valid_len; offset += priv->chunk_size, i++)
+        memcpy ((guint8 *) priv->data + offset,
+                g_ptr_array_index (priv->chunks, i),
+                MIN (priv->chunk_size, priv->valid_len - offset));
+    }
+  else if (priv->valid_len > 0)
+    {
+      /* A single chunk is used as it is; whatever follows the data in it
+       * must be zeroed, as it is in a resizable stream */
+      priv->data = g_ptr_array_steal_index (priv->chunks, 0);
+      priv->len = priv->chunk_size;
+      memset ((guint8 *) priv->data + priv->valid_len, 0, priv->len - priv->valid_len);
+    }
+  else
+    priv->len = 0;
+
+  g_clear_pointer (&priv->chunks, g_ptr_array_unref);
+}
+
 /**
  * g_memory_output_stream_get_data:
  * @ostream: a #GMemoryOutputStream
@@ -437,6 +617,8 @@ g_memory_output_stream_get_data (GMemoryOutputStream *ostream)
 {
   g_return_val_if_fail (G_IS_MEMORY_OUTPUT_STREAM (ostream), NULL);
 
+  chunks_flatten (ostream->priv);
+
   return ostream->priv->data;
 }
 
@@ -513,6 +695,8 @@ g_memory_output_stream_steal_data (GMemoryOutputStream *ostream)
   g_return_val_if_fail (G_IS_MEMORY_OUTPUT_STREAM (ostream), NULL);
   g_return_val_if_fail (g_output_stream_is_closed (G_OUTPUT_STREAM (ostream)), NULL);
 
+  chunks_flatten (ostream->priv);
+
   data = ostream->priv->data;
   ostream->priv->data = NULL;
 
@@ -538,6 +722,8 @@ g_memory_output_stream_steal_as_bytes (GMemoryOutputStream *ostream)
   g_return_val_if_fail (G_IS_MEMORY_OUTPUT_STREAM (ostream), NULL);
   g_return_val_if_fail (g_output_stream_is_closed (G_OUTPUT_STREAM (ostream)), NULL);
 
+  chunks_flatten (ostream->priv);
+
   result = g_bytes_new_with_free_func (ostream->priv->data,
                                        ostream->priv->valid_len,
                                        ostream->priv->destroy,
@@ -547,6 +733,56 @@ g_memory_output_stream_steal_as_bytes (GMemoryOutputStream *ostream)
   return result;
 }
 
+/**
+ * g_memory_output_stream_steal_chunks:
+ * @ostream: a #GMemoryOutputStream
+ *
+ * Returns data from the @ostream as an array of #GBytes which, put end
+ * to end, make up the data. For a stream created with
+ * g_memory_output_stream_new_chunked(), there is one #GBytes per chunk
+ * and none of the data is copied. For other streams, the array holds the
+ * same single #GBytes that g_memory_output_stream_steal_as_bytes()
+ * returns.
+ *
+ * The array is empty if no data was written. @ostream must be closed
+ * before calling this function.
+ *
+ * Returns: (transfer full) (element-type GBytes): the stream's data
+ *
+ * Since: 2.76
+ **/
+GPtrArray *
+g_memory_output_stream_steal_chunks (GMemoryOutputStream *ostream)
+{
+  GMemoryOutputStreamPrivate *priv;
+  GPtrArray *result;
+  gsize offset, i;
+
+  g_return_val_if_fail (G_IS_MEMORY_OUTPUT_STREAM (ostream), NULL);
+  g_return_val_if_fail (g_output_stream_is_closed (G_OUTPUT_STREAM (ostream)), NULL);
+
+  priv = ostream->priv;
+  result = g_ptr_array_new_with_free_func ((GDestroyNotify) g_bytes_unref);
+
+  if (priv->chunks == NULL)
+    {
+      if (priv->valid_len > 0)
+        g_ptr_array_add (result, g_memory_output_stream_steal_as_bytes (ostream));
+      return result;
+    }
+
+  for (offset = 0, i = 0; offset < priv->valid_len; offset += priv->chunk_size, i++)
+    g_ptr_array_add (result,
+                     g_bytes_new_take (g_steal_pointer (&priv->chunks->pdata[i]),
+                                       MIN (priv->chunk_size, priv->valid_len - offset)));
+
+  /* The stream now looks like any other whose data was stolen */
+  g_clear_pointer (&priv->chunks, g_ptr_array_unref);
+  priv->len = 0;
+
+  return result;
+}
+
 static gboolean
 array_resize (GMemoryOutputStream  *ostream,
               gsize                 size,
@@ -626,6 +862,21 @@ g_memory_output_stream_write (GOutputStream  *stream,
   if (priv->realloc_fn && priv->pos + count < priv->pos)
     goto overflow;
 
+  if (priv->chunks != NULL)
+    {
+      /* Fill any gap left by seeking past the end with zeroes */
+      if (priv->pos > priv->valid_len)
+        chunks_fill (priv, priv->valid_len, NULL, priv->pos - priv->valid_len);
+
+      chunks_fill (priv, priv->pos, buffer, count);
+      priv->pos += count;
+
+      if (priv->pos > priv->valid_len)
+        priv->valid_len = priv->pos;
+
+      return count;
+    }
+
   if (priv->pos + count > priv->len)
     {
       /* At least enough to fit the write, rounded up for greater than
@@ -671,6 +922,63 @@ g_memory_output_stream_write (GOutputStream  *stream,
   return -1;
 }
 
+static gboolean
+g_memory_output_stream_writev (GOutputStream        *stream,
+                               const GOutputVector  *vectors,
+                               gsize                 n_vectors,
+                               gsize                *bytes_written,
+                               GCancellable         *cancellable,
+                               GError              **error)
+{
+  GMemoryOutputStream        *ostream;
+  GMemoryOutputStreamPrivate *priv;
+  gsize total, i;
+  gssize res;
+
+  ostream = G_MEMORY_OUTPUT_STREAM (stream);
+  priv = ostream->priv;
+
+  *bytes_written = 0;
+
+  for (total = 0, i = 0; i < n_vectors; i++)
+    {
+      if (total + vectors[i].size < total)
+        break;
+      total += vectors[i].size;
+    }
+
+  /* Grow a resizable buffer once for all the vectors, rather than for
+   * each of them; the chunks of a chunked stream are just filled in turn */
+  if (priv->chunks == NULL && priv->realloc_fn &&
+      i == n_vectors && priv->pos + total > priv->len && priv->pos + total > priv->pos)
+    {
+      gsize new_size = g_nearest_pow (priv->pos + total);
+
+      if (new_size != 0 &&
+          !array_resize (ostream, MAX (new_size, MIN_ARRAY_SIZE), TRUE, error))
+        return FALSE;
+    }
+
+  /* Go through the class so that a subclass overriding write_fn sees
+   * every write */
+  for (i = 0; i < n_vectors; i++)
+    {
+      res = G_OUTPUT_STREAM_GET_CLASS (stream)->write_fn (stream,
+                                                          vectors[i].buffer,
+                                                          vectors[i].size,
+                                                          cancellable,
+                                                          *bytes_written > 0 ? NULL : error);
+      if (res < 0)
+        return *bytes_written > 0;
+
+      *bytes_written += res;
+      if ((gsize) res < vectors[i].size)
+        break;
+    }
+
+  return TRUE;
+}
+
 static gboolean
 g_memory_output_stream_close (GOutputStream  *stream,
                               GCancellable   *cancellable,
@@ -819,6 +1127,24 @@ g_memory_output_stream_truncate (GSeekable     *seekable,
                                  GError       **error)
 {
   GMemoryOutputStream *ostream = G_MEMORY_OUTPUT_STREAM (seekable);
+  GMemoryOutputStreamPrivate *priv = ostream->priv;
+
+  if (priv->chunks != NULL)
+    {
+      gsize n_chunks = (offset + priv->chunk_size - 1) / priv->chunk_size;
+
+      if ((gsize) offset > priv->valid_len)
+        chunks_fill (priv, priv->valid_len, NULL, offset - priv->valid_len);
+      else if (n_chunks < priv->chunks->len)
+        {
+          g_ptr_array_set_size (priv->chunks, n_chunks);
+          priv->len = n_chunks * priv->chunk_size;
+        }
+
+      priv->valid_len = offset;
+
+      return TRUE;
+    }
 
   if (!array_resize (ostream, offset, FALSE, error))
     return FALSE;
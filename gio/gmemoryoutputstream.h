@@ -92,6 +92,8 @@ GOutputStream *g_memory_output_stream_new           (gpointer             data,
                                                      GDestroyNotify       destroy_function);
 GIO_AVAILABLE_IN_2_36
 GOutputStream *g_memory_output_stream_new_resizable (void);
+GIO_AVAILABLE_IN_2_76
+GOutputStream *g_memory_output_stream_new_chunked   (gsize                chunk_size);
 GIO_AVAILABLE_IN_ALL
 gpointer       g_memory_output_stream_get_data      (GMemoryOutputStream *ostream);
 GIO_AVAILABLE_IN_ALL
@@ -104,6 +106,9 @@ gpointer       g_memory_output_stream_steal_data    (GMemoryOutputStream *ostrea
 GIO_AVAILABLE_IN_2_34
 GBytes *       g_memory_output_stream_steal_as_bytes (GMemoryOutputStream *ostream);
 
+GIO_AVAILABLE_IN_2_76
+GPtrArray *    g_memory_output_stream_steal_chunks   (GMemoryOutputStream *ostream);
+
 G_END_DECLS
 
 #endif /* __G_MEMORY_OUTPUT_STREAM_H__ */
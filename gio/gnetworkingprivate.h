@@ -23,6 +23,31 @@
 
 #include "gnetworking.h"
 
+#ifdef __linux__
+#include <netinet/udp.h>
+
+/* UDP segmentation offload, which older C libraries do not define */
+#ifndef UDP_SEGMENT
+#define UDP_SEGMENT 103
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
+
+#include <linux/errqueue.h>
+
+/* Zero-copy sending, likewise */
+#ifndef SO_ZEROCOPY
+#define SO_ZEROCOPY 60
+#endif
+#ifndef MSG_ZEROCOPY
+#define MSG_ZEROCOPY 0x4000000
+#endif
+#ifndef SO_EE_ORIGIN_ZEROCOPY
+#define SO_EE_ORIGIN_ZEROCOPY 5
+#endif
+#endif
+
 G_BEGIN_DECLS
 
 guint64  g_resolver_get_serial             (GResolver        *resolver);
@@ -74,6 +74,10 @@ static void     g_output_stream_real_write_async   (GOutputStream             *s
 static gssize   g_output_stream_real_write_finish  (GOutputStream             *stream,
 						    GAsyncResult              *result,
 						    GError                   **error);
+static gssize   g_output_stream_real_write_bytes   (GOutputStream             *stream,
+						    GBytes                    *bytes,
+						    GCancellable              *cancellable,
+						    GError                   **error);
 static gboolean g_output_stream_real_writev        (GOutputStream             *stream,
 						    const GOutputVector       *vectors,
 						    gsize                      n_vectors,
@@ -156,6 +160,7 @@ g_output_stream_class_init (GOutputStreamClass *klass)
   klass->writev_fn = g_output_stream_real_writev;
   klass->writev_async = g_output_stream_real_writev_async;
   klass->writev_finish = g_output_stream_real_writev_finish;
+  klass->write_bytes = g_output_stream_real_write_bytes;
   klass->splice_async = g_output_stream_real_splice_async;
   klass->splice_finish = g_output_stream_real_splice_finish;
   klass->flush_async = g_output_stream_real_flush_async;
@@ -633,6 +638,13 @@ g_output_stream_vprintf (GOutputStream  *stream,
  * #GBytes instance multiple times potentially can result in duplicated
  * data in the output stream.
  *
+ * Since 2.76, streams can implement #GOutputStreamClass.write_bytes to
+ * keep a reference on @bytes instead of copying them. For example, on
+ * the output stream of a #GSocketConnection whose socket has zero-copy
+ * sending enabled with g_socket_set_zerocopy(), @bytes may be sent
+ * without being copied, in which case a reference is kept on it until
+ * the kernel is done with it.
+ *
  * Returns: Number of bytes written, or -1 on error
  **/
 gssize
@@ -641,15 +653,62 @@ g_output_stream_write_bytes (GOutputStream  *stream,
 			     GCancellable   *cancellable,
 			     GError        **error)
 {
+  GOutputStreamClass *class;
+  gssize res;
+
+  g_return_val_if_fail (G_IS_OUTPUT_STREAM (stream), -1);
+  g_return_val_if_fail (bytes != NULL, -1);
+
+  if (g_bytes_get_size (bytes) == 0)
+    return 0;
+
+  if (((gssize) g_bytes_get_size (bytes)) < 0)
+    {
+      g_set_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT,
+		   _("Too large count value passed to %s"), G_STRFUNC);
+      return -1;
+    }
+
+  class = G_OUTPUT_STREAM_GET_CLASS (stream);
+
+  if (!g_output_stream_set_pending (stream, error))
+    return -1;
+
+  if (cancellable)
+    g_cancellable_push_current (cancellable);
+
+  res = class->write_bytes (stream, bytes, cancellable, error);
+
+  if (cancellable)
+    g_cancellable_pop_current (cancellable);
+
+  g_output_stream_clear_pending (stream);
+
+  return res;
+}
+
+static gssize
+g_output_stream_real_write_bytes (GOutputStream  *stream,
+				  GBytes         *bytes,
+				  GCancellable   *cancellable,
+				  GError        **error)
+{
+  GOutputStreamClass *class;
   gsize size;
   gconstpointer data;
 
+  class = G_OUTPUT_STREAM_GET_CLASS (stream);
+
+  if (class->write_fn == NULL)
+    {
+      g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                           _("Output stream doesn’t implement write"));
+      return -1;
+    }
+
   data = g_bytes_get_data (bytes, &size);
 
-  return g_output_stream_write (stream,
-                                data, size,
-				cancellable,
-				error);
+  return class->write_fn (stream, data, size, cancellable, error);
 }
 
 /**
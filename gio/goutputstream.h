@@ -141,9 +141,13 @@ struct _GOutputStreamClass
                                  gsize                    *bytes_written,
                                  GError                  **error);
 
+  gssize      (* write_bytes)   (GOutputStream            *stream,
+                                 GBytes                   *bytes,
+                                 GCancellable             *cancellable,
+                                 GError                  **error);
+
   /*< private >*/
   /* Padding for future expansion */
-  void (*_g_reserved4) (void);
   void (*_g_reserved5) (void);
   void (*_g_reserved6) (void);
   void (*_g_reserved7) (void);
@@ -36,11 +36,35 @@
 
 #include "glib-private.h"
 
+#ifdef HAVE_LZ4
+#include <lz4.h>
+#endif
+
+/* Decompressed data of compressed entries is kept in a small per-resource
+ * LRU cache, so that repeated lookups of the same CSS, UI or icon files
+ * don't inflate them again. Entries bigger than a quarter of the cache are
+ * never cached.
+ */
+#define RESOURCE_CACHE_MAX_SIZE (1024 * 1024)
+
+typedef struct
+{
+  const void *compressed_data;  /* key: the entry's data inside the table */
+  GBytes *bytes;  /* (owned) */
+} ResourceCacheEntry;
+
 struct _GResource
 {
   int ref_count;
 
   GvdbTable *table;
+
+  GMutex cache_lock;
+  GHashTable *cache;  /* (owned) compressed data -> GList link in @cache_lru */
+  GQueue cache_lru;  /* (element-type ResourceCacheEntry), most recently used first */
+  gsize cache_size;
+  guint64 cache_hits;
+  guint64 cache_misses;
 };
 
 static void register_lazy_static_resources (void);
@@ -69,6 +93,9 @@ G_DEFINE_BOXED_TYPE (GResource, g_resource, g_resource_ref, g_resource_unref)
  * Resource files can also be marked as compressed. Such files will be included in the resource bundle
  * in a compressed form, but will be automatically uncompressed when the resource is used. This
  * is very useful e.g. for larger text files that are parsed once (or rarely) and then thrown away.
+ * By default, compressed files use zlib. Since 2.76, setting `compressed="lz4"` instead
+ * selects LZ4, which compresses less well but decompresses several times faster; this
+ * requires GLib to be built with LZ4 support.
  *
  * Resource files can also be marked to be preprocessed, by setting the value of the
  * `preprocess` attribute to a comma-separated list of preprocessing options.
@@ -528,6 +555,21 @@ g_resource_unref (GResource *resource)
 {
   if (g_atomic_int_dec_and_test (&resource->ref_count))
     {
+      ResourceCacheEntry *entry;
+
+      if (resource->cache_hits + resource->cache_misses > 0)
+        g_debug ("GResource %p: %" G_GUINT64_FORMAT " decompression cache hits, "
+                 "%" G_GUINT64_FORMAT " misses",
+                 resource, resource->cache_hits, resource->cache_misses);
+
+      while ((entry = g_queue_pop_head (&resource->cache_lru)) != NULL)
+        {
+          g_bytes_unref (entry->bytes);
+          g_free (entry);
+        }
+      g_hash_table_unref (resource->cache);
+      g_mutex_clear (&resource->cache_lock);
+
       gvdb_table_free (resource->table);
       g_free (resource);
     }
@@ -544,13 +586,218 @@ g_resource_new_from_table (GvdbTable *table)
 {
   GResource *resource;
 
-  resource = g_new (GResource, 1);
+  resource = g_new0 (GResource, 1);
   resource->ref_count = 1;
   resource->table = table;
 
+  g_mutex_init (&resource->cache_lock);
+  resource->cache = g_hash_table_new (NULL, NULL);
+  g_queue_init (&resource->cache_lru);
+
   return resource;
 }
 
+/* Returns: (transfer full) (nullable): the cached decompressed data of the
+ * entry at @compressed_data, or %NULL if it is not cached */
+static GBytes *
+resource_cache_lookup (GResource  *resource,
+                       const void *compressed_data)
+{
+  GList *link;
+  GBytes *bytes = NULL;
+
+  g_mutex_lock (&resource->cache_lock);
+
+  link = g_hash_table_lookup (resource->cache, compressed_data);
+  if (link != NULL)
+    {
+      ResourceCacheEntry *entry = link->data;
+
+      g_queue_unlink (&resource->cache_lru, link);
+      g_queue_push_head_link (&resource->cache_lru, link);
+
+      bytes = g_bytes_ref (entry->bytes);
+      resource->cache_hits++;
+    }
+  else
+    resource->cache_misses++;
+
+  g_mutex_unlock (&resource->cache_lock);
+
+  return bytes;
+}
+
+/* Returns: (transfer full): @bytes, or the equal data some other thread
+ * cached for @compressed_data in the meantime */
+static GBytes *
+resource_cache_insert (GResource  *resource,
+                       const void *compressed_data,
+                       GBytes     *bytes  /* (transfer full) */)
+{
+  ResourceCacheEntry *entry;
+  GList *link;
+  gsize size = g_bytes_get_size (bytes);
+
+  if (size > RESOURCE_CACHE_MAX_SIZE / 4)
+    return bytes;
+
+  g_mutex_lock (&resource->cache_lock);
+
+  link = g_hash_table_lookup (resource->cache, compressed_data);
+  if (link != NULL)
+    {
+      entry = link->data;
+      g_bytes_unref (bytes);
+      bytes = g_bytes_ref (entry->bytes);
+      g_mutex_unlock (&resource->cache_lock);
+      return bytes;
+    }
+
+  /* Evict least recently used entries to make room */
+  while (resource->cache_size + size > RESOURCE_CACHE_MAX_SIZE)
+    {
+      entry = g_queue_pop_tail (&resource->cache_lru);
+      g_hash_table_remove (resource->cache, entry->compressed_data);
+      resource->cache_size -= g_bytes_get_size (entry->bytes);
+      g_bytes_unref (entry->bytes);
+      g_free (entry);
+    }
+
+  entry = g_new (ResourceCacheEntry, 1);
+  entry->compressed_data = compressed_data;
+  entry->bytes = g_bytes_ref (bytes);
+  g_queue_push_head (&resource->cache_lru, entry);
+  g_hash_table_insert (resource->cache, (gpointer) compressed_data, resource->cache_lru.head);
+  resource->cache_size += size;
+
+  g_mutex_unlock (&resource->cache_lock);
+
+  return bytes;
+}
+
+/* Returns: (transfer full) (nullable): the @size bytes inflated from the
+ * zlib stream at @data, followed by a zero byte */
+static gchar *
+resource_decompress_zlib (const void *data,
+                          gsize       data_size,
+                          gsize       size)
+{
+  char *uncompressed, *d;
+  const char *s;
+  GConverterResult res;
+  gsize d_size, s_size;
+  gsize bytes_read, bytes_written;
+  GZlibDecompressor *decompressor;
+
+  decompressor = g_zlib_decompressor_new (G_ZLIB_COMPRESSOR_FORMAT_ZLIB);
+  uncompressed = g_malloc (size + 1);
+
+  s = data;
+  s_size = data_size;
+  d = uncompressed;
+  d_size = size;
+
+  do
+    {
+      res = g_converter_convert (G_CONVERTER (decompressor),
+                                 s, s_size,
+                                 d, d_size,
+                                 G_CONVERTER_INPUT_AT_END,
+                                 &bytes_read,
+                                 &bytes_written,
+                                 NULL);
+      if (res == G_CONVERTER_ERROR)
+        {
+          g_free (uncompressed);
+          g_object_unref (decompressor);
+          return NULL;
+        }
+      s += bytes_read;
+      s_size -= bytes_read;
+      d += bytes_written;
+      d_size -= bytes_written;
+    }
+  while (res != G_CONVERTER_FINISHED);
+
+  uncompressed[size] = 0; /* Zero terminate */
+
+  g_object_unref (decompressor);
+
+  return uncompressed;
+}
+
+#ifdef HAVE_LZ4
+/* Returns: (transfer full) (nullable): the @size bytes decoded from the LZ4
+ * block at @data, followed by a zero byte */
+static gchar *
+resource_decompress_lz4 (const void *data,
+                         gsize       data_size,
+                         gsize       size)
+{
+  gchar *uncompressed;
+
+  if (data_size > G_MAXINT || size > G_MAXINT)
+    return NULL;
+
+  uncompressed = g_malloc (size + 1);
+
+  if (LZ4_decompress_safe (data, uncompressed, (int) data_size, (int) size) != (int) size)
+    {
+      g_free (uncompressed);
+      return NULL;
+    }
+
+  uncompressed[size] = 0; /* Zero terminate */
+
+  return uncompressed;
+}
+#endif
+
+/* Returns: (transfer full) (nullable): the uncompressed data of the
+ * compressed entry at @data, from the cache if possible */
+static GBytes *
+resource_decompress (GResource    *resource,
+                     const gchar  *path,
+                     guint32       flags,
+                     const void   *data,
+                     gsize         data_size,
+                     gsize         size,
+                     GError      **error)
+{
+  gchar *uncompressed;
+  GBytes *bytes;
+
+  bytes = resource_cache_lookup (resource, data);
+  if (bytes != NULL)
+    return bytes;
+
+  if (flags & G_RESOURCE_FLAGS_COMPRESSED_LZ4)
+    {
+#ifdef HAVE_LZ4
+      uncompressed = resource_decompress_lz4 (data, data_size, size);
+#else
+      g_set_error (error, G_RESOURCE_ERROR, G_RESOURCE_ERROR_INTERNAL,
+                   _("The resource at “%s” is LZ4-compressed, which is not supported"),
+                   path);
+      return NULL;
+#endif
+    }
+  else
+    uncompressed = resource_decompress_zlib (data, data_size, size);
+
+  if (uncompressed == NULL)
+    {
+      g_set_error (error, G_RESOURCE_ERROR, G_RESOURCE_ERROR_INTERNAL,
+                   _("The resource at “%s” failed to decompress"),
+                   path);
+      return NULL;
+    }
+
+  bytes = g_bytes_new_take (uncompressed, size);
+
+  return resource_cache_insert (resource, data, bytes);
+}
+
 static void
 g_resource_error_from_gvdb_table_error (GError **g_resource_error,
                                         GError  *gvdb_table_error  /* (transfer full) */)
@@ -745,12 +992,36 @@ g_resource_open_stream (GResource             *resource,
 {
   const void *data;
   gsize data_size;
+  gsize size;
   guint32 flags;
   GInputStream *stream, *stream2;
 
-  if (!do_lookup (resource, path, lookup_flags, NULL, &flags, &data, &data_size, error))
+  if (!do_lookup (resource, path, lookup_flags, &size, &flags, &data, &data_size, error))
     return NULL;
 
+  if (flags & G_RESOURCE_FLAGS_COMPRESSED)
+    {
+      GBytes *bytes;
+
+      /* There is no streaming LZ4 decoder, so such entries are decoded in
+       * one go; zlib ones are inflated on the fly unless already cached. */
+      if (flags & G_RESOURCE_FLAGS_COMPRESSED_LZ4)
+        {
+          bytes = resource_decompress (resource, path, flags, data, data_size, size, error);
+          if (bytes == NULL)
+            return NULL;
+        }
+      else
+        bytes = resource_cache_lookup (resource, data);
+
+      if (bytes != NULL)
+        {
+          stream = g_memory_input_stream_new_from_bytes (bytes);
+          g_bytes_unref (bytes);
+          return stream;
+        }
+    }
+
   stream = g_memory_input_stream_new_from_data (data, data_size, NULL);
   g_object_set_data_full (G_OBJECT (stream), "g-resource",
                           g_resource_ref (resource),
@@ -788,7 +1059,9 @@ g_resource_open_stream (GResource             *resource,
  * For uncompressed resource files this is a pointer directly into
  * the resource bundle, which is typically in some readonly data section
  * in the program binary. For compressed files we allocate memory on
- * the heap and automatically uncompress the data.
+ * the heap and automatically uncompress the data. Since 2.76, @resource
+ * keeps the most recently used uncompressed data in a bounded cache, so
+ * looking up the same compressed file again is cheap.
  *
  * @lookup_flags controls the behaviour of the lookup.
  *
@@ -814,57 +1087,7 @@ g_resource_lookup_data (GResource             *resource,
   if (size == 0)
     return g_bytes_new_with_free_func ("", 0, (GDestroyNotify) g_resource_unref, g_resource_ref (resource));
   else if (flags & G_RESOURCE_FLAGS_COMPRESSED)
-    {
-      char *uncompressed, *d;
-      const char *s;
-      GConverterResult res;
-      gsize d_size, s_size;
-      gsize bytes_read, bytes_written;
-
-
-      GZlibDecompressor *decompressor =
-        g_zlib_decompressor_new (G_ZLIB_COMPRESSOR_FORMAT_ZLIB);
-
-      uncompressed = g_malloc (size + 1);
-
-      s = data;
-      s_size = data_size;
-      d = uncompressed;
-      d_size = size;
-
-      do
-        {
-          res = g_converter_convert (G_CONVERTER (decompressor),
-                                     s, s_size,
-                                     d, d_size,
-                                     G_CONVERTER_INPUT_AT_END,
-                                     &bytes_read,
-                                     &bytes_written,
-                                     NULL);
-          if (res == G_CONVERTER_ERROR)
-            {
-              g_free (uncompressed);
-              g_object_unref (decompressor);
-
-              g_set_error (error, G_RESOURCE_ERROR, G_RESOURCE_ERROR_INTERNAL,
-                           _("The resource at “%s” failed to decompress"),
-                           path);
-              return NULL;
-
-            }
-          s += bytes_read;
-          s_size -= bytes_read;
-          d += bytes_written;
-          d_size -= bytes_written;
-        }
-      while (res != G_CONVERTER_FINISHED);
-
-      uncompressed[size] = 0; /* Zero terminate */
-
-      g_object_unref (decompressor);
-
-      return g_bytes_new_take (uncompressed, size);
-    }
+    return resource_decompress (resource, path, flags, data, data_size, size, error);
   else
     return g_bytes_new_with_free_func (data, data_size, (GDestroyNotify)g_resource_unref, g_resource_ref (resource));
 }
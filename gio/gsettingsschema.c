@@ -153,7 +153,7 @@ struct _GSettingsSchema
   const gchar *path;
   GQuark *items;
   gint n_items;
-  GvdbTable *table;
+  GvdbTable *table;  /* (unowned), see g_settings_schema_source_get_table() */
   gchar *id;
 
   GSettingsSchema *extends;
@@ -193,11 +193,49 @@ struct _GSettingsSchemaSource
   GvdbTable *table;
   GHashTable **text_tables;
 
+  /* The tables of the schemas in @table are opened on first use and kept
+   * until @source is freed, so that looking up the same schema again (as
+   * happens for every GSettings object) doesn't allocate a new table. */
+  GMutex schema_tables_lock;
+  GHashTable *schema_tables;  /* schema id -> GvdbTable, or NULL if absent */
+
   gint ref_count;
 };
 
 static GSettingsSchemaSource *schema_sources;
 
+static void
+schema_table_free (gpointer data)
+{
+  GvdbTable *table = data;
+
+  if (table != NULL)
+    gvdb_table_free (table);
+}
+
+/* Returns: (transfer none) (nullable): the table of @schema_id in @source,
+ * valid for as long as @source is alive */
+static GvdbTable *
+g_settings_schema_source_get_table (GSettingsSchemaSource *source,
+                                    const gchar           *schema_id)
+{
+  GvdbTable *table;
+
+  g_mutex_lock (&source->schema_tables_lock);
+
+  if (!g_hash_table_lookup_extended (source->schema_tables, schema_id, NULL, (gpointer *) &table))
+    {
+      /* Misses are cached too, as recursive lookups of schemas from
+       * lower layers check every source on the way. */
+      table = gvdb_table_get_table (source->table, schema_id);
+      g_hash_table_insert (source->schema_tables, g_strdup (schema_id), table);
+    }
+
+  g_mutex_unlock (&source->schema_tables_lock);
+
+  return table;
+}
+
 /**
  * g_settings_schema_source_ref:
  * @source: a #GSettingsSchemaSource
@@ -234,6 +272,8 @@ g_settings_schema_source_unref (GSettingsSchemaSource *source)
 
       if (source->parent)
         g_settings_schema_source_unref (source->parent);
+      g_hash_table_unref (source->schema_tables);
+      g_mutex_clear (&source->schema_tables_lock);
       gvdb_table_free (source->table);
       g_free (source->directory);
 
@@ -311,6 +351,8 @@ g_settings_schema_source_new_from_directory (const gchar            *directory,
   source->parent = parent ? g_settings_schema_source_ref (parent) : NULL;
   source->text_tables = NULL;
   source->table = table;
+  g_mutex_init (&source->schema_tables_lock);
+  source->schema_tables = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, schema_table_free);
   source->ref_count = 1;
 
   return source;
@@ -440,11 +482,11 @@ g_settings_schema_source_lookup (GSettingsSchemaSource *source,
   g_return_val_if_fail (source != NULL, NULL);
   g_return_val_if_fail (schema_id != NULL, NULL);
 
-  table = gvdb_table_get_table (source->table, schema_id);
+  table = g_settings_schema_source_get_table (source, schema_id);
 
   if (table == NULL && recursive)
     for (source = source->parent; source; source = source->parent)
-      if ((table = gvdb_table_get_table (source->table, schema_id)))
+      if ((table = g_settings_schema_source_get_table (source, schema_id)))
         break;
 
   if (table == NULL)
@@ -761,15 +803,13 @@ g_settings_schema_source_list_schemas (GSettingsSchemaSource   *source,
 
               schema = g_strdup (list[i]);
 
-              table = gvdb_table_get_table (s->table, list[i]);
+              table = g_settings_schema_source_get_table (s, list[i]);
               g_assert (table != NULL);
 
               if (gvdb_table_has_value (table, ".path"))
                 g_hash_table_add (single, schema);
               else
                 g_hash_table_add (reloc, schema);
-
-              gvdb_table_free (table);
             }
         }
 
@@ -895,7 +935,6 @@ g_settings_schema_unref (GSettingsSchema *schema)
         g_settings_schema_unref (schema->extends);
 
       g_settings_schema_source_unref (schema->source);
-      gvdb_table_free (schema->table);
       g_free (schema->items);
       g_free (schema->id);
 
@@ -1140,7 +1179,7 @@ g_settings_schema_list (GSettingsSchema *schema,
             child_table = NULL;
 
             for (source = schema->source; source; source = source->parent)
-              if ((child_table = gvdb_table_get_table (source->table, g_variant_get_string (child_schema, NULL))))
+              if ((child_table = g_settings_schema_source_get_table (source, g_variant_get_string (child_schema, NULL))))
                 break;
 
             g_variant_unref (child_schema);
@@ -1173,8 +1212,6 @@ g_settings_schema_list (GSettingsSchema *schema,
                 if (!same)
                   g_hash_table_iter_remove (&iter);
               }
-
-            gvdb_table_free (child_table);
           }
 
       /* Now create the list */
@@ -229,6 +229,12 @@ enum
 /* Size of the receiver cache for g_socket_receive_from() */
 #define RECV_ADDR_CACHE_SIZE 8
 
+typedef struct _GSocketZerocopy GSocketZerocopy;
+
+#ifdef __linux__
+static void zerocopy_unref (GSocketZerocopy *state);
+#endif
+
 struct _GSocketPrivate
 {
   GSocketFamily   family;
@@ -248,6 +254,8 @@ struct _GSocketPrivate
   guint           listening : 1;
   guint           timed_out : 1;
   guint           connect_pending : 1;
+  guint           zerocopy : 1;
+  guint           reuse_port : 1;
 #ifdef G_OS_WIN32
   WSAEVENT        event;
   gboolean        waiting;
@@ -266,6 +274,10 @@ struct _GSocketPrivate
     gsize native_len;
     guint64 last_used;
   } recv_addr_cache[RECV_ADDR_CACHE_SIZE];
+
+  /* Zero-copy sends whose memory the kernel may still be using, once
+   * zero-copy sending has been enabled */
+  GSocketZerocopy *zerocopy_state;  /* (owned) (nullable) */
 };
 
 _G_DEFINE_TYPE_EXTENDED_WITH_PRELUDE (GSocket, g_socket, G_TYPE_OBJECT, 0,
@@ -895,6 +907,10 @@ g_socket_finalize (GObject *object)
   if (socket->priv->remote_address)
     g_object_unref (socket->priv->remote_address);
 
+#ifdef __linux__
+  g_clear_pointer (&socket->priv->zerocopy_state, zerocopy_unref);
+#endif
+
 #ifdef G_OS_WIN32
   if (socket->priv->event != WSA_INVALID_EVENT)
     {
@@ -1895,6 +1911,134 @@ g_socket_set_multicast_ttl (GSocket  *socket,
   g_object_notify (G_OBJECT (socket), "multicast-ttl");
 }
 
+static gboolean
+set_udp_offload_option (GSocket      *socket,
+                        gint          optname,
+                        gint          value,
+                        GError      **error)
+{
+#ifdef __linux__
+  if (socket->priv->type != G_SOCKET_TYPE_DATAGRAM ||
+      (socket->priv->family != G_SOCKET_FAMILY_IPV4 &&
+       socket->priv->family != G_SOCKET_FAMILY_IPV6))
+    {
+      g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                           _("UDP segmentation offload requires a UDP socket"));
+      return FALSE;
+    }
+
+  if (!check_socket (socket, error))
+    return FALSE;
+
+  /* Not g_socket_set_option(), whose GError doesn't tell an unknown
+   * option apart from other failures */
+  if (setsockopt (socket->priv->fd, SOL_UDP, optname, &value, sizeof (value)) != 0)
+    {
+      int errsv = get_socket_errno ();
+
+      /* Kernels older than 4.18 (UDP_SEGMENT) or 5.0 (UDP_GRO) */
+      if (errsv == ENOPROTOOPT)
+        g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                             _("UDP segmentation offload is not supported by the kernel"));
+      else
+        g_set_error_literal (error, G_IO_ERROR,
+                             socket_io_error_from_errno (errsv),
+                             socket_strerror (errsv));
+      return FALSE;
+    }
+
+  return TRUE;
+#else
+  g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                       _("UDP segmentation offload is not supported on this platform"));
+  return FALSE;
+#endif
+}
+
+/**
+ * g_socket_set_udp_segment_size:
+ * @socket: a #GSocket
+ * @segment_size: the size of each datagram, or 0 to disable segmentation
+ * @error: #GError for error reporting, or %NULL to ignore.
+ *
+ * Enables UDP segmentation offload (GSO) for datagrams sent on @socket.
+ *
+ * When @segment_size is not 0, each buffer sent on @socket, with
+ * g_socket_send_to(), g_socket_send_message() or
+ * g_socket_send_messages(), is split into datagrams of @segment_size
+ * bytes, the last of which may be shorter. This lets one call, and
+ * one trip through the network stack, send up to 64 kilobytes of
+ * datagrams, which is much cheaper than sending them one by one. The
+ * segment size can also be set for a single send by passing a
+ * #GUdpSegmentMessage to g_socket_send_message().
+ *
+ * The buffer may hold at most 64 datagrams, and each must fit in the
+ * path MTU, as they cannot be fragmented.
+ *
+ * This is only supported on Linux, for %G_SOCKET_TYPE_DATAGRAM sockets
+ * in the %G_SOCKET_FAMILY_IPV4 and %G_SOCKET_FAMILY_IPV6 families.
+ * Elsewhere, %G_IO_ERROR_NOT_SUPPORTED is returned.
+ *
+ * Returns: %TRUE on success, %FALSE on error
+ *
+ * Since: 2.76
+ */
+gboolean
+g_socket_set_udp_segment_size (GSocket  *socket,
+                               guint     segment_size,
+                               GError  **error)
+{
+  g_return_val_if_fail (G_IS_SOCKET (socket), FALSE);
+  g_return_val_if_fail (segment_size <= G_MAXUINT16, FALSE);
+  g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+#ifdef __linux__
+  return set_udp_offload_option (socket, UDP_SEGMENT, segment_size, error);
+#else
+  return set_udp_offload_option (socket, 0, segment_size, error);
+#endif
+}
+
+/**
+ * g_socket_set_udp_gro:
+ * @socket: a #GSocket
+ * @enabled: whether to enable UDP receive offload
+ * @error: #GError for error reporting, or %NULL to ignore.
+ *
+ * Enables UDP receive offload (GRO) for datagrams received on @socket.
+ *
+ * When enabled, the kernel may coalesce datagrams of the same size from
+ * the same sender into a single buffer, which is then received by one
+ * call. Such a buffer is returned with a #GUdpSegmentMessage giving the
+ * size of the datagrams in it, so the control messages must be asked
+ * for when receiving, with g_socket_receive_message() or
+ * g_socket_receive_messages(). The receive buffers should be large
+ * enough for the coalesced datagrams, i.e. 64 kilobytes, as a buffer
+ * that is too short truncates the data.
+ *
+ * This is only supported on Linux, for %G_SOCKET_TYPE_DATAGRAM sockets
+ * in the %G_SOCKET_FAMILY_IPV4 and %G_SOCKET_FAMILY_IPV6 families.
+ * Elsewhere, %G_IO_ERROR_NOT_SUPPORTED is returned.
+ *
+ * Returns: %TRUE on success, %FALSE on error
+ *
+ * Since: 2.76
+ */
+gboolean
+g_socket_set_udp_gro (GSocket   *socket,
+                      gboolean   enabled,
+                      GError   **error)
+{
+  g_return_val_if_fail (G_IS_SOCKET (socket), FALSE);
+  g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+#ifdef __linux__
+  return set_udp_offload_option (socket, UDP_GRO, !!enabled, error);
+#else
+  return set_udp_offload_option (socket, 0, !!enabled, error);
+#endif
+}
+
 /**
  * g_socket_get_family:
  * @socket: a #GSocket.
@@ -2123,6 +2267,31 @@ g_socket_listen (GSocket  *socket,
   return TRUE;
 }
 
+/*
+ * g_socket_set_reuse_port:
+ * @socket: a #GSocket
+ * @reuse_port: whether to set `SO_REUSEPORT`
+ *
+ * Makes g_socket_bind() set `SO_REUSEPORT` when @allow_reuse is %TRUE on
+ * non-UDP sockets too, so that several listening sockets can share an
+ * address and have the kernel spread the connections between them.
+ *
+ * Returns: %FALSE if `SO_REUSEPORT` is not available
+ */
+gboolean
+g_socket_set_reuse_port (GSocket  *socket,
+                         gboolean  reuse_port)
+{
+  g_return_val_if_fail (G_IS_SOCKET (socket), FALSE);
+
+#ifdef SO_REUSEPORT
+  socket->priv->reuse_port = !!reuse_port;
+  return TRUE;
+#else
+  return FALSE;
+#endif
+}
+
 /**
  * g_socket_bind:
  * @socket: a #GSocket.
@@ -2199,7 +2368,8 @@ g_socket_bind (GSocket         *socket,
 #endif
 
 #ifdef SO_REUSEPORT
-  so_reuseport = reuse_address && (socket->priv->type == G_SOCKET_TYPE_DATAGRAM);
+  so_reuseport = reuse_address &&
+                 (socket->priv->type == G_SOCKET_TYPE_DATAGRAM || socket->priv->reuse_port);
 #endif
 
   /* Ignore errors here, the only likely error is "not supported", and
@@ -3473,6 +3643,376 @@ g_socket_send_with_timeout (GSocket       *socket,
   return ret;
 }
 
+/* Zero-copy sending, with MSG_ZEROCOPY, makes the kernel read the data
+ * from the caller's memory when it is transmitted rather than copying it
+ * at send() time. Each such send is given an ID by the kernel, counting
+ * from 0, and a notification covering a range of IDs is queued on the
+ * socket's error queue when the kernel no longer needs their memory. We
+ * keep a reference on the GBytes of each send until then.
+ *
+ * The error queue is read by whichever thread gets to it first, but the
+ * GBytes are only released in the source's dispatch, on the main context
+ * zero-copy was enabled in.
+ *
+ * The kernel may still be transmitting the data after the socket has
+ * been closed, so the sends are tracked in a GSocketZerocopy of their
+ * own, which the source holds a reference on rather than on the socket.
+ * If sends are still pending when the socket is closed, it takes over a
+ * duplicate of the fd, which keeps the error queue readable, and closes
+ * it once the last notification has arrived. */
+
+#ifdef __linux__
+typedef struct {
+  guint32  id;
+  GBytes  *bytes;
+} GSocketZerocopySend;
+
+struct _GSocketZerocopy {
+  gatomicrefcount  ref_count;
+  GMutex           lock;
+  int              fd;  /* the socket's, or our own once it was closed */
+  gboolean         orphaned;
+  GQueue           pending;  /* (element-type GSocketZerocopySend) */
+  GSList          *completed;  /* (element-type GBytes) (owned) */
+  guint32          next_id;
+  GMainContext    *context;  /* (owned) */
+  GSource         *source;  /* (owned) (nullable) */
+};
+
+/* Sending less than this with MSG_ZEROCOPY costs more than copying it */
+#define ZEROCOPY_MIN_SIZE (10 * 1024)
+
+static GSocketZerocopy *
+zerocopy_new (int fd)
+{
+  GSocketZerocopy *state;
+
+  state = g_new0 (GSocketZerocopy, 1);
+  g_atomic_ref_count_init (&state->ref_count);
+  g_mutex_init (&state->lock);
+  state->fd = fd;
+  g_queue_init (&state->pending);
+
+  return state;
+}
+
+static GSocketZerocopy *
+zerocopy_ref (GSocketZerocopy *state)
+{
+  g_atomic_ref_count_inc (&state->ref_count);
+  return state;
+}
+
+static void
+zerocopy_unref (GSocketZerocopy *state)
+{
+  if (!g_atomic_ref_count_dec (&state->ref_count))
+    return;
+
+  /* Only left if the fd could not be duplicated on close, in which case
+   * the GBytes are leaked on purpose: the kernel may still read them */
+  g_queue_clear_full (&state->pending, g_free);
+
+  g_slist_free_full (state->completed, (GDestroyNotify) g_bytes_unref);
+  g_assert (state->source == NULL);
+  g_clear_pointer (&state->context, g_main_context_unref);
+  g_mutex_clear (&state->lock);
+  g_free (state);
+}
+
+/* Reads the notifications in the error queue, and moves the sends they
+ * cover to the completed list. Called with the lock held. */
+static gboolean
+zerocopy_reap_locked (GSocketZerocopy *state)
+{
+  gboolean reaped = FALSE;
+
+  while (!g_queue_is_empty (&state->pending))
+    {
+      union {
+        struct cmsghdr align;
+        char buffer[CMSG_SPACE (sizeof (struct sock_extended_err) + sizeof (struct sockaddr_in6))];
+      } control;
+      struct msghdr msg = { 0, };
+      struct cmsghdr *cmsg;
+
+      msg.msg_control = control.buffer;
+      msg.msg_controllen = sizeof (control.buffer);
+
+      if (recvmsg (state->fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0)
+        break;
+
+      for (cmsg = CMSG_FIRSTHDR (&msg); cmsg != NULL; cmsg = CMSG_NXTHDR (&msg, cmsg))
+        {
+          struct sock_extended_err serr;
+          GList *l, *next;
+
+          if (!(cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR) &&
+              !(cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR))
+            continue;
+
+          memcpy (&serr, CMSG_DATA (cmsg), sizeof (serr));
+          if (serr.ee_errno != 0 || serr.ee_origin != SO_EE_ORIGIN_ZEROCOPY)
+            continue;
+
+          /* The IDs from ee_info to ee_data, which may wrap around */
+          for (l = state->pending.head; l != NULL; l = next)
+            {
+              GSocketZerocopySend *send = l->data;
+
+              next = l->next;
+              if (send->id - serr.ee_info > serr.ee_data - serr.ee_info)
+                continue;
+
+              state->completed = g_slist_prepend (state->completed, send->bytes);
+              g_queue_delete_link (&state->pending, l);
+              g_free (send);
+              reaped = TRUE;
+            }
+        }
+    }
+
+  return reaped;
+}
+
+/* Called with the lock held */
+static void
+zerocopy_destroy_source_locked (GSocketZerocopy *state)
+{
+  if (state->source == NULL)
+    return;
+
+  g_source_destroy (state->source);
+  g_clear_pointer (&state->source, g_source_unref);
+}
+
+static gboolean
+zerocopy_source_dispatch (gint         fd,
+                          GIOCondition condition,
+                          gpointer     user_data)
+{
+  GSocketZerocopy *state = user_data;
+  GSList *completed;
+  gboolean keep;
+
+  g_mutex_lock (&state->lock);
+
+  if (state->source != g_main_current_source ())
+    {
+      /* Replaced or destroyed in the meantime */
+      g_mutex_unlock (&state->lock);
+      return G_SOURCE_REMOVE;
+    }
+
+  zerocopy_reap_locked (state);
+  completed = g_steal_pointer (&state->completed);
+
+  keep = !g_queue_is_empty (&state->pending);
+  if (keep)
+    g_source_set_ready_time (state->source, -1);
+  else
+    {
+      g_clear_pointer (&state->source, g_source_unref);
+
+      /* The kernel is done with the socket's memory, so the duplicate fd
+       * we kept it open with can go */
+      if (state->orphaned && state->fd != -1)
+        {
+          close (state->fd);
+          state->fd = -1;
+        }
+    }
+
+  g_mutex_unlock (&state->lock);
+
+  g_slist_free_full (completed, (GDestroyNotify) g_bytes_unref);
+
+  return keep;
+}
+
+/* Called with the lock held */
+static void
+zerocopy_ensure_source_locked (GSocketZerocopy *state)
+{
+  GSource *source;
+
+  if (state->source != NULL)
+    return;
+
+  /* Notifications in the error queue make the socket poll as G_IO_ERR */
+  source = g_unix_fd_source_new (state->fd, G_IO_ERR);
+  g_source_set_static_name (source, "GSocket zero-copy completions");
+  g_source_set_callback (source, G_SOURCE_FUNC (zerocopy_source_dispatch),
+                         zerocopy_ref (state), (GDestroyNotify) zerocopy_unref);
+  g_source_attach (source, state->context);
+  state->source = source;
+}
+
+/* Reaps completions outside of the source, when the socket is found not
+ * to be writable, as they may be holding the socket's memory, or when
+ * they make it poll as G_IO_ERR. The source is woken to release the
+ * GBytes. */
+static void
+zerocopy_reap (GSocketZerocopy *state)
+{
+  g_mutex_lock (&state->lock);
+  if (zerocopy_reap_locked (state) && state->source != NULL)
+    g_source_set_ready_time (state->source, 0);
+  g_mutex_unlock (&state->lock);
+}
+
+/* Called by g_socket_close() before it closes the socket's fd. Sends the
+ * kernel has not notified yet keep their GBytes, and get the error queue
+ * of a duplicate of the fd to be notified on. */
+static void
+zerocopy_orphan (GSocketZerocopy *state)
+{
+  GSList *completed;
+
+  g_mutex_lock (&state->lock);
+
+  zerocopy_reap_locked (state);
+  completed = g_steal_pointer (&state->completed);
+  zerocopy_destroy_source_locked (state);
+
+  if (!g_queue_is_empty (&state->pending))
+    {
+      int fd = fcntl (state->fd, F_DUPFD_CLOEXEC, 0);
+
+      if (fd >= 0)
+        {
+          state->fd = fd;
+          state->orphaned = TRUE;
+          zerocopy_ensure_source_locked (state);
+        }
+      else
+        {
+          g_warning ("Could not keep socket open for zero-copy sends to complete: %s",
+                     g_strerror (errno));
+          state->fd = -1;
+        }
+    }
+  else
+    state->fd = -1;
+
+  g_mutex_unlock (&state->lock);
+
+  g_slist_free_full (completed, (GDestroyNotify) g_bytes_unref);
+}
+
+/* Completed sends make the socket poll as G_IO_ERR until their
+ * notifications are read, although nothing is wrong with it. If @revents
+ * has G_IO_ERR, reads them and polls the socket for @condition again, so
+ * that sources and waits are not woken for nothing. */
+static GIOCondition
+zerocopy_recheck_condition (GSocket      *socket,
+                            GIOCondition  condition,
+                            GIOCondition  revents)
+{
+  GSocketZerocopy *state = socket->priv->zerocopy_state;
+  GPollFD poll_fd;
+  gint result;
+
+  if (state == NULL || (revents & G_IO_ERR) == 0)
+    return revents;
+
+  zerocopy_reap (state);
+
+  poll_fd.fd = socket->priv->fd;
+  poll_fd.events = condition;
+  poll_fd.revents = 0;
+
+  do
+    result = g_poll (&poll_fd, 1, 0);
+  while (result == -1 && get_socket_errno () == EINTR);
+
+  return poll_fd.revents;
+}
+
+static gssize
+g_socket_send_zerocopy_with_timeout (GSocket       *socket,
+                                     GBytes        *bytes,
+                                     gint64         timeout_us,
+                                     GCancellable  *cancellable,
+                                     GError       **error)
+{
+  GSocketZerocopy *state = socket->priv->zerocopy_state;
+  const guint8 *buffer;
+  gsize size;
+  gssize ret;
+  gint64 start_time;
+
+  buffer = g_bytes_get_data (bytes, &size);
+  start_time = g_get_monotonic_time ();
+
+  if (!check_socket (socket, error))
+    return -1;
+
+  if (!check_timeout (socket, error))
+    return -1;
+
+  if (g_cancellable_set_error_if_cancelled (cancellable, error))
+    return -1;
+
+  while (1)
+    {
+      int errsv;
+
+      /* The sends must be added to the pending queue in the order the
+       * kernel gives them IDs. The fd is non-blocking, so this does not
+       * hold the lock for long. */
+      g_mutex_lock (&state->lock);
+
+      ret = send (socket->priv->fd, (const char *) buffer, size,
+                  G_SOCKET_DEFAULT_SEND_FLAGS | MSG_ZEROCOPY);
+      if (ret >= 0)
+        {
+          GSocketZerocopySend *send;
+
+          send = g_new (GSocketZerocopySend, 1);
+          send->id = state->next_id++;
+          send->bytes = g_bytes_ref (bytes);
+          g_queue_push_tail (&state->pending, send);
+          zerocopy_ensure_source_locked (state);
+
+          g_mutex_unlock (&state->lock);
+          break;
+        }
+
+      errsv = get_socket_errno ();
+      g_mutex_unlock (&state->lock);
+
+      if (errsv == EINTR)
+        continue;
+
+      /* Out of memory to pin the pages with, so copy them instead */
+      if (errsv == ENOBUFS)
+        return g_socket_send_with_timeout (socket, buffer, size, timeout_us,
+                                           cancellable, error);
+
+      if (errsv == EWOULDBLOCK ||
+          errsv == EAGAIN)
+        {
+          zerocopy_reap (state);
+
+          if (timeout_us != 0)
+            {
+              if (!block_on_timeout (socket, G_IO_OUT, timeout_us, start_time,
+                                     cancellable, error))
+                return -1;
+
+              continue;
+            }
+        }
+
+      socket_set_error_lazy (error, errsv, _("Error sending data: %s"));
+      return -1;
+    }
+
+  return ret;
+}
+#endif /* __linux__ */
+
 /**
  * g_socket_send:
  * @socket: a #GSocket
@@ -3545,6 +4085,175 @@ g_socket_send_with_blocking (GSocket       *socket,
                                      blocking ? -1 : 0, cancellable, error);
 }
 
+/**
+ * g_socket_set_zerocopy:
+ * @socket: a #GSocket
+ * @enabled: whether to send without copying
+ * @error: #GError for error reporting, or %NULL to ignore.
+ *
+ * Enables zero-copy sending on @socket, for the data sent with
+ * g_socket_send_bytes(), and with g_output_stream_write_bytes() on the
+ * output stream of a #GSocketConnection for @socket.
+ *
+ * Normally, the data is copied into the kernel when it is sent. With
+ * zero-copy sending, the kernel reads it from the #GBytes itself when
+ * it is transmitted, which saves memory bandwidth when sending large
+ * amounts of data. A reference is kept on the #GBytes until the kernel
+ * reports that it no longer needs it; so its memory is not freed until
+ * some time after the send has returned. Only sends of more than about
+ * 10 kilobytes benefit from it, so smaller ones are still copied.
+ *
+ * The kernel's reports are processed, and the #GBytes released, in the
+ * [thread-default main context][g-main-context-push-thread-default] of
+ * the thread calling this function, so it must be running for the
+ * memory to be released. This carries on after @socket has been closed,
+ * until the kernel has reported on every send.
+ *
+ * This is only supported on Linux, for TCP and UDP sockets.
+ * Elsewhere, %G_IO_ERROR_NOT_SUPPORTED is returned. It may also not
+ * save anything: over the loopback interface, for example, the kernel
+ * copies the data anyway.
+ *
+ * Returns: %TRUE on success, %FALSE on error
+ *
+ * Since: 2.76
+ */
+gboolean
+g_socket_set_zerocopy (GSocket   *socket,
+                       gboolean   enabled,
+                       GError   **error)
+{
+  g_return_val_if_fail (G_IS_SOCKET (socket), FALSE);
+  g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+#ifdef __linux__
+  if (!check_socket (socket, error))
+    return FALSE;
+
+  if (socket->priv->family != G_SOCKET_FAMILY_IPV4 &&
+      socket->priv->family != G_SOCKET_FAMILY_IPV6)
+    {
+      g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                           _("Zero-copy sending requires a TCP or UDP socket"));
+      return FALSE;
+    }
+
+  if (!g_socket_set_option (socket, SOL_SOCKET, SO_ZEROCOPY, !!enabled, error))
+    {
+      /* Kernels older than 4.14, or an unsupported protocol */
+      if (errno == ENOPROTOOPT || errno == EOPNOTSUPP)
+        {
+          g_clear_error (error);
+          g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                               _("Zero-copy sending is not supported by the kernel for this socket"));
+        }
+      return FALSE;
+    }
+
+  socket->priv->zerocopy = !!enabled;
+  if (enabled)
+    {
+      GSocketZerocopy *state;
+
+      if (socket->priv->zerocopy_state == NULL)
+        socket->priv->zerocopy_state = zerocopy_new (socket->priv->fd);
+
+      state = socket->priv->zerocopy_state;
+      g_mutex_lock (&state->lock);
+      g_clear_pointer (&state->context, g_main_context_unref);
+      state->context = g_main_context_ref_thread_default ();
+      g_mutex_unlock (&state->lock);
+    }
+
+  return TRUE;
+#else
+  g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED,
+                       _("Zero-copy sending is not supported on this platform"));
+  return FALSE;
+#endif
+}
+
+/**
+ * g_socket_get_zerocopy:
+ * @socket: a #GSocket
+ *
+ * Gets whether zero-copy sending is enabled on @socket. See
+ * g_socket_set_zerocopy().
+ *
+ * Returns: %TRUE if zero-copy sending is enabled
+ *
+ * Since: 2.76
+ */
+gboolean
+g_socket_get_zerocopy (GSocket *socket)
+{
+  g_return_val_if_fail (G_IS_SOCKET (socket), FALSE);
+
+  return socket->priv->zerocopy;
+}
+
+/* Sends @bytes, without copying them if zero-copy sending is enabled */
+gssize
+g_socket_send_bytes_with_blocking (GSocket       *socket,
+                                   GBytes        *bytes,
+                                   gboolean       blocking,
+                                   GCancellable  *cancellable,
+                                   GError       **error)
+{
+  gconstpointer data;
+  gsize size;
+
+  data = g_bytes_get_data (bytes, &size);
+
+#ifdef __linux__
+  if (socket->priv->zerocopy && size >= ZEROCOPY_MIN_SIZE)
+    return g_socket_send_zerocopy_with_timeout (socket, bytes,
+                                                blocking ? -1 : 0,
+                                                cancellable, error);
+#endif
+
+  if (size == 0)
+    data = "";
+
+  return g_socket_send_with_timeout (socket, data, size,
+                                     blocking ? -1 : 0, cancellable, error);
+}
+
+/**
+ * g_socket_send_bytes:
+ * @socket: a #GSocket
+ * @bytes: the data to send
+ * @cancellable: (nullable): a %GCancellable or %NULL
+ * @error: #GError for error reporting, or %NULL to ignore.
+ *
+ * Tries to send the contents of @bytes on the socket. This is the same
+ * as g_socket_send(), except that if zero-copy sending is enabled with
+ * g_socket_set_zerocopy(), the data may be sent without being copied,
+ * and a reference kept on @bytes until the kernel is done with it.
+ *
+ * As with g_socket_send(), fewer bytes than the size of @bytes may be
+ * sent. The rest can be sent with a #GBytes from g_bytes_new_from_bytes(),
+ * which does not copy the data either.
+ *
+ * Returns: Number of bytes written (which may be less than the size of
+ *   @bytes), or -1 on error
+ *
+ * Since: 2.76
+ */
+gssize
+g_socket_send_bytes (GSocket       *socket,
+                     GBytes        *bytes,
+                     GCancellable  *cancellable,
+                     GError       **error)
+{
+  g_return_val_if_fail (G_IS_SOCKET (socket), -1);
+  g_return_val_if_fail (bytes != NULL, -1);
+
+  return g_socket_send_bytes_with_blocking (socket, bytes,
+                                            socket->priv->blocking,
+                                            cancellable, error);
+}
+
 /**
  * g_socket_send_to:
  * @socket: a #GSocket
@@ -3716,6 +4425,16 @@ g_socket_close (GSocket  *socket,
   if (!check_socket (socket, error))
     return FALSE;
 
+#ifdef __linux__
+  /* The kernel may still be sending from the GBytes of zero-copy sends */
+  if (socket->priv->zerocopy_state != NULL)
+    {
+      zerocopy_orphan (socket->priv->zerocopy_state);
+      g_clear_pointer (&socket->priv->zerocopy_state, zerocopy_unref);
+      socket->priv->zerocopy = FALSE;
+    }
+#endif
+
   while (1)
     {
 #ifdef G_OS_WIN32
@@ -4027,6 +4746,9 @@ socket_source_dispatch (GSource     *source,
   else
     {
       events = g_source_query_unix_fd (source, socket_source->fd_tag);
+#ifdef __linux__
+      events = zerocopy_recheck_condition (socket, socket_source->condition, events);
+#endif
     }
 #endif
 
@@ -4038,6 +4760,12 @@ socket_source_dispatch (GSource     *source,
       events |= (G_IO_IN | G_IO_OUT);
     }
 
+#ifdef __linux__
+  /* Only woken by completed zero-copy sends */
+  if ((events & socket_source->condition) == 0)
+    return G_SOURCE_CONTINUE;
+#endif
+
   ret = (*func) (socket, events & socket_source->condition, user_data);
 
   if (socket->priv->timeout && !g_socket_is_closed (socket_source->socket))
@@ -4207,6 +4935,175 @@ g_socket_create_source (GSocket      *socket,
   return socket_source_new (socket, condition, cancellable);
 }
 
+typedef struct {
+  GSource        source;
+  GSocket       *socket;
+  GCancellable  *cancellable;
+  guint          max_messages;
+  gsize          max_message_size;
+  guint8        *buffer;
+  GInputVector  *vectors;
+  GInputMessage *messages;
+  GSocketAddress **addresses;
+} GSocketReceiveMessagesSource;
+
+static gboolean
+receive_messages_source_dispatch (GSource     *source,
+                                  GSourceFunc  callback,
+                                  gpointer     user_data)
+{
+  GSocketReceiveMessagesSourceFunc func = (GSocketReceiveMessagesSourceFunc) callback;
+  GSocketReceiveMessagesSource *rm_source = (GSocketReceiveMessagesSource *) source;
+  GError *error = NULL;
+  gboolean ret;
+  guint i;
+  gint n;
+
+  for (i = 0; i < rm_source->max_messages; i++)
+    {
+      rm_source->vectors[i].buffer = rm_source->buffer + i * rm_source->max_message_size;
+      rm_source->vectors[i].size = rm_source->max_message_size;
+      rm_source->messages[i].bytes_received = 0;
+      rm_source->messages[i].flags = 0;
+    }
+
+  /* The socket source is a child of this one, so this is called when
+   * it or the cancellable is ready. Take everything that is queued, up
+   * to max_messages, with one recvmmsg() where it is available. */
+  n = g_socket_receive_messages_with_timeout (rm_source->socket,
+                                              rm_source->messages,
+                                              rm_source->max_messages,
+                                              0, 0,
+                                              rm_source->cancellable,
+                                              &error);
+
+  if (n < 0 && g_error_matches (error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK))
+    {
+      g_error_free (error);
+      return G_SOURCE_CONTINUE;
+    }
+
+  if (func == NULL)
+    ret = G_SOURCE_REMOVE;
+  else
+    ret = (*func) (rm_source->socket, rm_source->messages, MAX (n, 0), error, user_data);
+
+  g_clear_error (&error);
+
+  if (rm_source->addresses != NULL)
+    {
+      for (i = 0; i < (guint) MAX (n, 0); i++)
+        g_clear_object (&rm_source->addresses[i]);
+    }
+
+  return ret;
+}
+
+static void
+receive_messages_source_finalize (GSource *source)
+{
+  GSocketReceiveMessagesSource *rm_source = (GSocketReceiveMessagesSource *) source;
+
+  g_object_unref (rm_source->socket);
+  g_clear_object (&rm_source->cancellable);
+  g_free (rm_source->buffer);
+  g_free (rm_source->vectors);
+  g_free (rm_source->messages);
+  g_free (rm_source->addresses);
+}
+
+static GSourceFuncs receive_messages_source_funcs =
+{
+  NULL,
+  NULL,
+  receive_messages_source_dispatch,
+  receive_messages_source_finalize,
+  NULL,
+  NULL,
+};
+
+/**
+ * g_socket_create_receive_messages_source: (skip)
+ * @socket: a #GSocket
+ * @max_messages: the maximum number of messages to receive per dispatch
+ * @max_message_size: the size of the buffer for each message
+ * @receive_addresses: whether to return the source address of each message
+ * @cancellable: (nullable): a %GCancellable or %NULL
+ *
+ * Creates a #GSource that receives messages from @socket as they arrive,
+ * in batches of up to @max_messages, and passes each batch to its
+ * callback, which is of the #GSocketReceiveMessagesSourceFunc type.
+ *
+ * This is meant for receiving datagrams at high rates. Each time @socket
+ * becomes readable, the source receives all the messages that are queued,
+ * up to @max_messages, with a single call to g_socket_receive_messages(),
+ * and dispatches them at once. The messages are received into buffers
+ * of @max_message_size bytes that the source allocates once and reuses;
+ * messages that are longer are truncated, and have %G_SOCKET_MSG_TRUNC
+ * set in their flags where the platform reports it. The messages and
+ * their buffers are only valid during the callback.
+ *
+ * If @receive_addresses is %TRUE, the address field of each message is
+ * set to the address it was sent from. This creates a #GSocketAddress
+ * per message, so leave it %FALSE for connected sockets or when the
+ * sender does not matter.
+ *
+ * The callback is also called with an error and no messages if
+ * receiving fails, and with a %G_IO_ERROR_CANCELLED error if
+ * @cancellable is cancelled. Whether the socket is blocking or not does
+ * not matter; the source never blocks.
+ *
+ * Returns: (transfer full): a newly allocated %GSource, free with g_source_unref().
+ *
+ * Since: 2.76
+ */
+GSource *
+g_socket_create_receive_messages_source (GSocket      *socket,
+                                         guint         max_messages,
+                                         gsize         max_message_size,
+                                         gboolean      receive_addresses,
+                                         GCancellable *cancellable)
+{
+  GSource *source;
+  GSource *socket_source;
+  GSocketReceiveMessagesSource *rm_source;
+  guint i;
+
+  g_return_val_if_fail (G_IS_SOCKET (socket), NULL);
+  g_return_val_if_fail (max_messages > 0, NULL);
+  g_return_val_if_fail (max_message_size > 0 && max_message_size <= G_MAXSIZE / max_messages, NULL);
+  g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
+
+  source = g_source_new (&receive_messages_source_funcs, sizeof (GSocketReceiveMessagesSource));
+  g_source_set_static_name (source, "GSocketReceiveMessages");
+  rm_source = (GSocketReceiveMessagesSource *) source;
+
+  rm_source->socket = g_object_ref (socket);
+  rm_source->cancellable = cancellable ? g_object_ref (cancellable) : NULL;
+  rm_source->max_messages = max_messages;
+  rm_source->max_message_size = max_message_size;
+  rm_source->buffer = g_malloc (max_messages * max_message_size);
+  rm_source->vectors = g_new0 (GInputVector, max_messages);
+  rm_source->messages = g_new0 (GInputMessage, max_messages);
+  if (receive_addresses)
+    rm_source->addresses = g_new0 (GSocketAddress *, max_messages);
+
+  for (i = 0; i < max_messages; i++)
+    {
+      rm_source->messages[i].vectors = &rm_source->vectors[i];
+      rm_source->messages[i].num_vectors = 1;
+      if (receive_addresses)
+        rm_source->messages[i].address = &rm_source->addresses[i];
+    }
+
+  socket_source = socket_source_new (socket, G_IO_IN, cancellable);
+  g_source_add_child_source (source, socket_source);
+  g_source_set_dummy_callback (socket_source);
+  g_source_unref (socket_source);
+
+  return source;
+}
+
 /**
  * g_socket_condition_check:
  * @socket: a #GSocket
@@ -4266,7 +5163,11 @@ g_socket_condition_check (GSocket      *socket,
       result = g_poll (&poll_fd, 1, 0);
     while (result == -1 && get_socket_errno () == EINTR);
 
+#ifdef __linux__
+    return zerocopy_recheck_condition (socket, condition, poll_fd.revents);
+#else
     return poll_fd.revents;
+#endif
   }
 #endif
 }
@@ -4476,7 +5377,15 @@ g_socket_condition_timed_wait (GSocket       *socket,
 	int errsv;
 	result = g_poll (poll_fd, num, timeout_ms);
 	errsv = errno;
-	if (result != -1 || errsv != EINTR)
+	if (result == -1 && errsv == EINTR)
+	  ;
+#ifdef __linux__
+	/* Keep waiting if only completed zero-copy sends woke us */
+	else if (result > 0 && (num == 1 || poll_fd[1].revents == 0) &&
+	         zerocopy_recheck_condition (socket, condition, poll_fd[0].revents) == 0)
+	  ;
+#endif
+	else
 	  break;
 
 	if (timeout_ms != -1)
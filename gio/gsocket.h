@@ -140,6 +140,14 @@ guint                  g_socket_get_multicast_ttl       (GSocket
 GIO_AVAILABLE_IN_2_32
 void                   g_socket_set_multicast_ttl       (GSocket                 *socket,
                                                          guint                    ttl);
+GIO_AVAILABLE_IN_2_76
+gboolean               g_socket_set_udp_segment_size    (GSocket                 *socket,
+                                                         guint                    segment_size,
+                                                         GError                 **error);
+GIO_AVAILABLE_IN_2_76
+gboolean               g_socket_set_udp_gro             (GSocket                 *socket,
+                                                         gboolean                 enabled,
+                                                         GError                 **error);
 GIO_AVAILABLE_IN_ALL
 gboolean               g_socket_is_connected            (GSocket                 *socket);
 GIO_AVAILABLE_IN_ALL
@@ -280,6 +288,12 @@ GIO_AVAILABLE_IN_ALL
 GSource *              g_socket_create_source           (GSocket                 *socket,
 							 GIOCondition             condition,
 							 GCancellable            *cancellable);
+GIO_AVAILABLE_IN_2_76
+GSource *              g_socket_create_receive_messages_source (GSocket          *socket,
+                                                                guint             max_messages,
+                                                                gsize             max_message_size,
+                                                                gboolean          receive_addresses,
+                                                                GCancellable     *cancellable);
 GIO_AVAILABLE_IN_ALL
 gboolean               g_socket_speaks_ipv4             (GSocket                 *socket);
 GIO_AVAILABLE_IN_ALL
@@ -300,6 +314,17 @@ gssize                 g_socket_send_with_blocking      (GSocket
 							 gboolean                 blocking,
 							 GCancellable            *cancellable,
 							 GError                 **error);
+GIO_AVAILABLE_IN_2_76
+gssize                 g_socket_send_bytes              (GSocket                 *socket,
+                                                         GBytes                  *bytes,
+                                                         GCancellable            *cancellable,
+                                                         GError                 **error);
+GIO_AVAILABLE_IN_2_76
+gboolean               g_socket_set_zerocopy            (GSocket                 *socket,
+                                                         gboolean                 enabled,
+                                                         GError                 **error);
+GIO_AVAILABLE_IN_2_76
+gboolean               g_socket_get_zerocopy            (GSocket                 *socket);
 GIO_AVAILABLE_IN_2_60
 GPollableReturn        g_socket_send_message_with_timeout (GSocket                *socket,
 							   GSocketAddress         *address,
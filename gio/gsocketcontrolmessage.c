@@ -48,6 +48,7 @@
 #include "config.h"
 #include "gsocketcontrolmessage.h"
 #include "gnetworkingprivate.h"
+#include "gudpsegmentmessage.h"
 #include "glibintl.h"
 
 #ifndef G_OS_WIN32
@@ -184,6 +185,7 @@ g_socket_control_message_deserialize (int      level,
   g_type_ensure (G_TYPE_UNIX_CREDENTIALS_MESSAGE);
   g_type_ensure (G_TYPE_UNIX_FD_MESSAGE);
 #endif
+  g_type_ensure (G_TYPE_UDP_SEGMENT_MESSAGE);
 
   message_types = g_type_children (G_TYPE_SOCKET_CONTROL_MESSAGE, &n_message_types);
 
@@ -39,6 +39,8 @@
 #include <gio/ginetsocketaddress.h>
 #include "glibintl.h"
 #include "gmarshal-internal.h"
+#include "gioprivate.h"
+#include "gnetworking.h"
 
 
 /**
@@ -81,12 +83,14 @@ enum
 static guint signals[LAST_SIGNAL] = { 0 };
 
 static GQuark source_quark = 0;
+static GQuark shard_quark = 0;
 
 struct _GSocketListenerPrivate
 {
   GPtrArray           *sockets;
   GMainContext        *main_context;
   int                 listen_backlog;
+  guint               n_shards;
   guint               closed : 1;
 };
 
@@ -194,6 +198,7 @@ g_socket_listener_class_init (GSocketListenerClass *klass)
                               _g_cclosure_marshal_VOID__ENUM_OBJECTv);
 
   source_quark = g_quark_from_static_string ("g-socket-listener-source");
+  shard_quark = g_quark_from_static_string ("g-socket-listener-shard");
 }
 
 static void
@@ -203,6 +208,7 @@ g_socket_listener_init (GSocketListener *listener)
   listener->priv->sockets =
     g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
   listener->priv->listen_backlog = 10;
+  listener->priv->n_shards = 1;
 }
 
 /**
@@ -236,6 +242,118 @@ check_listener (GSocketListener *listener,
   return TRUE;
 }
 
+static gboolean
+is_shardable (GSocketListener *listener,
+              GSocket         *socket)
+{
+  GSocketFamily family = g_socket_get_family (socket);
+
+  return listener->priv->n_shards > 1 &&
+         g_socket_get_socket_type (socket) == G_SOCKET_TYPE_STREAM &&
+         (family == G_SOCKET_FAMILY_IPV4 || family == G_SOCKET_FAMILY_IPV6);
+}
+
+/* With several shards, each TCP address is listened on by one socket per
+ * shard, all with SO_REUSEPORT so that the kernel spreads the incoming
+ * connections between them. This is called on the first socket, before
+ * it is bound.
+ *
+ * The shard sockets are non-blocking: a connection may be reset between
+ * the wakeup and accept(), which must then not block the shard's thread,
+ * as stopping the service waits for it. */
+static void
+prepare_shard_socket (GSocketListener *listener,
+                      GSocket         *socket)
+{
+  if (is_shardable (listener, socket))
+    {
+      g_socket_set_reuse_port (socket, TRUE);
+      g_socket_set_blocking (socket, FALSE);
+    }
+}
+
+/* Creates the sockets for the other shards, listening on the address
+ * @socket is bound to, and adds them to @shard_sockets */
+static gboolean
+create_shard_sockets (GSocketListener  *listener,
+                      GSocket          *socket,
+                      GObject          *source_object,
+                      GPtrArray        *shard_sockets,
+                      GError          **error)
+{
+  GSocketAddress *address;
+  guint i;
+
+  if (!is_shardable (listener, socket))
+    return TRUE;
+
+  address = g_socket_get_local_address (socket, error);
+  if (address == NULL)
+    return FALSE;
+
+  for (i = 1; i < listener->priv->n_shards; i++)
+    {
+      GSocket *shard_socket;
+
+      shard_socket = g_socket_new (g_socket_get_family (socket),
+                                   G_SOCKET_TYPE_STREAM,
+                                   g_socket_get_protocol (socket),
+                                   error);
+      if (shard_socket == NULL)
+        {
+          g_object_unref (address);
+          return FALSE;
+        }
+
+      g_ptr_array_add (shard_sockets, shard_socket);
+      g_socket_set_listen_backlog (shard_socket, listener->priv->listen_backlog);
+      g_socket_set_reuse_port (shard_socket, TRUE);
+      g_socket_set_blocking (shard_socket, FALSE);
+
+      g_signal_emit (listener, signals[EVENT], 0,
+                     G_SOCKET_LISTENER_BINDING, shard_socket);
+
+      if (!g_socket_bind (shard_socket, address, TRUE, error))
+        {
+          g_object_unref (address);
+          return FALSE;
+        }
+
+      g_signal_emit (listener, signals[EVENT], 0,
+                     G_SOCKET_LISTENER_BOUND, shard_socket);
+      g_signal_emit (listener, signals[EVENT], 0,
+                     G_SOCKET_LISTENER_LISTENING, shard_socket);
+
+      if (!g_socket_listen (shard_socket, error))
+        {
+          g_object_unref (address);
+          return FALSE;
+        }
+
+      g_signal_emit (listener, signals[EVENT], 0,
+                     G_SOCKET_LISTENER_LISTENED, shard_socket);
+
+      g_object_set_qdata (G_OBJECT (shard_socket), shard_quark, GUINT_TO_POINTER (i));
+      if (source_object)
+        g_object_set_qdata_full (G_OBJECT (shard_socket), source_quark,
+                                 g_object_ref (source_object), g_object_unref);
+    }
+
+  g_object_unref (address);
+
+  return TRUE;
+}
+
+static void
+add_shard_sockets (GSocketListener *listener,
+                   GPtrArray       *shard_sockets)
+{
+  guint i;
+
+  for (i = 0; i < shard_sockets->len; i++)
+    g_ptr_array_add (listener->priv->sockets, g_object_ref (shard_sockets->pdata[i]));
+}
+
 /**
  * g_socket_listener_add_socket:
  * @listener: a #GSocketListener
@@ -343,6 +461,7 @@ g_socket_listener_add_address (GSocketListener  *listener,
   GSocketAddress *local_address;
   GSocketFamily family;
   GSocket *socket;
+  g_autoptr(GPtrArray) shard_sockets = NULL;
 
   if (!check_listener (listener, error))
     return FALSE;
@@ -354,6 +473,8 @@ g_socket_listener_add_address (GSocketListener  *listener,
 
   g_socket_set_listen_backlog (socket, listener->priv->listen_backlog);
 
+  prepare_shard_socket (listener, socket);
+
   g_signal_emit (listener, signals[EVENT], 0,
                  G_SOCKET_LISTENER_BINDING, socket);
 
@@ -377,6 +498,13 @@ g_socket_listener_add_address (GSocketListener  *listener,
   g_signal_emit (listener, signals[EVENT], 0,
                  G_SOCKET_LISTENER_LISTENED, socket);
 
+  shard_sockets = g_ptr_array_new_with_free_func (g_object_unref);
+  if (!create_shard_sockets (listener, socket, source_object, shard_sockets, error))
+    {
+      g_object_unref (socket);
+      return FALSE;
+    }
+
   local_address = NULL;
   if (effective_address)
     {
@@ -388,6 +516,9 @@ g_socket_listener_add_address (GSocketListener  *listener,
 	}
     }
 
+  /* Added first, so that there is a single ::changed for all of them */
+  add_shard_sockets (listener, shard_sockets);
+
   if (!g_socket_listener_add_socket (listener, socket,
 				     source_object,
 				     error))
@@ -439,6 +570,7 @@ g_socket_listener_add_inet_port (GSocketListener  *listener,
   gboolean need_ipv4_socket = TRUE;
   GSocket *socket4 = NULL;
   GSocket *socket6;
+  g_autoptr(GPtrArray) shard_sockets = NULL;
 
   g_return_val_if_fail (listener != NULL, FALSE);
   g_return_val_if_fail (port != 0, FALSE);
@@ -446,6 +578,8 @@ g_socket_listener_add_inet_port (GSocketListener  *listener,
   if (!check_listener (listener, error))
     return FALSE;
 
+  shard_sockets = g_ptr_array_new_with_free_func (g_object_unref);
+
   /* first try to create an IPv6 socket */
   socket6 = g_socket_new (G_SOCKET_FAMILY_IPV6,
                           G_SOCKET_TYPE_STREAM,
@@ -470,6 +604,8 @@ g_socket_listener_add_inet_port (GSocketListener  *listener,
       g_signal_emit (listener, signals[EVENT], 0,
                      G_SOCKET_LISTENER_BINDING, socket6);
 
+      prepare_shard_socket (listener, socket6);
+
       if (!g_socket_bind (socket6, address, TRUE, error))
         {
           g_object_unref (address);
@@ -493,6 +629,12 @@ g_socket_listener_add_inet_port (GSocketListener  *listener,
       g_signal_emit (listener, signals[EVENT], 0,
                      G_SOCKET_LISTENER_LISTENED, socket6);
 
+      if (!create_shard_sockets (listener, socket6, source_object, shard_sockets, error))
+        {
+          g_object_unref (socket6);
+          return FALSE;
+        }
+
       if (source_object)
         g_object_set_qdata_full (G_OBJECT (socket6), source_quark,
                                  g_object_ref (source_object),
@@ -537,6 +679,8 @@ g_socket_listener_add_inet_port (GSocketListener  *listener,
           g_signal_emit (listener, signals[EVENT], 0,
                          G_SOCKET_LISTENER_BINDING, socket4);
 
+          prepare_shard_socket (listener, socket4);
+
           if (!g_socket_bind (socket4, address, TRUE, error))
             {
               g_object_unref (address);
@@ -566,6 +710,15 @@ g_socket_listener_add_inet_port (GSocketListener  *listener,
           g_signal_emit (listener, signals[EVENT], 0,
                          G_SOCKET_LISTENER_LISTENED, socket4);
 
+          if (!create_shard_sockets (listener, socket4, source_object, shard_sockets, error))
+            {
+              g_object_unref (socket4);
+              if (socket6 != NULL)
+                g_object_unref (socket6);
+
+              return FALSE;
+            }
+
           if (source_object)
             g_object_set_qdata_full (G_OBJECT (socket4), source_quark,
                                      g_object_ref (source_object),
@@ -592,6 +745,8 @@ g_socket_listener_add_inet_port (GSocketListener  *listener,
   if (socket4 != NULL)
     g_ptr_array_add (listener->priv->sockets, socket4);
 
+  add_shard_sockets (listener, shard_sockets);
+
   if (G_SOCKET_LISTENER_GET_CLASS (listener)->changed)
     G_SOCKET_LISTENER_GET_CLASS (listener)->changed (listener);
 
@@ -1026,6 +1181,76 @@ g_socket_listener_close (GSocketListener *listener)
   listener->priv->closed = TRUE;
 }
 
+/*
+ * g_socket_listener_set_shards:
+ * @listener: a #GSocketListener
+ * @n_shards: the number of shards
+ *
+ * Makes @listener listen on each TCP address it is given afterwards with
+ * @n_shards sockets, sharing the address with `SO_REUSEPORT`, so that the
+ * kernel spreads the incoming connections between them. Each of these
+ * sockets belongs to one shard, see g_socket_listener_get_shard_sockets().
+ * Other sockets belong to shard 0.
+ *
+ * This does nothing where `SO_REUSEPORT` is not available.
+ */
+void
+g_socket_listener_set_shards (GSocketListener *listener,
+                              guint            n_shards)
+{
+  g_return_if_fail (G_IS_SOCKET_LISTENER (listener));
+  g_return_if_fail (n_shards > 0);
+
+#ifdef SO_REUSEPORT
+  listener->priv->n_shards = n_shards;
+#endif
+}
+
+/*
+ * g_socket_listener_get_shard_sockets:
+ * @listener: a #GSocketListener
+ * @shard: the shard to get the sockets of
+ *
+ * Gets the sockets of @listener that belong to @shard.
+ *
+ * Returns: (transfer full) (element-type GSocket): the sockets
+ */
+GPtrArray *
+g_socket_listener_get_shard_sockets (GSocketListener *listener,
+                                     guint            shard)
+{
+  GPtrArray *sockets;
+  GSocket *socket;
+  guint i;
+
+  g_return_val_if_fail (G_IS_SOCKET_LISTENER (listener), NULL);
+
+  sockets = g_ptr_array_new_with_free_func (g_object_unref);
+  for (i = 0; i < listener->priv->sockets->len; i++)
+    {
+      socket = listener->priv->sockets->pdata[i];
+
+      if (GPOINTER_TO_UINT (g_object_get_qdata (G_OBJECT (socket), shard_quark)) == shard)
+        g_ptr_array_add (sockets, g_object_ref (socket));
+    }
+
+  return sockets;
+}
+
+/*
+ * g_socket_listener_get_source_object:
+ * @socket: one of the sockets of a #GSocketListener
+ *
+ * Gets the source object @socket was added to its listener with.
+ *
+ * Returns: (transfer none) (nullable): the source object
+ */
+GObject *
+g_socket_listener_get_source_object (GSocket *socket)
+{
+  return g_object_get_qdata (G_OBJECT (socket), source_quark);
+}
+
 /**
  * g_socket_listener_add_any_inet_port:
  * @listener: a #GSocketListener
@@ -1058,6 +1283,7 @@ g_socket_listener_add_any_inet_port (GSocketListener  *listener,
   GSocket *socket6 = NULL;
   GSocket *socket4 = NULL;
   gint attempts = 37;
+  g_autoptr(GPtrArray) shard_sockets = NULL;
 
   /*
    * multi-step process:
@@ -1093,6 +1319,7 @@ g_socket_listener_add_any_inet_port (GSocketListener  *listener,
           g_signal_emit (listener, signals[EVENT], 0,
                          G_SOCKET_LISTENER_BINDING, socket6);
 
+          prepare_shard_socket (listener, socket6);
           result = g_socket_bind (socket6, address, TRUE, error);
           g_object_unref (address);
 
@@ -1154,6 +1381,7 @@ g_socket_listener_add_any_inet_port (GSocketListener  *listener,
        * port number AND we have more attempts to try, then ignore the
        * error for now".
        */
+      prepare_shard_socket (listener, socket4);
       result = g_socket_bind (socket4, address, TRUE,
                               (candidate_port && attempts) ? NULL : error);
       g_object_unref (address);
@@ -1220,6 +1448,8 @@ g_socket_listener_add_any_inet_port (GSocketListener  *listener,
                                               sockets_to_close);
     }
 
+  shard_sockets = g_ptr_array_new_with_free_func (g_object_unref);
+
   /* now we actually listen() the sockets and add them to the listener */
   if (socket6 != NULL)
     {
@@ -1240,6 +1470,15 @@ g_socket_listener_add_any_inet_port (GSocketListener  *listener,
       g_signal_emit (listener, signals[EVENT], 0,
                      G_SOCKET_LISTENER_LISTENED, socket6);
 
+      if (!create_shard_sockets (listener, socket6, source_object, shard_sockets, error))
+        {
+          g_object_unref (socket6);
+          if (socket4)
+            g_object_unref (socket4);
+
+          return 0;
+        }
+
       if (source_object)
         g_object_set_qdata_full (G_OBJECT (socket6), source_quark,
                                  g_object_ref (source_object),
@@ -1267,6 +1506,12 @@ g_socket_listener_add_any_inet_port (GSocketListener  *listener,
       g_signal_emit (listener, signals[EVENT], 0,
                      G_SOCKET_LISTENER_LISTENED, socket4);
 
+      if (!create_shard_sockets (listener, socket4, source_object, shard_sockets, error))
+        {
+          g_object_unref (socket4);
+          return 0;
+        }
+
       if (source_object)
         g_object_set_qdata_full (G_OBJECT (socket4), source_quark,
                                  g_object_ref (source_object),
@@ -1275,6 +1520,8 @@ g_socket_listener_add_any_inet_port (GSocketListener  *listener,
       g_ptr_array_add (listener->priv->sockets, socket4);
     }
 
+  add_shard_sockets (listener, shard_sockets);
+
   if ((socket4 != NULL || socket6 != NULL) &&
       G_SOCKET_LISTENER_GET_CLASS (listener)->changed)
     G_SOCKET_LISTENER_GET_CLASS (listener)->changed (listener);
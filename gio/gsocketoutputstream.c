@@ -137,6 +137,23 @@ g_socket_output_stream_write (GOutputStream  *stream,
 				      cancellable, error);
 }
 
+static gssize
+g_socket_output_stream_write_bytes (GOutputStream  *stream,
+                                    GBytes         *bytes,
+                                    GCancellable   *cancellable,
+                                    GError        **error)
+{
+  GSocketOutputStream *output_stream = G_SOCKET_OUTPUT_STREAM (stream);
+
+  /* Let the socket keep a reference on @bytes rather than copy them */
+  if (g_socket_get_zerocopy (output_stream->priv->socket))
+    return g_socket_send_bytes_with_blocking (output_stream->priv->socket, bytes, TRUE,
+                                              cancellable, error);
+
+  return G_OUTPUT_STREAM_CLASS (g_socket_output_stream_parent_class)->write_bytes (stream, bytes,
+                                                                                  cancellable, error);
+}
+
 static gboolean
 g_socket_output_stream_writev (GOutputStream        *stream,
                                const GOutputVector  *vectors,
@@ -247,6 +264,7 @@ g_socket_output_stream_class_init (GSocketOutputStreamClass *klass)
 
   goutputstream_class->write_fn = g_socket_output_stream_write;
   goutputstream_class->writev_fn = g_socket_output_stream_writev;
+  goutputstream_class->write_bytes = g_socket_output_stream_write_bytes;
 
   g_object_class_install_property (gobject_class, PROP_SOCKET,
 				   g_param_spec_object ("socket",
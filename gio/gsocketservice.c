@@ -56,6 +56,18 @@
  * service are thread-safe so these can be used from threads that
  * handle incoming clients.
  *
+ * For services handling many short connections, the #GSocketService:shards
+ * property can be set to create the service in sharded mode. Each TCP
+ * address is then listened on by that many sockets, sharing the address
+ * with `SO_REUSEPORT` so that the kernel spreads the incoming connections
+ * between them, and each socket is serviced by its own thread running its
+ * own #GMainContext. When woken up, a shard accepts all the pending
+ * connections of its socket, up to a limit, instead of one per main loop
+ * iteration. In this mode, #GSocketService::incoming is emitted in the
+ * thread of the shard, with its #GMainContext as the
+ * [thread-default context][g-main-context-push-thread-default-context],
+ * so handlers must be thread-safe.
+ *
  * Since: 2.22
  */
 
@@ -65,12 +77,27 @@
 #include <gio/gio.h>
 #include "gsocketlistener.h"
 #include "gsocketconnection.h"
+#include "gioprivate.h"
 #include "glibintl.h"
 #include "gmarshal-internal.h"
 
+/* The maximum number of connections accepted by a shard per wakeup, so
+ * that a busy socket does not starve the other sources of its shard */
+#define SHARD_ACCEPT_BATCH_SIZE 32
+
+typedef struct
+{
+  GMainContext *context;  /* (owned) (nullable) */
+  GMainLoop *loop;  /* (owned) (nullable) */
+  GThread *thread;  /* (owned) (nullable) */
+  GList *sources;  /* (owned) (element-type GSource) */
+} GSocketServiceShard;
+
 struct _GSocketServicePrivate
 {
   GCancellable *cancellable;
+  guint n_shards;
+  GSocketServiceShard *shards;  /* (nullable), only when n_shards > 1 */
   guint active : 1;
   guint outstanding_accept : 1;
 };
@@ -84,12 +111,14 @@ G_DEFINE_TYPE_WITH_PRIVATE (GSocketService, g_socket_service, G_TYPE_SOCKET_LIST
 enum
 {
   PROP_0,
-  PROP_ACTIVE
+  PROP_ACTIVE,
+  PROP_SHARDS
 };
 
 static void g_socket_service_ready (GObject      *object,
 				    GAsyncResult *result,
 				    gpointer      user_data);
+static void shards_update (GSocketService *service);
 
 static gboolean
 g_socket_service_real_incoming (GSocketService    *service,
@@ -104,14 +133,73 @@ g_socket_service_init (GSocketService *service)
 {
   service->priv = g_socket_service_get_instance_private (service);
   service->priv->cancellable = g_cancellable_new ();
+  service->priv->n_shards = 1;
   service->priv->active = TRUE;
 }
 
+static void
+g_socket_service_constructed (GObject *object)
+{
+  GSocketService *service = G_SOCKET_SERVICE (object);
+
+  G_OBJECT_CLASS (g_socket_service_parent_class)->constructed (object);
+
+  if (service->priv->n_shards > 1)
+    {
+      service->priv->shards = g_new0 (GSocketServiceShard, service->priv->n_shards);
+      g_socket_listener_set_shards (G_SOCKET_LISTENER (service),
+                                    service->priv->n_shards);
+    }
+}
+
+static gboolean
+shard_quit_cb (gpointer user_data)
+{
+  GMainLoop *loop = user_data;
+
+  g_main_loop_quit (loop);
+
+  return G_SOURCE_REMOVE;
+}
+
 static void
 g_socket_service_finalize (GObject *object)
 {
   GSocketService *service = G_SOCKET_SERVICE (object);
+  guint i;
+
+  for (i = 0; service->priv->shards != NULL && i < service->priv->n_shards; i++)
+    {
+      GSocketServiceShard *shard = &service->priv->shards[i];
+      GSource *source;
+
+      /* The sources hold a reference on the service, so they are all
+       * destroyed by now */
+      g_list_free_full (shard->sources, (GDestroyNotify) g_source_unref);
+
+      if (shard->thread == NULL)
+        continue;
+
+      /* Quit from within the loop, in case it is not running yet */
+      source = g_idle_source_new ();
+      g_source_set_callback (source, shard_quit_cb,
+                             g_main_loop_ref (shard->loop),
+                             (GDestroyNotify) g_main_loop_unref);
+      g_source_attach (source, shard->context);
+      g_source_unref (source);
+
+      /* The last reference may be dropped by one of the shards, which then
+       * exits on its own */
+      if (shard->thread != g_thread_self ())
+        g_thread_join (shard->thread);
+      else
+        g_thread_unref (shard->thread);
+
+      g_main_loop_unref (shard->loop);
+      g_main_context_unref (shard->context);
+    }
 
+  g_free (service->priv->shards);
   g_object_unref (service->priv->cancellable);
 
   G_OBJECT_CLASS (g_socket_service_parent_class)
@@ -153,7 +241,9 @@ set_active (GSocketService *service, gboolean active)
       service->priv->active = active;
       notify = TRUE;
 
-      if (active)
+      if (service->priv->shards != NULL)
+        shards_update (service);
+      else if (active)
         {
           if (service->priv->outstanding_accept)
             g_cancellable_cancel (service->priv->cancellable);
@@ -186,6 +276,9 @@ g_socket_service_get_property (GObject    *object,
     case PROP_ACTIVE:
       g_value_set_boolean (value, get_active (service));
       break;
+    case PROP_SHARDS:
+      g_value_set_uint (value, service->priv->n_shards);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -205,6 +298,9 @@ g_socket_service_set_property (GObject      *object,
     case PROP_ACTIVE:
       set_active (service, g_value_get_boolean (value));
       break;
+    case PROP_SHARDS:
+      service->priv->n_shards = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -218,7 +314,9 @@ g_socket_service_changed (GSocketListener *listener)
 
   G_LOCK (active);
 
-  if (service->priv->active)
+  if (service->priv->shards != NULL)
+    shards_update (service);
+  else if (service->priv->active)
     {
       if (service->priv->outstanding_accept)
 	g_cancellable_cancel (service->priv->cancellable);
@@ -250,6 +348,25 @@ g_socket_service_is_active (GSocketService *service)
   return get_active (service);
 }
 
+/**
+ * g_socket_service_get_shards:
+ * @service: a #GSocketService
+ *
+ * Gets the number of shards @service was created with, see
+ * #GSocketService:shards.
+ *
+ * Returns: the number of shards
+ *
+ * Since: 2.76
+ */
+guint
+g_socket_service_get_shards (GSocketService *service)
+{
+  g_return_val_if_fail (G_IS_SOCKET_SERVICE (service), 1);
+
+  return service->priv->n_shards;
+}
+
 /**
  * g_socket_service_start:
  * @service: a #GSocketService
@@ -320,6 +437,7 @@ g_socket_service_class_init (GSocketServiceClass *class)
   GObjectClass *gobject_class = G_OBJECT_CLASS (class);
   GSocketListenerClass *listener_class = G_SOCKET_LISTENER_CLASS (class);
 
+  gobject_class->constructed = g_socket_service_constructed;
   gobject_class->finalize = g_socket_service_finalize;
   gobject_class->set_property = g_socket_service_set_property;
   gobject_class->get_property = g_socket_service_get_property;
@@ -369,6 +487,26 @@ g_socket_service_class_init (GSocketServiceClass *class)
                                                          P_("Whether the service is currently accepting connections"),
                                                          TRUE,
                                                          G_PARAM_CONSTRUCT | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GSocketService:shards:
+   *
+   * The number of sockets listening on each TCP address, each serviced
+   * by its own thread. With the default of 1, the service runs in the
+   * thread-default context of the thread it is created in. See the
+   * #GSocketService documentation for the sharded mode.
+   *
+   * Sharding relies on `SO_REUSEPORT`; where it is not available, only
+   * one socket listens on each address, in the thread of the first shard.
+   *
+   * Since: 2.76
+   */
+  g_object_class_install_property (gobject_class, PROP_SHARDS,
+                                   g_param_spec_uint ("shards",
+                                                      P_("Shards"),
+                                                      P_("The number of sockets listening on each TCP address"),
+                                                      1, G_MAXUINT, 1,
+                                                      G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 }
 
 static void
@@ -407,6 +545,126 @@ g_socket_service_ready (GObject      *object,
   G_UNLOCK (active);
 }
 
+static gboolean
+shard_accept_cb (GSocket      *socket,
+                 GIOCondition  condition,
+                 gpointer      user_data)
+{
+  GSocketService *service = user_data;
+  GSource *source = g_main_current_source ();
+  gboolean blocking;
+  guint i;
+
+  if ((condition & (G_IO_NVAL | G_IO_HUP | G_IO_ERR)) != 0 ||
+      g_socket_is_closed (socket))
+    return G_SOURCE_REMOVE;
+
+  blocking = g_socket_get_blocking (socket);
+
+  /* Accept the whole backlog rather than one connection per wakeup, until
+   * the socket has nothing left. Stopping the service destroys the source
+   * from another thread, which is checked here instead of the active
+   * state, so that the shards don't contend on the active lock. */
+  for (i = 0; i < SHARD_ACCEPT_BATCH_SIZE && !g_source_is_destroyed (source); i++)
+    {
+      GSocketConnection *connection;
+      GSocket *client;
+      GError *error = NULL;
+
+      /* The sockets the listener created for the shards are non-blocking,
+       * the ones the caller added keep their mode and are polled first */
+      if (blocking && g_socket_condition_check (socket, G_IO_IN) == 0)
+        break;
+
+      client = g_socket_accept (socket, NULL, &error);
+      if (client == NULL)
+        {
+          /* Errors here are about a single connection (it was aborted
+           * before we got to it), or a lack of resources (too many open
+           * files) which may be gone by the next wakeup; neither is worth
+           * a warning. A socket which can't accept at all is caught by the
+           * condition check above. */
+          if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK))
+            g_debug ("Error accepting connection: %s", error->message);
+          g_error_free (error);
+          break;
+        }
+
+      connection = g_socket_connection_factory_create_connection (client);
+      g_object_unref (client);
+
+      g_socket_service_incoming (service, connection,
+                                 g_socket_listener_get_source_object (socket));
+      g_object_unref (connection);
+    }
+
+  return G_SOURCE_CONTINUE;
+}
+
+static gpointer
+shard_thread_func (gpointer user_data)
+{
+  GMainLoop *loop = user_data;
+  GMainContext *context = g_main_loop_get_context (loop);
+
+  g_main_context_push_thread_default (context);
+  g_main_loop_run (loop);
+  g_main_context_pop_thread_default (context);
+
+  g_main_loop_unref (loop);
+
+  return NULL;
+}
+
+/* Called with the active lock held, after the sockets or the active state
+ * changed. Replaces the sources of each shard. */
+static void
+shards_update (GSocketService *service)
+{
+  guint i, j;
+
+  for (i = 0; i < service->priv->n_shards; i++)
+    {
+      GSocketServiceShard *shard = &service->priv->shards[i];
+      GPtrArray *sockets;
+
+      while (shard->sources != NULL)
+        {
+          g_source_destroy (shard->sources->data);
+          g_source_unref (shard->sources->data);
+          shard->sources = g_list_delete_link (shard->sources, shard->sources);
+        }
+
+      if (!service->priv->active)
+        continue;
+
+      sockets = g_socket_listener_get_shard_sockets (G_SOCKET_LISTENER (service), i);
+
+      if (sockets->len > 0 && shard->thread == NULL)
+        {
+          shard->context = g_main_context_new ();
+          shard->loop = g_main_loop_new (shard->context, FALSE);
+          shard->thread = g_thread_new ("gsocketservice",
+                                        shard_thread_func,
+                                        g_main_loop_ref (shard->loop));
+        }
+
+      for (j = 0; j < sockets->len; j++)
+        {
+          GSource *source;
+
+          source = g_socket_create_source (sockets->pdata[j], G_IO_IN, NULL);
+          g_source_set_callback (source, (GSourceFunc) shard_accept_cb,
+                                 g_object_ref (service), g_object_unref);
+          g_source_attach (source, shard->context);
+
+          shard->sources = g_list_prepend (shard->sources, source);
+        }
+
+      g_ptr_array_unref (sockets);
+    }
+}
+
 /**
  * g_socket_service_new:
  *
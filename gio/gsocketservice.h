@@ -88,6 +88,8 @@ GIO_AVAILABLE_IN_ALL
 void            g_socket_service_stop      (GSocketService *service);
 GIO_AVAILABLE_IN_ALL
 gboolean        g_socket_service_is_active (GSocketService *service);
+GIO_AVAILABLE_IN_2_76
+guint           g_socket_service_get_shards (GSocketService *service);
 
 
 G_END_DECLS
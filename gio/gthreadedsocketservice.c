@@ -44,6 +44,16 @@
  *
  * As with #GSocketService, you may connect to #GThreadedSocketService::run,
  * or subclass and override the default handler.
+ *
+ * The #GSocketService:shards property may be set to accept connections
+ * from several sockets and threads as well, which helps when connections
+ * arrive faster than a single thread can accept them:
+ * |[<!-- language="C" -->
+ * service = g_object_new (G_TYPE_THREADED_SOCKET_SERVICE,
+ *                         "max-threads", 64,
+ *                         "shards", 4,
+ *                         NULL);
+ * ]|
  */
 
 #include "config.h"
@@ -0,0 +1,287 @@
+/* GIO - GLib Input, Output and Streaming Library
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gudpsegmentmessage
+ * @title: GUdpSegmentMessage
+ * @short_description: A GSocketControlMessage containing a UDP segment size
+ * @include: gio/gio.h
+ * @see_also: #GSocket, #GSocketControlMessage
+ *
+ * This #GSocketControlMessage carries the segment size used by UDP
+ * segmentation offload, which lets a single call send or receive many
+ * datagrams of the same size in one buffer. It is only supported on
+ * Linux; see g_udp_segment_message_is_supported().
+ *
+ * When sent with g_socket_send_message() on a %G_SOCKET_TYPE_DATAGRAM
+ * socket, the message's buffer is split by the kernel (or the network
+ * card) into datagrams of the given segment size, the last of which may
+ * be shorter. This overrides, for that call only, the segment size set
+ * with g_socket_set_udp_segment_size().
+ *
+ * When g_socket_set_udp_gro() has been enabled on a socket, the kernel
+ * may coalesce several datagrams from the same sender into one buffer.
+ * A #GUdpSegmentMessage is then returned by g_socket_receive_message()
+ * with the size of each datagram in the buffer, the last of which may
+ * be shorter.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include "gudpsegmentmessage.h"
+#include "gnetworkingprivate.h"
+
+#include "glibintl.h"
+
+struct _GUdpSegmentMessage
+{
+  GSocketControlMessage parent_instance;
+
+  guint segment_size;
+};
+
+struct _GUdpSegmentMessageClass
+{
+  GSocketControlMessageClass parent_class;
+};
+
+enum
+{
+  PROP_0,
+  PROP_SEGMENT_SIZE
+};
+
+G_DEFINE_TYPE (GUdpSegmentMessage, g_udp_segment_message, G_TYPE_SOCKET_CONTROL_MESSAGE)
+
+static gsize
+g_udp_segment_message_get_size (GSocketControlMessage *message)
+{
+#ifdef __linux__
+  return sizeof (guint16);
+#else
+  return 0;
+#endif
+}
+
+static int
+g_udp_segment_message_get_level (GSocketControlMessage *message)
+{
+#ifdef __linux__
+  return SOL_UDP;
+#else
+  return 0;
+#endif
+}
+
+static int
+g_udp_segment_message_get_msg_type (GSocketControlMessage *message)
+{
+#ifdef __linux__
+  return UDP_SEGMENT;
+#else
+  return 0;
+#endif
+}
+
+static GSocketControlMessage *
+g_udp_segment_message_deserialize (gint     level,
+                                   gint     type,
+                                   gsize    size,
+                                   gpointer data)
+{
+#ifdef __linux__
+  int segment_size;
+
+  /* Received with UDP_GRO, as an int */
+  if (level != SOL_UDP || type != UDP_GRO)
+    return NULL;
+
+  if (size != sizeof (int))
+    {
+      g_warning ("Expected a UDP segment size of %" G_GSIZE_FORMAT " bytes but "
+                 "got %" G_GSIZE_FORMAT " bytes of data",
+                 sizeof (int), size);
+      return NULL;
+    }
+
+  memcpy (&segment_size, data, sizeof (int));
+  if (segment_size <= 0)
+    return NULL;
+
+  return g_udp_segment_message_new (segment_size);
+#else
+  return NULL;
+#endif
+}
+
+static void
+g_udp_segment_message_serialize (GSocketControlMessage *_message,
+                                 gpointer               data)
+{
+#ifdef __linux__
+  GUdpSegmentMessage *message = G_UDP_SEGMENT_MESSAGE (_message);
+  guint16 segment_size = message->segment_size;
+
+  /* Sent with UDP_SEGMENT, as a 16-bit value */
+  memcpy (data, &segment_size, sizeof (guint16));
+#endif
+}
+
+static void
+g_udp_segment_message_init (GUdpSegmentMessage *message)
+{
+}
+
+static void
+g_udp_segment_message_get_property (GObject    *object,
+                                    guint       prop_id,
+                                    GValue     *value,
+                                    GParamSpec *pspec)
+{
+  GUdpSegmentMessage *message = G_UDP_SEGMENT_MESSAGE (object);
+
+  switch (prop_id)
+    {
+    case PROP_SEGMENT_SIZE:
+      g_value_set_uint (value, message->segment_size);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+g_udp_segment_message_set_property (GObject      *object,
+                                    guint         prop_id,
+                                    const GValue *value,
+                                    GParamSpec   *pspec)
+{
+  GUdpSegmentMessage *message = G_UDP_SEGMENT_MESSAGE (object);
+
+  switch (prop_id)
+    {
+    case PROP_SEGMENT_SIZE:
+      message->segment_size = g_value_get_uint (value);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+g_udp_segment_message_class_init (GUdpSegmentMessageClass *class)
+{
+  GSocketControlMessageClass *scm_class;
+  GObjectClass *gobject_class;
+
+  gobject_class = G_OBJECT_CLASS (class);
+  gobject_class->get_property = g_udp_segment_message_get_property;
+  gobject_class->set_property = g_udp_segment_message_set_property;
+
+  scm_class = G_SOCKET_CONTROL_MESSAGE_CLASS (class);
+  scm_class->get_size = g_udp_segment_message_get_size;
+  scm_class->get_level = g_udp_segment_message_get_level;
+  scm_class->get_type = g_udp_segment_message_get_msg_type;
+  scm_class->serialize = g_udp_segment_message_serialize;
+  scm_class->deserialize = g_udp_segment_message_deserialize;
+
+  /**
+   * GUdpSegmentMessage:segment-size:
+   *
+   * The size of each datagram, in bytes.
+   *
+   * Since: 2.76
+   */
+  g_object_class_install_property (gobject_class,
+                                   PROP_SEGMENT_SIZE,
+                                   g_param_spec_uint ("segment-size",
+                                                      P_("Segment size"),
+                                                      P_("The size of each datagram"),
+                                                      1, G_MAXUINT16, 1,
+                                                      G_PARAM_READABLE |
+                                                      G_PARAM_WRITABLE |
+                                                      G_PARAM_CONSTRUCT_ONLY |
+                                                      G_PARAM_STATIC_STRINGS));
+}
+
+/**
+ * g_udp_segment_message_is_supported:
+ *
+ * Checks if UDP segmentation offload is supported on this platform.
+ * Even if it is, the running kernel may be too old for it, in which
+ * case g_socket_set_udp_segment_size() and g_socket_set_udp_gro() fail
+ * with %G_IO_ERROR_NOT_SUPPORTED.
+ *
+ * Returns: %TRUE if supported, %FALSE otherwise
+ *
+ * Since: 2.76
+ */
+gboolean
+g_udp_segment_message_is_supported (void)
+{
+#ifdef __linux__
+  return TRUE;
+#else
+  return FALSE;
+#endif
+}
+
+/**
+ * g_udp_segment_message_new:
+ * @segment_size: the size of each datagram, between 1 and 65535
+ *
+ * Creates a new #GUdpSegmentMessage with the given segment size.
+ *
+ * Returns: a new #GUdpSegmentMessage
+ *
+ * Since: 2.76
+ */
+GSocketControlMessage *
+g_udp_segment_message_new (guint segment_size)
+{
+  g_return_val_if_fail (segment_size > 0 && segment_size <= G_MAXUINT16, NULL);
+
+  return g_object_new (G_TYPE_UDP_SEGMENT_MESSAGE,
+                       "segment-size", segment_size,
+                       NULL);
+}
+
+/**
+ * g_udp_segment_message_get_segment_size:
+ * @message: a #GUdpSegmentMessage
+ *
+ * Gets the size of each datagram in the buffer that @message came
+ * with, or that it is sent with.
+ *
+ * Returns: the segment size, in bytes
+ *
+ * Since: 2.76
+ */
+guint
+g_udp_segment_message_get_segment_size (GUdpSegmentMessage *message)
+{
+  g_return_val_if_fail (G_IS_UDP_SEGMENT_MESSAGE (message), 0);
+
+  return message->segment_size;
+}
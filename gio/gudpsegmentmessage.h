@@ -0,0 +1,52 @@
+/* GIO - GLib Input, Output and Streaming Library
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __G_UDP_SEGMENT_MESSAGE_H__
+#define __G_UDP_SEGMENT_MESSAGE_H__
+
+#if !defined (__GIO_GIO_H_INSIDE__) && !defined (GIO_COMPILATION)
+#error "Only <gio/gio.h> can be included directly."
+#endif
+
+#include <gio/giotypes.h>
+#include <gio/gsocketcontrolmessage.h>
+
+G_BEGIN_DECLS
+
+#define G_TYPE_UDP_SEGMENT_MESSAGE         (g_udp_segment_message_get_type ())
+#define G_UDP_SEGMENT_MESSAGE(o)           (G_TYPE_CHECK_INSTANCE_CAST ((o), G_TYPE_UDP_SEGMENT_MESSAGE, GUdpSegmentMessage))
+#define G_UDP_SEGMENT_MESSAGE_CLASS(c)     (G_TYPE_CHECK_CLASS_CAST ((c), G_TYPE_UDP_SEGMENT_MESSAGE, GUdpSegmentMessageClass))
+#define G_IS_UDP_SEGMENT_MESSAGE(o)        (G_TYPE_CHECK_INSTANCE_TYPE ((o), G_TYPE_UDP_SEGMENT_MESSAGE))
+#define G_IS_UDP_SEGMENT_MESSAGE_CLASS(c)  (G_TYPE_CHECK_CLASS_TYPE ((c), G_TYPE_UDP_SEGMENT_MESSAGE))
+#define G_UDP_SEGMENT_MESSAGE_GET_CLASS(o) (G_TYPE_INSTANCE_GET_CLASS ((o), G_TYPE_UDP_SEGMENT_MESSAGE, GUdpSegmentMessageClass))
+
+typedef struct _GUdpSegmentMessage      GUdpSegmentMessage;
+typedef struct _GUdpSegmentMessageClass GUdpSegmentMessageClass;
+
+GIO_AVAILABLE_IN_2_76
+GType                  g_udp_segment_message_get_type         (void) G_GNUC_CONST;
+GIO_AVAILABLE_IN_2_76
+GSocketControlMessage *g_udp_segment_message_new              (guint               segment_size);
+GIO_AVAILABLE_IN_2_76
+guint                  g_udp_segment_message_get_segment_size (GUdpSegmentMessage *message);
+GIO_AVAILABLE_IN_2_76
+gboolean               g_udp_segment_message_is_supported     (void);
+
+G_END_DECLS
+
+#endif /* __G_UDP_SEGMENT_MESSAGE_H__ */
@@ -39,9 +39,15 @@ enum {
   PROP_0,
   PROP_FORMAT,
   PROP_LEVEL,
-  PROP_FILE_INFO
+  PROP_FILE_INFO,
+  PROP_THREADS
 };
 
+/* Size of the blocks compressed in parallel, and of the dictionary each
+ * block is primed with, taken from the end of the previous block */
+#define PARALLEL_BLOCK_SIZE (128 * 1024)
+#define PARALLEL_DICTIONARY_SIZE (32 * 1024)
+
 /**
  * SECTION:gzlibcompressor
  * @short_description: Zlib compressor
@@ -49,6 +55,13 @@ enum {
  *
  * #GZlibCompressor is an implementation of #GConverter that
  * compresses data using zlib.
+ *
+ * If #GZlibCompressor:threads is set, the input is split into blocks which
+ * are compressed concurrently on a thread pool, each block being primed
+ * with the end of the previous one, and the compressed blocks are written
+ * out in order as a single stream, as pigz does. The output can be read
+ * by any decompressor, but is slightly larger than the output of serial
+ * compression, and differs from it.
  */
 
 static void g_zlib_compressor_iface_init          (GConverterIface *iface,
@@ -59,6 +72,8 @@ static void g_zlib_compressor_iface_init          (GConverterIface *iface,
  *
  * Zlib decompression
  */
+typedef struct _ParallelState ParallelState;
+
 struct _GZlibCompressor
 {
   GObject parent_instance;
@@ -68,6 +83,50 @@ struct _GZlibCompressor
   z_stream zstream;
   gz_header gzheader;
   GFileInfo *file_info;
+  guint n_threads;
+  ParallelState *parallel;  /* (owned) (nullable) */
+};
+
+typedef struct
+{
+  ParallelState *state;  /* (unowned) */
+  GBytes *input;  /* (owned) */
+  GBytes *dictionary;  /* (owned) (nullable) */
+  gboolean last;
+
+  /* Set by the worker thread, read once done is set */
+  guchar *output;
+  gsize output_len;
+  uLong checksum;
+  gboolean done;  /* (atomic) */
+} CompressJob;
+
+struct _ParallelState
+{
+  GZlibCompressorFormat format;
+  int level;
+
+  GThreadPool *pool;  /* (owned) */
+  GMutex lock;
+  GCond cond;
+
+  /* Dispatched jobs, in stream order */
+  GQueue jobs;
+  guint max_jobs;
+
+  GByteArray *block;  /* (owned) */
+  GBytes *previous_block;  /* (owned) (nullable) */
+
+  /* The header and trailer of the stream, written out before and after
+   * the output of the jobs */
+  GByteArray *extra;  /* (owned) */
+  gsize extra_pos;
+  gsize output_pos;
+
+  uLong checksum;
+  guint64 total_in;
+  gboolean last_dispatched;
+  gboolean trailer_added;
 };
 
 static void
@@ -101,6 +160,8 @@ G_DEFINE_TYPE_WITH_CODE (GZlibCompressor, g_zlib_compressor, G_TYPE_OBJECT,
 			 G_IMPLEMENT_INTERFACE (G_TYPE_CONVERTER,
 						g_zlib_compressor_iface_init))
 
+static void parallel_state_free (ParallelState *state);
+
 static void
 g_zlib_compressor_finalize (GObject *object)
 {
@@ -108,6 +169,7 @@ g_zlib_compressor_finalize (GObject *object)
 
   compressor = G_ZLIB_COMPRESSOR (object);
 
+  g_clear_pointer (&compressor->parallel, parallel_state_free);
   deflateEnd (&compressor->zstream);
 
   if (compressor->file_info)
@@ -141,6 +203,10 @@ g_zlib_compressor_set_property (GObject      *object,
       g_zlib_compressor_set_file_info (compressor, g_value_get_object (value));
       break;
 
+    case PROP_THREADS:
+      compressor->n_threads = g_value_get_uint (value);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -172,6 +238,10 @@ g_zlib_compressor_get_property (GObject    *object,
       g_value_set_object (value, compressor->file_info);
       break;
 
+    case PROP_THREADS:
+      g_value_set_uint (value, compressor->n_threads);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -266,6 +336,27 @@ g_zlib_compressor_class_init (GZlibCompressorClass *klass)
                                                        G_TYPE_FILE_INFO,
                                                        G_PARAM_READWRITE |
                                                        G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GZlibCompressor:threads:
+   *
+   * The number of threads to compress with. If 0, the data is compressed
+   * in the thread calling g_converter_convert(). Otherwise, it is split
+   * into blocks of 128 KiB which are compressed concurrently by up to
+   * that many threads.
+   *
+   * Since: 2.76
+   */
+  g_object_class_install_property (gobject_class,
+                                   PROP_THREADS,
+                                   g_param_spec_uint ("threads",
+                                                      P_("threads"),
+                                                      P_("The number of threads to compress with, or 0 to compress in the calling thread"),
+                                                      0, G_MAXUINT,
+                                                      0,
+                                                      G_PARAM_READWRITE |
+                                                      G_PARAM_CONSTRUCT_ONLY |
+                                                      G_PARAM_STATIC_STRINGS));
 }
 
 /**
@@ -352,6 +443,8 @@ g_zlib_compressor_reset (GConverter *converter)
   GZlibCompressor *compressor = G_ZLIB_COMPRESSOR (converter);
   int res;
 
+  g_clear_pointer (&compressor->parallel, parallel_state_free);
+
   res = deflateReset (&compressor->zstream);
   if (res != Z_OK)
     g_warning ("unexpected zlib error: %s", compressor->zstream.msg);
@@ -360,6 +453,382 @@ g_zlib_compressor_reset (GConverter *converter)
   g_zlib_compressor_set_gzheader (compressor);
 }
 
+static void
+compress_job_free (CompressJob *job)
+{
+  g_bytes_unref (job->input);
+  g_clear_pointer (&job->dictionary, g_bytes_unref);
+  g_free (job->output);
+  g_free (job);
+}
+
+/* Runs in the thread pool. Each block is compressed as raw deflate data,
+ * ending with a sync flush so that the blocks can be concatenated, or
+ * with the final deflate block for the last one. */
+static void
+compress_job_run (gpointer data,
+                  gpointer user_data)
+{
+  CompressJob *job = data;
+  ParallelState *state = job->state;
+  const guchar *input;
+  gsize input_len;
+  gsize output_size;
+  z_stream zstream;
+  int res;
+
+  input = g_bytes_get_data (job->input, &input_len);
+
+  memset (&zstream, 0, sizeof (zstream));
+  res = deflateInit2 (&zstream, state->level, Z_DEFLATED,
+                      -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+  if (res == Z_MEM_ERROR)
+    g_error ("GZlibCompressor: Not enough memory for zlib use");
+
+  if (job->dictionary != NULL)
+    {
+      const guchar *dictionary;
+      gsize dictionary_len;
+
+      dictionary = g_bytes_get_data (job->dictionary, &dictionary_len);
+      if (dictionary_len > PARALLEL_DICTIONARY_SIZE)
+        {
+          dictionary += dictionary_len - PARALLEL_DICTIONARY_SIZE;
+          dictionary_len = PARALLEL_DICTIONARY_SIZE;
+        }
+
+      deflateSetDictionary (&zstream, dictionary, dictionary_len);
+    }
+
+  /* Room for the sync flush marker too */
+  output_size = deflateBound (&zstream, input_len) + 16;
+  job->output = g_malloc (output_size);
+
+  zstream.next_in = (Bytef *) input;
+  zstream.avail_in = input_len;
+  zstream.next_out = job->output;
+  zstream.avail_out = output_size;
+
+  while (TRUE)
+    {
+      res = deflate (&zstream, job->last ? Z_FINISH : Z_SYNC_FLUSH);
+      if (res == Z_MEM_ERROR)
+        g_error ("GZlibCompressor: Not enough memory for zlib use");
+
+      if (res == Z_STREAM_END || (res == Z_OK && zstream.avail_out > 0))
+        break;
+
+      job->output = g_realloc (job->output, output_size * 2);
+      zstream.next_out = job->output + output_size;
+      zstream.avail_out = output_size;
+      output_size *= 2;
+    }
+
+  job->output_len = output_size - zstream.avail_out;
+  deflateEnd (&zstream);
+
+  if (state->format == G_ZLIB_COMPRESSOR_FORMAT_GZIP)
+    job->checksum = crc32 (0, input, input_len);
+  else if (state->format == G_ZLIB_COMPRESSOR_FORMAT_ZLIB)
+    job->checksum = adler32 (1, input, input_len);
+
+  g_mutex_lock (&state->lock);
+  g_atomic_int_set (&job->done, TRUE);
+  g_cond_broadcast (&state->cond);
+  g_mutex_unlock (&state->lock);
+}
+
+static void
+append_uint32_le (GByteArray *array,
+                  guint32     value)
+{
+  guint8 bytes[4] = { value & 0xff, (value >> 8) & 0xff,
+                      (value >> 16) & 0xff, (value >> 24) & 0xff };
+
+  g_byte_array_append (array, bytes, sizeof (bytes));
+}
+
+static void
+parallel_state_add_header (ParallelState *state,
+                           GFileInfo     *file_info)
+{
+  if (state->format == G_ZLIB_COMPRESSOR_FORMAT_GZIP)
+    {
+      const gchar *filename = NULL;
+      guint32 mtime = 0;
+      guint8 header[4] = { 0x1f, 0x8b, Z_DEFLATED, 0 };
+      guint8 xfl_os[2] = { 0, 0x03 /* Unix */ };
+
+      if (file_info != NULL)
+        {
+          filename = g_file_info_get_name (file_info);
+          mtime = g_file_info_get_attribute_uint64 (file_info,
+                                                    G_FILE_ATTRIBUTE_TIME_MODIFIED);
+        }
+
+      if (filename != NULL)
+        header[3] |= 0x08; /* FNAME */
+      if (state->level == 9)
+        xfl_os[0] = 2;
+      else if (state->level == 1)
+        xfl_os[0] = 4;
+
+      g_byte_array_append (state->extra, header, sizeof (header));
+      append_uint32_le (state->extra, mtime);
+      g_byte_array_append (state->extra, xfl_os, sizeof (xfl_os));
+      if (filename != NULL)
+        g_byte_array_append (state->extra, (const guint8 *) filename, strlen (filename) + 1);
+
+      state->checksum = crc32 (0, NULL, 0);
+    }
+  else if (state->format == G_ZLIB_COMPRESSOR_FORMAT_ZLIB)
+    {
+      guint header, flevel;
+      guint8 bytes[2];
+
+      if (state->level == 0 || state->level == 1)
+        flevel = 0;
+      else if (state->level >= 2 && state->level <= 5)
+        flevel = 1;
+      else if (state->level == 6 || state->level == -1)
+        flevel = 2;
+      else
+        flevel = 3;
+
+      /* 32K window, deflate, no preset dictionary */
+      header = (0x78 << 8) | (flevel << 6);
+      header += 31 - (header % 31);
+
+      bytes[0] = header >> 8;
+      bytes[1] = header & 0xff;
+      g_byte_array_append (state->extra, bytes, sizeof (bytes));
+
+      state->checksum = adler32 (0, NULL, 0);
+    }
+}
+
+static void
+parallel_state_add_trailer (ParallelState *state)
+{
+  if (state->format == G_ZLIB_COMPRESSOR_FORMAT_GZIP)
+    {
+      append_uint32_le (state->extra, state->checksum);
+      append_uint32_le (state->extra, state->total_in & 0xffffffff);
+    }
+  else if (state->format == G_ZLIB_COMPRESSOR_FORMAT_ZLIB)
+    {
+      guint8 bytes[4] = { (state->checksum >> 24) & 0xff, (state->checksum >> 16) & 0xff,
+                          (state->checksum >> 8) & 0xff, state->checksum & 0xff };
+
+      g_byte_array_append (state->extra, bytes, sizeof (bytes));
+    }
+
+  state->trailer_added = TRUE;
+}
+
+static ParallelState *
+parallel_state_new (GZlibCompressor *compressor)
+{
+  ParallelState *state;
+
+  state = g_new0 (ParallelState, 1);
+  state->format = compressor->format;
+  state->level = compressor->level;
+  g_mutex_init (&state->lock);
+  g_cond_init (&state->cond);
+  g_queue_init (&state->jobs);
+  state->max_jobs = compressor->n_threads * 2;
+  state->pool = g_thread_pool_new (compress_job_run, NULL,
+                                   compressor->n_threads, FALSE, NULL);
+  state->block = g_byte_array_sized_new (PARALLEL_BLOCK_SIZE);
+  state->extra = g_byte_array_new ();
+
+  parallel_state_add_header (state, compressor->file_info);
+
+  return state;
+}
+
+static void
+parallel_state_free (ParallelState *state)
+{
+  /* Waits for the jobs still running */
+  g_thread_pool_free (state->pool, FALSE, TRUE);
+
+  g_queue_clear_full (&state->jobs, (GDestroyNotify) compress_job_free);
+  g_byte_array_unref (state->block);
+  g_clear_pointer (&state->previous_block, g_bytes_unref);
+  g_byte_array_unref (state->extra);
+  g_cond_clear (&state->cond);
+  g_mutex_clear (&state->lock);
+  g_free (state);
+}
+
+static void
+parallel_state_dispatch (ParallelState *state,
+                         gboolean       last)
+{
+  CompressJob *job;
+
+  job = g_new0 (CompressJob, 1);
+  job->state = state;
+  job->input = g_byte_array_free_to_bytes (state->block);
+  job->dictionary = state->previous_block;
+  job->last = last;
+
+  state->previous_block = g_bytes_ref (job->input);
+  state->total_in += g_bytes_get_size (job->input);
+  state->block = g_byte_array_sized_new (PARALLEL_BLOCK_SIZE);
+  state->last_dispatched = last;
+
+  g_queue_push_tail (&state->jobs, job);
+  g_thread_pool_push (state->pool, job, NULL);
+}
+
+/* Copies as much of the stream as is ready, or as fits, to @outbuf. If
+ * @wait is set and the first job is not done, waits for it, so that
+ * something is written while the other jobs keep running. */
+static gsize
+parallel_state_drain (ParallelState *state,
+                      guchar        *outbuf,
+                      gsize          outbuf_size,
+                      gboolean       wait)
+{
+  gsize written = 0;
+
+  while (written < outbuf_size)
+    {
+      CompressJob *job;
+      gsize len;
+
+      if (state->extra_pos < state->extra->len)
+        {
+          len = MIN (state->extra->len - state->extra_pos, outbuf_size - written);
+          memcpy (outbuf + written, state->extra->data + state->extra_pos, len);
+          state->extra_pos += len;
+          written += len;
+          continue;
+        }
+
+      job = g_queue_peek_head (&state->jobs);
+      if (job == NULL)
+        break;
+
+      if (!g_atomic_int_get (&job->done))
+        {
+          if (!wait)
+            break;
+
+          g_mutex_lock (&state->lock);
+          while (!g_atomic_int_get (&job->done))
+            g_cond_wait (&state->cond, &state->lock);
+          g_mutex_unlock (&state->lock);
+        }
+
+      wait = FALSE;
+
+      len = MIN (job->output_len - state->output_pos, outbuf_size - written);
+      memcpy (outbuf + written, job->output + state->output_pos, len);
+      state->output_pos += len;
+      written += len;
+
+      if (state->output_pos == job->output_len)
+        {
+          gsize input_len = g_bytes_get_size (job->input);
+
+          if (state->format == G_ZLIB_COMPRESSOR_FORMAT_GZIP)
+            state->checksum = crc32_combine (state->checksum, job->checksum, input_len);
+          else if (state->format == G_ZLIB_COMPRESSOR_FORMAT_ZLIB)
+            state->checksum = adler32_combine (state->checksum, job->checksum, input_len);
+
+          g_queue_pop_head (&state->jobs);
+          compress_job_free (job);
+          state->output_pos = 0;
+
+          if (g_queue_is_empty (&state->jobs) && state->last_dispatched &&
+              !state->trailer_added)
+            parallel_state_add_trailer (state);
+        }
+    }
+
+  return written;
+}
+
+static gboolean
+parallel_state_is_drained (ParallelState *state)
+{
+  return g_queue_is_empty (&state->jobs) &&
+         state->extra_pos == state->extra->len;
+}
+
+static GConverterResult
+g_zlib_compressor_convert_parallel (GZlibCompressor *compressor,
+                                    const guchar    *inbuf,
+                                    gsize            inbuf_size,
+                                    guchar          *outbuf,
+                                    gsize            outbuf_size,
+                                    GConverterFlags  flags,
+                                    gsize           *bytes_read,
+                                    gsize           *bytes_written,
+                                    GError         **error)
+{
+  ParallelState *state;
+  gsize read = 0, written;
+  gboolean at_end, flush;
+
+  if (compressor->parallel == NULL)
+    compressor->parallel = parallel_state_new (compressor);
+  state = compressor->parallel;
+
+  if (outbuf_size == 0)
+    {
+      g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_NO_SPACE,
+                           _("Not enough space in destination"));
+      return G_CONVERTER_ERROR;
+    }
+
+  /* Split the input into blocks, bounding the number of blocks in flight */
+  while (read < inbuf_size && !state->last_dispatched &&
+         g_queue_get_length (&state->jobs) < state->max_jobs)
+    {
+      gsize len = MIN (inbuf_size - read, PARALLEL_BLOCK_SIZE - state->block->len);
+
+      g_byte_array_append (state->block, inbuf + read, len);
+      read += len;
+
+      if (state->block->len == PARALLEL_BLOCK_SIZE)
+        parallel_state_dispatch (state, FALSE);
+    }
+
+  at_end = (flags & G_CONVERTER_INPUT_AT_END) && read == inbuf_size;
+  flush = (flags & G_CONVERTER_FLUSH) && read == inbuf_size;
+
+  if (at_end && !state->last_dispatched)
+    parallel_state_dispatch (state, TRUE);
+  else if (flush && state->block->len > 0)
+    parallel_state_dispatch (state, FALSE);
+
+  /* Wait for a job if there is nothing else to do */
+  written = parallel_state_drain (state, outbuf, outbuf_size,
+                                  at_end || flush || read == 0);
+
+  if (read == 0 && written == 0 && !at_end && !flush)
+    {
+      g_set_error_literal (error, G_IO_ERROR, G_IO_ERROR_PARTIAL_INPUT,
+                           _("Need more input"));
+      return G_CONVERTER_ERROR;
+    }
+
+  *bytes_read = read;
+  *bytes_written = written;
+
+  if (at_end && state->trailer_added && parallel_state_is_drained (state))
+    return G_CONVERTER_FINISHED;
+  if (flush && state->block->len == 0 && parallel_state_is_drained (state))
+    return G_CONVERTER_FLUSHED;
+
+  return G_CONVERTER_CONVERTED;
+}
+
 static GConverterResult
 g_zlib_compressor_convert (GConverter *converter,
 			   const void *inbuf,
@@ -377,6 +846,12 @@ g_zlib_compressor_convert (GConverter *converter,
 
   compressor = G_ZLIB_COMPRESSOR (converter);
 
+  if (compressor->n_threads > 0)
+    return g_zlib_compressor_convert_parallel (compressor, inbuf, inbuf_size,
+                                               outbuf, outbuf_size, flags,
+                                               bytes_read, bytes_written,
+                                               error);
+
   compressor->zstream.next_in = (void *)inbuf;
   compressor->zstream.avail_in = inbuf_size;
 
@@ -27,6 +27,11 @@
 #include <stdlib.h>
 #include <string.h>
 
+#ifdef G_OS_UNIX
+#include <gio/gunixinputstream.h>
+#include <unistd.h>
+#endif
+
 static void
 test_peek (void)
 {
@@ -449,7 +454,7 @@ test_close (void)
 }
 
 static void
-test_seek (void)
+do_test_seek (gboolean readahead)
 {
   GInputStream *base;
   GInputStream *in;
@@ -459,6 +464,7 @@ test_seek (void)
 
   base = g_memory_input_stream_new_from_data ("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVXYZ", -1, NULL);
   in = g_buffered_input_stream_new_sized (base, 4);
+  g_buffered_input_stream_set_readahead (G_BUFFERED_INPUT_STREAM (in), readahead);
   error = NULL;
 
   /* Seek by read */
@@ -533,6 +539,353 @@ test_seek (void)
   g_object_unref (base);
 }
 
+static void
+test_seek (void)
+{
+  do_test_seek (FALSE);
+}
+
+static void
+test_seek_readahead (void)
+{
+  do_test_seek (TRUE);
+}
+
+static guint8 *
+create_pattern (gsize size)
+{
+  guint8 *data = g_malloc (size);
+  gsize i;
+
+  for (i = 0; i < size; i++)
+    data[i] = (i * 7 + i / 251) & 0xff;
+
+  return data;
+}
+
+static void
+test_adaptive (void)
+{
+  const gsize size = 4 * 1024 * 1024;
+  guint8 *data, *buffer;
+  GInputStream *base;
+  GInputStream *in;
+  GError *error = NULL;
+  gsize pos = 0;
+  gssize nread;
+
+  data = create_pattern (size);
+  base = g_memory_input_stream_new_from_data (data, size, NULL);
+  in = g_buffered_input_stream_new (base);
+  g_assert_false (g_buffered_input_stream_get_adaptive (G_BUFFERED_INPUT_STREAM (in)));
+  g_object_set (in, "adaptive", TRUE, NULL);
+  g_assert_true (g_buffered_input_stream_get_adaptive (G_BUFFERED_INPUT_STREAM (in)));
+
+  /* Small sequential reads make the buffer grow, up to a limit */
+  buffer = g_malloc (1000);
+  while ((nread = g_input_stream_read (in, buffer, 1000, NULL, &error)) > 0)
+    {
+      g_assert_cmpmem (buffer, nread, data + pos, nread);
+      pos += nread;
+    }
+  g_assert_no_error (error);
+  g_assert_cmpuint (pos, ==, size);
+
+  g_assert_cmpuint (g_buffered_input_stream_get_buffer_size (G_BUFFERED_INPUT_STREAM (in)), >, 4096);
+  g_assert_cmpuint (g_buffered_input_stream_get_buffer_size (G_BUFFERED_INPUT_STREAM (in)), <=, 1024 * 1024);
+
+  g_free (buffer);
+  g_object_unref (in);
+  g_object_unref (base);
+  g_free (data);
+}
+
+static void
+test_readahead (void)
+{
+  const gsize size = 1024 * 1024;
+  guint8 *data, *buffer;
+  GInputStream *base;
+  GInputStream *in;
+  GError *error = NULL;
+  GAsyncResult *result = NULL;
+  GRand *rand;
+  gsize pos = 0;
+
+  data = create_pattern (size);
+  base = g_memory_input_stream_new_from_data (data, size, NULL);
+  in = g_buffered_input_stream_new_sized (base, 1000);
+  g_buffered_input_stream_set_readahead (G_BUFFERED_INPUT_STREAM (in), TRUE);
+  g_assert_true (g_buffered_input_stream_get_readahead (G_BUFFERED_INPUT_STREAM (in)));
+
+  rand = g_rand_new_with_seed (3);
+  buffer = g_malloc (5000);
+
+  /* Whatever mix of operations, the data comes out in order */
+  while (pos < size)
+    {
+      gsize count = g_rand_int_range (rand, 1, 5000);
+      gssize res;
+
+      switch (g_rand_int_range (rand, 0, 5))
+        {
+        case 0:
+          res = g_input_stream_read (in, buffer, count, NULL, &error);
+          g_assert_no_error (error);
+          g_assert_cmpint (res, >, 0);
+          g_assert_cmpmem (buffer, res, data + pos, res);
+          pos += res;
+          break;
+
+        case 1:
+          res = g_buffered_input_stream_read_byte (G_BUFFERED_INPUT_STREAM (in), NULL, &error);
+          g_assert_no_error (error);
+          g_assert_cmpint (res, ==, data[pos]);
+          pos++;
+          break;
+
+        case 2:
+          res = g_input_stream_skip (in, count, NULL, &error);
+          g_assert_no_error (error);
+          g_assert_cmpint (res, >, 0);
+          pos += res;
+          break;
+
+        case 3:
+          g_buffered_input_stream_fill_async (G_BUFFERED_INPUT_STREAM (in), -1,
+                                              G_PRIORITY_DEFAULT, NULL,
+                                              return_result_cb, &result);
+          while (!result)
+            g_main_context_iteration (NULL, TRUE);
+          g_buffered_input_stream_fill_finish (G_BUFFERED_INPUT_STREAM (in), result, &error);
+          g_assert_no_error (error);
+          g_clear_object (&result);
+          break;
+
+        case 4:
+          g_assert_cmpint (g_seekable_tell (G_SEEKABLE (in)), ==, pos);
+          break;
+        }
+    }
+
+  g_assert_cmpint (g_input_stream_read (in, buffer, 1, NULL, &error), ==, 0);
+  g_assert_no_error (error);
+
+  /* Seeking drops what has been read ahead */
+  g_assert_true (g_seekable_seek (G_SEEKABLE (in), 12345, G_SEEK_SET, NULL, &error));
+  g_assert_no_error (error);
+  g_assert_cmpint (g_buffered_input_stream_read_byte (G_BUFFERED_INPUT_STREAM (in), NULL, &error), ==, data[12345]);
+  g_assert_no_error (error);
+  g_assert_cmpint (g_seekable_tell (G_SEEKABLE (in)), ==, 12346);
+
+  g_assert_true (g_input_stream_close (in, NULL, &error));
+  g_assert_no_error (error);
+  g_assert_true (g_input_stream_is_closed (base));
+
+  g_rand_free (rand);
+  g_free (buffer);
+  g_object_unref (in);
+  g_object_unref (base);
+  g_free (data);
+}
+
+static void
+test_readahead_close (void)
+{
+#ifdef G_OS_UNIX
+  GInputStream *base;
+  GInputStream *in;
+  GError *error = NULL;
+  gchar buffer[10];
+  int fds[2];
+
+  g_test_summary ("Test that closing a stream cancels a readahead which is "
+                  "blocked on the base stream");
+
+  g_assert_no_errno (pipe (fds));
+  g_assert_cmpint (write (fds[1], "0123456789", 10), ==, 10);
+
+  base = g_unix_input_stream_new (fds[0], TRUE);
+  in = g_buffered_input_stream_new (base);
+  g_buffered_input_stream_set_readahead (G_BUFFERED_INPUT_STREAM (in), TRUE);
+
+  /* This starts a readahead, which blocks as the write end stays open */
+  g_assert_cmpint (g_input_stream_read (in, buffer, sizeof (buffer), NULL, &error), ==, 10);
+  g_assert_no_error (error);
+  g_assert_cmpmem (buffer, sizeof (buffer), "0123456789", 10);
+
+  g_assert_true (g_input_stream_close (in, NULL, &error));
+  g_assert_no_error (error);
+  g_assert_true (g_input_stream_is_closed (base));
+
+  g_object_unref (in);
+  g_object_unref (base);
+  g_assert_no_errno (close (fds[1]));
+#else
+  g_test_skip ("Test needs a pipe");
+#endif
+}
+
+/* A memory input stream whose reads take a while, and fail if they have
+ * been cancelled meanwhile, as reads from a slow device would */
+typedef GMemoryInputStream SlowInputStream;
+typedef GMemoryInputStreamClass SlowInputStreamClass;
+
+static GType slow_input_stream_get_type (void);
+G_DEFINE_TYPE (SlowInputStream, slow_input_stream, G_TYPE_MEMORY_INPUT_STREAM)
+
+static guint slow_input_stream_n_cancelled = 0;
+
+static gssize
+slow_input_stream_read (GInputStream  *stream,
+                        void          *buffer,
+                        gsize          count,
+                        GCancellable  *cancellable,
+                        GError       **error)
+{
+  g_usleep (20 * G_TIME_SPAN_MILLISECOND);
+
+  if (g_cancellable_set_error_if_cancelled (cancellable, error))
+    {
+      g_atomic_int_inc (&slow_input_stream_n_cancelled);
+      return -1;
+    }
+
+  return G_INPUT_STREAM_CLASS (slow_input_stream_parent_class)->read_fn (stream, buffer, count,
+                                                                          cancellable, error);
+}
+
+static void
+slow_input_stream_class_init (SlowInputStreamClass *klass)
+{
+  G_INPUT_STREAM_CLASS (klass)->read_fn = slow_input_stream_read;
+}
+
+static void
+slow_input_stream_init (SlowInputStream *stream)
+{
+}
+
+static void
+test_readahead_tell (void)
+{
+  const gsize size = 1024 * 1024;
+  guint8 *data, *buffer;
+  GInputStream *base;
+  GInputStream *in;
+  GError *error = NULL;
+  gsize pos = 0;
+  guint i;
+
+  g_test_summary ("Test that telling the position waits for a running "
+                  "readahead rather than cancelling it");
+
+  data = create_pattern (size);
+  base = g_object_new (slow_input_stream_get_type (), NULL);
+  g_memory_input_stream_add_data (G_MEMORY_INPUT_STREAM (base), data, size, NULL);
+  in = g_buffered_input_stream_new_sized (base, 1000);
+  g_buffered_input_stream_set_readahead (G_BUFFERED_INPUT_STREAM (in), TRUE);
+  buffer = g_malloc (100);
+
+  /* As a line reader would, tell after each read, which is always while
+   * the next block is being read ahead */
+  for (i = 0; i < 20; i++)
+    {
+      gssize nread;
+
+      nread = g_input_stream_read (in, buffer, 100, NULL, &error);
+      g_assert_no_error (error);
+      g_assert_cmpint (nread, >, 0);
+      g_assert_cmpmem (buffer, nread, data + pos, nread);
+      pos += nread;
+
+      g_assert_cmpint (g_seekable_tell (G_SEEKABLE (in)), ==, pos);
+    }
+
+  g_assert_cmpuint (g_atomic_int_get (&slow_input_stream_n_cancelled), ==, 0);
+
+  g_free (buffer);
+  g_object_unref (in);
+  g_object_unref (base);
+  g_free (data);
+}
+
+static void
+buffer_size_notify_cb (GObject    *object,
+                       GParamSpec *pspec,
+                       gpointer    user_data)
+{
+  guint *n_notifies = user_data;
+
+  g_assert_true (g_main_context_is_owner (NULL));
+  (*n_notifies)++;
+}
+
+static void
+test_readahead_adaptive_async (void)
+{
+  const gsize size = 4 * 1024 * 1024;
+  guint8 *data;
+  GInputStream *base;
+  GInputStream *in;
+  GError *error = NULL;
+  GAsyncResult *result = NULL;
+  guint n_notifies = 0;
+  gsize pos = 0;
+
+  g_test_summary ("Test that asynchronous fills from a readahead grow the "
+                  "buffer, and notify about it, in the calling thread");
+
+  data = create_pattern (size);
+  base = g_memory_input_stream_new_from_data (data, size, NULL);
+  in = g_buffered_input_stream_new (base);
+  g_object_set (in, "adaptive", TRUE, "readahead", TRUE, NULL);
+  g_signal_connect (in, "notify::buffer-size",
+                    G_CALLBACK (buffer_size_notify_cb), &n_notifies);
+
+  g_main_context_acquire (NULL);
+
+  /* A synchronous fill starts the readahead, which the asynchronous
+   * fills then take their data from in a worker thread */
+  g_assert_cmpint (g_buffered_input_stream_fill (G_BUFFERED_INPUT_STREAM (in), -1, NULL, &error), >, 0);
+  g_assert_no_error (error);
+
+  while (TRUE)
+    {
+      gssize nread;
+      gsize available;
+      const guint8 *buffered;
+
+      buffered = g_buffered_input_stream_peek_buffer (G_BUFFERED_INPUT_STREAM (in), &available);
+      g_assert_cmpmem (buffered, available, data + pos, available);
+      g_assert_cmpint (g_input_stream_skip (in, available, NULL, &error), ==, available);
+      g_assert_no_error (error);
+      pos += available;
+
+      g_buffered_input_stream_fill_async (G_BUFFERED_INPUT_STREAM (in), -1,
+                                          G_PRIORITY_DEFAULT, NULL,
+                                          return_result_cb, &result);
+      while (!result)
+        g_main_context_iteration (NULL, TRUE);
+      nread = g_buffered_input_stream_fill_finish (G_BUFFERED_INPUT_STREAM (in), result, &error);
+      g_assert_no_error (error);
+      g_clear_object (&result);
+
+      if (nread == 0)
+        break;
+    }
+  g_assert_cmpuint (pos, ==, size);
+
+  g_main_context_release (NULL);
+
+  g_assert_cmpuint (n_notifies, >, 0);
+  g_assert_cmpuint (g_buffered_input_stream_get_buffer_size (G_BUFFERED_INPUT_STREAM (in)), >, 4096);
+
+  g_object_unref (in);
+  g_object_unref (base);
+  g_free (data);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -548,6 +901,12 @@ main (int   argc,
   g_test_add_func ("/buffered-input-stream/skip", test_skip);
   g_test_add_func ("/buffered-input-stream/skip-async", test_skip_async);
   g_test_add_func ("/buffered-input-stream/seek", test_seek);
+  g_test_add_func ("/buffered-input-stream/seek-readahead", test_seek_readahead);
+  g_test_add_func ("/buffered-input-stream/adaptive", test_adaptive);
+  g_test_add_func ("/buffered-input-stream/readahead", test_readahead);
+  g_test_add_func ("/buffered-input-stream/readahead-close", test_readahead_close);
+  g_test_add_func ("/buffered-input-stream/readahead-tell", test_readahead_tell);
+  g_test_add_func ("/buffered-input-stream/readahead-adaptive-async", test_readahead_adaptive_async);
   g_test_add_func ("/filter-input-stream/close", test_close);
 
   return g_test_run();
@@ -0,0 +1,270 @@
+/* GIO - GLib Input, Output and Streaming Library
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <gio/gio.h>
+#include <glib/gstdio.h>
+
+#if defined(G_OS_UNIX) && !defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "../gcontenttypecache.h"
+
+static GContentTypeCacheKey
+make_key (guint64     ino,
+          const char *basename)
+{
+  GContentTypeCacheKey key = { 0, };
+
+  key.dev = 42;
+  key.ino = ino;
+  key.mtime = 1600000000;
+  key.mtime_nsec = 123;
+  key.size = 4096;
+  key.basename = basename;
+
+  return key;
+}
+
+static void
+assert_stats (guint64 expected_hits,
+              guint64 expected_misses)
+{
+  guint64 hits, misses;
+
+  _g_content_type_cache_get_stats (&hits, &misses);
+  g_assert_cmpuint (hits, ==, expected_hits);
+  g_assert_cmpuint (misses, ==, expected_misses);
+}
+
+static void
+test_lookup (void)
+{
+  GContentTypeCacheKey key = make_key (1, "file.dat");
+  GContentTypeCacheKey other;
+  char *basename;
+
+  _g_content_type_cache_reset (16);
+
+  g_assert_null (_g_content_type_cache_lookup (&key));
+  assert_stats (0, 1);
+
+  _g_content_type_cache_insert (&key, "application/x-test");
+
+  /* The key is copied, including the basename */
+  basename = g_strdup ("file.dat");
+  other = make_key (1, basename);
+  g_assert_cmpstr (_g_content_type_cache_lookup (&other), ==, "application/x-test");
+  g_free (basename);
+  assert_stats (1, 1);
+
+  /* Any change to the file is a miss */
+  other = make_key (1, "file.dat");
+  other.mtime++;
+  g_assert_null (_g_content_type_cache_lookup (&other));
+  other = make_key (1, "file.dat");
+  other.mtime_nsec++;
+  g_assert_null (_g_content_type_cache_lookup (&other));
+  other = make_key (1, "file.dat");
+  other.size++;
+  g_assert_null (_g_content_type_cache_lookup (&other));
+  other = make_key (1, "file.dat");
+  other.dev++;
+  g_assert_null (_g_content_type_cache_lookup (&other));
+  other = make_key (2, "file.dat");
+  g_assert_null (_g_content_type_cache_lookup (&other));
+
+  /* The same inode under another name can guess differently */
+  other = make_key (1, "file.txt");
+  g_assert_null (_g_content_type_cache_lookup (&other));
+  assert_stats (1, 7);
+
+  /* Inserting again replaces the content type */
+  _g_content_type_cache_insert (&key, "text/plain");
+  g_assert_cmpstr (_g_content_type_cache_lookup (&key), ==, "text/plain");
+  assert_stats (2, 7);
+
+  _g_content_type_cache_reset (16);
+  assert_stats (0, 0);
+  g_assert_null (_g_content_type_cache_lookup (&key));
+}
+
+static void
+test_eviction (void)
+{
+  GContentTypeCacheKey key;
+  guint i;
+
+  _g_content_type_cache_reset (4);
+
+  for (i = 0; i < 4; i++)
+    {
+      key = make_key (i, "file");
+      _g_content_type_cache_insert (&key, "text/plain");
+    }
+
+  /* Use the oldest entry, so that inode 1 becomes the least recently used */
+  key = make_key (0, "file");
+  g_assert_nonnull (_g_content_type_cache_lookup (&key));
+
+  key = make_key (4, "file");
+  _g_content_type_cache_insert (&key, "text/plain");
+
+  key = make_key (1, "file");
+  g_assert_null (_g_content_type_cache_lookup (&key));
+  for (i = 0; i < 5; i++)
+    {
+      if (i == 1)
+        continue;
+      key = make_key (i, "file");
+      g_assert_nonnull (_g_content_type_cache_lookup (&key));
+    }
+}
+
+static void
+test_disabled (void)
+{
+  GContentTypeCacheKey key = make_key (1, "file");
+
+  _g_content_type_cache_reset (0);
+
+  _g_content_type_cache_insert (&key, "text/plain");
+  g_assert_null (_g_content_type_cache_lookup (&key));
+  assert_stats (0, 0);
+
+  _g_content_type_cache_reset (16);
+}
+
+#if defined(G_OS_UNIX) && !defined(__APPLE__)
+static gchar *
+query_content_type (GFile *file)
+{
+  GFileInfo *info;
+  GError *error = NULL;
+  gchar *content_type;
+
+  info = g_file_query_info (file, G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE,
+                            G_FILE_QUERY_INFO_NONE, NULL, &error);
+  g_assert_no_error (error);
+
+  content_type = g_strdup (g_file_info_get_content_type (info));
+  g_assert_nonnull (content_type);
+  g_object_unref (info);
+
+  return content_type;
+}
+
+/* Replace the contents of @path without changing its inode, and give it
+ * @mtime as its modification time */
+static void
+rewrite_file (const gchar           *path,
+              const gchar           *data,
+              gsize                  len,
+              const struct timespec *mtime)
+{
+  struct timespec times[2];
+  int fd;
+
+  fd = g_open (path, O_WRONLY | O_TRUNC, 0);
+  g_assert_cmpint (fd, >=, 0);
+  g_assert_cmpint (write (fd, data, len), ==, (gssize) len);
+
+  times[0].tv_sec = 0;
+  times[0].tv_nsec = UTIME_OMIT;
+  times[1] = *mtime;
+  g_assert_cmpint (futimens (fd, times), ==, 0);
+
+  g_assert_true (g_close (fd, NULL));
+}
+#endif
+
+/* Check the cache as used by g_file_query_info(): a file which hasn't
+ * changed is not sniffed again, while a new modification time or size
+ * is picked up. The file is rewritten behind the cache's back with
+ * contents of a different type to tell the two apart. */
+static void
+test_query_info (void)
+{
+#if defined(G_OS_UNIX) && !defined(__APPLE__)
+  const gchar text[] = "Just some plain text, nothing to see here.\n";
+  gchar binary[sizeof (text) - 1];
+  gchar *dir, *path;
+  GFile *file;
+  GStatBuf buf;
+  struct timespec mtime;
+  gchar *type;
+
+  memset (binary, 0, sizeof (binary));
+
+  dir = g_dir_make_tmp ("content-type-cache-XXXXXX", NULL);
+  g_assert_nonnull (dir);
+  /* No extension, so that the content type has to be sniffed */
+  path = g_build_filename (dir, "noextension", NULL);
+  file = g_file_new_for_path (path);
+
+  g_assert_true (g_file_set_contents (path, text, sizeof (text) - 1, NULL));
+  g_assert_cmpint (g_stat (path, &buf), ==, 0);
+  mtime = buf.st_mtim;
+
+  type = query_content_type (file);
+  g_assert_true (g_content_type_is_a (type, "text/plain"));
+  g_free (type);
+
+  /* Same inode, size and modification time: the cached type is returned */
+  rewrite_file (path, binary, sizeof (binary), &mtime);
+  type = query_content_type (file);
+  g_assert_true (g_content_type_is_a (type, "text/plain"));
+  g_free (type);
+
+  /* A new modification time means the file is sniffed again */
+  mtime.tv_sec += 10;
+  rewrite_file (path, binary, sizeof (binary), &mtime);
+  type = query_content_type (file);
+  g_assert_false (g_content_type_is_a (type, "text/plain"));
+  g_free (type);
+
+  /* So does a new size, even with the modification time kept */
+  rewrite_file (path, text, sizeof (text) - 2, &mtime);
+  type = query_content_type (file);
+  g_assert_true (g_content_type_is_a (type, "text/plain"));
+  g_free (type);
+
+  g_assert_cmpint (g_remove (path), ==, 0);
+  g_assert_cmpint (g_rmdir (dir), ==, 0);
+  g_object_unref (file);
+  g_free (path);
+  g_free (dir);
+#else
+  g_test_skip ("Content types are not sniffed on this platform");
+#endif
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/content-type-cache/lookup", test_lookup);
+  g_test_add_func ("/content-type-cache/eviction", test_eviction);
+  g_test_add_func ("/content-type-cache/disabled", test_disabled);
+  g_test_add_func ("/content-type-cache/query-info", test_query_info);
+
+  return g_test_run ();
+}
@@ -426,6 +426,69 @@ test_mime_from_content (void)
 #endif
 }
 
+/* A corpus of file names and file headers, in the proportions a file
+ * manager might see them, to time g_content_type_guess() with */
+static const struct {
+  const char *extension;
+  const char *header;
+  gsize header_len;
+} guess_corpus[] = {
+  { ".pdf", "%PDF-1.7\n%\xe2\xe3\xcf\xd3\n", 15 },
+  { ".png", "\x89PNG\r\n\x1a\n\0\0\0\rIHDR", 16 },
+  { ".jpg", "\xff\xd8\xff\xe0\0\x10JFIF\0\x01\x01", 13 },
+  { ".gz", "\x1f\x8b\x08\0\0\0\0\0\0\x03", 10 },
+  { ".zip", "PK\x03\x04\x14\0\0\0\x08\0", 10 },
+  { "", "\x7f" "ELF\x02\x01\x01\0\0\0\0\0\0\0\0\0", 16 },
+  { ".xml", "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<root/>\n", 47 },
+  { ".html", "<!DOCTYPE html>\n<html><head><title>x</title></head></html>\n", 59 },
+  { ".sh", "#!/bin/sh\necho hello\n", 21 },
+  { ".txt", "Just some plain text, nothing to see here.\n", 43 },
+  { ".c", "#include <stdio.h>\n\nint main (void) { return 0; }\n", 50 },
+  { "", "no extension and no magic either\n", 33 },
+  { ".dat", "\0\x01\x02\x03\x04\x05\x06\x07\x08\x09\x0a\x0b\x0c\x0d\x0e\x0f", 16 },
+};
+
+static void
+test_guess_perf (void)
+{
+  const guint n_iterations = 2000;
+  char *names[G_N_ELEMENTS (guess_corpus)];
+  guint i, j;
+  gdouble elapsed;
+
+  if (!g_test_perf ())
+    {
+      g_test_skip ("Performance tests not enabled");
+      return;
+    }
+
+  for (i = 0; i < G_N_ELEMENTS (guess_corpus); i++)
+    names[i] = g_strdup_printf ("some-file-%u%s", i, guess_corpus[i].extension);
+
+  g_test_timer_start ();
+
+  for (j = 0; j < n_iterations; j++)
+    for (i = 0; i < G_N_ELEMENTS (guess_corpus); i++)
+      {
+        gchar *type;
+
+        /* Alternate between guessing from the name and data, and from
+         * the data alone */
+        type = g_content_type_guess ((j & 1) ? NULL : names[i],
+                                     (const guchar *) guess_corpus[i].header,
+                                     guess_corpus[i].header_len, NULL);
+        g_assert_nonnull (type);
+        g_free (type);
+      }
+
+  elapsed = g_test_timer_elapsed ();
+  g_test_maximized_result (n_iterations * G_N_ELEMENTS (guess_corpus) / elapsed,
+                           "%.0f guesses/s", n_iterations * G_N_ELEMENTS (guess_corpus) / elapsed);
+
+  for (i = 0; i < G_N_ELEMENTS (guess_corpus); i++)
+    g_free (names[i]);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -444,6 +507,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/contenttype/tree", test_tree);
   g_test_add_func ("/contenttype/test_type_is_a_special_case",
                    test_type_is_a_special_case);
+  g_test_add_func ("/contenttype/perf/guess", test_guess_perf);
 
   return g_test_run ();
 }
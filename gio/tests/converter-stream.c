@@ -732,6 +732,7 @@ typedef struct {
   const gchar *path;
   GZlibCompressorFormat format;
   gint level;
+  guint threads;
 } CompressorTest;
 
 static void
@@ -760,7 +761,11 @@ test_roundtrip (gconstpointer data)
     DATA_LENGTH * sizeof (guint32), NULL);
 
   ostream1 = g_memory_output_stream_new (NULL, 0, g_realloc, g_free);
-  compressor = G_CONVERTER (g_zlib_compressor_new (test->format, test->level));
+  compressor = g_object_new (G_TYPE_ZLIB_COMPRESSOR,
+                             "format", test->format,
+                             "level", test->level,
+                             "threads", test->threads,
+                             NULL);
   info = g_file_info_new ();
   g_file_info_set_name (info, "foo");
   g_object_set (compressor, "file-info", info, NULL);
@@ -1166,6 +1171,374 @@ test_truncation (gconstpointer data)
   g_free (data0);
 }
 
+/* Fills @data with text that compresses well, but not so well that the
+ * matches across blocks do not matter */
+static void
+fill_compressible (guchar *data,
+                   gsize   len)
+{
+  const gchar *words[] = { "stream ", "converter ", "compress", "ion ", "block ",
+                           "thread ", "pool ", "gzip ", "deflate ", "\n" };
+  GRand *rand = g_rand_new_with_seed (42);
+  gsize i = 0;
+
+  while (i < len)
+    {
+      const gchar *word = words[g_rand_int_range (rand, 0, G_N_ELEMENTS (words))];
+      gsize word_len = MIN (strlen (word), len - i);
+
+      memcpy (data + i, word, word_len);
+      i += word_len;
+    }
+
+  g_rand_free (rand);
+}
+
+static GBytes *
+compress_with_threads (GZlibCompressorFormat  format,
+                       gint                   level,
+                       guint                  threads,
+                       const guchar          *data,
+                       gsize                  len,
+                       gsize                  flush_every)
+{
+  GOutputStream *ostream, *costream;
+  GConverter *compressor;
+  GFileInfo *info;
+  GError *error = NULL;
+  gsize offset;
+
+  compressor = g_object_new (G_TYPE_ZLIB_COMPRESSOR,
+                             "format", format,
+                             "level", level,
+                             "threads", threads,
+                             NULL);
+  info = g_file_info_new ();
+  g_file_info_set_name (info, "foo");
+  g_zlib_compressor_set_file_info (G_ZLIB_COMPRESSOR (compressor), info);
+  g_object_unref (info);
+
+  ostream = g_memory_output_stream_new_resizable ();
+  costream = g_converter_output_stream_new (ostream, compressor);
+
+  for (offset = 0; offset < len; offset += flush_every)
+    {
+      g_output_stream_write_all (costream, data + offset,
+                                 MIN (flush_every, len - offset),
+                                 NULL, NULL, &error);
+      g_assert_no_error (error);
+
+      g_output_stream_flush (costream, NULL, &error);
+      g_assert_no_error (error);
+    }
+
+  g_output_stream_close (costream, NULL, &error);
+  g_assert_no_error (error);
+
+  g_object_unref (costream);
+  g_object_unref (compressor);
+
+  return g_memory_output_stream_steal_as_bytes (G_MEMORY_OUTPUT_STREAM (ostream));
+}
+
+/* Test that the parallel mode of GZlibCompressor produces valid streams,
+ * whatever the format, with flushes in the middle of blocks, and with an
+ * input that ends at a block boundary. */
+static void
+test_compressor_parallel (void)
+{
+  const gsize lengths[] = { 0, 1, 128 * 1024, 3 * 128 * 1024 + 4321 };
+  const gsize flushes[] = { G_MAXSIZE, 100000 };
+  const GZlibCompressorFormat formats[] = {
+    G_ZLIB_COMPRESSOR_FORMAT_ZLIB,
+    G_ZLIB_COMPRESSOR_FORMAT_GZIP,
+    G_ZLIB_COMPRESSOR_FORMAT_RAW
+  };
+  gsize max_len = lengths[G_N_ELEMENTS (lengths) - 1];
+  guchar *data;
+  gsize i, j, k;
+
+  data = g_malloc (max_len);
+  fill_compressible (data, max_len);
+
+  for (i = 0; i < G_N_ELEMENTS (formats); i++)
+    for (j = 0; j < G_N_ELEMENTS (lengths); j++)
+      for (k = 0; k < G_N_ELEMENTS (flushes); k++)
+        {
+          GBytes *compressed, *serial;
+          GInputStream *istream, *cistream;
+          GOutputStream *ostream;
+          GZlibDecompressor *decompressor;
+          GError *error = NULL;
+
+          g_test_message ("format %d, length %" G_GSIZE_FORMAT ", flush every %" G_GSIZE_FORMAT,
+                          formats[i], lengths[j], flushes[k]);
+
+          compressed = compress_with_threads (formats[i], -1, 3, data, lengths[j], flushes[k]);
+
+          istream = g_memory_input_stream_new_from_bytes (compressed);
+          decompressor = g_zlib_decompressor_new (formats[i]);
+          cistream = g_converter_input_stream_new (istream, G_CONVERTER (decompressor));
+          ostream = g_memory_output_stream_new_resizable ();
+
+          g_output_stream_splice (ostream, cistream, G_OUTPUT_STREAM_SPLICE_CLOSE_TARGET,
+                                  NULL, &error);
+          g_assert_no_error (error);
+
+          g_assert_cmpmem (g_memory_output_stream_get_data (G_MEMORY_OUTPUT_STREAM (ostream)),
+                           g_memory_output_stream_get_data_size (G_MEMORY_OUTPUT_STREAM (ostream)),
+                           data, lengths[j]);
+
+          if (formats[i] == G_ZLIB_COMPRESSOR_FORMAT_GZIP)
+            {
+              GFileInfo *info = g_zlib_decompressor_get_file_info (decompressor);
+
+              g_assert_nonnull (info);
+              g_assert_cmpstr (g_file_info_get_name (info), ==, "foo");
+            }
+
+          /* Priming with the previous block keeps the output close to serial
+           * compression */
+          serial = compress_with_threads (formats[i], -1, 0, data, lengths[j], flushes[k]);
+          if (lengths[j] > 128 * 1024)
+            g_assert_cmpuint (g_bytes_get_size (compressed), <,
+                              g_bytes_get_size (serial) + g_bytes_get_size (serial) / 20);
+
+          g_bytes_unref (serial);
+          g_object_unref (ostream);
+          g_object_unref (cistream);
+          g_object_unref (decompressor);
+          g_object_unref (istream);
+          g_bytes_unref (compressed);
+        }
+
+  g_free (data);
+}
+
+static void
+test_compressor_parallel_perf (void)
+{
+  const gsize len = 64 * 1024 * 1024;
+  const guint threads[] = { 0, 1, 2, 4, 8 };
+  guchar *data;
+  gsize i;
+
+  if (!g_test_perf ())
+    {
+      g_test_skip ("Performance tests not enabled");
+      return;
+    }
+
+  data = g_malloc (len);
+  fill_compressible (data, len);
+
+  for (i = 0; i < G_N_ELEMENTS (threads); i++)
+    {
+      GBytes *compressed;
+      gdouble elapsed;
+
+      g_test_timer_start ();
+      compressed = compress_with_threads (G_ZLIB_COMPRESSOR_FORMAT_GZIP, -1, threads[i],
+                                          data, len, G_MAXSIZE);
+      elapsed = g_test_timer_elapsed ();
+
+      g_test_maximized_result (len / elapsed / (1024 * 1024),
+                               "%u threads: %.1f MiB/s, %" G_GSIZE_FORMAT " bytes",
+                               threads[i], len / elapsed / (1024 * 1024),
+                               g_bytes_get_size (compressed));
+      g_bytes_unref (compressed);
+    }
+
+  g_free (data);
+}
+
+/* Reads all of @istream in reads of @chunk_size bytes, and checks that it
+ * gives back @data */
+static void
+check_read_all (GInputStream *istream,
+                gsize         chunk_size,
+                const guchar *data,
+                gsize         len)
+{
+  guchar *buf = g_malloc (chunk_size);
+  gsize offset = 0;
+  GError *error = NULL;
+
+  while (TRUE)
+    {
+      gssize nread = g_input_stream_read (istream, buf, chunk_size, NULL, &error);
+
+      g_assert_no_error (error);
+      if (nread == 0)
+        break;
+
+      g_assert_cmpuint (offset + nread, <=, len);
+      g_assert_cmpmem (buf, nread, data + offset, nread);
+      offset += nread;
+    }
+
+  g_assert_cmpuint (offset, ==, len);
+  g_free (buf);
+}
+
+/* Test converter input streams stacked on a buffered stream and on each
+ * other, with various buffer sizes and read sizes. */
+static void
+test_converter_chained (void)
+{
+  const gsize len = 300000;
+  const guint buffer_sizes[] = { 1, 100, 4096, 1024 * 1024 };
+  const gsize chunk_sizes[] = { 1, 777, 65536 };
+  guchar *data;
+  GBytes *gzipped, *twice;
+  gsize i, j;
+
+  data = g_malloc (len);
+  fill_compressible (data, len);
+
+  gzipped = compress_with_threads (G_ZLIB_COMPRESSOR_FORMAT_GZIP, -1, 0, data, len, G_MAXSIZE);
+  twice = compress_with_threads (G_ZLIB_COMPRESSOR_FORMAT_ZLIB, -1, 0,
+                                 g_bytes_get_data (gzipped, NULL),
+                                 g_bytes_get_size (gzipped), G_MAXSIZE);
+
+  for (i = 0; i < G_N_ELEMENTS (buffer_sizes); i++)
+    for (j = 0; j < G_N_ELEMENTS (chunk_sizes); j++)
+      {
+        GInputStream *istream, *bistream, *cistream, *cistream2;
+        GConverter *decompressor, *decompressor2;
+        guint buffer_size;
+
+        g_test_message ("buffer size %u, reads of %" G_GSIZE_FORMAT " bytes",
+                        buffer_sizes[i], chunk_sizes[j]);
+
+        /* On a buffered stream */
+        istream = g_memory_input_stream_new_from_bytes (gzipped);
+        bistream = g_buffered_input_stream_new_sized (istream, 1000);
+        decompressor = G_CONVERTER (g_zlib_decompressor_new (G_ZLIB_COMPRESSOR_FORMAT_GZIP));
+        cistream = g_object_new (G_TYPE_CONVERTER_INPUT_STREAM,
+                                 "base-stream", bistream,
+                                 "converter", decompressor,
+                                 "buffer-size", buffer_sizes[i],
+                                 NULL);
+        g_assert_cmpuint (g_converter_input_stream_get_buffer_size (G_CONVERTER_INPUT_STREAM (cistream)),
+                          ==, buffer_sizes[i]);
+        g_object_get (cistream, "buffer-size", &buffer_size, NULL);
+        g_assert_cmpuint (buffer_size, ==, buffer_sizes[i]);
+
+        check_read_all (cistream, chunk_sizes[j], data, len);
+
+        g_object_unref (cistream);
+        g_object_unref (decompressor);
+        g_object_unref (bistream);
+        g_object_unref (istream);
+
+        /* On another converter stream */
+        istream = g_memory_input_stream_new_from_bytes (twice);
+        decompressor = G_CONVERTER (g_zlib_decompressor_new (G_ZLIB_COMPRESSOR_FORMAT_ZLIB));
+        cistream = g_object_new (G_TYPE_CONVERTER_INPUT_STREAM,
+                                 "base-stream", istream,
+                                 "converter", decompressor,
+                                 "buffer-size", buffer_sizes[i],
+                                 NULL);
+        decompressor2 = G_CONVERTER (g_zlib_decompressor_new (G_ZLIB_COMPRESSOR_FORMAT_GZIP));
+        cistream2 = g_object_new (G_TYPE_CONVERTER_INPUT_STREAM,
+                                  "base-stream", cistream,
+                                  "converter", decompressor2,
+                                  "buffer-size", buffer_sizes[i],
+                                  NULL);
+
+        check_read_all (cistream2, chunk_sizes[j], data, len);
+
+        g_object_unref (cistream2);
+        g_object_unref (decompressor2);
+        g_object_unref (cistream);
+        g_object_unref (decompressor);
+        g_object_unref (istream);
+      }
+
+  g_bytes_unref (twice);
+  g_bytes_unref (gzipped);
+  g_free (data);
+}
+
+static void
+test_converter_decompress_perf (void)
+{
+  const gsize chunk_len = 4 * 1024 * 1024;
+  const gsize len = 1024 * 1024 * 1024;
+  const guint buffer_sizes[] = { 4096, 65536, 1024 * 1024 };
+  GOutputStream *ostream, *costream;
+  GConverter *compressor;
+  GBytes *compressed;
+  guchar *data, *buf;
+  GError *error = NULL;
+  gsize i, offset;
+
+  if (!g_test_perf ())
+    {
+      g_test_skip ("Performance tests not enabled");
+      return;
+    }
+
+  data = g_malloc (chunk_len);
+  fill_compressible (data, chunk_len);
+
+  compressor = G_CONVERTER (g_zlib_compressor_new (G_ZLIB_COMPRESSOR_FORMAT_GZIP, 1));
+  ostream = g_memory_output_stream_new_resizable ();
+  costream = g_converter_output_stream_new (ostream, compressor);
+  for (offset = 0; offset < len; offset += chunk_len)
+    {
+      g_output_stream_write_all (costream, data, chunk_len, NULL, NULL, &error);
+      g_assert_no_error (error);
+    }
+  g_output_stream_close (costream, NULL, &error);
+  g_assert_no_error (error);
+  compressed = g_memory_output_stream_steal_as_bytes (G_MEMORY_OUTPUT_STREAM (ostream));
+  g_object_unref (costream);
+  g_object_unref (ostream);
+  g_object_unref (compressor);
+
+  buf = g_malloc (65536);
+
+  for (i = 0; i < G_N_ELEMENTS (buffer_sizes); i++)
+    {
+      guint buffer_size = buffer_sizes[i];
+      GInputStream *istream, *cistream;
+      GConverter *decompressor;
+      gsize total = 0;
+      gssize nread;
+      gdouble elapsed;
+
+      istream = g_memory_input_stream_new_from_bytes (compressed);
+      decompressor = G_CONVERTER (g_zlib_decompressor_new (G_ZLIB_COMPRESSOR_FORMAT_GZIP));
+      cistream = g_object_new (G_TYPE_CONVERTER_INPUT_STREAM,
+                               "base-stream", istream,
+                               "converter", decompressor,
+                               "buffer-size", buffer_size,
+                               NULL);
+
+      g_test_timer_start ();
+      while ((nread = g_input_stream_read (cistream, buf, 65536, NULL, &error)) > 0)
+        total += nread;
+      elapsed = g_test_timer_elapsed ();
+
+      g_assert_no_error (error);
+      g_assert_cmpuint (total, ==, len);
+
+      g_test_maximized_result (len / elapsed / (1024 * 1024),
+                               "%u byte buffers: %.1f MiB/s",
+                               buffer_size, len / elapsed / (1024 * 1024));
+
+      g_object_unref (cistream);
+      g_object_unref (decompressor);
+      g_object_unref (istream);
+    }
+
+  g_free (buf);
+  g_bytes_unref (compressed);
+  g_free (data);
+}
+
 static void
 test_converter_basics (void)
 {
@@ -1200,6 +1573,10 @@ main (int   argc,
     { "/converter-output-stream/roundtrip/gzip-9", G_ZLIB_COMPRESSOR_FORMAT_GZIP, 9 },
     { "/converter-output-stream/roundtrip/raw-0", G_ZLIB_COMPRESSOR_FORMAT_RAW, 0 },
     { "/converter-output-stream/roundtrip/raw-9", G_ZLIB_COMPRESSOR_FORMAT_RAW, 9 },
+    { "/converter-output-stream/roundtrip/zlib-6-threads", G_ZLIB_COMPRESSOR_FORMAT_ZLIB, 6, 4 },
+    { "/converter-output-stream/roundtrip/gzip-0-threads", G_ZLIB_COMPRESSOR_FORMAT_GZIP, 0, 4 },
+    { "/converter-output-stream/roundtrip/gzip-9-threads", G_ZLIB_COMPRESSOR_FORMAT_GZIP, 9, 4 },
+    { "/converter-output-stream/roundtrip/raw-1-threads", G_ZLIB_COMPRESSOR_FORMAT_RAW, 1, 4 },
   };
   CompressorTest truncation_tests[] = {
     { "/converter-input-stream/truncation/zlib", G_ZLIB_COMPRESSOR_FORMAT_ZLIB, 0 },
@@ -1231,6 +1608,10 @@ main (int   argc,
 
   g_test_add_func ("/converter-stream/pollable", test_converter_pollable);
   g_test_add_func ("/converter-stream/leftover", test_converter_leftover);
+  g_test_add_func ("/converter-output-stream/compressor/parallel", test_compressor_parallel);
+  g_test_add_func ("/converter-output-stream/perf/parallel-compression", test_compressor_parallel_perf);
+  g_test_add_func ("/converter-input-stream/chained", test_converter_chained);
+  g_test_add_func ("/converter-input-stream/perf/gzip-decompress", test_converter_decompress_perf);
 
   return g_test_run();
 }
@@ -152,6 +152,250 @@ test_read_lines_any (void)
   test_read_lines (G_DATA_STREAM_NEWLINE_TYPE_ANY);
 }
 
+/* Splits @data the way g_data_input_stream_read_line() should for
+ * @newline_type, one byte at a time */
+static GPtrArray *
+split_lines (const char             *data,
+             gsize                   len,
+             GDataStreamNewlineType  newline_type)
+{
+  GPtrArray *lines = g_ptr_array_new_with_free_func (g_free);
+  gsize line_start = 0;
+  gsize i = 0;
+
+  while (i < len)
+    {
+      gsize newline_len = 0;
+
+      switch (newline_type)
+        {
+        case G_DATA_STREAM_NEWLINE_TYPE_LF:
+          if (data[i] == '\n')
+            newline_len = 1;
+          break;
+        case G_DATA_STREAM_NEWLINE_TYPE_CR:
+          if (data[i] == '\r')
+            newline_len = 1;
+          break;
+        case G_DATA_STREAM_NEWLINE_TYPE_CR_LF:
+          if (data[i] == '\r' && i + 1 < len && data[i + 1] == '\n')
+            newline_len = 2;
+          break;
+        case G_DATA_STREAM_NEWLINE_TYPE_ANY:
+        default:
+          if (data[i] == '\n')
+            newline_len = 1;
+          else if (data[i] == '\r')
+            newline_len = (i + 1 < len && data[i + 1] == '\n') ? 2 : 1;
+          break;
+        }
+
+      if (newline_len > 0)
+        {
+          g_ptr_array_add (lines, g_strndup (data + line_start, i - line_start));
+          i += newline_len;
+          line_start = i;
+        }
+      else
+        i++;
+    }
+
+  if (line_start < len)
+    g_ptr_array_add (lines, g_strndup (data + line_start, len - line_start));
+
+  return lines;
+}
+
+typedef enum {
+  READ_LINE,
+  READ_LINE_BORROWED,
+  READ_LINES_BORROWED,
+} ReadLinesMethod;
+
+/* Reads all lines from @stream with @method, copying them */
+static GPtrArray *
+read_all_lines (GDataInputStream *stream,
+                ReadLinesMethod   method)
+{
+  GPtrArray *lines = g_ptr_array_new_with_free_func (g_free);
+
+  while (TRUE)
+    {
+      GError *error = NULL;
+      const char *batch[7];
+      gsize lengths[G_N_ELEMENTS (batch)];
+      gsize n, i;
+      char *str;
+
+      switch (method)
+        {
+        case READ_LINE:
+          str = g_data_input_stream_read_line (stream, &lengths[0], NULL, &error);
+          g_assert_no_error (error);
+          if (str == NULL)
+            return lines;
+          g_assert_cmpuint (lengths[0], ==, strlen (str));
+          g_ptr_array_add (lines, str);
+          break;
+
+        case READ_LINE_BORROWED:
+          batch[0] = g_data_input_stream_read_line_borrowed (stream, &lengths[0], NULL, &error);
+          g_assert_no_error (error);
+          if (batch[0] == NULL)
+            {
+              g_assert_cmpuint (lengths[0], ==, 0);
+              return lines;
+            }
+          g_ptr_array_add (lines, g_strndup (batch[0], lengths[0]));
+          break;
+
+        case READ_LINES_BORROWED:
+          n = g_data_input_stream_read_lines_borrowed (stream, batch, lengths,
+                                                       G_N_ELEMENTS (batch), NULL, &error);
+          g_assert_no_error (error);
+          if (n == 0)
+            return lines;
+          g_assert_cmpuint (n, <=, G_N_ELEMENTS (batch));
+          for (i = 0; i < n; i++)
+            g_ptr_array_add (lines, g_strndup (batch[i], lengths[i]));
+          break;
+
+        default:
+          g_assert_not_reached ();
+        }
+    }
+}
+
+/* Reads mixed line endings, added in small chunks through a small buffer,
+ * so that line ends (and the two halves of CR LF) often straddle the end
+ * of what has been scanned so far */
+static void
+test_read_lines_mixed (void)
+{
+  const char *endl[] = { "\n", "\r", "\r\n", "\n\r", "\r\r\n", "\n\n" };
+  GDataStreamNewlineType newline_type;
+  ReadLinesMethod method;
+  GString *data;
+  GRand *rand;
+  guint i;
+
+  rand = g_rand_new_with_seed (42);
+  data = g_string_new (NULL);
+
+  for (i = 0; i < 2000; i++)
+    {
+      guint line_len = g_rand_int_range (rand, 0, 70);
+      guint j;
+
+      for (j = 0; j < line_len; j++)
+        g_string_append_c (data, 'a' + g_rand_int_range (rand, 0, 26));
+      g_string_append (data, endl[g_rand_int_range (rand, 0, G_N_ELEMENTS (endl))]);
+    }
+  /* Don't end with a CR, whose meaning depends on what follows */
+  g_string_append (data, "last");
+
+  for (method = READ_LINE; method <= READ_LINES_BORROWED; method++)
+    for (newline_type = G_DATA_STREAM_NEWLINE_TYPE_LF;
+         newline_type <= G_DATA_STREAM_NEWLINE_TYPE_ANY;
+         newline_type++)
+      {
+        GInputStream *base_stream;
+        GDataInputStream *stream;
+        GPtrArray *expected, *lines;
+        gsize pos;
+
+        expected = split_lines (data->str, data->len, newline_type);
+
+        base_stream = g_memory_input_stream_new ();
+        for (pos = 0; pos < data->len;)
+          {
+            gsize chunk = g_rand_int_range (rand, 1, 40);
+
+            chunk = MIN (chunk, data->len - pos);
+
+            g_memory_input_stream_add_data (G_MEMORY_INPUT_STREAM (base_stream),
+                                            g_memdup2 (data->str + pos, chunk), chunk, g_free);
+            pos += chunk;
+          }
+
+        stream = g_data_input_stream_new (base_stream);
+        g_buffered_input_stream_set_buffer_size (G_BUFFERED_INPUT_STREAM (stream), 17);
+        g_data_input_stream_set_newline_type (stream, newline_type);
+
+        lines = read_all_lines (stream, method);
+
+        g_assert_cmpuint (lines->len, ==, expected->len);
+        for (i = 0; i < lines->len; i++)
+          g_assert_cmpstr (g_ptr_array_index (lines, i), ==, g_ptr_array_index (expected, i));
+
+        g_object_unref (stream);
+        g_object_unref (base_stream);
+        g_ptr_array_unref (lines);
+        g_ptr_array_unref (expected);
+      }
+
+  g_string_free (data, TRUE);
+  g_rand_free (rand);
+}
+
+static void
+test_read_lines_borrowed (void)
+{
+  GInputStream *base_stream;
+  GDataInputStream *stream;
+  GError *error = NULL;
+  const char *lines[10];
+  gsize lengths[10];
+  const char *line;
+  gsize length;
+  gsize n;
+
+  base_stream = g_memory_input_stream_new_from_data ("one\n\nthree\nfour\nfive", -1, NULL);
+  stream = g_data_input_stream_new (base_stream);
+
+  line = g_data_input_stream_read_line_borrowed (stream, &length, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpmem (line, length, "one", 3);
+
+  /* An empty line is not the end of the stream */
+  line = g_data_input_stream_read_line_borrowed (stream, &length, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (line);
+  g_assert_cmpuint (length, ==, 0);
+
+  /* The rest is in the buffer already, so it comes back in one go */
+  n = g_data_input_stream_read_lines_borrowed (stream, lines, lengths, G_N_ELEMENTS (lines), NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (n, ==, 2);
+  g_assert_cmpmem (lines[0], lengths[0], "three", 5);
+  g_assert_cmpmem (lines[1], lengths[1], "four", 4);
+
+  /* Other reads see what the borrowed ones left */
+  g_assert_cmpint (g_data_input_stream_read_byte (stream, NULL, &error), ==, 'f');
+  g_assert_no_error (error);
+
+  line = g_data_input_stream_read_upto_borrowed (stream, "v", -1, &length, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpmem (line, length, "i", 1);
+
+  n = g_data_input_stream_read_lines_borrowed (stream, lines, lengths, G_N_ELEMENTS (lines), NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (n, ==, 1);
+  g_assert_cmpmem (lines[0], lengths[0], "ve", 2);
+
+  n = g_data_input_stream_read_lines_borrowed (stream, lines, lengths, G_N_ELEMENTS (lines), NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (n, ==, 0);
+
+  line = g_data_input_stream_read_line_borrowed (stream, &length, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_null (line);
+  g_assert_cmpuint (length, ==, 0);
+
+  g_object_unref (stream);
+  g_object_unref (base_stream);
+}
+
 static void
 test_read_lines_LF_valid_utf8 (void)
 {
@@ -329,6 +573,68 @@ test_read_upto (void)
   g_object_unref (base_stream);
   g_object_unref (stream);
 }
+static void
+test_read_upto_sets (void)
+{
+  /* Sets of one, several and many stop characters take different paths */
+  const char *stop_chars[] = { ",", ",;", ",;:|", ",;:|!?=+", "" };
+  GString *data;
+  GRand *rand;
+  guint i;
+
+  rand = g_rand_new_with_seed (7);
+  data = g_string_new (NULL);
+
+  for (i = 0; i < 5000; i++)
+    {
+      const char *alphabet = "abc,;:|!?=+";
+
+      g_string_append_c (data, alphabet[g_rand_int_range (rand, 0, strlen (alphabet))]);
+    }
+
+  for (i = 0; i < G_N_ELEMENTS (stop_chars); i++)
+    {
+      GInputStream *base_stream;
+      GDataInputStream *stream;
+      gsize pos = 0;
+
+      base_stream = g_memory_input_stream_new_from_data (data->str, data->len, NULL);
+      stream = g_data_input_stream_new (base_stream);
+      g_buffered_input_stream_set_buffer_size (G_BUFFERED_INPUT_STREAM (stream), 23);
+
+      while (pos < data->len)
+        {
+          GError *error = NULL;
+          gsize expected_length, length;
+          char *str;
+
+          expected_length = strcspn (data->str + pos, stop_chars[i]);
+
+          str = g_data_input_stream_read_upto (stream, stop_chars[i], -1,
+                                               &length, NULL, &error);
+          g_assert_no_error (error);
+          g_assert_nonnull (str);
+          g_assert_cmpuint (length, ==, expected_length);
+          g_assert_cmpmem (str, length, data->str + pos, expected_length);
+          g_free (str);
+          pos += length;
+
+          if (pos < data->len)
+            {
+              g_assert_cmpint (g_data_input_stream_read_byte (stream, NULL, &error), ==, data->str[pos]);
+              g_assert_no_error (error);
+              pos++;
+            }
+        }
+
+      g_object_unref (stream);
+      g_object_unref (base_stream);
+    }
+
+  g_string_free (data, TRUE);
+  g_rand_free (rand);
+}
+
 enum TestDataType {
   TEST_DATA_BYTE = 0,
   TEST_DATA_INT16,
@@ -488,6 +794,244 @@ test_read_int (void)
 }
 
 
+/* Writes @n_lines lines of 20 to 200 printable characters, each followed
+ * by @endl, to a new temporary file */
+static GFile *
+create_lines_file (GRand      *rand,
+                   guint       n_lines,
+                   const char *endl,
+                   gsize      *size)
+{
+  GString *data;
+  GFile *file;
+  GFileIOStream *iostream;
+  GError *error = NULL;
+  guint i;
+
+  data = g_string_sized_new (n_lines * 112);
+  for (i = 0; i < n_lines; i++)
+    {
+      guint line_len = g_rand_int_range (rand, 20, 200);
+      guint j;
+
+      for (j = 0; j < line_len; j++)
+        g_string_append_c (data, ' ' + g_rand_int_range (rand, 0, 95));
+      g_string_append (data, endl);
+    }
+
+  file = g_file_new_tmp ("g-data-input-stream-perf-XXXXXX", &iostream, &error);
+  g_assert_no_error (error);
+  g_output_stream_write_all (g_io_stream_get_output_stream (G_IO_STREAM (iostream)),
+                             data->str, data->len, NULL, NULL, &error);
+  g_assert_no_error (error);
+  g_io_stream_close (G_IO_STREAM (iostream), NULL, &error);
+  g_assert_no_error (error);
+
+  *size = data->len;
+
+  g_object_unref (iostream);
+  g_string_free (data, TRUE);
+
+  return file;
+}
+
+static void
+read_lines_perf (GFile                  *file,
+                 GDataStreamNewlineType  newline_type,
+                 const char             *stop_chars,
+                 gboolean                borrowed,
+                 gsize                   file_size,
+                 guint                   expected_lines)
+{
+  GFileInputStream *base_stream;
+  GDataInputStream *stream;
+  GError *error = NULL;
+  gdouble elapsed;
+  guint n_lines = 0;
+  const char *lines[64];
+  gsize lengths[G_N_ELEMENTS (lines)];
+  gsize length, n;
+  char *line;
+
+  base_stream = g_file_read (file, NULL, &error);
+  g_assert_no_error (error);
+  stream = g_data_input_stream_new (G_INPUT_STREAM (base_stream));
+  g_data_input_stream_set_newline_type (stream, newline_type);
+
+  g_test_timer_start ();
+
+  if (stop_chars != NULL && borrowed)
+    {
+      while (g_data_input_stream_read_upto_borrowed (stream, stop_chars, -1, &length, NULL, &error) != NULL)
+        {
+          g_data_input_stream_read_byte (stream, NULL, NULL);
+          n_lines++;
+        }
+    }
+  else if (stop_chars != NULL)
+    {
+      while ((line = g_data_input_stream_read_upto (stream, stop_chars, -1, NULL, NULL, &error)) != NULL)
+        {
+          g_data_input_stream_read_byte (stream, NULL, NULL);
+          g_free (line);
+          n_lines++;
+        }
+    }
+  else if (borrowed)
+    {
+      while ((n = g_data_input_stream_read_lines_borrowed (stream, lines, lengths, G_N_ELEMENTS (lines), NULL, &error)) > 0)
+        n_lines += n;
+    }
+  else
+    {
+      while ((line = g_data_input_stream_read_line (stream, NULL, NULL, &error)) != NULL)
+        {
+          g_free (line);
+          n_lines++;
+        }
+    }
+
+  elapsed = g_test_timer_elapsed ();
+
+  g_assert_no_error (error);
+  g_assert_cmpuint (n_lines, ==, expected_lines);
+
+  g_test_maximized_result (file_size / elapsed / (1024 * 1024),
+                           "Read %u lines (%s%s, newline type %d) at %.1f MiB/s",
+                           n_lines,
+                           stop_chars != NULL ? "read_upto" : borrowed ? "read_lines" : "read_line",
+                           borrowed ? "_borrowed" : "", newline_type, file_size / elapsed / (1024 * 1024));
+
+  g_object_unref (stream);
+  g_object_unref (base_stream);
+}
+
+static void
+test_read_lines_perf (void)
+{
+  const struct {
+    GDataStreamNewlineType newline_type;
+    const char *stop_chars;
+    gboolean borrowed;
+    const char *endl;
+  } modes[] = {
+    { G_DATA_STREAM_NEWLINE_TYPE_LF, NULL, FALSE, "\n" },
+    { G_DATA_STREAM_NEWLINE_TYPE_CR, NULL, FALSE, "\r" },
+    { G_DATA_STREAM_NEWLINE_TYPE_CR_LF, NULL, FALSE, "\r\n" },
+    { G_DATA_STREAM_NEWLINE_TYPE_ANY, NULL, FALSE, "\r\n" },
+    { G_DATA_STREAM_NEWLINE_TYPE_LF, "\n", FALSE, "\n" },
+    { G_DATA_STREAM_NEWLINE_TYPE_LF, "\t\f\n", FALSE, "\n" },
+    { G_DATA_STREAM_NEWLINE_TYPE_LF, NULL, TRUE, "\n" },
+    { G_DATA_STREAM_NEWLINE_TYPE_ANY, NULL, TRUE, "\r\n" },
+    { G_DATA_STREAM_NEWLINE_TYPE_LF, "\n", TRUE, "\n" },
+  };
+  const guint n_lines = 200000;
+  GRand *rand;
+  gsize i;
+
+  if (!g_test_perf ())
+    {
+      g_test_skip ("Performance tests not enabled");
+      return;
+    }
+
+  rand = g_rand_new_with_seed (1);
+
+  for (i = 0; i < G_N_ELEMENTS (modes); i++)
+    {
+      GFile *file;
+      gsize size;
+
+      file = create_lines_file (rand, n_lines, modes[i].endl, &size);
+
+      read_lines_perf (file, modes[i].newline_type, modes[i].stop_chars,
+                       modes[i].borrowed, size, n_lines);
+
+      g_file_delete (file, NULL, NULL);
+      g_object_unref (file);
+    }
+
+  g_rand_free (rand);
+}
+
+static void
+test_read_lines_buffering_perf (void)
+{
+  const struct {
+    gboolean adaptive;
+    gboolean readahead;
+  } modes[] = {
+    { FALSE, FALSE },
+    { TRUE, FALSE },
+    { FALSE, TRUE },
+    { TRUE, TRUE },
+  };
+  const guint n_lines = 600000;
+  guint first_hash = 0;
+  GRand *rand;
+  GFile *file;
+  gsize size;
+  gsize i;
+
+  if (!g_test_perf ())
+    {
+      g_test_skip ("Performance tests not enabled");
+      return;
+    }
+
+  rand = g_rand_new_with_seed (2);
+  file = create_lines_file (rand, n_lines, "\n", &size);
+
+  for (i = 0; i < G_N_ELEMENTS (modes); i++)
+    {
+      GFileInputStream *base_stream;
+      GDataInputStream *stream;
+      GError *error = NULL;
+      gdouble elapsed;
+      guint hash = 0;
+      guint n = 0;
+      char *line;
+
+      base_stream = g_file_read (file, NULL, &error);
+      g_assert_no_error (error);
+      stream = g_data_input_stream_new (G_INPUT_STREAM (base_stream));
+      g_buffered_input_stream_set_adaptive (G_BUFFERED_INPUT_STREAM (stream), modes[i].adaptive);
+      g_buffered_input_stream_set_readahead (G_BUFFERED_INPUT_STREAM (stream), modes[i].readahead);
+
+      g_test_timer_start ();
+
+      /* Hash the lines, as a stand-in for parsing them */
+      while ((line = g_data_input_stream_read_line (stream, NULL, NULL, &error)) != NULL)
+        {
+          hash ^= g_str_hash (line);
+          g_free (line);
+          n++;
+        }
+
+      elapsed = g_test_timer_elapsed ();
+
+      g_assert_no_error (error);
+      g_assert_cmpuint (n, ==, n_lines);
+      if (i == 0)
+        first_hash = hash;
+      g_assert_cmpuint (hash, ==, first_hash);
+
+      g_test_maximized_result (size / elapsed / (1024 * 1024),
+                               "Read %" G_GSIZE_FORMAT " MiB (adaptive %d, readahead %d, "
+                               "final buffer %" G_GSIZE_FORMAT " bytes) at %.1f MiB/s",
+                               size / (1024 * 1024), modes[i].adaptive, modes[i].readahead,
+                               g_buffered_input_stream_get_buffer_size (G_BUFFERED_INPUT_STREAM (stream)),
+                               size / elapsed / (1024 * 1024));
+
+      g_object_unref (stream);
+      g_object_unref (base_stream);
+    }
+
+  g_file_delete (file, NULL, NULL);
+  g_object_unref (file);
+  g_rand_free (rand);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -501,9 +1045,14 @@ main (int   argc,
   g_test_add_func ("/data-input-stream/read-lines-CR", test_read_lines_CR);
   g_test_add_func ("/data-input-stream/read-lines-CR-LF", test_read_lines_CR_LF);
   g_test_add_func ("/data-input-stream/read-lines-any", test_read_lines_any);
+  g_test_add_func ("/data-input-stream/read-lines-mixed", test_read_lines_mixed);
+  g_test_add_func ("/data-input-stream/read-lines-borrowed", test_read_lines_borrowed);
   g_test_add_func ("/data-input-stream/read-until", test_read_until);
   g_test_add_func ("/data-input-stream/read-upto", test_read_upto);
+  g_test_add_func ("/data-input-stream/read-upto-sets", test_read_upto_sets);
   g_test_add_func ("/data-input-stream/read-int", test_read_int);
+  g_test_add_func ("/data-input-stream/perf/read-lines", test_read_lines_perf);
+  g_test_add_func ("/data-input-stream/perf/read-lines-buffering", test_read_lines_buffering_perf);
 
   return g_test_run();
 }
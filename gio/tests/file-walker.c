@@ -0,0 +1,333 @@
+/* GIO - GLib Input, Output and Streaming Library
+ *
+ * SPDX-License-Identifier: LGPL-2.1-or-later
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General
+ * Public License along with this library; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+#include <gio/gio.h>
+
+/* The test tree has N_CHILD_DIRS subdirectories in each directory, down to
+ * DEPTH levels, and N_FILES regular files in every directory */
+#define N_FILES 40
+#define DEPTH 3
+#define N_CHILD_DIRS 3
+
+typedef struct
+{
+  GMainLoop *loop;
+  GHashTable *seen;  /* (element-type utf8 GFileType) relative path -> type */
+  guint n_batches;
+  guint max_batch_size;
+  gboolean walk_done;
+  GError *error;
+} WalkResult;
+
+static guint
+create_tree (GFile *dir,
+             guint  depth)
+{
+  guint n = 0;
+  guint i;
+
+  for (i = 0; i < N_FILES; i++)
+    {
+      gchar *name = g_strdup_printf ("file-%u", i);
+      GFile *file = g_file_get_child (dir, name);
+      GError *error = NULL;
+
+      g_file_replace_contents (file, "x", 1, NULL, FALSE, G_FILE_CREATE_NONE,
+                               NULL, NULL, &error);
+      g_assert_no_error (error);
+      n++;
+
+      g_object_unref (file);
+      g_free (name);
+    }
+
+  if (depth == DEPTH)
+    return n;
+
+  for (i = 0; i < N_CHILD_DIRS; i++)
+    {
+      gchar *name = g_strdup_printf ("dir-%u", i);
+      GFile *child = g_file_get_child (dir, name);
+      GError *error = NULL;
+
+      g_file_make_directory (child, NULL, &error);
+      g_assert_no_error (error);
+      n += 1 + create_tree (child, depth + 1);
+
+      g_object_unref (child);
+      g_free (name);
+    }
+
+  return n;
+}
+
+static void
+delete_tree (GFile *dir)
+{
+  GFileEnumerator *enumerator;
+  GFileInfo *info;
+  GFile *child;
+  GError *error = NULL;
+
+  enumerator = g_file_enumerate_children (dir, G_FILE_ATTRIBUTE_STANDARD_TYPE,
+                                          G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+                                          NULL, &error);
+  g_assert_no_error (error);
+
+  while (g_file_enumerator_iterate (enumerator, &info, &child, NULL, &error) && info != NULL)
+    {
+      if (g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY)
+        delete_tree (child);
+      else
+        {
+          g_file_delete (child, NULL, &error);
+          g_assert_no_error (error);
+        }
+    }
+  g_assert_no_error (error);
+  g_object_unref (enumerator);
+
+  g_file_delete (dir, NULL, &error);
+  g_assert_no_error (error);
+}
+
+static GFile *
+make_tree (guint *n_entries)
+{
+  gchar *path;
+  GFile *root;
+  GError *error = NULL;
+
+  path = g_dir_make_tmp ("file-walker-XXXXXX", &error);
+  g_assert_no_error (error);
+  root = g_file_new_for_path (path);
+  g_free (path);
+
+  *n_entries = create_tree (root, 0);
+
+  return root;
+}
+
+static void
+batch_cb (GFileWalker  *walker,
+          GFile       **files,
+          GFileInfo   **infos,
+          guint         n_files,
+          gpointer      user_data)
+{
+  WalkResult *result = user_data;
+  GFile *root = g_object_get_data (G_OBJECT (walker), "test-root");
+  guint i;
+
+  g_assert_false (result->walk_done);
+  g_assert_cmpuint (n_files, >, 0);
+
+  result->n_batches++;
+  result->max_batch_size = MAX (result->max_batch_size, n_files);
+
+  for (i = 0; i < n_files; i++)
+    {
+      gchar *relative = g_file_get_relative_path (root, files[i]);
+      gchar *basename = g_file_get_basename (files[i]);
+
+      g_assert_nonnull (relative);
+      g_assert_cmpstr (g_file_info_get_name (infos[i]), ==, basename);
+      g_free (basename);
+      g_assert_true (g_hash_table_insert (result->seen, relative,
+                                          GINT_TO_POINTER (g_file_info_get_file_type (infos[i]))));
+    }
+}
+
+static void
+walk_cb (GObject      *object,
+         GAsyncResult *res,
+         gpointer      user_data)
+{
+  WalkResult *result = user_data;
+
+  g_file_walker_walk_finish (G_FILE_WALKER (object), res, &result->error);
+  result->walk_done = TRUE;
+  g_main_loop_quit (result->loop);
+}
+
+static void
+walk_result_init (WalkResult *result)
+{
+  result->loop = g_main_loop_new (NULL, FALSE);
+  result->seen = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  result->n_batches = 0;
+  result->max_batch_size = 0;
+  result->walk_done = FALSE;
+  result->error = NULL;
+}
+
+static void
+walk_result_clear (WalkResult *result)
+{
+  g_main_loop_unref (result->loop);
+  g_hash_table_unref (result->seen);
+  g_clear_error (&result->error);
+}
+
+static void
+run_walk (GFileWalker  *walker,
+          GFile        *root,
+          GCancellable *cancellable,
+          WalkResult   *result)
+{
+  g_object_set_data_full (G_OBJECT (walker), "test-root", g_object_ref (root), g_object_unref);
+  g_file_walker_walk_async (walker, cancellable, batch_cb, result, walk_cb, result);
+  g_main_loop_run (result->loop);
+  g_assert_true (result->walk_done);
+}
+
+static void
+test_walk (void)
+{
+  GFile *root;
+  GFileWalker *walker;
+  WalkResult result;
+  guint n_entries;
+
+  root = make_tree (&n_entries);
+
+  walker = g_file_walker_new (root, G_FILE_ATTRIBUTE_STANDARD_SIZE, G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS);
+  g_assert_cmpuint (g_file_walker_get_batch_size (walker), ==, 256);
+  g_file_walker_set_max_threads (walker, 4);
+  g_assert_cmpuint (g_file_walker_get_max_threads (walker), ==, 4);
+  g_file_walker_set_batch_size (walker, 16);
+  g_assert_cmpuint (g_file_walker_get_batch_size (walker), ==, 16);
+
+  walk_result_init (&result);
+  run_walk (walker, root, NULL, &result);
+
+  g_assert_no_error (result.error);
+  g_assert_cmpuint (g_hash_table_size (result.seen), ==, n_entries);
+  g_assert_cmpuint (result.max_batch_size, <=, 16);
+  g_assert_cmpuint (result.n_batches, >=, n_entries / 16);
+  g_assert_cmpint (GPOINTER_TO_INT (g_hash_table_lookup (result.seen, "dir-0")), ==, G_FILE_TYPE_DIRECTORY);
+  g_assert_cmpint (GPOINTER_TO_INT (g_hash_table_lookup (result.seen, "dir-2/dir-1/dir-0/file-7")), ==, G_FILE_TYPE_REGULAR);
+  walk_result_clear (&result);
+
+  /* The walker can be reused once the walk is complete */
+  walk_result_init (&result);
+  run_walk (walker, root, NULL, &result);
+  g_assert_no_error (result.error);
+  g_assert_cmpuint (g_hash_table_size (result.seen), ==, n_entries);
+  walk_result_clear (&result);
+
+  g_object_unref (walker);
+  delete_tree (root);
+  g_object_unref (root);
+}
+
+static gboolean
+skip_dir_1 (GFileWalker *walker,
+            GFile       *file,
+            GFileInfo   *info,
+            gpointer     user_data)
+{
+  g_atomic_int_inc ((gint *) user_data);
+
+  return !(g_file_info_get_file_type (info) == G_FILE_TYPE_DIRECTORY &&
+           g_str_equal (g_file_info_get_name (info), "dir-1"));
+}
+
+static void
+test_walk_filter (void)
+{
+  GFile *root;
+  GFileWalker *walker;
+  WalkResult result;
+  GHashTableIter iter;
+  gpointer key;
+  guint n_entries;
+  gint n_filtered = 0;
+
+  root = make_tree (&n_entries);
+
+  walker = g_file_walker_new (root, NULL, G_FILE_QUERY_INFO_NONE);
+  g_file_walker_set_filter (walker, skip_dir_1, &n_filtered, NULL);
+
+  walk_result_init (&result);
+  run_walk (walker, root, NULL, &result);
+  g_assert_no_error (result.error);
+
+  /* No dir-1 at any level, nor anything below one */
+  g_hash_table_iter_init (&iter, result.seen);
+  while (g_hash_table_iter_next (&iter, &key, NULL))
+    g_assert_null (strstr (key, "dir-1"));
+
+  g_assert_cmpuint (g_hash_table_size (result.seen), <, n_entries);
+  g_assert_cmpint (n_filtered, >, g_hash_table_size (result.seen));
+  walk_result_clear (&result);
+
+  g_object_unref (walker);
+  delete_tree (root);
+  g_object_unref (root);
+}
+
+static void
+test_walk_errors (void)
+{
+  GFile *root, *missing;
+  GFileWalker *walker;
+  GCancellable *cancellable;
+  WalkResult result;
+  guint n_entries;
+
+  root = make_tree (&n_entries);
+
+  /* A missing root fails the walk */
+  missing = g_file_get_child (root, "missing");
+  walker = g_file_walker_new (missing, NULL, G_FILE_QUERY_INFO_NONE);
+  walk_result_init (&result);
+  run_walk (walker, missing, NULL, &result);
+  g_assert_error (result.error, G_IO_ERROR, G_IO_ERROR_NOT_FOUND);
+  g_assert_cmpuint (g_hash_table_size (result.seen), ==, 0);
+  walk_result_clear (&result);
+  g_object_unref (walker);
+  g_object_unref (missing);
+
+  /* So does cancelling it */
+  cancellable = g_cancellable_new ();
+  g_cancellable_cancel (cancellable);
+  walker = g_file_walker_new (root, NULL, G_FILE_QUERY_INFO_NONE);
+  walk_result_init (&result);
+  run_walk (walker, root, cancellable, &result);
+  g_assert_error (result.error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+  walk_result_clear (&result);
+  g_object_unref (walker);
+  g_object_unref (cancellable);
+
+  delete_tree (root);
+  g_object_unref (root);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/file-walker/walk", test_walk);
+  g_test_add_func ("/file-walker/filter", test_walk_filter);
+  g_test_add_func ("/file-walker/errors", test_walk_errors);
+
+  return g_test_run ();
+}
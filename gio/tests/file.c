@@ -9,6 +9,12 @@
 #ifdef G_OS_UNIX
 #include <sys/stat.h>
 #endif
+#ifdef __linux__
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#endif
 
 typedef struct
 {
@@ -2439,6 +2445,853 @@ test_copy_preserve_mode (void)
 #endif
 }
 
+static void
+test_enumerate_large_directory (void)
+{
+  GFile *tmpdir, *subdir;
+  GFileEnumerator *fenum;
+  GFileInfo *info;
+  GHashTable *names;
+  GError *error = NULL;
+  gchar *path, *padding;
+  guint i, n_files = 4000;
+
+  path = g_dir_make_tmp ("g_file_enumerate_large_XXXXXX", &error);
+  g_assert_no_error (error);
+  tmpdir = g_file_new_for_path (path);
+
+  /* With names of 200 bytes, each entry takes about 224 bytes on Linux,
+   * so these are around 900 KiB of entries: the 256 KiB getdents64()
+   * buffer has to be refilled at least three times */
+  padding = g_strnfill (190, 'x');
+  for (i = 0; i < n_files; i++)
+    {
+      gchar *name = g_strdup_printf ("%s/%s-%05u", path, padding, i);
+      g_file_set_contents (name, "", 0, &error);
+      g_assert_no_error (error);
+      g_free (name);
+    }
+  g_free (padding);
+  g_free (path);
+
+  subdir = g_file_get_child (tmpdir, "subdir");
+  g_file_make_directory (subdir, NULL, &error);
+  g_assert_no_error (error);
+  g_object_unref (subdir);
+
+  names = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+  fenum = g_file_enumerate_children (tmpdir,
+                                     G_FILE_ATTRIBUTE_STANDARD_NAME ","
+                                     G_FILE_ATTRIBUTE_STANDARD_TYPE,
+                                     G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+                                     NULL, &error);
+  g_assert_no_error (error);
+
+  while ((info = g_file_enumerator_next_file (fenum, NULL, &error)) != NULL)
+    {
+      const gchar *name = g_file_info_get_name (info);
+
+      if (g_str_equal (name, "subdir"))
+        g_assert_cmpint (g_file_info_get_file_type (info), ==, G_FILE_TYPE_DIRECTORY);
+      else
+        g_assert_cmpint (g_file_info_get_file_type (info), ==, G_FILE_TYPE_REGULAR);
+
+      g_assert_true (g_hash_table_add (names, g_strdup (name)));
+      g_object_unref (info);
+    }
+  g_assert_no_error (error);
+  g_assert_cmpuint (g_hash_table_size (names), ==, n_files + 1);
+
+  g_file_enumerator_close (fenum, NULL, &error);
+  g_assert_no_error (error);
+  g_object_unref (fenum);
+
+  /* Clean up */
+  fenum = g_file_enumerate_children (tmpdir, G_FILE_ATTRIBUTE_STANDARD_NAME,
+                                     G_FILE_QUERY_INFO_NOFOLLOW_SYMLINKS,
+                                     NULL, &error);
+  g_assert_no_error (error);
+  while ((info = g_file_enumerator_next_file (fenum, NULL, &error)) != NULL)
+    {
+      GFile *child = g_file_get_child (tmpdir, g_file_info_get_name (info));
+      g_file_delete (child, NULL, &error);
+      g_assert_no_error (error);
+      g_object_unref (child);
+      g_object_unref (info);
+    }
+  g_assert_no_error (error);
+  g_object_unref (fenum);
+
+  g_file_delete (tmpdir, NULL, &error);
+  g_assert_no_error (error);
+
+  g_hash_table_unref (names);
+  g_object_unref (tmpdir);
+}
+
+typedef struct
+{
+  goffset last_current;
+  goffset total;
+  guint n_calls;
+} CopyProgress;
+
+static void
+copy_progress_cb (goffset  current_num_bytes,
+                  goffset  total_num_bytes,
+                  gpointer user_data)
+{
+  CopyProgress *progress = user_data;
+
+  g_assert_cmpint (current_num_bytes, >=, progress->last_current);
+  progress->last_current = current_num_bytes;
+  progress->total = total_num_bytes;
+  progress->n_calls++;
+}
+
+static void
+test_copy_large (void)
+{
+  GFile *tmpfile;
+  GFile *dest_tmpfile;
+  GFileIOStream *iostream;
+  GError *local_error = NULL;
+  CopyProgress progress = { 0, 0, 0 };
+  gchar *data, *contents;
+  gsize size, i, length;
+
+  /* Big enough to need several chunks in whichever fast path is used */
+  size = 17 * 1024 * 1024 + 123;
+  data = g_malloc (size);
+  for (i = 0; i < size; i++)
+    data[i] = (gchar) (i * 7 + i / 4096);
+
+  tmpfile = g_file_new_tmp ("tmp-copy-largeXXXXXX", &iostream, &local_error);
+  g_assert_no_error (local_error);
+  g_output_stream_write_all (g_io_stream_get_output_stream (G_IO_STREAM (iostream)),
+                             data, size, NULL, NULL, &local_error);
+  g_assert_no_error (local_error);
+  g_io_stream_close (G_IO_STREAM (iostream), NULL, &local_error);
+  g_assert_no_error (local_error);
+  g_clear_object (&iostream);
+
+  dest_tmpfile = g_file_new_tmp ("tmp-copy-largeXXXXXX", &iostream, &local_error);
+  g_assert_no_error (local_error);
+  g_io_stream_close (G_IO_STREAM (iostream), NULL, &local_error);
+  g_assert_no_error (local_error);
+  g_clear_object (&iostream);
+
+  g_file_copy (tmpfile, dest_tmpfile, G_FILE_COPY_OVERWRITE,
+               NULL, copy_progress_cb, &progress, &local_error);
+  g_assert_no_error (local_error);
+
+  g_assert_cmpuint (progress.n_calls, >, 0);
+  g_assert_cmpint (progress.last_current, ==, size);
+  g_assert_cmpint (progress.total, ==, size);
+
+  g_file_load_contents (dest_tmpfile, NULL, &contents, &length, NULL, &local_error);
+  g_assert_no_error (local_error);
+  g_assert_cmpmem (contents, length, data, size);
+
+  (void) g_file_delete (tmpfile, NULL, NULL);
+  (void) g_file_delete (dest_tmpfile, NULL, NULL);
+
+  g_free (contents);
+  g_free (data);
+  g_clear_object (&tmpfile);
+  g_clear_object (&dest_tmpfile);
+}
+
+/* What g_file_copy() falls back to when no fast path works */
+static void
+copy_userspace (GFile *source,
+                GFile *destination)
+{
+  GFileInputStream *in;
+  GFileOutputStream *out;
+  GError *local_error = NULL;
+  gchar *buffer;
+  gssize n_read;
+
+  in = g_file_read (source, NULL, &local_error);
+  g_assert_no_error (local_error);
+  out = g_file_replace (destination, NULL, FALSE, G_FILE_CREATE_NONE, NULL, &local_error);
+  g_assert_no_error (local_error);
+
+  buffer = g_malloc (256 * 1024);
+  while ((n_read = g_input_stream_read (G_INPUT_STREAM (in), buffer, 256 * 1024, NULL, &local_error)) > 0)
+    {
+      g_output_stream_write_all (G_OUTPUT_STREAM (out), buffer, n_read, NULL, NULL, &local_error);
+      g_assert_no_error (local_error);
+    }
+  g_assert_no_error (local_error);
+
+  g_output_stream_close (G_OUTPUT_STREAM (out), NULL, &local_error);
+  g_assert_no_error (local_error);
+
+  g_free (buffer);
+  g_object_unref (out);
+  g_object_unref (in);
+}
+
+static void
+test_copy_perf (void)
+{
+  const gsize size = 256 * 1024 * 1024;
+  const gchar *dirs[2];
+  gsize i;
+
+  if (!g_test_perf ())
+    {
+      g_test_skip ("Performance tests not enabled");
+      return;
+    }
+
+  /* The temporary directory is typically on tmpfs, and the build directory
+   * on a disk file system such as ext4 */
+  dirs[0] = g_get_tmp_dir ();
+  dirs[1] = g_test_get_dir (G_TEST_BUILT);
+
+  for (i = 0; i < G_N_ELEMENTS (dirs); i++)
+    {
+      GFile *dir, *source, *destination;
+      GFileInfo *fs_info;
+      GError *local_error = NULL;
+      gchar *path, *data;
+      const gchar *fs_type;
+      gdouble elapsed, userspace_elapsed;
+
+      path = g_build_filename (dirs[i], "copy-perf-source", NULL);
+      data = g_malloc0 (size);
+      g_file_set_contents (path, data, size, &local_error);
+      g_assert_no_error (local_error);
+      g_free (data);
+
+      source = g_file_new_for_path (path);
+      dir = g_file_get_parent (source);
+      destination = g_file_get_child (dir, "copy-perf-destination");
+      g_free (path);
+
+      fs_info = g_file_query_filesystem_info (dir, G_FILE_ATTRIBUTE_FILESYSTEM_TYPE, NULL, NULL);
+      fs_type = fs_info ? g_file_info_get_attribute_string (fs_info, G_FILE_ATTRIBUTE_FILESYSTEM_TYPE) : NULL;
+
+      g_test_timer_start ();
+      g_file_copy (source, destination, G_FILE_COPY_OVERWRITE, NULL, NULL, NULL, &local_error);
+      g_assert_no_error (local_error);
+      elapsed = g_test_timer_elapsed ();
+
+      g_test_timer_start ();
+      copy_userspace (source, destination);
+      userspace_elapsed = g_test_timer_elapsed ();
+
+      g_test_message ("%s (%s): g_file_copy %.1f MB/s, read/write loop %.1f MB/s",
+                      dirs[i], fs_type ? fs_type : "unknown",
+                      size / elapsed / (1024 * 1024),
+                      size / userspace_elapsed / (1024 * 1024));
+      g_test_maximized_result (size / elapsed / (1024 * 1024),
+                               "%.1f MB/s copying %" G_GSIZE_FORMAT " MiB on %s",
+                               size / elapsed / (1024 * 1024), size / (1024 * 1024),
+                               fs_type ? fs_type : dirs[i]);
+
+      (void) g_file_delete (source, NULL, NULL);
+      (void) g_file_delete (destination, NULL, NULL);
+
+      g_clear_object (&fs_info);
+      g_object_unref (destination);
+      g_object_unref (source);
+      g_object_unref (dir);
+    }
+}
+
+static void
+async_result_cb (GObject      *source_object,
+                 GAsyncResult *result,
+                 gpointer      user_data)
+{
+  GAsyncResult **result_out = user_data;
+
+  g_assert_null (*result_out);
+  *result_out = g_object_ref (result);
+  g_main_context_wakeup (NULL);
+}
+
+/* Reads a local file with many small asynchronous reads on several
+ * streams at once, the way the io_uring backend is meant to be used */
+#define ASYNC_READ_N_STREAMS 8
+#define ASYNC_READ_CHUNK 512
+
+typedef struct
+{
+  GInputStream *stream;
+  guint8 buffer[ASYNC_READ_CHUNK];
+  GByteArray *contents;
+  guint *n_pending;
+} AsyncReader;
+
+static void
+async_reader_read_cb (GObject      *object,
+                      GAsyncResult *result,
+                      gpointer      user_data)
+{
+  AsyncReader *reader = user_data;
+  GError *local_error = NULL;
+  gssize nread;
+
+  nread = g_input_stream_read_finish (G_INPUT_STREAM (object), result, &local_error);
+  g_assert_no_error (local_error);
+
+  if (nread > 0)
+    {
+      g_byte_array_append (reader->contents, reader->buffer, nread);
+      g_input_stream_read_async (reader->stream, reader->buffer, sizeof (reader->buffer),
+                                 G_PRIORITY_DEFAULT, NULL, async_reader_read_cb, reader);
+    }
+  else
+    {
+      (*reader->n_pending)--;
+      g_main_context_wakeup (NULL);
+    }
+}
+
+static void
+read_file_async_concurrently (GFile  *file,
+                              gsize   expected_size)
+{
+  AsyncReader readers[ASYNC_READ_N_STREAMS];
+  guint n_pending = ASYNC_READ_N_STREAMS;
+  guint i;
+
+  for (i = 0; i < ASYNC_READ_N_STREAMS; i++)
+    {
+      GError *local_error = NULL;
+
+      readers[i].stream = G_INPUT_STREAM (g_file_read (file, NULL, &local_error));
+      g_assert_no_error (local_error);
+      readers[i].contents = g_byte_array_new ();
+      readers[i].n_pending = &n_pending;
+      g_input_stream_read_async (readers[i].stream, readers[i].buffer, sizeof (readers[i].buffer),
+                                 G_PRIORITY_DEFAULT, NULL, async_reader_read_cb, &readers[i]);
+    }
+
+  while (n_pending > 0)
+    g_main_context_iteration (NULL, TRUE);
+
+  for (i = 0; i < ASYNC_READ_N_STREAMS; i++)
+    {
+      g_assert_cmpuint (readers[i].contents->len, ==, expected_size);
+      if (i > 0)
+        g_assert_cmpmem (readers[i].contents->data, readers[i].contents->len,
+                         readers[0].contents->data, readers[0].contents->len);
+
+      g_byte_array_unref (readers[i].contents);
+      g_object_unref (readers[i].stream);
+    }
+}
+
+static void
+check_async_read_write_many (void)
+{
+  const gsize size = 256 * 1024;
+  GFile *file;
+  GFileIOStream *iostream;
+  GOutputStream *out;
+  GInputStream *in;
+  GCancellable *cancellable;
+  GAsyncResult *result = NULL;
+  GError *local_error = NULL;
+  guint8 *data;
+  gchar *contents;
+  gsize length, bytes_written;
+  guint8 buffer[16];
+  gssize nread;
+  gsize i;
+
+  data = g_malloc (size);
+  for (i = 0; i < size; i++)
+    data[i] = (guint8) (i * 7 + i / 251);
+
+  file = g_file_new_tmp ("g_file_async_read_write_many_XXXXXX", &iostream, &local_error);
+  g_assert_no_error (local_error);
+  g_object_unref (iostream);
+
+  /* Write the data in one go, which takes several write() calls if the
+   * backend does short writes */
+  out = G_OUTPUT_STREAM (g_file_replace (file, NULL, FALSE, G_FILE_CREATE_NONE, NULL, &local_error));
+  g_assert_no_error (local_error);
+  g_output_stream_write_all_async (out, data, size, G_PRIORITY_DEFAULT, NULL,
+                                   async_result_cb, &result);
+  while (result == NULL)
+    g_main_context_iteration (NULL, TRUE);
+  g_output_stream_write_all_finish (out, result, &bytes_written, &local_error);
+  g_assert_no_error (local_error);
+  g_assert_cmpuint (bytes_written, ==, size);
+  g_clear_object (&result);
+  g_output_stream_close (out, NULL, &local_error);
+  g_assert_no_error (local_error);
+  g_object_unref (out);
+
+  g_file_load_contents (file, NULL, &contents, &length, NULL, &local_error);
+  g_assert_no_error (local_error);
+  g_assert_cmpmem (contents, length, data, size);
+  g_free (contents);
+
+  read_file_async_concurrently (file, size);
+
+  /* Asynchronous reads start at the current position, like read() does */
+  in = G_INPUT_STREAM (g_file_read (file, NULL, &local_error));
+  g_assert_no_error (local_error);
+  g_seekable_seek (G_SEEKABLE (in), 1000, G_SEEK_SET, NULL, &local_error);
+  g_assert_no_error (local_error);
+  g_input_stream_read_async (in, buffer, sizeof (buffer), G_PRIORITY_DEFAULT, NULL,
+                             async_result_cb, &result);
+  while (result == NULL)
+    g_main_context_iteration (NULL, TRUE);
+  nread = g_input_stream_read_finish (in, result, &local_error);
+  g_assert_no_error (local_error);
+  g_assert_cmpint (nread, ==, sizeof (buffer));
+  g_assert_cmpmem (buffer, sizeof (buffer), data + 1000, sizeof (buffer));
+  g_assert_cmpint (g_seekable_tell (G_SEEKABLE (in)), ==, 1000 + sizeof (buffer));
+  g_clear_object (&result);
+
+  /* Skipping seeks, and reports how far it went */
+  g_input_stream_skip_async (in, size, G_PRIORITY_DEFAULT, NULL, async_result_cb, &result);
+  while (result == NULL)
+    g_main_context_iteration (NULL, TRUE);
+  g_assert_cmpint (g_input_stream_skip_finish (in, result, &local_error), ==, size - 1000 - sizeof (buffer));
+  g_assert_no_error (local_error);
+  g_clear_object (&result);
+
+  /* A read cancelled before it starts fails */
+  cancellable = g_cancellable_new ();
+  g_cancellable_cancel (cancellable);
+  g_input_stream_read_async (in, buffer, sizeof (buffer), G_PRIORITY_DEFAULT, cancellable,
+                             async_result_cb, &result);
+  while (result == NULL)
+    g_main_context_iteration (NULL, TRUE);
+  nread = g_input_stream_read_finish (in, result, &local_error);
+  g_assert_error (local_error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+  g_assert_cmpint (nread, ==, -1);
+  g_clear_error (&local_error);
+  g_clear_object (&result);
+  g_object_unref (cancellable);
+
+  g_object_unref (in);
+
+  (void) g_file_delete (file, NULL, NULL);
+  g_object_unref (file);
+  g_free (data);
+}
+
+static void
+test_async_read_write_many (void)
+{
+  g_test_summary ("Test many concurrent small asynchronous reads and writes on local files");
+
+  check_async_read_write_many ();
+}
+
+#ifdef __linux__
+static guint
+count_io_uring_fds (void)
+{
+  GDir *dir;
+  const gchar *name;
+  guint n_found = 0;
+
+  dir = g_dir_open ("/proc/self/fd", 0, NULL);
+  g_assert_nonnull (dir);
+
+  while ((name = g_dir_read_name (dir)) != NULL)
+    {
+      gchar *path = g_build_filename ("/proc/self/fd", name, NULL);
+      gchar *target = g_file_read_link (path, NULL);
+
+      if (g_strcmp0 (target, "anon_inode:[io_uring]") == 0)
+        n_found++;
+
+      g_free (target);
+      g_free (path);
+    }
+
+  g_dir_close (dir);
+
+  return n_found;
+}
+#endif
+
+static void
+test_async_read_write_many_no_io_uring (void)
+{
+  g_test_summary ("Test that asynchronous reads and writes on local files "
+                  "work in threads when io_uring is disabled");
+
+  if (g_test_subprocess ())
+    {
+      /* io_uring support is only looked at on the first asynchronous
+       * operation, so this is early enough */
+      g_setenv ("GIO_USE_IO_URING", "0", TRUE);
+
+      check_async_read_write_many ();
+
+#ifdef __linux__
+      g_assert_cmpuint (count_io_uring_fds (), ==, 0);
+#endif
+      return;
+    }
+
+  g_test_trap_subprocess (NULL, 0, G_TEST_SUBPROCESS_DEFAULT);
+  g_test_trap_assert_passed ();
+}
+
+#ifdef __linux__
+/* Reads a few bytes from @file asynchronously, in @context */
+static void
+read_file_async_in_context (GFile        *file,
+                            GMainContext *context)
+{
+  GInputStream *in;
+  GAsyncResult *result = NULL;
+  GError *local_error = NULL;
+  guint8 buffer[16];
+
+  g_main_context_push_thread_default (context);
+
+  in = G_INPUT_STREAM (g_file_read (file, NULL, &local_error));
+  g_assert_no_error (local_error);
+  g_input_stream_read_async (in, buffer, sizeof (buffer), G_PRIORITY_DEFAULT, NULL,
+                             async_result_cb, &result);
+  while (result == NULL)
+    g_main_context_iteration (context, TRUE);
+  g_assert_cmpint (g_input_stream_read_finish (in, result, &local_error), ==, sizeof (buffer));
+  g_assert_no_error (local_error);
+  g_object_unref (result);
+  g_object_unref (in);
+
+  g_main_context_pop_thread_default (context);
+}
+#endif
+
+static void
+test_async_read_io_uring_emfile (void)
+{
+#ifdef __linux__
+  GFile *file;
+  GFileIOStream *iostream;
+  GMainContext *contexts[3];
+  GArray *fds;
+  struct rlimit limit;
+  GError *local_error = NULL;
+  guint i;
+  int fd;
+#endif
+
+  g_test_summary ("Test that io_uring is used again after failing to set up "
+                  "a ring for lack of file descriptors");
+
+#ifdef __linux__
+  if (!g_test_subprocess ())
+    {
+      g_test_trap_subprocess (NULL, 0, G_TEST_SUBPROCESS_DEFAULT);
+      g_test_trap_assert_passed ();
+      return;
+    }
+
+  file = g_file_new_tmp ("g_file_async_read_io_uring_emfile_XXXXXX", &iostream, &local_error);
+  g_assert_no_error (local_error);
+  g_output_stream_write_all (g_io_stream_get_output_stream (G_IO_STREAM (iostream)),
+                             "0123456789abcdef", 16, NULL, NULL, &local_error);
+  g_assert_no_error (local_error);
+  g_object_unref (iostream);
+
+  for (i = 0; i < G_N_ELEMENTS (contexts); i++)
+    contexts[i] = g_main_context_new ();
+
+  /* Each context gets a ring of its own */
+  read_file_async_in_context (file, contexts[0]);
+  if (count_io_uring_fds () == 0)
+    {
+      g_test_message ("io_uring is not available");
+      goto out;
+    }
+
+  /* Use up the file descriptors before the stream is opened in the second
+   * context, but leave one for it */
+  g_assert_no_errno (getrlimit (RLIMIT_NOFILE, &limit));
+  limit.rlim_cur = MIN (limit.rlim_cur, 256);
+  g_assert_no_errno (setrlimit (RLIMIT_NOFILE, &limit));
+  fds = g_array_new (FALSE, FALSE, sizeof (int));
+  while ((fd = open ("/dev/null", O_RDONLY | O_CLOEXEC)) >= 0)
+    g_array_append_val (fds, fd);
+  g_assert_cmpint (errno, ==, EMFILE);
+  g_assert_cmpuint (fds->len, >, 0);
+  close (g_array_index (fds, int, --fds->len));
+
+  read_file_async_in_context (file, contexts[1]);
+  g_assert_cmpuint (count_io_uring_fds (), ==, 1);
+
+  for (i = 0; i < fds->len; i++)
+    close (g_array_index (fds, int, i));
+  g_array_unref (fds);
+
+  read_file_async_in_context (file, contexts[2]);
+  g_assert_cmpuint (count_io_uring_fds (), ==, 2);
+
+out:
+  for (i = 0; i < G_N_ELEMENTS (contexts); i++)
+    g_main_context_unref (contexts[i]);
+  (void) g_file_delete (file, NULL, NULL);
+  g_object_unref (file);
+#else
+  g_test_skip ("io_uring is only used on Linux");
+#endif
+}
+
+static void
+test_async_read_perf (void)
+{
+  const gsize size = 4 * 1024 * 1024;
+  const guint n_passes = 8;
+  GFile *file;
+  GFileIOStream *iostream;
+  GError *local_error = NULL;
+  gchar *data;
+  gdouble elapsed;
+  guint i;
+
+  if (!g_test_perf ())
+    {
+      g_test_skip ("Performance tests not enabled");
+      return;
+    }
+
+  file = g_file_new_tmp ("g_file_async_read_perf_XXXXXX", &iostream, &local_error);
+  g_assert_no_error (local_error);
+  g_object_unref (iostream);
+
+  data = g_malloc0 (size);
+  g_file_replace_contents (file, data, size, NULL, FALSE, G_FILE_CREATE_NONE, NULL, NULL, &local_error);
+  g_assert_no_error (local_error);
+  g_free (data);
+
+  g_test_timer_start ();
+  for (i = 0; i < n_passes; i++)
+    read_file_async_concurrently (file, size);
+  elapsed = g_test_timer_elapsed ();
+
+  g_test_maximized_result (n_passes * ASYNC_READ_N_STREAMS * (size / ASYNC_READ_CHUNK) / elapsed,
+                           "%.0f asynchronous %u-byte reads/s",
+                           n_passes * ASYNC_READ_N_STREAMS * (size / ASYNC_READ_CHUNK) / elapsed,
+                           ASYNC_READ_CHUNK);
+
+  (void) g_file_delete (file, NULL, NULL);
+  g_object_unref (file);
+}
+
+static GFile *
+create_patterned_file (gsize    size,
+                       guint8 **data_out)
+{
+  GFile *file;
+  GFileIOStream *iostream;
+  GError *local_error = NULL;
+  guint8 *data;
+  gsize i;
+
+  data = g_malloc (size);
+  for (i = 0; i < size; i++)
+    data[i] = (guint8) (i * 7 + i / 251);
+
+  file = g_file_new_tmp ("g_file_read_bytes_XXXXXX", &iostream, &local_error);
+  g_assert_no_error (local_error);
+  g_object_unref (iostream);
+
+  g_file_replace_contents (file, (const char *) data, size, NULL, FALSE,
+                           G_FILE_CREATE_NONE, NULL, NULL, &local_error);
+  g_assert_no_error (local_error);
+
+  *data_out = data;
+  return file;
+}
+
+static void
+test_read_bytes_mapped (void)
+{
+  const gsize size = 4 * 1024 * 1024;
+  const gsize chunk = 256 * 1024;
+  GFile *file;
+  GInputStream *in;
+  GBytes *bytes, *previous = NULL;
+  GAsyncResult *result = NULL;
+  GError *local_error = NULL;
+  guint8 *data;
+  guint8 buffer[16];
+  gsize offset = 0;
+  gssize nread;
+
+  g_test_summary ("Test that large g_input_stream_read_bytes() calls on local files "
+                  "return the right data, without copying it if asked to");
+
+  file = create_patterned_file (size, &data);
+
+  /* By default, the data is copied */
+  in = G_INPUT_STREAM (g_file_read (file, NULL, &local_error));
+  g_assert_no_error (local_error);
+  previous = g_input_stream_read_bytes (in, chunk, NULL, &local_error);
+  g_assert_no_error (local_error);
+  bytes = g_input_stream_read_bytes (in, chunk, NULL, &local_error);
+  g_assert_no_error (local_error);
+  g_assert_cmpmem (g_bytes_get_data (bytes, NULL), g_bytes_get_size (bytes), data + chunk, chunk);
+  g_assert_true ((const guint8 *) g_bytes_get_data (previous, NULL) + chunk !=
+                 g_bytes_get_data (bytes, NULL));
+  g_clear_pointer (&previous, g_bytes_unref);
+  g_bytes_unref (bytes);
+  g_object_unref (in);
+
+  in = G_INPUT_STREAM (g_file_read (file, NULL, &local_error));
+  g_assert_no_error (local_error);
+  g_assert_false (g_file_input_stream_get_map_reads (G_FILE_INPUT_STREAM (in)));
+  g_file_input_stream_set_map_reads (G_FILE_INPUT_STREAM (in), TRUE);
+  g_assert_true (g_file_input_stream_get_map_reads (G_FILE_INPUT_STREAM (in)));
+
+  /* A small read first, which is a plain copy */
+  bytes = g_input_stream_read_bytes (in, 100, NULL, &local_error);
+  g_assert_no_error (local_error);
+  g_assert_cmpmem (g_bytes_get_data (bytes, NULL), g_bytes_get_size (bytes), data, 100);
+  g_bytes_unref (bytes);
+  offset = 100;
+
+  while (TRUE)
+    {
+      bytes = g_input_stream_read_bytes (in, chunk, NULL, &local_error);
+      g_assert_no_error (local_error);
+      if (g_bytes_get_size (bytes) == 0)
+        {
+          g_bytes_unref (bytes);
+          break;
+        }
+
+      g_assert_cmpmem (g_bytes_get_data (bytes, NULL), g_bytes_get_size (bytes),
+                       data + offset, MIN (chunk, size - offset));
+
+#ifdef G_OS_UNIX
+      /* Consecutive slices of the same mapping follow each other in memory */
+      if (previous != NULL)
+        g_assert_true ((const guint8 *) g_bytes_get_data (previous, NULL) + chunk ==
+                       g_bytes_get_data (bytes, NULL));
+#endif
+
+      offset += g_bytes_get_size (bytes);
+      g_assert_cmpint (g_seekable_tell (G_SEEKABLE (in)), ==, offset);
+      g_clear_pointer (&previous, g_bytes_unref);
+      previous = bytes;
+    }
+  g_assert_cmpuint (offset, ==, size);
+
+  /* The slices stay valid after the stream is gone */
+  g_object_unref (in);
+  g_assert_cmpmem (g_bytes_get_data (previous, NULL), g_bytes_get_size (previous),
+                   data + size - g_bytes_get_size (previous), g_bytes_get_size (previous));
+  g_bytes_unref (previous);
+
+  /* Seeking, reading and reading bytes asynchronously all agree on the
+   * position in the file */
+  in = G_INPUT_STREAM (g_file_read (file, NULL, &local_error));
+  g_assert_no_error (local_error);
+  g_file_input_stream_set_map_reads (G_FILE_INPUT_STREAM (in), TRUE);
+  g_seekable_seek (G_SEEKABLE (in), size / 2, G_SEEK_SET, NULL, &local_error);
+  g_assert_no_error (local_error);
+  bytes = g_input_stream_read_bytes (in, chunk, NULL, &local_error);
+  g_assert_no_error (local_error);
+  g_assert_cmpmem (g_bytes_get_data (bytes, NULL), g_bytes_get_size (bytes), data + size / 2, chunk);
+  g_bytes_unref (bytes);
+
+  nread = g_input_stream_read (in, buffer, sizeof (buffer), NULL, &local_error);
+  g_assert_no_error (local_error);
+  g_assert_cmpmem (buffer, nread, data + size / 2 + chunk, sizeof (buffer));
+
+  g_input_stream_read_bytes_async (in, chunk, G_PRIORITY_DEFAULT, NULL, async_result_cb, &result);
+  while (result == NULL)
+    g_main_context_iteration (NULL, TRUE);
+  bytes = g_input_stream_read_bytes_finish (in, result, &local_error);
+  g_assert_no_error (local_error);
+  g_assert_cmpmem (g_bytes_get_data (bytes, NULL), g_bytes_get_size (bytes),
+                   data + size / 2 + chunk + sizeof (buffer), chunk);
+  g_bytes_unref (bytes);
+  g_clear_object (&result);
+
+  /* A closed stream fails as before */
+  g_input_stream_close (in, NULL, &local_error);
+  g_assert_no_error (local_error);
+  bytes = g_input_stream_read_bytes (in, chunk, NULL, &local_error);
+  g_assert_error (local_error, G_IO_ERROR, G_IO_ERROR_CLOSED);
+  g_assert_null (bytes);
+  g_clear_error (&local_error);
+  g_object_unref (in);
+
+  (void) g_file_delete (file, NULL, NULL);
+  g_object_unref (file);
+  g_free (data);
+}
+
+static void
+test_read_bytes_perf (void)
+{
+  const gsize size = 64 * 1024 * 1024;
+  const gsize chunk = 1024 * 1024;
+  const guint n_passes = 8;
+  GFile *file;
+  GError *local_error = NULL;
+  guint8 *data;
+  gdouble elapsed;
+  guint64 checksum = 0;
+  guint i;
+
+  if (!g_test_perf ())
+    {
+      g_test_skip ("Performance tests not enabled");
+      return;
+    }
+
+  file = create_patterned_file (size, &data);
+  g_free (data);
+
+  g_test_timer_start ();
+
+  for (i = 0; i < n_passes; i++)
+    {
+      GInputStream *in;
+      GBytes *bytes;
+
+      in = G_INPUT_STREAM (g_file_read (file, NULL, &local_error));
+      g_assert_no_error (local_error);
+      g_file_input_stream_set_map_reads (G_FILE_INPUT_STREAM (in), TRUE);
+
+      /* Touch one byte per page, as a parser would at least do */
+      while ((bytes = g_input_stream_read_bytes (in, chunk, NULL, &local_error)) != NULL &&
+             g_bytes_get_size (bytes) > 0)
+        {
+          gsize length, j;
+          const guint8 *p = g_bytes_get_data (bytes, &length);
+
+          for (j = 0; j < length; j += 4096)
+            checksum += p[j];
+          g_bytes_unref (bytes);
+        }
+      g_assert_no_error (local_error);
+      g_clear_pointer (&bytes, g_bytes_unref);
+      g_object_unref (in);
+    }
+
+  elapsed = g_test_timer_elapsed ();
+  g_test_message ("checksum %" G_GUINT64_FORMAT, checksum);
+  g_test_maximized_result (n_passes * size / elapsed / (1024 * 1024),
+                           "%.1f MB/s reading bytes in %" G_GSIZE_FORMAT " KiB chunks",
+                           n_passes * size / elapsed / (1024 * 1024), chunk / 1024);
+
+  (void) g_file_delete (file, NULL, NULL);
+  g_object_unref (file);
+}
+
 static gchar *
 splice_to_string (GInputStream   *stream,
                   GError        **error)
@@ -3845,6 +4698,15 @@ main (int argc, char *argv[])
   g_test_add_func ("/file/async-delete", test_async_delete);
   g_test_add_func ("/file/async-make-symlink", test_async_make_symlink);
   g_test_add_func ("/file/copy-preserve-mode", test_copy_preserve_mode);
+  g_test_add_func ("/file/enumerate/large-directory", test_enumerate_large_directory);
+  g_test_add_func ("/file/copy/large", test_copy_large);
+  g_test_add_func ("/file/perf/copy", test_copy_perf);
+  g_test_add_func ("/file/async-read-write-many", test_async_read_write_many);
+  g_test_add_func ("/file/async-read-write-many/no-io-uring", test_async_read_write_many_no_io_uring);
+  g_test_add_func ("/file/async-read/io-uring-emfile", test_async_read_io_uring_emfile);
+  g_test_add_func ("/file/perf/async-read", test_async_read_perf);
+  g_test_add_func ("/file/read-bytes-mapped", test_read_bytes_mapped);
+  g_test_add_func ("/file/perf/read-bytes", test_read_bytes_perf);
   g_test_add_func ("/file/measure", test_measure);
   g_test_add_func ("/file/measure-async", test_measure_async);
   g_test_add_func ("/file/load-bytes", test_load_bytes);
@@ -1095,6 +1095,299 @@ test_xattrs (void)
   g_object_unref (file);
 }
 
+static void
+test_common_attributes (void)
+{
+  GFileInfo *info, *copy;
+  GFileAttributeMatcher *matcher;
+  gchar **names;
+  const gchar *expected[] = {
+    G_FILE_ATTRIBUTE_STANDARD_TYPE,
+    G_FILE_ATTRIBUTE_STANDARD_IS_HIDDEN,
+    G_FILE_ATTRIBUTE_STANDARD_NAME,
+    G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE,
+    G_FILE_ATTRIBUTE_STANDARD_SIZE,
+    G_FILE_ATTRIBUTE_TIME_MODIFIED,
+    G_FILE_ATTRIBUTE_TIME_MODIFIED_USEC,
+    G_FILE_ATTRIBUTE_TIME_MODIFIED_NSEC,
+    "xattr::test",
+    NULL
+  };
+  GDateTime *dt;
+
+  g_test_summary ("Test the common attributes through the generic attribute API");
+
+  dt = g_date_time_new_from_unix_utc (1234);
+
+  /* Set them in an order different from their ids */
+  info = g_file_info_new ();
+  g_file_info_set_attribute_string (info, "xattr::test", "value");
+  g_file_info_set_modification_date_time (info, dt);
+  g_file_info_set_attribute_uint32 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED_NSEC, 5);
+  g_file_info_set_size (info, 42);
+  g_file_info_set_content_type (info, "text/plain");
+  g_file_info_set_is_hidden (info, TRUE);
+  g_file_info_set_name (info, "name");
+  g_file_info_set_file_type (info, G_FILE_TYPE_REGULAR);
+
+  names = g_file_info_list_attributes (info, NULL);
+  g_assert_cmpstrv (names, expected);
+  g_strfreev (names);
+
+  names = g_file_info_list_attributes (info, "standard");
+  g_assert_cmpuint (g_strv_length (names), ==, 5);
+  g_strfreev (names);
+
+  g_assert_true (g_file_info_has_namespace (info, "time"));
+  g_assert_true (g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_STANDARD_NAME));
+  g_assert_false (g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_STANDARD_DISPLAY_NAME));
+  g_assert_cmpint (g_file_info_get_attribute_type (info, G_FILE_ATTRIBUTE_STANDARD_SIZE), ==, G_FILE_ATTRIBUTE_TYPE_UINT64);
+  g_assert_cmpstr (g_file_info_get_attribute_byte_string (info, G_FILE_ATTRIBUTE_STANDARD_NAME), ==, "name");
+  g_assert_cmpuint (g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED), ==, 1234);
+
+  /* Copies keep them */
+  copy = g_file_info_dup (info);
+  g_assert_cmpstr (g_file_info_get_name (copy), ==, "name");
+  g_assert_cmpint (g_file_info_get_size (copy), ==, 42);
+  g_file_info_set_name (copy, "other");
+  g_assert_cmpstr (g_file_info_get_name (info), ==, "name");
+  g_object_unref (copy);
+
+  /* Removing them */
+  g_file_info_remove_attribute (info, G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE);
+  g_assert_false (g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE));
+  g_assert_null (g_file_info_get_attribute_string (info, G_FILE_ATTRIBUTE_STANDARD_CONTENT_TYPE));
+
+  /* Masking them */
+  matcher = g_file_attribute_matcher_new ("standard::name,xattr::*");
+  g_file_info_set_attribute_mask (info, matcher);
+  g_assert_false (g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_STANDARD_SIZE));
+  g_assert_false (g_file_info_has_namespace (info, "time"));
+  g_file_info_set_size (info, 1);
+  g_assert_false (g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_STANDARD_SIZE));
+  g_file_attribute_matcher_unref (matcher);
+
+  names = g_file_info_list_attributes (info, NULL);
+  g_assert_cmpuint (g_strv_length (names), ==, 2);
+  g_assert_cmpstr (names[0], ==, G_FILE_ATTRIBUTE_STANDARD_NAME);
+  g_assert_cmpstr (names[1], ==, "xattr::test");
+  g_strfreev (names);
+
+  g_object_unref (info);
+  g_date_time_unref (dt);
+}
+
+static void
+test_perf_enumerate (void)
+{
+  GFile *dir;
+  GFileEnumerator *enumerator;
+  GFileInfo *info;
+  GPtrArray *infos;
+  GError *error = NULL;
+  gchar *path;
+  guint n_files = 5000, i;
+  gdouble elapsed;
+
+  if (!g_test_perf ())
+    {
+      g_test_skip ("Performance tests not enabled");
+      return;
+    }
+
+  g_test_summary ("Measure enumerating a large directory with the common attributes");
+
+  path = g_dir_make_tmp ("g-file-info-perf-XXXXXX", &error);
+  g_assert_no_error (error);
+  dir = g_file_new_for_path (path);
+
+  for (i = 0; i < n_files; i++)
+    {
+      gchar *name = g_strdup_printf ("file-%u", i);
+      GFile *child = g_file_get_child (dir, name);
+
+      g_file_replace_contents (child, "x", 1, NULL, FALSE, G_FILE_CREATE_NONE, NULL, NULL, &error);
+      g_assert_no_error (error);
+
+      g_object_unref (child);
+      g_free (name);
+    }
+
+  infos = g_ptr_array_new_with_free_func (g_object_unref);
+
+  g_test_timer_start ();
+
+  enumerator = g_file_enumerate_children (dir,
+                                          G_FILE_ATTRIBUTE_STANDARD_NAME ","
+                                          G_FILE_ATTRIBUTE_STANDARD_DISPLAY_NAME ","
+                                          G_FILE_ATTRIBUTE_STANDARD_TYPE ","
+                                          G_FILE_ATTRIBUTE_STANDARD_SIZE ","
+                                          G_FILE_ATTRIBUTE_STANDARD_FAST_CONTENT_TYPE ","
+                                          G_FILE_ATTRIBUTE_TIME_MODIFIED,
+                                          G_FILE_QUERY_INFO_NONE, NULL, &error);
+  g_assert_no_error (error);
+
+  /* Keep the infos alive, as a directory listing would */
+  while ((info = g_file_enumerator_next_file (enumerator, NULL, &error)) != NULL)
+    {
+      g_assert_nonnull (g_file_info_get_name (info));
+      g_ptr_array_add (infos, info);
+    }
+  g_assert_no_error (error);
+  g_object_unref (enumerator);
+
+  elapsed = g_test_timer_elapsed ();
+
+  g_assert_cmpuint (infos->len, ==, n_files);
+  g_test_maximized_result (n_files / elapsed, "%.0f files/s", n_files / elapsed);
+
+  g_ptr_array_unref (infos);
+
+  for (i = 0; i < n_files; i++)
+    {
+      gchar *name = g_strdup_printf ("file-%u", i);
+      GFile *child = g_file_get_child (dir, name);
+
+      g_file_delete (child, NULL, NULL);
+
+      g_object_unref (child);
+      g_free (name);
+    }
+  g_file_delete (dir, NULL, NULL);
+
+  g_object_unref (dir);
+  g_free (path);
+}
+
+#define N_ATTRIBUTE_THREADS 8
+#define N_ATTRIBUTES_PER_THREAD 200
+
+static gpointer
+concurrent_attributes_thread (gpointer data)
+{
+  guint thread_id = GPOINTER_TO_UINT (data);
+  GFileInfo *info;
+  guint i;
+
+  info = g_file_info_new ();
+
+  for (i = 0; i < N_ATTRIBUTES_PER_THREAD; i++)
+    {
+      /* Half the attributes are shared between all the threads, so they race
+       * to register them; the other half is private to this thread */
+      gchar *shared = g_strdup_printf ("test-shared::attribute-%u", i);
+      gchar *own = g_strdup_printf ("test-thread-%u::attribute-%u", thread_id, i);
+
+      g_file_info_set_attribute_uint32 (info, shared, i);
+      g_file_info_set_attribute_uint32 (info, own, i + thread_id);
+      g_file_info_set_attribute_uint64 (info, G_FILE_ATTRIBUTE_STANDARD_SIZE, i);
+
+      g_assert_cmpuint (g_file_info_get_attribute_uint32 (info, shared), ==, i);
+      g_assert_cmpuint (g_file_info_get_attribute_uint32 (info, own), ==, i + thread_id);
+      g_assert_cmpuint (g_file_info_get_size (info), ==, i);
+
+      g_free (shared);
+      g_free (own);
+    }
+
+  g_object_unref (info);
+
+  return NULL;
+}
+
+static void
+test_concurrent_attributes (void)
+{
+  GThread *threads[N_ATTRIBUTE_THREADS];
+  GFileInfo *info;
+  gchar **names;
+  guint i;
+
+  g_test_summary ("Test registering and looking up attributes from several threads at once");
+
+  for (i = 0; i < N_ATTRIBUTE_THREADS; i++)
+    threads[i] = g_thread_new ("file-info-attributes", concurrent_attributes_thread, GUINT_TO_POINTER (i));
+  for (i = 0; i < N_ATTRIBUTE_THREADS; i++)
+    g_thread_join (threads[i]);
+
+  /* Every attribute must have kept a single consistent id and name */
+  info = g_file_info_new ();
+  g_file_info_set_attribute_uint32 (info, "test-shared::attribute-7", 7);
+  g_file_info_set_attribute_uint32 (info, "test-thread-3::attribute-7", 10);
+  g_assert_true (g_file_info_has_namespace (info, "test-shared"));
+  g_assert_true (g_file_info_has_namespace (info, "test-thread-3"));
+  g_assert_false (g_file_info_has_namespace (info, "test-thread-4"));
+
+  names = g_file_info_list_attributes (info, "test-shared");
+  g_assert_cmpuint (g_strv_length (names), ==, 1);
+  g_assert_cmpstr (names[0], ==, "test-shared::attribute-7");
+  g_strfreev (names);
+
+  g_object_unref (info);
+}
+
+#define N_LOOKUP_ITERATIONS 200000
+
+static gpointer
+lookup_attributes_thread (gpointer data)
+{
+  GFileInfo *info = data;
+  guint64 total = 0;
+  guint i;
+
+  for (i = 0; i < N_LOOKUP_ITERATIONS; i++)
+    {
+      total += g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_STANDARD_SIZE);
+      total += g_file_info_get_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED);
+      total += g_file_info_get_attribute_uint32 (info, G_FILE_ATTRIBUTE_UNIX_MODE);
+      total += g_file_info_has_attribute (info, G_FILE_ATTRIBUTE_STANDARD_NAME);
+    }
+
+  return GSIZE_TO_POINTER ((gsize) total);
+}
+
+static void
+test_perf_threaded_lookup (void)
+{
+  GThread **threads;
+  GFileInfo *info;
+  guint n_threads, i;
+  gdouble elapsed;
+
+  if (!g_test_perf ())
+    {
+      g_test_skip ("Performance tests not enabled");
+      return;
+    }
+
+  g_test_summary ("Measure looking up attributes by name from several threads at once");
+
+  info = g_file_info_new ();
+  g_file_info_set_name (info, "perf");
+  g_file_info_set_size (info, 1);
+  g_file_info_set_attribute_uint64 (info, G_FILE_ATTRIBUTE_TIME_MODIFIED, 2);
+  g_file_info_set_attribute_uint32 (info, G_FILE_ATTRIBUTE_UNIX_MODE, 3);
+
+  n_threads = MAX (g_get_num_processors (), 2);
+  threads = g_new (GThread *, n_threads);
+
+  g_test_timer_start ();
+
+  for (i = 0; i < n_threads; i++)
+    threads[i] = g_thread_new ("file-info-lookup", lookup_attributes_thread, info);
+  for (i = 0; i < n_threads; i++)
+    g_thread_join (threads[i]);
+
+  elapsed = g_test_timer_elapsed ();
+
+  g_test_maximized_result (4.0 * N_LOOKUP_ITERATIONS * n_threads / elapsed,
+                           "%u threads: %.0f lookups/s",
+                           n_threads, 4.0 * N_LOOKUP_ITERATIONS * n_threads / elapsed);
+
+  g_free (threads);
+  g_object_unref (info);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -1109,6 +1402,10 @@ main (int   argc,
   g_test_add_func ("/g-file-info/internal-enhanced-stdio", test_internal_enhanced_stdio);
 #endif
   g_test_add_func ("/g-file-info/xattrs", test_xattrs);
+  g_test_add_func ("/g-file-info/common-attributes", test_common_attributes);
+  g_test_add_func ("/g-file-info/concurrent-attributes", test_concurrent_attributes);
+  g_test_add_func ("/g-file-info/perf/enumerate", test_perf_enumerate);
+  g_test_add_func ("/g-file-info/perf/threaded-lookup", test_perf_threaded_lookup);
   
   return g_test_run();
 }
@@ -401,6 +401,103 @@ msg_cb_expect_error_cancelled_2 (GDBusConnection *connection,
   g_main_loop_quit (loop);
 }
 
+static void
+msg_batch_cb_expect_replies (GDBusConnection *connection,
+                             GAsyncResult    *res,
+                             gpointer         user_data)
+{
+  GError *error;
+  GPtrArray *replies;
+  guint n;
+
+  /* Make sure gdbusconnection isn't holding @connection's lock. (#747349) */
+  g_dbus_connection_get_last_serial (connection);
+
+  error = NULL;
+  replies = g_dbus_connection_send_messages_with_reply_finish (connection,
+                                                               res,
+                                                               &error);
+  g_assert_no_error (error);
+  g_assert_nonnull (replies);
+  g_assert_cmpuint (replies->len, ==, 4);
+
+  /* replies are in the order of the method calls */
+  for (n = 0; n < 3; n++)
+    {
+      GDBusMessage *reply = g_ptr_array_index (replies, n);
+      g_assert_cmpint (g_dbus_message_get_message_type (reply), ==, G_DBUS_MESSAGE_TYPE_METHOD_RETURN);
+      g_assert_true (g_variant_is_of_type (g_dbus_message_get_body (reply), G_VARIANT_TYPE ("(s)")));
+    }
+  g_assert_cmpint (g_dbus_message_get_message_type (g_ptr_array_index (replies, 3)), ==, G_DBUS_MESSAGE_TYPE_ERROR);
+  g_assert_cmpstr (g_dbus_message_get_error_name (g_ptr_array_index (replies, 3)), ==, "org.freedesktop.DBus.Error.UnknownMethod");
+
+  g_ptr_array_unref (replies);
+
+  g_main_loop_quit (loop);
+}
+
+static void
+msg_batch_cb_expect_error_cancelled (GDBusConnection *connection,
+                                     GAsyncResult    *res,
+                                     gpointer         user_data)
+{
+  GError *error;
+  GPtrArray *replies;
+
+  /* Make sure gdbusconnection isn't holding @connection's lock. (#747349) */
+  g_dbus_connection_get_last_serial (connection);
+
+  error = NULL;
+  replies = g_dbus_connection_send_messages_with_reply_finish (connection,
+                                                               res,
+                                                               &error);
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+  g_error_free (error);
+  g_assert_null (replies);
+
+  g_main_loop_quit (loop);
+}
+
+static void
+msg_batch_cb_expect_error_invalid (GDBusConnection *connection,
+                                   GAsyncResult    *res,
+                                   gpointer         user_data)
+{
+  GError *error;
+  GPtrArray *replies;
+
+  error = NULL;
+  replies = g_dbus_connection_send_messages_with_reply_finish (connection,
+                                                               res,
+                                                               &error);
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_INVALID_ARGUMENT);
+  g_error_free (error);
+  g_assert_null (replies);
+
+  g_main_loop_quit (loop);
+}
+
+static void
+new_batch_messages (GDBusMessage *messages[4])
+{
+  guint n;
+
+  for (n = 0; n < 4; n++)
+    messages[n] = g_dbus_message_new_method_call ("org.freedesktop.DBus",  /* name */
+                                                  "/org/freedesktop/DBus", /* path */
+                                                  "org.freedesktop.DBus",  /* interface */
+                                                  n < 3 ? "GetId" : "NonExistantMethod");
+}
+
+static void
+free_batch_messages (GDBusMessage *messages[4])
+{
+  guint n;
+
+  for (n = 0; n < 4; n++)
+    g_object_unref (messages[n]);
+}
+
 /* ---------------------------------------------------------------------------------------------------- */
 
 static void
@@ -488,6 +585,74 @@ test_connection_send (void)
   g_main_loop_run (loop);
   g_object_unref (ca);
 
+  /*
+   * Check that a batch of method calls gets all its replies, in order.
+   */
+  {
+    GDBusMessage *messages[4];
+
+    new_batch_messages (messages);
+    g_dbus_connection_send_messages_with_reply (c,
+                                                messages,
+                                                G_N_ELEMENTS (messages),
+                                                -1,
+                                                NULL,
+                                                (GAsyncReadyCallback) msg_batch_cb_expect_replies,
+                                                NULL);
+    g_main_loop_run (loop);
+    free_batch_messages (messages);
+  }
+
+  /*
+   * Check that cancelling a batch in flight fails it as a whole.
+   */
+  {
+    GDBusMessage *messages[4];
+
+    new_batch_messages (messages);
+    ca = g_cancellable_new ();
+    g_dbus_connection_send_messages_with_reply (c,
+                                                messages,
+                                                G_N_ELEMENTS (messages),
+                                                -1,
+                                                ca,
+                                                (GAsyncReadyCallback) msg_batch_cb_expect_error_cancelled,
+                                                NULL);
+    g_cancellable_cancel (ca);
+    g_main_loop_run (loop);
+    g_object_unref (ca);
+    free_batch_messages (messages);
+  }
+
+  /*
+   * Check that if one message of a batch cannot be serialized, none of
+   * them is touched.
+   */
+  {
+    GDBusMessage *messages[4];
+    guint32 last_serial;
+    guint n;
+
+    new_batch_messages (messages);
+    g_dbus_message_set_member (messages[2], NULL);
+    last_serial = g_dbus_connection_get_last_serial (c);
+    g_dbus_connection_send_messages_with_reply (c,
+                                                messages,
+                                                G_N_ELEMENTS (messages),
+                                                -1,
+                                                NULL,
+                                                (GAsyncReadyCallback) msg_batch_cb_expect_error_invalid,
+                                                NULL);
+    g_main_loop_run (loop);
+    for (n = 0; n < G_N_ELEMENTS (messages); n++)
+      {
+        g_assert_false (g_dbus_message_get_locked (messages[n]));
+        g_assert_cmpuint (g_dbus_message_get_serial (messages[n]), ==, 0);
+      }
+    g_assert_cmpuint (g_dbus_connection_get_last_serial (c), ==, last_serial);
+    free_batch_messages (messages);
+  }
+
   /*
    * Check that we get an error when sending to a connection that is disconnected.
    */
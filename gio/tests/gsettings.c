@@ -2642,9 +2642,13 @@ test_schema_source (void)
   g_settings_schema_unref (schema);
   schema = g_settings_schema_source_lookup (source, "org.gtk.schemasourcecheck", FALSE);
   g_assert_nonnull (schema);
-  g_settings_schema_unref (schema);
 
+  /* ...and schemas must outlive the source they were looked up from, even
+   * though their tables are shared with it */
   g_settings_schema_source_unref (source);
+  g_assert_true (g_settings_schema_has_key (schema, "enabled"));
+  g_settings_schema_unref (schema);
+
   g_object_unref (backend);
 }
 
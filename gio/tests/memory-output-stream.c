@@ -190,6 +190,19 @@ test_seek_resizable (void)
       /* No writes = no resizes */
       g_assert_cmpint (g_memory_output_stream_get_size (G_MEMORY_OUTPUT_STREAM (mo)), ==, i);
 
+      g_object_unref (mo);
+    }
+
+  /* Nor for chunked streams */
+  for (i = 1; i < 1024; i *= 2)
+    {
+      mo = g_memory_output_stream_new_chunked (i);
+
+      test_seek_resizable_stream (mo);
+
+      g_assert_cmpint (g_memory_output_stream_get_data_size (G_MEMORY_OUTPUT_STREAM (mo)), ==, 0);
+      g_assert_cmpint (g_memory_output_stream_get_size (G_MEMORY_OUTPUT_STREAM (mo)), ==, 0);
+
       g_object_unref (mo);
     }
 }
@@ -446,6 +459,254 @@ test_steal_as_bytes (void)
   g_object_unref (o);
 }
 
+/* Applies the same writes, seeks and truncations to @mo */
+static void
+chunked_test_ops (GOutputStream *mo,
+                  const guint8  *data)
+{
+  GOutputVector vectors[3];
+  GError *error = NULL;
+  gsize bytes_written, offset;
+  guint i;
+
+  /* Writes of all sizes, crossing chunk boundaries */
+  for (offset = 0, i = 1; i < 300; offset += i, i += 7)
+    {
+      g_output_stream_write_all (mo, data + offset, i, NULL, NULL, &error);
+      g_assert_no_error (error);
+    }
+
+  /* Vectors, including an empty one */
+  vectors[0].buffer = data;
+  vectors[0].size = 250;
+  vectors[1].buffer = data + 250;
+  vectors[1].size = 0;
+  vectors[2].buffer = data + 1000;
+  vectors[2].size = 1234;
+  g_output_stream_writev_all (mo, vectors, G_N_ELEMENTS (vectors), &bytes_written, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (bytes_written, ==, 250 + 1234);
+
+  /* Overwrite in the middle */
+  g_seekable_seek (G_SEEKABLE (mo), 517, G_SEEK_SET, NULL, &error);
+  g_assert_no_error (error);
+  g_output_stream_write_all (mo, data + 7, 333, NULL, NULL, &error);
+  g_assert_no_error (error);
+
+  /* Leave a gap */
+  g_seekable_seek (G_SEEKABLE (mo), 555, G_SEEK_END, NULL, &error);
+  g_assert_no_error (error);
+  g_output_stream_write_all (mo, data + 3, 99, NULL, NULL, &error);
+  g_assert_no_error (error);
+
+  /* Shrink, then write past the end, so the truncated part is zeroed */
+  g_seekable_truncate (G_SEEKABLE (mo), 3003, NULL, &error);
+  g_assert_no_error (error);
+  g_seekable_seek (G_SEEKABLE (mo), 3500, G_SEEK_SET, NULL, &error);
+  g_assert_no_error (error);
+  g_output_stream_write_all (mo, data + 11, 10, NULL, NULL, &error);
+  g_assert_no_error (error);
+
+  /* Shrink, then grow by truncating */
+  g_seekable_truncate (G_SEEKABLE (mo), 2900, NULL, &error);
+  g_assert_no_error (error);
+  g_seekable_truncate (G_SEEKABLE (mo), 4321, NULL, &error);
+  g_assert_no_error (error);
+}
+
+static void
+test_chunked (void)
+{
+  const gsize chunk_sizes[] = { 1, 100, 4096, 1024 * 1024 };
+  guint8 data[8192];
+  GOutputStream *reference;
+  const guint8 *expected;
+  gsize expected_size, i, j;
+  GError *error = NULL;
+
+  for (i = 0; i < sizeof data; i++)
+    data[i] = i * 7 + 1;
+
+  reference = g_memory_output_stream_new_resizable ();
+  chunked_test_ops (reference, data);
+  expected = g_memory_output_stream_get_data (G_MEMORY_OUTPUT_STREAM (reference));
+  expected_size = g_memory_output_stream_get_data_size (G_MEMORY_OUTPUT_STREAM (reference));
+  g_assert_cmpuint (expected_size, ==, 4321);
+
+  for (i = 0; i < G_N_ELEMENTS (chunk_sizes); i++)
+    {
+      GOutputStream *mo;
+      GPtrArray *chunks;
+      GBytes *bytes;
+      gsize chunk_size, offset;
+
+      g_test_message ("chunk size %" G_GSIZE_FORMAT, chunk_sizes[i]);
+
+      /* Taken as chunks */
+      mo = g_memory_output_stream_new_chunked (chunk_sizes[i]);
+      g_object_get (mo, "chunk-size", &chunk_size, NULL);
+      g_assert_cmpuint (chunk_size, ==, chunk_sizes[i]);
+
+      chunked_test_ops (mo, data);
+      g_assert_cmpuint (g_memory_output_stream_get_data_size (G_MEMORY_OUTPUT_STREAM (mo)), ==, expected_size);
+      g_assert_cmpuint (g_memory_output_stream_get_size (G_MEMORY_OUTPUT_STREAM (mo)), <,
+                        expected_size + chunk_sizes[i]);
+
+      g_output_stream_close (mo, NULL, &error);
+      g_assert_no_error (error);
+
+      chunks = g_memory_output_stream_steal_chunks (G_MEMORY_OUTPUT_STREAM (mo));
+      g_assert_cmpuint (chunks->len, ==, (expected_size + chunk_sizes[i] - 1) / chunk_sizes[i]);
+      for (offset = 0, j = 0; j < chunks->len; j++)
+        {
+          gsize size;
+          const guint8 *chunk = g_bytes_get_data (g_ptr_array_index (chunks, j), &size);
+
+          g_assert_cmpuint (size, ==, MIN (chunk_sizes[i], expected_size - offset));
+          g_assert_cmpmem (chunk, size, expected + offset, size);
+          offset += size;
+        }
+      g_assert_cmpuint (offset, ==, expected_size);
+      g_assert_null (g_memory_output_stream_get_data (G_MEMORY_OUTPUT_STREAM (mo)));
+
+      g_ptr_array_unref (chunks);
+      g_object_unref (mo);
+
+      /* Flattened, then written to some more */
+      mo = g_memory_output_stream_new_chunked (chunk_sizes[i]);
+      chunked_test_ops (mo, data);
+      g_assert_cmpmem (g_memory_output_stream_get_data (G_MEMORY_OUTPUT_STREAM (mo)),
+                       g_memory_output_stream_get_data_size (G_MEMORY_OUTPUT_STREAM (mo)),
+                       expected, expected_size);
+
+      g_seekable_seek (G_SEEKABLE (mo), 10, G_SEEK_END, NULL, &error);
+      g_assert_no_error (error);
+      g_output_stream_write_all (mo, data, 5, NULL, NULL, &error);
+      g_assert_no_error (error);
+      g_output_stream_close (mo, NULL, &error);
+      g_assert_no_error (error);
+
+      bytes = g_memory_output_stream_steal_as_bytes (G_MEMORY_OUTPUT_STREAM (mo));
+      g_assert_cmpuint (g_bytes_get_size (bytes), ==, expected_size + 15);
+      g_assert_cmpmem (g_bytes_get_data (bytes, NULL), expected_size, expected, expected_size);
+      for (j = expected_size; j < expected_size + 10; j++)
+        g_assert_cmpuint (((const guint8 *) g_bytes_get_data (bytes, NULL))[j], ==, 0);
+      g_assert_cmpmem ((const guint8 *) g_bytes_get_data (bytes, NULL) + expected_size + 10, 5, data, 5);
+
+      g_bytes_unref (bytes);
+      g_object_unref (mo);
+    }
+
+  /* A stream with nothing written gives no chunks */
+  {
+    GOutputStream *mo = g_memory_output_stream_new_chunked (100);
+    GPtrArray *chunks;
+
+    g_output_stream_close (mo, NULL, &error);
+    g_assert_no_error (error);
+    chunks = g_memory_output_stream_steal_chunks (G_MEMORY_OUTPUT_STREAM (mo));
+    g_assert_cmpuint (chunks->len, ==, 0);
+    g_ptr_array_unref (chunks);
+    g_object_unref (mo);
+  }
+
+  /* Other streams give a single chunk */
+  {
+    GPtrArray *chunks;
+
+    g_output_stream_close (reference, NULL, &error);
+    g_assert_no_error (error);
+    chunks = g_memory_output_stream_steal_chunks (G_MEMORY_OUTPUT_STREAM (reference));
+    g_assert_cmpuint (chunks->len, ==, 1);
+    g_assert_cmpuint (g_bytes_get_size (g_ptr_array_index (chunks, 0)), ==, expected_size);
+    g_ptr_array_unref (chunks);
+  }
+
+  g_object_unref (reference);
+
+  /* A caller-supplied buffer can not be chunked; the chunk size is
+   * ignored and the buffer kept */
+  {
+    GOutputStream *mo;
+    gsize chunk_size;
+
+    g_test_expect_message ("GLib-GIO", G_LOG_LEVEL_CRITICAL, "*chunk-size*");
+    mo = g_object_new (G_TYPE_MEMORY_OUTPUT_STREAM,
+                       "data", g_malloc (16),
+                       "size", (gulong) 16,
+                       "realloc-function", g_realloc,
+                       "destroy-function", g_free,
+                       "chunk-size", (gulong) 100,
+                       NULL);
+    g_test_assert_expected_messages ();
+
+    g_object_get (mo, "chunk-size", &chunk_size, NULL);
+    g_assert_cmpuint (chunk_size, ==, 0);
+    g_output_stream_write_all (mo, data, 20, NULL, NULL, &error);
+    g_assert_no_error (error);
+    g_assert_cmpmem (g_memory_output_stream_get_data (G_MEMORY_OUTPUT_STREAM (mo)),
+                     g_memory_output_stream_get_data_size (G_MEMORY_OUTPUT_STREAM (mo)),
+                     data, 20);
+    g_object_unref (mo);
+  }
+}
+
+static void
+test_chunked_perf (void)
+{
+  const gsize len = 256 * 1024 * 1024;
+  const gsize write_size = 64 * 1024;
+  guint8 *data;
+  guint i;
+
+  if (!g_test_perf ())
+    {
+      g_test_skip ("Performance tests not enabled");
+      return;
+    }
+
+  data = g_malloc (write_size);
+  memset (data, 'x', write_size);
+
+  /* Resizable, chunked and taken as chunks, chunked and flattened */
+  for (i = 0; i < 3; i++)
+    {
+      const gchar *names[] = { "resizable", "chunked", "chunked, flattened" };
+      GOutputStream *mo;
+      GError *error = NULL;
+      gdouble elapsed;
+      gsize offset;
+
+      g_test_timer_start ();
+
+      if (i == 0)
+        mo = g_memory_output_stream_new_resizable ();
+      else
+        mo = g_memory_output_stream_new_chunked (1024 * 1024);
+
+      for (offset = 0; offset < len; offset += write_size)
+        {
+          g_output_stream_write_all (mo, data, write_size, NULL, NULL, &error);
+          g_assert_no_error (error);
+        }
+      g_output_stream_close (mo, NULL, &error);
+      g_assert_no_error (error);
+
+      if (i == 1)
+        g_ptr_array_unref (g_memory_output_stream_steal_chunks (G_MEMORY_OUTPUT_STREAM (mo)));
+      else
+        g_bytes_unref (g_memory_output_stream_steal_as_bytes (G_MEMORY_OUTPUT_STREAM (mo)));
+
+      elapsed = g_test_timer_elapsed ();
+      g_test_maximized_result (len / elapsed / (1024 * 1024),
+                               "%s: %.1f MiB/s", names[i], len / elapsed / (1024 * 1024));
+
+      g_object_unref (mo);
+    }
+
+  g_free (data);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -462,6 +723,8 @@ main (int   argc,
   g_test_add_func ("/memory-output-stream/writev", test_writev);
   g_test_add_func ("/memory-output-stream/writev_nonblocking", test_writev_nonblocking);
   g_test_add_func ("/memory-output-stream/steal_as_bytes", test_steal_as_bytes);
+  g_test_add_func ("/memory-output-stream/chunked", test_chunked);
+  g_test_add_func ("/memory-output-stream/perf/chunked", test_chunked_perf);
 
   return g_test_run();
 }
@@ -672,6 +672,224 @@ test_resource_binary_linked (void)
   #endif /* if __linux__ */
 }
 
+static void
+test_resource_compressed_cache (void)
+{
+  GError *error = NULL;
+  GBytes *data, *data2, *uncompressed;
+  GInputStream *in;
+  gchar buffer[101];
+  gsize bytes_read;
+
+  uncompressed = g_resources_lookup_data ("/big_prefix/gresource-big-test.txt",
+                                          G_RESOURCE_LOOKUP_FLAGS_NONE,
+                                          &error);
+  g_assert_no_error (error);
+
+  data = g_resources_lookup_data ("/big_prefix/gresource-big-test-compressed.txt",
+                                  G_RESOURCE_LOOKUP_FLAGS_NONE,
+                                  &error);
+  g_assert_no_error (error);
+  g_assert_true (g_bytes_equal (data, uncompressed));
+
+  /* The second lookup is served from the cache of decompressed data */
+  data2 = g_resources_lookup_data ("/big_prefix/gresource-big-test-compressed.txt",
+                                   G_RESOURCE_LOOKUP_FLAGS_NONE,
+                                   &error);
+  g_assert_no_error (error);
+  g_assert_true (g_bytes_get_data (data2, NULL) == g_bytes_get_data (data, NULL));
+  g_assert_cmpstr ((const gchar *) g_bytes_get_data (data2, NULL) + g_bytes_get_size (data2), ==, "");
+
+  /* Streams can be served from the cache as well */
+  in = g_resources_open_stream ("/big_prefix/gresource-big-test-compressed.txt",
+                                G_RESOURCE_LOOKUP_FLAGS_NONE,
+                                &error);
+  g_assert_no_error (error);
+  g_input_stream_read_all (in, buffer, sizeof (buffer) - 1, &bytes_read, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (bytes_read, ==, sizeof (buffer) - 1);
+  buffer[bytes_read] = '\0';
+  g_assert_cmpstr (buffer, ==, "aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa\n");
+  g_object_unref (in);
+
+  g_bytes_unref (data2);
+  g_bytes_unref (data);
+  g_bytes_unref (uncompressed);
+}
+
+static void
+test_resource_compressed_lookup_perf (void)
+{
+  GError *error = NULL;
+  GBytes *data;
+  guint i, n_lookups;
+  gdouble elapsed;
+
+  if (!g_test_perf ())
+    {
+      g_test_skip ("Performance tests not enabled");
+      return;
+    }
+
+  n_lookups = 100000;
+
+  g_test_timer_start ();
+  for (i = 0; i < n_lookups; i++)
+    {
+      data = g_resources_lookup_data ("/big_prefix/gresource-big-test-compressed.txt",
+                                      G_RESOURCE_LOOKUP_FLAGS_NONE,
+                                      &error);
+      g_assert_no_error (error);
+      g_bytes_unref (data);
+    }
+  elapsed = g_test_timer_elapsed ();
+
+  g_test_maximized_result (n_lookups / elapsed,
+                           "%.0f lookups/s of a %" G_GSIZE_FORMAT " byte compressed resource",
+                           n_lookups / elapsed, (gsize) ((26 + 26 + 10) * (100 + 1) * 12));
+}
+
+static void
+test_resource_jobs (void)
+{
+  GError *error = NULL;
+  gchar *contents, *jobs_contents;
+  gsize length, jobs_length;
+
+  /* glib-compile-resources --jobs must not change the output */
+  g_file_get_contents (g_test_get_filename (G_TEST_BUILT, "test.gresource", NULL),
+                       &contents, &length, &error);
+  g_assert_no_error (error);
+  g_file_get_contents (g_test_get_filename (G_TEST_BUILT, "test-jobs.gresource", NULL),
+                       &jobs_contents, &jobs_length, &error);
+  g_assert_no_error (error);
+
+  g_assert_cmpmem (jobs_contents, jobs_length, contents, length);
+
+  g_free (jobs_contents);
+  g_free (contents);
+}
+
+static void
+test_resource_lz4 (void)
+{
+#ifdef HAVE_LZ4
+  GError *error = NULL;
+  GResource *resource;
+  GBytes *zlib_data, *lz4_data;
+  GInputStream *in;
+  gchar buffer[101];
+  gsize size, bytes_read;
+  guint32 flags;
+  gboolean found;
+
+  resource = g_resource_load (g_test_get_filename (G_TEST_BUILT, "test-lz4.gresource", NULL), &error);
+  g_assert_no_error (error);
+
+  found = g_resource_get_info (resource, "/compression/big-lz4.txt",
+                               G_RESOURCE_LOOKUP_FLAGS_NONE,
+                               &size, &flags, &error);
+  g_assert_no_error (error);
+  g_assert_true (found);
+  g_assert_cmpuint (flags, ==, G_RESOURCE_FLAGS_COMPRESSED | G_RESOURCE_FLAGS_COMPRESSED_LZ4);
+
+  zlib_data = g_resource_lookup_data (resource, "/compression/big-zlib.txt",
+                                      G_RESOURCE_LOOKUP_FLAGS_NONE, &error);
+  g_assert_no_error (error);
+  lz4_data = g_resource_lookup_data (resource, "/compression/big-lz4.txt",
+                                     G_RESOURCE_LOOKUP_FLAGS_NONE, &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (g_bytes_get_size (lz4_data), ==, size);
+  g_assert_true (g_bytes_equal (lz4_data, zlib_data));
+  g_assert_cmpstr ((const gchar *) g_bytes_get_data (lz4_data, NULL) + size, ==, "");
+
+  in = g_resource_open_stream (resource, "/compression/big-lz4.txt",
+                               G_RESOURCE_LOOKUP_FLAGS_NONE, &error);
+  g_assert_no_error (error);
+  g_input_stream_read_all (in, buffer, sizeof (buffer) - 1, &bytes_read, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (bytes_read, ==, sizeof (buffer) - 1);
+  g_assert_cmpmem (buffer, bytes_read, g_bytes_get_data (zlib_data, NULL), sizeof (buffer) - 1);
+  g_object_unref (in);
+
+  g_bytes_unref (lz4_data);
+  lz4_data = g_resource_lookup_data (resource, "/compression/empty.txt",
+                                     G_RESOURCE_LOOKUP_FLAGS_NONE, &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (g_bytes_get_size (lz4_data), ==, 0);
+
+  g_bytes_unref (lz4_data);
+  g_bytes_unref (zlib_data);
+  g_resource_unref (resource);
+#else
+  g_test_skip ("LZ4 support not enabled");
+#endif
+}
+
+#ifdef HAVE_LZ4
+/* Every lookup goes through a fresh #GResource so that the decompressed
+ * data cache doesn't get in the way of measuring the decoder. */
+static gdouble
+measure_decode_throughput (GBytes      *bundle,
+                           const gchar *path,
+                           guint        n_lookups)
+{
+  GError *error = NULL;
+  GResource *resource;
+  GBytes *data;
+  gsize size = 0;
+  guint i;
+
+  g_test_timer_start ();
+  for (i = 0; i < n_lookups; i++)
+    {
+      resource = g_resource_new_from_data (bundle, &error);
+      g_assert_no_error (error);
+      data = g_resource_lookup_data (resource, path, G_RESOURCE_LOOKUP_FLAGS_NONE, &error);
+      g_assert_no_error (error);
+      size = g_bytes_get_size (data);
+      g_bytes_unref (data);
+      g_resource_unref (resource);
+    }
+
+  return (gdouble) size * n_lookups / g_test_timer_elapsed () / (1024 * 1024);
+}
+#endif
+
+static void
+test_resource_lz4_decode_perf (void)
+{
+#ifdef HAVE_LZ4
+  GError *error = NULL;
+  GBytes *bundle;
+  gchar *contents;
+  gsize length;
+  gdouble zlib_mbps, lz4_mbps;
+
+  if (!g_test_perf ())
+    {
+      g_test_skip ("Performance tests not enabled");
+      return;
+    }
+
+  g_file_get_contents (g_test_get_filename (G_TEST_BUILT, "test-lz4.gresource", NULL),
+                       &contents, &length, &error);
+  g_assert_no_error (error);
+  bundle = g_bytes_new_take (contents, length);
+
+  zlib_mbps = measure_decode_throughput (bundle, "/compression/big-zlib.txt", 2000);
+  lz4_mbps = measure_decode_throughput (bundle, "/compression/big-lz4.txt", 2000);
+
+  g_test_message ("zlib: %.1f MB/s, LZ4: %.1f MB/s", zlib_mbps, lz4_mbps);
+  g_test_maximized_result (lz4_mbps, "%.1f MB/s LZ4 decode (%.1fx zlib)",
+                           lz4_mbps, lz4_mbps / zlib_mbps);
+
+  g_bytes_unref (bundle);
+#else
+  g_test_skip ("LZ4 support not enabled");
+#endif
+}
+
 /* Test resource whose xml file starts with more than one digit
  * and where no explicit c-name is given
  * Checks if resources are successfully registered and
@@ -1073,6 +1291,11 @@ main (int   argc,
   g_test_add_func ("/resource/uri/query-info", test_uri_query_info);
   g_test_add_func ("/resource/uri/file", test_uri_file);
   g_test_add_func ("/resource/64k", test_resource_64k);
+  g_test_add_func ("/resource/compressed-cache", test_resource_compressed_cache);
+  g_test_add_func ("/resource/perf/compressed-lookup", test_resource_compressed_lookup_perf);
+  g_test_add_func ("/resource/jobs", test_resource_jobs);
+  g_test_add_func ("/resource/lz4", test_resource_lz4);
+  g_test_add_func ("/resource/perf/lz4-decode", test_resource_lz4_decode_perf);
   g_test_add_func ("/resource/overlay", test_overlay);
   g_test_add_func ("/resource/digits", test_resource_digits);
 
@@ -552,6 +552,304 @@ test_read_writev_async (void)
   test_read_write_async_internal (TRUE);
 }
 
+typedef struct
+{
+  GMutex mutex;
+  GCond cond;
+  guint n_incoming;
+  GHashTable *threads;
+  GObject *source_object;
+} ShardedData;
+
+static void
+sharded_data_init (ShardedData *data)
+{
+  g_mutex_init (&data->mutex);
+  g_cond_init (&data->cond);
+  data->n_incoming = 0;
+  data->threads = g_hash_table_new (NULL, NULL);
+  data->source_object = g_object_new (G_TYPE_OBJECT, NULL);
+}
+
+static void
+sharded_data_clear (ShardedData *data)
+{
+  g_object_unref (data->source_object);
+  g_hash_table_unref (data->threads);
+  g_cond_clear (&data->cond);
+  g_mutex_clear (&data->mutex);
+}
+
+static gboolean
+sharded_incoming_cb (GSocketService    *service,
+                     GSocketConnection *connection,
+                     GObject           *source_object,
+                     gpointer           user_data)
+{
+  ShardedData *data = user_data;
+
+  /* Emitted in the thread of a shard, with its own context */
+  if (g_socket_service_get_shards (service) > 1)
+    {
+      g_assert_nonnull (g_main_context_get_thread_default ());
+      g_assert_true (g_main_context_is_owner (g_main_context_get_thread_default ()));
+    }
+  g_assert_true (source_object == data->source_object);
+
+  g_mutex_lock (&data->mutex);
+  data->n_incoming++;
+  g_hash_table_add (data->threads, g_thread_self ());
+  g_cond_signal (&data->cond);
+  g_mutex_unlock (&data->mutex);
+
+  return TRUE;
+}
+
+static GSocketService *
+sharded_service_new (guint        n_shards,
+                     ShardedData *data,
+                     guint16     *port)
+{
+  GSocketService *service;
+  GError *error = NULL;
+
+  service = g_object_new (G_TYPE_SOCKET_SERVICE, "shards", n_shards, NULL);
+  g_assert_cmpuint (g_socket_service_get_shards (service), ==, n_shards);
+  g_socket_listener_set_backlog (G_SOCKET_LISTENER (service), 128);
+  g_signal_connect (service, "incoming", G_CALLBACK (sharded_incoming_cb), data);
+
+  *port = g_socket_listener_add_any_inet_port (G_SOCKET_LISTENER (service),
+                                               data->source_object, &error);
+  g_assert_no_error (error);
+  g_assert_cmpuint (*port, !=, 0);
+
+  return service;
+}
+
+static void
+sharded_service_free (GSocketService *service)
+{
+  GWeakRef ref;
+  GObject *object;
+
+  g_weak_ref_init (&ref, service);
+
+  g_socket_service_stop (service);
+  g_socket_listener_close (G_SOCKET_LISTENER (service));
+  g_object_unref (service);
+
+  /* A shard may still be dispatching, and then drops the last reference.
+   * Without shards, the pending accept is cancelled in this thread. */
+  while ((object = g_weak_ref_get (&ref)) != NULL)
+    {
+      g_object_unref (object);
+      if (!g_main_context_iteration (NULL, FALSE))
+        g_usleep (1000);
+    }
+
+  g_weak_ref_clear (&ref);
+}
+
+static void
+connect_clients (guint16  port,
+                 GPtrArray *connections,
+                 guint     n_clients)
+{
+  GSocketClient *client;
+  guint i;
+
+  client = g_socket_client_new ();
+
+  for (i = 0; i < n_clients; i++)
+    {
+      GSocketConnection *connection;
+      GError *error = NULL;
+
+      connection = g_socket_client_connect_to_host (client, "127.0.0.1", port,
+                                                    NULL, &error);
+      g_assert_no_error (error);
+      g_ptr_array_add (connections, connection);
+    }
+
+  g_object_unref (client);
+}
+
+static void
+wait_for_incoming (GSocketService *service,
+                   ShardedData    *data,
+                   guint           n_incoming)
+{
+  /* Without shards, the service runs in this thread */
+  if (g_socket_service_get_shards (service) == 1)
+    {
+      while (data->n_incoming < n_incoming)
+        g_main_context_iteration (NULL, TRUE);
+      return;
+    }
+
+  g_mutex_lock (&data->mutex);
+  while (data->n_incoming < n_incoming)
+    g_cond_wait (&data->cond, &data->mutex);
+  g_mutex_unlock (&data->mutex);
+}
+
+/* Test that a sharded service accepts every connection, in threads of its
+ * own, and that it can be stopped and started again. */
+static void
+test_sharded (void)
+{
+  const guint n_clients = 64;
+  GSocketService *service;
+  GPtrArray *connections;
+  ShardedData data;
+  guint16 port;
+
+  sharded_data_init (&data);
+
+  service = sharded_service_new (4, &data, &port);
+  connections = g_ptr_array_new_with_free_func (g_object_unref);
+
+  connect_clients (port, connections, n_clients);
+  wait_for_incoming (service, &data, n_clients);
+
+  g_assert_cmpuint (data.n_incoming, ==, n_clients);
+  g_assert_false (g_hash_table_contains (data.threads, g_thread_self ()));
+  g_assert_cmpuint (g_hash_table_size (data.threads), >=, 1);
+  g_assert_cmpuint (g_hash_table_size (data.threads), <=, 4);
+  g_test_message ("%u connections accepted by %u threads",
+                  data.n_incoming, g_hash_table_size (data.threads));
+
+  /* Connections queue up while stopped */
+  g_socket_service_stop (service);
+  connect_clients (port, connections, 4);
+  g_usleep (G_USEC_PER_SEC / 10);
+  g_mutex_lock (&data.mutex);
+  g_assert_cmpuint (data.n_incoming, ==, n_clients);
+  g_mutex_unlock (&data.mutex);
+
+  g_socket_service_start (service);
+  wait_for_incoming (service, &data, n_clients + 4);
+  g_assert_cmpuint (data.n_incoming, ==, n_clients + 4);
+
+  sharded_service_free (service);
+  g_ptr_array_unref (connections);
+  sharded_data_clear (&data);
+}
+
+/* Test that a sharded service accepts on a socket added by the caller,
+ * without changing its blocking mode. */
+static void
+test_sharded_add_socket (void)
+{
+  GSocketService *service;
+  GSocket *socket;
+  GSocketAddress *address, *effective_address;
+  GInetAddress *iaddr;
+  GPtrArray *connections;
+  ShardedData data;
+  guint16 port;
+  GError *error = NULL;
+
+  sharded_data_init (&data);
+
+  service = sharded_service_new (4, &data, &port);
+
+  socket = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_STREAM,
+                         G_SOCKET_PROTOCOL_DEFAULT, &error);
+  g_assert_no_error (error);
+  iaddr = g_inet_address_new_loopback (G_SOCKET_FAMILY_IPV4);
+  address = g_inet_socket_address_new (iaddr, 0);
+  g_socket_bind (socket, address, TRUE, &error);
+  g_assert_no_error (error);
+  g_socket_listen (socket, &error);
+  g_assert_no_error (error);
+  g_socket_listener_add_socket (G_SOCKET_LISTENER (service), socket,
+                                data.source_object, &error);
+  g_assert_no_error (error);
+  g_assert_true (g_socket_get_blocking (socket));
+
+  effective_address = g_socket_get_local_address (socket, &error);
+  g_assert_no_error (error);
+  connections = g_ptr_array_new_with_free_func (g_object_unref);
+  connect_clients (g_inet_socket_address_get_port (G_INET_SOCKET_ADDRESS (effective_address)),
+                   connections, 8);
+  wait_for_incoming (service, &data, 8);
+  g_assert_cmpuint (data.n_incoming, ==, 8);
+  g_assert_true (g_socket_get_blocking (socket));
+
+  sharded_service_free (service);
+  g_ptr_array_unref (connections);
+  g_object_unref (effective_address);
+  g_object_unref (address);
+  g_object_unref (iaddr);
+  g_object_unref (socket);
+  sharded_data_clear (&data);
+}
+
+typedef struct
+{
+  guint16 port;
+  guint n_clients;
+} ConnectData;
+
+static gpointer
+connect_thread (gpointer user_data)
+{
+  ConnectData *connect_data = user_data;
+  GPtrArray *connections;
+
+  connections = g_ptr_array_new_with_free_func (g_object_unref);
+  connect_clients (connect_data->port, connections, connect_data->n_clients);
+
+  return connections;
+}
+
+static void
+test_sharded_perf (void)
+{
+  const guint n_threads = 4;
+  const guint n_clients = 2000;
+  guint n_shards;
+
+  if (!g_test_perf ())
+    {
+      g_test_skip ("Performance tests not enabled");
+      return;
+    }
+
+  for (n_shards = 1; n_shards <= 4; n_shards *= 4)
+    {
+      GSocketService *service;
+      ShardedData data;
+      ConnectData connect_data;
+      GThread *threads[4];
+      gdouble elapsed;
+      guint i;
+
+      sharded_data_init (&data);
+
+      service = sharded_service_new (n_shards, &data, &connect_data.port);
+      connect_data.n_clients = n_clients / n_threads;
+
+      g_test_timer_start ();
+
+      for (i = 0; i < n_threads; i++)
+        threads[i] = g_thread_new ("connect", connect_thread, &connect_data);
+      wait_for_incoming (service, &data, n_clients);
+
+      elapsed = g_test_timer_elapsed ();
+
+      for (i = 0; i < n_threads; i++)
+        g_ptr_array_unref (g_thread_join (threads[i]));
+
+      g_test_maximized_result (n_clients / elapsed,
+                               "%u shards: %.0f connections/s",
+                               n_shards, n_clients / elapsed);
+
+      sharded_service_free (service);
+      sharded_data_clear (&data);
+    }
+}
 
 int
 main (int   argc,
@@ -563,6 +861,9 @@ main (int   argc,
   g_test_add_func ("/socket-service/threaded/712570", test_threaded_712570);
   g_test_add_func ("/socket-service/read_write_async", test_read_write_async);
   g_test_add_func ("/socket-service/read_writev_async", test_read_writev_async);
+  g_test_add_func ("/socket-service/sharded", test_sharded);
+  g_test_add_func ("/socket-service/sharded/add-socket", test_sharded_add_socket);
+  g_test_add_func ("/socket-service/perf/sharded", test_sharded_perf);
 
   return g_test_run();
 }
@@ -1696,6 +1696,738 @@ test_reuse_udp (void)
   g_object_unref (sock2);
 }
 
+static void
+create_udp_pair (GSocket **receiver,
+                 GSocket **sender)
+{
+  GError *error = NULL;
+  GInetAddress *iaddr;
+  GSocketAddress *addr;
+
+  *receiver = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_DATAGRAM,
+                            G_SOCKET_PROTOCOL_DEFAULT, &error);
+  g_assert_no_error (error);
+  *sender = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_DATAGRAM,
+                          G_SOCKET_PROTOCOL_DEFAULT, &error);
+  g_assert_no_error (error);
+
+  iaddr = g_inet_address_new_loopback (G_SOCKET_FAMILY_IPV4);
+  addr = g_inet_socket_address_new (iaddr, 0);
+  g_socket_bind (*receiver, addr, TRUE, &error);
+  g_assert_no_error (error);
+  g_socket_bind (*sender, addr, TRUE, &error);
+  g_assert_no_error (error);
+  g_object_unref (addr);
+  g_object_unref (iaddr);
+
+  addr = g_socket_get_local_address (*receiver, &error);
+  g_assert_no_error (error);
+  g_socket_connect (*sender, addr, NULL, &error);
+  g_assert_no_error (error);
+  g_object_unref (addr);
+}
+
+typedef struct {
+  guint n_received;
+  guint n_batches;
+  guint max_batch;
+  guint16 sender_port;
+  GError *error;
+} ReceiveMessagesData;
+
+static gboolean
+receive_messages_cb (GSocket       *socket,
+                     GInputMessage *messages,
+                     guint          num_messages,
+                     const GError  *error,
+                     gpointer       user_data)
+{
+  ReceiveMessagesData *data = user_data;
+  guint i;
+
+  if (error != NULL)
+    {
+      g_assert_cmpuint (num_messages, ==, 0);
+      data->error = g_error_copy (error);
+      return G_SOURCE_REMOVE;
+    }
+
+  g_assert_cmpuint (num_messages, >, 0);
+
+  for (i = 0; i < num_messages; i++)
+    {
+      char expected[32];
+      gsize len;
+
+      len = g_snprintf (expected, sizeof (expected), "message %u", data->n_received);
+      g_assert_cmpmem (messages[i].vectors[0].buffer, messages[i].bytes_received, expected, len);
+
+      if (data->sender_port != 0)
+        {
+          g_assert_nonnull (messages[i].address);
+          g_assert_true (G_IS_INET_SOCKET_ADDRESS (*messages[i].address));
+          g_assert_cmpuint (g_inet_socket_address_get_port (G_INET_SOCKET_ADDRESS (*messages[i].address)), ==, data->sender_port);
+        }
+
+      data->n_received++;
+    }
+
+  data->n_batches++;
+  data->max_batch = MAX (data->max_batch, num_messages);
+
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+test_receive_messages_source (void)
+{
+  GSocket *receiver, *sender;
+  GCancellable *cancellable;
+  GSource *source;
+  GSocketAddress *addr;
+  ReceiveMessagesData data = { 0, };
+  GError *error = NULL;
+  guint i;
+
+  create_udp_pair (&receiver, &sender);
+
+  addr = g_socket_get_local_address (sender, &error);
+  g_assert_no_error (error);
+  data.sender_port = g_inet_socket_address_get_port (G_INET_SOCKET_ADDRESS (addr));
+  g_object_unref (addr);
+
+  /* Queue the messages first, so that they are there to be batched */
+  for (i = 0; i < 100; i++)
+    {
+      char message[32];
+      gsize len;
+
+      len = g_snprintf (message, sizeof (message), "message %u", i);
+      g_assert_cmpint (g_socket_send (sender, message, len, NULL, &error), ==, len);
+      g_assert_no_error (error);
+    }
+
+  cancellable = g_cancellable_new ();
+  source = g_socket_create_receive_messages_source (receiver, 16, 64, TRUE, cancellable);
+  g_source_set_callback (source, G_SOURCE_FUNC (receive_messages_cb), &data, NULL);
+  g_source_attach (source, NULL);
+
+  while (data.n_received < 100)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert_cmpuint (data.n_received, ==, 100);
+  g_assert_cmpuint (data.max_batch, ==, 16);
+  g_assert_cmpuint (data.n_batches, <, 100);
+
+  /* Cancelling reports an error and removes the source */
+  g_cancellable_cancel (cancellable);
+  while (data.error == NULL)
+    g_main_context_iteration (NULL, TRUE);
+  g_assert_error (data.error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+  g_assert_true (g_source_is_destroyed (source));
+
+  g_clear_error (&data.error);
+  g_source_unref (source);
+  g_object_unref (cancellable);
+  g_object_unref (sender);
+  g_object_unref (receiver);
+}
+
+typedef struct {
+  guint n_received;
+  guint8 buffer[64];
+} ReceiveOneData;
+
+static gboolean
+receive_one_cb (GSocket      *socket,
+                GIOCondition  condition,
+                gpointer      user_data)
+{
+  ReceiveOneData *data = user_data;
+
+  if (g_socket_receive (socket, (gchar *) data->buffer, sizeof (data->buffer), NULL, NULL) > 0)
+    data->n_received++;
+
+  return G_SOURCE_CONTINUE;
+}
+
+static gboolean
+receive_messages_count_cb (GSocket       *socket,
+                           GInputMessage *messages,
+                           guint          num_messages,
+                           const GError  *error,
+                           gpointer       user_data)
+{
+  guint *n_received = user_data;
+
+  *n_received += num_messages;
+
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+test_receive_messages_source_perf (void)
+{
+  const guint n_bursts = 2000;
+  const guint burst = 128;
+  GSocket *receiver, *sender;
+  GOutputVector vector = { "0123456789abcdef0123456789abcdef", 32 };
+  GOutputMessage messages[128];
+  gboolean batched;
+  guint i;
+
+  if (!g_test_perf ())
+    {
+      g_test_skip ("Performance tests not enabled");
+      return;
+    }
+
+  for (i = 0; i < burst; i++)
+    {
+      messages[i].address = NULL;
+      messages[i].vectors = &vector;
+      messages[i].num_vectors = 1;
+      messages[i].bytes_sent = 0;
+      messages[i].control_messages = NULL;
+      messages[i].num_control_messages = 0;
+    }
+
+  for (batched = FALSE; batched <= TRUE; batched++)
+    {
+      ReceiveOneData one_data = { 0, };
+      guint n_received = 0;
+      guint *counter;
+      GSource *source;
+      gdouble elapsed;
+
+      create_udp_pair (&receiver, &sender);
+      g_socket_set_blocking (receiver, FALSE);
+
+      if (batched)
+        {
+          source = g_socket_create_receive_messages_source (receiver, 64, 64, FALSE, NULL);
+          g_source_set_callback (source, G_SOURCE_FUNC (receive_messages_count_cb), &n_received, NULL);
+          counter = &n_received;
+        }
+      else
+        {
+          source = g_socket_create_source (receiver, G_IO_IN, NULL);
+          g_source_set_callback (source, G_SOURCE_FUNC (receive_one_cb), &one_data, NULL);
+          counter = &one_data.n_received;
+        }
+      g_source_attach (source, NULL);
+
+      g_test_timer_start ();
+
+      /* Send in bursts that fit in the receive buffer, and let the main
+       * loop drain each one */
+      for (i = 0; i < n_bursts; i++)
+        {
+          GError *error = NULL;
+          guint target = *counter + burst;
+
+          g_assert_cmpint (g_socket_send_messages (sender, messages, burst, 0, NULL, &error), ==, burst);
+          g_assert_no_error (error);
+
+          while (*counter < target)
+            g_main_context_iteration (NULL, TRUE);
+        }
+
+      elapsed = g_test_timer_elapsed ();
+
+      g_assert_cmpuint (*counter, ==, n_bursts * burst);
+      g_test_maximized_result (n_bursts * burst / elapsed,
+                               "%s: %.0f datagrams/s",
+                               batched ? "g_socket_create_receive_messages_source()" : "g_socket_create_source()",
+                               n_bursts * burst / elapsed);
+
+      g_source_destroy (source);
+      g_source_unref (source);
+      g_object_unref (sender);
+      g_object_unref (receiver);
+    }
+}
+
+static void
+test_udp_segmentation (void)
+{
+  GSocket *receiver, *sender;
+  GSocketControlMessage *segment_message;
+  GSocketControlMessage **messages;
+  GInputVector input_vector;
+  GOutputVector output_vector;
+  guint8 data[1000], buffer[2000];
+  GError *error = NULL;
+  gint n_messages;
+  gssize len;
+  gsize i;
+
+  if (!g_udp_segment_message_is_supported ())
+    {
+      g_test_skip ("UDP segmentation offload not supported on this platform");
+      return;
+    }
+
+  create_udp_pair (&receiver, &sender);
+  g_socket_set_timeout (receiver, 10);
+
+  for (i = 0; i < sizeof (data); i++)
+    data[i] = i % 251;
+
+  if (!g_socket_set_udp_segment_size (sender, 100, &error))
+    {
+      g_assert_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED);
+      g_test_skip ("UDP segmentation offload not supported by the kernel");
+      g_clear_error (&error);
+      g_object_unref (sender);
+      g_object_unref (receiver);
+      return;
+    }
+
+  /* Without GRO, the buffer arrives as separate datagrams */
+  len = g_socket_send (sender, (gchar *) data, sizeof (data), NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (len, ==, sizeof (data));
+
+  for (i = 0; i < 10; i++)
+    {
+      len = g_socket_receive (receiver, (gchar *) buffer, sizeof (buffer), NULL, &error);
+      g_assert_no_error (error);
+      g_assert_cmpmem (buffer, len, data + i * 100, 100);
+    }
+
+  /* The segment size can be overridden per send; the last one is shorter */
+  output_vector.buffer = data;
+  output_vector.size = sizeof (data);
+  segment_message = g_udp_segment_message_new (300);
+  g_assert_cmpuint (g_udp_segment_message_get_segment_size (G_UDP_SEGMENT_MESSAGE (segment_message)), ==, 300);
+  len = g_socket_send_message (sender, NULL, &output_vector, 1,
+                               &segment_message, 1, G_SOCKET_MSG_NONE, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (len, ==, sizeof (data));
+  g_object_unref (segment_message);
+
+  for (i = 0; i < 4; i++)
+    {
+      len = g_socket_receive (receiver, (gchar *) buffer, sizeof (buffer), NULL, &error);
+      g_assert_no_error (error);
+      g_assert_cmpmem (buffer, len, data + i * 300, MIN (300, sizeof (data) - i * 300));
+    }
+
+  /* With GRO, it arrives in one piece with the segment size */
+  if (!g_socket_set_udp_gro (receiver, TRUE, &error))
+    {
+      /* GRO came to UDP sockets later than GSO, in Linux 5.0 */
+      g_assert_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED);
+      g_test_skip ("UDP receive offload not supported by the kernel");
+      g_clear_error (&error);
+      g_object_unref (sender);
+      g_object_unref (receiver);
+      return;
+    }
+
+  len = g_socket_send (sender, (gchar *) data, sizeof (data), NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (len, ==, sizeof (data));
+
+  input_vector.buffer = buffer;
+  input_vector.size = sizeof (buffer);
+  len = g_socket_receive_message (receiver, NULL, &input_vector, 1,
+                                  &messages, &n_messages, NULL, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpmem (buffer, len, data, sizeof (data));
+  g_assert_cmpint (n_messages, ==, 1);
+  g_assert_true (G_IS_UDP_SEGMENT_MESSAGE (messages[0]));
+  g_assert_cmpuint (g_udp_segment_message_get_segment_size (G_UDP_SEGMENT_MESSAGE (messages[0])), ==, 100);
+  g_object_unref (messages[0]);
+  g_free (messages);
+
+  /* It can only be enabled on UDP sockets */
+  g_object_unref (sender);
+  sender = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_STREAM,
+                         G_SOCKET_PROTOCOL_DEFAULT, &error);
+  g_assert_no_error (error);
+  g_assert_false (g_socket_set_udp_segment_size (sender, 100, &error));
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED);
+  g_clear_error (&error);
+
+  g_object_unref (sender);
+  g_object_unref (receiver);
+}
+
+static void
+test_udp_segmentation_perf (void)
+{
+  const gsize segment_size = 1200;
+  const gsize n_segments = 48;
+  const gsize total = 256 * 1024 * 1024;
+  GOutputVector output_vectors[48];
+  GOutputMessage output_messages[48];
+  GInputVector input_vectors[48];
+  GInputMessage input_messages[48];
+  guint8 *data, *buffer;
+  guint mode;
+  gsize i;
+
+  if (!g_test_perf ())
+    {
+      g_test_skip ("Performance tests not enabled");
+      return;
+    }
+
+  data = g_malloc0 (segment_size * n_segments);
+  buffer = g_malloc (segment_size * n_segments);
+
+  for (i = 0; i < n_segments; i++)
+    {
+      output_vectors[i].buffer = data + i * segment_size;
+      output_vectors[i].size = segment_size;
+      output_messages[i].address = NULL;
+      output_messages[i].vectors = &output_vectors[i];
+      output_messages[i].num_vectors = 1;
+      output_messages[i].bytes_sent = 0;
+      output_messages[i].control_messages = NULL;
+      output_messages[i].num_control_messages = 0;
+
+      input_vectors[i].buffer = buffer + i * segment_size;
+      input_vectors[i].size = segment_size;
+      input_messages[i].address = NULL;
+      input_messages[i].vectors = &input_vectors[i];
+      input_messages[i].num_vectors = 1;
+      input_messages[i].bytes_received = 0;
+      input_messages[i].flags = 0;
+      input_messages[i].control_messages = NULL;
+      input_messages[i].num_control_messages = NULL;
+    }
+
+  /* 0: one datagram per message; 1: GSO; 2: GSO and GRO */
+  for (mode = 0; mode < 3; mode++)
+    {
+      GSocket *receiver, *sender;
+      GError *error = NULL;
+      gsize sent = 0;
+      gdouble elapsed;
+
+      create_udp_pair (&receiver, &sender);
+      g_socket_set_timeout (receiver, 10);
+
+      if (mode >= 1 && !g_socket_set_udp_segment_size (sender, segment_size, &error))
+        {
+          g_test_message ("UDP segmentation offload not supported: %s", error->message);
+          g_clear_error (&error);
+          g_object_unref (sender);
+          g_object_unref (receiver);
+          break;
+        }
+      if (mode == 2 && !g_socket_set_udp_gro (receiver, TRUE, &error))
+        {
+          g_test_message ("UDP receive offload not supported: %s", error->message);
+          g_clear_error (&error);
+          g_object_unref (sender);
+          g_object_unref (receiver);
+          break;
+        }
+
+      g_test_timer_start ();
+
+      /* Send one buffer's worth at a time and receive it all, so that
+       * nothing is dropped when the receive queue is full */
+      while (sent < total)
+        {
+          gsize received = 0;
+
+          if (mode == 0)
+            {
+              g_assert_cmpint (g_socket_send_messages (sender, output_messages, n_segments,
+                                                       G_SOCKET_MSG_NONE, NULL, &error), ==, n_segments);
+            }
+          else
+            {
+              g_assert_cmpint (g_socket_send (sender, (gchar *) data, segment_size * n_segments,
+                                              NULL, &error), ==, segment_size * n_segments);
+            }
+          g_assert_no_error (error);
+
+          while (received < segment_size * n_segments)
+            {
+              if (mode == 2)
+                {
+                  received += g_socket_receive (receiver, (gchar *) buffer,
+                                                segment_size * n_segments, NULL, &error);
+                }
+              else
+                {
+                  gint n = g_socket_receive_messages (receiver, input_messages, n_segments,
+                                                      G_SOCKET_MSG_NONE, NULL, &error);
+
+                  for (i = 0; i < (gsize) MAX (n, 0); i++)
+                    received += input_messages[i].bytes_received;
+                }
+              g_assert_no_error (error);
+            }
+
+          sent += received;
+        }
+
+      elapsed = g_test_timer_elapsed ();
+
+      g_test_maximized_result (sent / elapsed / (1024 * 1024),
+                               "%s: %.0f MiB/s",
+                               mode == 0 ? "g_socket_send_messages()" :
+                               mode == 1 ? "GSO" : "GSO and GRO",
+                               sent / elapsed / (1024 * 1024));
+
+      g_object_unref (sender);
+      g_object_unref (receiver);
+    }
+
+  g_free (buffer);
+  g_free (data);
+}
+
+typedef struct {
+  GSocket *socket;
+  guint8 *buffer;
+  gsize size;
+} ZerocopyReadData;
+
+static gpointer
+zerocopy_read_thread (gpointer user_data)
+{
+  ZerocopyReadData *data = user_data;
+  gsize received = 0;
+
+  while (received < data->size)
+    {
+      GError *error = NULL;
+      gssize len;
+
+      len = g_socket_receive (data->socket, (gchar *) data->buffer + received,
+                              data->size - received, NULL, &error);
+      g_assert_no_error (error);
+      g_assert_cmpint (len, >, 0);
+      received += len;
+    }
+
+  return NULL;
+}
+
+static void
+zerocopy_bytes_freed (gpointer user_data)
+{
+  guint *n_freed = user_data;
+
+  (*n_freed)++;
+}
+
+static void
+test_zerocopy (void)
+{
+  const gsize size = 1024 * 1024;
+  GSocket *listener, *server, *client;
+  GSocketConnection *connection;
+  GOutputStream *os;
+  GInetAddress *iaddr;
+  GSocketAddress *addr;
+  ZerocopyReadData read_data;
+  GThread *read_thread;
+  guint8 *data;
+  GBytes *bytes;
+  GError *error = NULL;
+  guint n_freed = 0;
+  gsize i, sent;
+
+  listener = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_STREAM,
+                           G_SOCKET_PROTOCOL_DEFAULT, &error);
+  g_assert_no_error (error);
+  client = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_STREAM,
+                         G_SOCKET_PROTOCOL_DEFAULT, &error);
+  g_assert_no_error (error);
+
+  if (!g_socket_set_zerocopy (client, TRUE, &error))
+    {
+      g_assert_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED);
+      g_test_skip ("Zero-copy sending not supported");
+      g_clear_error (&error);
+      g_object_unref (client);
+      g_object_unref (listener);
+      return;
+    }
+  g_assert_true (g_socket_get_zerocopy (client));
+
+  iaddr = g_inet_address_new_loopback (G_SOCKET_FAMILY_IPV4);
+  addr = g_inet_socket_address_new (iaddr, 0);
+  g_socket_bind (listener, addr, TRUE, &error);
+  g_assert_no_error (error);
+  g_object_unref (addr);
+  g_object_unref (iaddr);
+  g_socket_listen (listener, &error);
+  g_assert_no_error (error);
+
+  addr = g_socket_get_local_address (listener, &error);
+  g_assert_no_error (error);
+  g_socket_connect (client, addr, NULL, &error);
+  g_assert_no_error (error);
+  g_object_unref (addr);
+  server = g_socket_accept (listener, NULL, &error);
+  g_assert_no_error (error);
+  g_object_unref (listener);
+
+  /* The first half is sent with g_socket_send_bytes(), the second with
+   * g_output_stream_write_bytes(); each from its own GBytes */
+  data = g_malloc (size * 2);
+  for (i = 0; i < size * 2; i++)
+    data[i] = g_test_rand_int ();
+
+  read_data.socket = server;
+  read_data.buffer = g_malloc (size * 2);
+  read_data.size = size * 2;
+  read_thread = g_thread_new ("zerocopy-reader", zerocopy_read_thread, &read_data);
+
+  bytes = g_bytes_new_with_free_func (data, size, zerocopy_bytes_freed, &n_freed);
+  for (sent = 0; sent < size; )
+    {
+      GBytes *rest = g_bytes_new_from_bytes (bytes, sent, size - sent);
+      gssize len;
+
+      len = g_socket_send_bytes (client, rest, NULL, &error);
+      g_assert_no_error (error);
+      g_assert_cmpint (len, >, 0);
+      sent += len;
+      g_bytes_unref (rest);
+    }
+  g_bytes_unref (bytes);
+
+  connection = g_socket_connection_factory_create_connection (client);
+  os = g_io_stream_get_output_stream (G_IO_STREAM (connection));
+
+  bytes = g_bytes_new_with_free_func (data + size, size, zerocopy_bytes_freed, &n_freed);
+  for (sent = 0; sent < size; )
+    {
+      GBytes *rest = g_bytes_new_from_bytes (bytes, sent, size - sent);
+      gssize len;
+
+      len = g_output_stream_write_bytes (os, rest, NULL, &error);
+      g_assert_no_error (error);
+      g_assert_cmpint (len, >, 0);
+      sent += len;
+      g_bytes_unref (rest);
+    }
+  g_bytes_unref (bytes);
+
+  g_thread_join (read_thread);
+  g_assert_cmpmem (read_data.buffer, size * 2, data, size * 2);
+
+  /* Notifications of completed sends neither make the socket look
+   * readable nor end a wait for it early */
+  g_assert_cmpint (g_socket_condition_check (client, G_IO_IN), ==, 0);
+  g_assert_false (g_socket_condition_timed_wait (client, G_IO_IN, 10000, NULL, &error));
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_TIMED_OUT);
+  g_clear_error (&error);
+
+  /* The GBytes are released once the kernel has reported it is done */
+  while (n_freed < 2)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_free (read_data.buffer);
+  g_free (data);
+  g_object_unref (connection);
+  g_object_unref (server);
+  g_object_unref (client);
+}
+
+static void
+test_zerocopy_close (void)
+{
+  const gsize size = 1024 * 1024;
+  GSocket *listener, *server, *client;
+  GInetAddress *iaddr;
+  GSocketAddress *addr;
+  ZerocopyReadData read_data;
+  GThread *read_thread;
+  guint8 *data;
+  GBytes *bytes;
+  GError *error = NULL;
+  guint n_freed = 0;
+  gssize sent;
+  gsize i;
+
+  g_test_summary ("Test that closing a socket keeps the GBytes of zero-copy "
+                  "sends until the kernel is done with them");
+
+  listener = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_STREAM,
+                           G_SOCKET_PROTOCOL_DEFAULT, &error);
+  g_assert_no_error (error);
+  client = g_socket_new (G_SOCKET_FAMILY_IPV4, G_SOCKET_TYPE_STREAM,
+                         G_SOCKET_PROTOCOL_DEFAULT, &error);
+  g_assert_no_error (error);
+
+  if (!g_socket_set_zerocopy (client, TRUE, &error))
+    {
+      g_assert_error (error, G_IO_ERROR, G_IO_ERROR_NOT_SUPPORTED);
+      g_test_skip ("Zero-copy sending not supported");
+      g_clear_error (&error);
+      g_object_unref (client);
+      g_object_unref (listener);
+      return;
+    }
+
+  /* A small receive buffer, so that most of what is sent stays queued on
+   * the client until the server reads it */
+  g_socket_set_option (listener, SOL_SOCKET, SO_RCVBUF, 4096, &error);
+  g_assert_no_error (error);
+
+  iaddr = g_inet_address_new_loopback (G_SOCKET_FAMILY_IPV4);
+  addr = g_inet_socket_address_new (iaddr, 0);
+  g_socket_bind (listener, addr, TRUE, &error);
+  g_assert_no_error (error);
+  g_object_unref (addr);
+  g_object_unref (iaddr);
+  g_socket_listen (listener, &error);
+  g_assert_no_error (error);
+
+  addr = g_socket_get_local_address (listener, &error);
+  g_assert_no_error (error);
+  g_socket_connect (client, addr, NULL, &error);
+  g_assert_no_error (error);
+  g_object_unref (addr);
+  server = g_socket_accept (listener, NULL, &error);
+  g_assert_no_error (error);
+  g_object_unref (listener);
+
+  data = g_malloc (size);
+  for (i = 0; i < size; i++)
+    data[i] = g_test_rand_int ();
+
+  g_socket_set_blocking (client, FALSE);
+  bytes = g_bytes_new_with_free_func (data, size, zerocopy_bytes_freed, &n_freed);
+  sent = g_socket_send_bytes (client, bytes, NULL, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (sent, >, 0);
+  g_bytes_unref (bytes);
+
+  g_assert_true (g_socket_close (client, &error));
+  g_assert_no_error (error);
+  g_assert_cmpuint (n_freed, ==, 0);
+
+  /* Once the data has been read, the kernel reports the send as done */
+  read_data.socket = server;
+  read_data.buffer = g_malloc (sent);
+  read_data.size = sent;
+  read_thread = g_thread_new ("zerocopy-reader", zerocopy_read_thread, &read_data);
+
+  while (n_freed < 1)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_thread_join (read_thread);
+  g_assert_cmpmem (read_data.buffer, sent, data, sent);
+
+  g_free (read_data.buffer);
+  g_free (data);
+  g_object_unref (server);
+  g_object_unref (client);
+}
+
 static void
 test_get_available (gconstpointer user_data)
 {
@@ -2387,6 +3119,12 @@ main (int   argc,
   g_test_add_func ("/socket/source-postmortem", test_source_postmortem);
   g_test_add_func ("/socket/reuse/tcp", test_reuse_tcp);
   g_test_add_func ("/socket/reuse/udp", test_reuse_udp);
+  g_test_add_func ("/socket/receive-messages-source", test_receive_messages_source);
+  g_test_add_func ("/socket/perf/receive-messages-source", test_receive_messages_source_perf);
+  g_test_add_func ("/socket/udp-segmentation", test_udp_segmentation);
+  g_test_add_func ("/socket/perf/udp-segmentation", test_udp_segmentation_perf);
+  g_test_add_func ("/socket/zerocopy", test_zerocopy);
+  g_test_add_func ("/socket/zerocopy/close", test_zerocopy_close);
   g_test_add_data_func ("/socket/get_available/datagram", GUINT_TO_POINTER (G_SOCKET_TYPE_DATAGRAM),
                         test_get_available);
   g_test_add_data_func ("/socket/get_available/stream", GUINT_TO_POINTER (G_SOCKET_TYPE_STREAM),
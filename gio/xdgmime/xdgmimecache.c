@@ -50,6 +50,7 @@
 #include <sys/types.h>
 
 #include "xdgmimecache.h"
+#include "xdgmimemagicindex.h"
 #include "xdgmimeint.h"
 
 #ifndef MAX
@@ -87,6 +88,10 @@ struct _XdgMimeCache
 
   size_t  size;
   char   *buffer;
+
+  /* Built on the first magic lookup */
+  XdgMimeMagicIndex *magic_index;
+  int *magic_candidates;
 };
 
 #define GET_UINT16(cache,offset) (ntohs(*(xdg_uint16_t*)((cache) + (offset))))
@@ -109,6 +114,8 @@ _xdg_mime_cache_unref (XdgMimeCache *cache)
 #ifdef HAVE_MMAP
       munmap (cache->buffer, cache->size);
 #endif
+      _xdg_mime_magic_index_free (cache->magic_index);
+      free (cache->magic_candidates);
       free (cache);
     }
 }
@@ -156,6 +163,8 @@ _xdg_mime_cache_new_from_file (const char *file_name)
   cache->ref_count = 1;
   cache->buffer = buffer;
   cache->size = st.st_size;
+  cache->magic_index = NULL;
+  cache->magic_candidates = NULL;
 
  done:
   if (fd != -1)
@@ -167,6 +176,8 @@ _xdg_mime_cache_new_from_file (const char *file_name)
   cache->ref_count = 1;
   cache->buffer = NULL;
   cache->size = 0;
+  cache->magic_index = NULL;
+  cache->magic_candidates = NULL;
 #endif  /* HAVE_MMAP */
 
   return cache;
@@ -272,6 +283,47 @@ cache_magic_compare_to_data (XdgMimeCache *cache,
   return NULL;
 }
 
+static void
+cache_magic_build_index (XdgMimeCache *cache)
+{
+  xdg_uint32_t list_offset;
+  xdg_uint32_t n_entries;
+  xdg_uint32_t offset;
+
+  xdg_uint32_t i, j;
+
+  list_offset = GET_UINT32 (cache->buffer, 24);
+  n_entries = GET_UINT32 (cache->buffer, list_offset);
+  offset = GET_UINT32 (cache->buffer, list_offset + 8);
+
+  cache->magic_index = _xdg_mime_magic_index_new (n_entries);
+  cache->magic_candidates = malloc ((n_entries > 0 ? n_entries : 1) * sizeof (int));
+
+  for (j = 0; j < n_entries; j++)
+    {
+      xdg_uint32_t n_matchlets = GET_UINT32 (cache->buffer, offset + 16 * j + 8);
+      xdg_uint32_t matchlet_offset = GET_UINT32 (cache->buffer, offset + 16 * j + 12);
+
+      for (i = 0; i < n_matchlets; i++)
+	{
+	  xdg_uint32_t matchlet = matchlet_offset + i * 32;
+	  xdg_uint32_t range_start = GET_UINT32 (cache->buffer, matchlet);
+	  xdg_uint32_t range_length = GET_UINT32 (cache->buffer, matchlet + 4);
+	  xdg_uint32_t data_length = GET_UINT32 (cache->buffer, matchlet + 12);
+	  xdg_uint32_t data_offset = GET_UINT32 (cache->buffer, matchlet + 16);
+	  xdg_uint32_t mask_offset = GET_UINT32 (cache->buffer, matchlet + 20);
+
+	  _xdg_mime_magic_index_add_matchlet (cache->magic_index, j,
+					      range_start, range_length,
+					      (const unsigned char *) cache->buffer + data_offset,
+					      mask_offset ? (const unsigned char *) cache->buffer + mask_offset : NULL,
+					      data_length);
+	}
+    }
+
+  _xdg_mime_magic_index_build (cache->magic_index);
+}
+
 static const char *
 cache_magic_lookup_data (XdgMimeCache *cache, 
 			 const void   *data, 
@@ -279,22 +331,28 @@ cache_magic_lookup_data (XdgMimeCache *cache,
 			 int          *prio)
 {
   xdg_uint32_t list_offset;
-  xdg_uint32_t n_entries;
   xdg_uint32_t offset;
 
-  xdg_uint32_t j;
+  int j, n_candidates;
 
   *prio = 0;
 
+  if (cache->magic_index == NULL)
+    cache_magic_build_index (cache);
+
   list_offset = GET_UINT32 (cache->buffer, 24);
-  n_entries = GET_UINT32 (cache->buffer, list_offset);
   offset = GET_UINT32 (cache->buffer, list_offset + 8);
-  
-  for (j = 0; j < n_entries; j++)
+
+  /* Only test the entries that the index could not rule out, in the
+   * order in which they appear in the cache */
+  n_candidates = _xdg_mime_magic_index_lookup (cache->magic_index, data, len,
+					       cache->magic_candidates);
+
+  for (j = 0; j < n_candidates; j++)
     {
       const char *match;
 
-      match = cache_magic_compare_to_data (cache, offset + 16 * j, 
+      match = cache_magic_compare_to_data (cache, offset + 16 * cache->magic_candidates[j],
 					   data, len, prio);
       if (match)
 	return match;
@@ -31,6 +31,7 @@
 
 #include <assert.h>
 #include "xdgmimemagic.h"
+#include "xdgmimemagicindex.h"
 #include "xdgmimeint.h"
 #include <stdio.h>
 #include <stdlib.h>
@@ -88,6 +89,13 @@ struct XdgMimeMagic
 {
   XdgMimeMagicMatch *match_list;
   int max_extent;
+
+  /* Built on the first lookup after reading magic files */
+  XdgMimeMagicIndex *index;
+  XdgMimeMagicMatch **matches;  /* match_list as an array */
+  int n_matches;
+  int *candidates;
+  const char **magic_types;  /* unaliased types of matches, sorted */
 };
 
 static XdgMimeMagicMatch *
@@ -643,6 +651,77 @@ _xdg_mime_magic_insert_match (XdgMimeMagic      *mime_magic,
   match->next = NULL;
 }
 
+static void
+_xdg_mime_magic_clear_index (XdgMimeMagic *mime_magic)
+{
+  _xdg_mime_magic_index_free (mime_magic->index);
+  free (mime_magic->matches);
+  free (mime_magic->candidates);
+  free (mime_magic->magic_types);
+
+  mime_magic->index = NULL;
+  mime_magic->matches = NULL;
+  mime_magic->n_matches = 0;
+  mime_magic->candidates = NULL;
+  mime_magic->magic_types = NULL;
+}
+
+static int
+_xdg_mime_magic_compare_types (const void *a,
+			       const void *b)
+{
+  return strcmp (*(const char * const *) a, *(const char * const *) b);
+}
+
+static void
+_xdg_mime_magic_build_index (XdgMimeMagic *mime_magic)
+{
+  XdgMimeMagicMatch *match;
+  XdgMimeMagicMatchlet *matchlet;
+  int n_matches = 0;
+  int i;
+
+  for (match = mime_magic->match_list; match; match = match->next)
+    n_matches++;
+
+  mime_magic->n_matches = n_matches;
+  mime_magic->matches = malloc ((n_matches > 0 ? n_matches : 1) * sizeof (XdgMimeMagicMatch *));
+  mime_magic->candidates = malloc ((n_matches > 0 ? n_matches : 1) * sizeof (int));
+  mime_magic->magic_types = malloc ((n_matches > 0 ? n_matches : 1) * sizeof (const char *));
+  mime_magic->index = _xdg_mime_magic_index_new (n_matches);
+
+  for (i = 0, match = mime_magic->match_list; match; i++, match = match->next)
+    {
+      mime_magic->matches[i] = match;
+      mime_magic->magic_types[i] = _xdg_mime_unalias_mime_type (match->mime_type);
+
+      for (matchlet = match->matchlet; matchlet; matchlet = matchlet->next)
+	{
+	  if (matchlet->indent == 0)
+	    _xdg_mime_magic_index_add_matchlet (mime_magic->index, i,
+						matchlet->offset,
+						matchlet->range_length,
+						matchlet->value,
+						matchlet->mask,
+						matchlet->value_length);
+	}
+    }
+
+  _xdg_mime_magic_index_build (mime_magic->index);
+  qsort (mime_magic->magic_types, n_matches, sizeof (const char *), _xdg_mime_magic_compare_types);
+}
+
+/* Whether any of the magic rules is for @mime_type */
+static int
+_xdg_mime_magic_has_type (XdgMimeMagic *mime_magic,
+			  const char   *mime_type)
+{
+  const char *unaliased = _xdg_mime_unalias_mime_type (mime_type);
+
+  return bsearch (&unaliased, mime_magic->magic_types, mime_magic->n_matches,
+		  sizeof (const char *), _xdg_mime_magic_compare_types) != NULL;
+}
+
 XdgMimeMagic *
 _xdg_mime_magic_new (void)
 {
@@ -653,6 +732,7 @@ void
 _xdg_mime_magic_free (XdgMimeMagic *mime_magic)
 {
   if (mime_magic) {
+    _xdg_mime_magic_clear_index (mime_magic);
     _xdg_mime_magic_match_free (mime_magic->match_list);
     free (mime_magic);
   }
@@ -674,32 +754,42 @@ _xdg_mime_magic_lookup_data (XdgMimeMagic *mime_magic,
 {
   XdgMimeMagicMatch *match;
   const char *mime_type;
-  int n;
+  int n, i, n_candidates;
   int prio;
 
+  if (mime_magic->index == NULL)
+    _xdg_mime_magic_build_index (mime_magic);
+
+  /* Only test the matches that the index could not rule out. They are
+   * in the same order as in match_list, so the first one that matches is
+   * the same as if all of them had been tested. */
+  n_candidates = _xdg_mime_magic_index_lookup (mime_magic->index, data, len,
+					       mime_magic->candidates);
+
   prio = 0;
   mime_type = NULL;
-  for (match = mime_magic->match_list; match; match = match->next)
+  for (i = 0; i < n_candidates; i++)
     {
+      match = mime_magic->matches[mime_magic->candidates[i]];
       if (_xdg_mime_magic_match_compare_to_data (match, data, len))
 	{
 	  prio = match->priority;
 	  mime_type = match->mime_type;
 	  break;
 	}
-      else 
-	{
-	  for (n = 0; n < n_mime_types; n++)
-	    {
-	      if (mime_types[n] && 
-		  _xdg_mime_mime_type_equal (mime_types[n], match->mime_type))
-		mime_types[n] = NULL;
-	    }
-	}
     }
 
   if (mime_type == NULL)
     {
+      /* Every match failed, which rules out the glob results that have
+       * magic rules of their own */
+      for (n = 0; n < n_mime_types; n++)
+	{
+	  if (mime_types[n] &&
+	      _xdg_mime_magic_has_type (mime_magic, mime_types[n]))
+	    mime_types[n] = NULL;
+	}
+
       for (n = 0; n < n_mime_types; n++)
 	{
 	  if (mime_types[n])
@@ -806,6 +896,7 @@ _xdg_mime_magic_read_magic_file (XdgMimeMagic *mime_magic,
 	}
     }
   _xdg_mime_update_mime_magic_extents (mime_magic);
+  _xdg_mime_magic_clear_index (mime_magic);
 }
 
 void
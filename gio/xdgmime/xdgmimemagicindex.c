@@ -0,0 +1,293 @@
+/* -*- mode: C; c-file-style: "gnu" -*- */
+/* xdgmimemagicindex.c: Index of magic rules by the bytes they expect.
+ *
+ * More info can be found at http://www.freedesktop.org/standards/
+ *
+ * Licensed under the Academic Free License version 2.0
+ * Or under the following terms:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+/* Testing every magic rule against the data, one after the other, costs
+ * time proportional to the number of installed MIME types. Nearly all
+ * rules however start with a matchlet that expects a given byte at a
+ * given offset (the first byte of "%PDF-" at 0, say), so they can be
+ * ruled out by looking at that one byte.
+ *
+ * The index maps each (offset, byte) pair to the matches that have a
+ * top-level matchlet expecting that byte there. A lookup reads the data
+ * at each distinct offset, collects the matches from those buckets plus
+ * the few whose matchlets could not be indexed, and returns them in
+ * match order. The caller then tests only those, which gives the same
+ * result as testing every match.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "xdgmimemagicindex.h"
+#include "xdgmimeint.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* Matchlets that would need more (offset, byte) pairs than this, such as
+ * ones searching a long range, are not indexed */
+#define MAX_ANCHORS_PER_MATCHLET 16
+
+typedef struct
+{
+  unsigned int offset;
+  int byte;
+  int match;
+} XdgMimeMagicAnchor;
+
+struct XdgMimeMagicIndex
+{
+  int n_matches;
+
+  /* Only used while adding matchlets */
+  XdgMimeMagicAnchor *anchors;
+  int n_anchors;
+  int n_anchors_allocated;
+  unsigned char *unindexed;
+
+  /* Matches that must always be tested, in order */
+  int *always;
+  int n_always;
+
+  /* Distinct offsets, in ascending order. The matches expecting byte b at
+   * offsets[k] are bucket_matches[bucket_starts[k * 257 + b]] up to
+   * bucket_matches[bucket_starts[k * 257 + b + 1]] */
+  unsigned int *offsets;
+  int n_offsets;
+  int *bucket_starts;
+  int *bucket_matches;
+
+  /* Used to drop duplicates during a lookup */
+  unsigned int *seen;
+  unsigned int stamp;
+};
+
+XdgMimeMagicIndex *
+_xdg_mime_magic_index_new (int n_matches)
+{
+  XdgMimeMagicIndex *index;
+
+  index = calloc (1, sizeof (XdgMimeMagicIndex));
+  index->n_matches = n_matches;
+  index->unindexed = calloc (n_matches > 0 ? n_matches : 1, 1);
+  index->seen = calloc (n_matches > 0 ? n_matches : 1, sizeof (unsigned int));
+
+  return index;
+}
+
+void
+_xdg_mime_magic_index_free (XdgMimeMagicIndex *index)
+{
+  if (index == NULL)
+    return;
+
+  free (index->anchors);
+  free (index->unindexed);
+  free (index->always);
+  free (index->offsets);
+  free (index->bucket_starts);
+  free (index->bucket_matches);
+  free (index->seen);
+  free (index);
+}
+
+static void
+add_anchor (XdgMimeMagicIndex *index,
+            int                match,
+            unsigned int       offset,
+            int                byte)
+{
+  if (index->n_anchors == index->n_anchors_allocated)
+    {
+      index->n_anchors_allocated = index->n_anchors_allocated ? index->n_anchors_allocated * 2 : 256;
+      index->anchors = realloc (index->anchors, index->n_anchors_allocated * sizeof (XdgMimeMagicAnchor));
+    }
+
+  index->anchors[index->n_anchors].offset = offset;
+  index->anchors[index->n_anchors].byte = byte;
+  index->anchors[index->n_anchors].match = match;
+  index->n_anchors++;
+}
+
+/* Adds one of the top-level matchlets of @match. A match may be returned
+ * by a lookup whenever any of its top-level matchlets could match. */
+void
+_xdg_mime_magic_index_add_matchlet (XdgMimeMagicIndex   *index,
+                                    int                  match,
+                                    unsigned int         offset,
+                                    unsigned int         range_length,
+                                    const unsigned char *value,
+                                    const unsigned char *mask,
+                                    unsigned int         value_length)
+{
+  int bytes[256];
+  int n_bytes = 0;
+  unsigned int i;
+  int b;
+
+  if (index->unindexed[match])
+    return;
+
+  /* Such a matchlet never matches */
+  if (range_length == 0)
+    return;
+
+  if (value_length == 0)
+    {
+      index->unindexed[match] = TRUE;
+      return;
+    }
+
+  if (mask == NULL || mask[0] == 0xff)
+    bytes[n_bytes++] = value[0];
+  else
+    {
+      for (b = 0; b < 256; b++)
+        if ((b & mask[0]) == (value[0] & mask[0]))
+          bytes[n_bytes++] = b;
+    }
+
+  if (range_length > MAX_ANCHORS_PER_MATCHLET ||
+      range_length * n_bytes > MAX_ANCHORS_PER_MATCHLET)
+    {
+      index->unindexed[match] = TRUE;
+      return;
+    }
+
+  for (i = 0; i < range_length; i++)
+    for (b = 0; b < n_bytes; b++)
+      add_anchor (index, match, offset + i, bytes[b]);
+}
+
+static int
+compare_anchors (const void *a,
+                 const void *b)
+{
+  const XdgMimeMagicAnchor *aa = a;
+  const XdgMimeMagicAnchor *bb = b;
+
+  if (aa->offset != bb->offset)
+    return aa->offset < bb->offset ? -1 : 1;
+  if (aa->byte != bb->byte)
+    return aa->byte - bb->byte;
+  return aa->match - bb->match;
+}
+
+static int
+compare_ints (const void *a,
+              const void *b)
+{
+  return *(const int *) a - *(const int *) b;
+}
+
+void
+_xdg_mime_magic_index_build (XdgMimeMagicIndex *index)
+{
+  int i, k, b;
+
+  qsort (index->anchors, index->n_anchors, sizeof (XdgMimeMagicAnchor), compare_anchors);
+
+  index->always = malloc ((index->n_matches > 0 ? index->n_matches : 1) * sizeof (int));
+  for (i = 0; i < index->n_matches; i++)
+    if (index->unindexed[i])
+      index->always[index->n_always++] = i;
+
+  index->offsets = malloc ((index->n_anchors > 0 ? index->n_anchors : 1) * sizeof (unsigned int));
+  for (i = 0; i < index->n_anchors; i++)
+    if (index->n_offsets == 0 ||
+        index->offsets[index->n_offsets - 1] != index->anchors[i].offset)
+      index->offsets[index->n_offsets++] = index->anchors[i].offset;
+
+  index->bucket_starts = malloc ((index->n_offsets * 257 + 1) * sizeof (int));
+  index->bucket_matches = malloc ((index->n_anchors > 0 ? index->n_anchors : 1) * sizeof (int));
+
+  i = 0;
+  for (k = 0; k < index->n_offsets; k++)
+    {
+      for (b = 0; b < 256; b++)
+        {
+          index->bucket_starts[k * 257 + b] = i;
+          while (i < index->n_anchors &&
+                 index->anchors[i].offset == index->offsets[k] &&
+                 index->anchors[i].byte == b)
+            {
+              index->bucket_matches[i] = index->anchors[i].match;
+              i++;
+            }
+        }
+      index->bucket_starts[k * 257 + 256] = i;
+    }
+
+  free (index->anchors);
+  index->anchors = NULL;
+  index->n_anchors_allocated = 0;
+}
+
+/* Stores the matches that may match @data in @candidates, which must have
+ * room for as many matches as the index was created for, in ascending
+ * order. Returns how many there are. */
+int
+_xdg_mime_magic_index_lookup (XdgMimeMagicIndex *index,
+                              const void        *data,
+                              size_t             len,
+                              int               *candidates)
+{
+  const unsigned char *bytes = data;
+  int n = 0;
+  int i, k;
+
+  index->stamp++;
+  if (index->stamp == 0)
+    {
+      memset (index->seen, 0, index->n_matches * sizeof (unsigned int));
+      index->stamp = 1;
+    }
+
+  for (i = 0; i < index->n_always; i++)
+    {
+      index->seen[index->always[i]] = index->stamp;
+      candidates[n++] = index->always[i];
+    }
+
+  for (k = 0; k < index->n_offsets && index->offsets[k] < len; k++)
+    {
+      int b = bytes[index->offsets[k]];
+      int end = index->bucket_starts[k * 257 + b + 1];
+
+      for (i = index->bucket_starts[k * 257 + b]; i < end; i++)
+        {
+          int match = index->bucket_matches[i];
+
+          if (index->seen[match] != index->stamp)
+            {
+              index->seen[match] = index->stamp;
+              candidates[n++] = match;
+            }
+        }
+    }
+
+  qsort (candidates, n, sizeof (int), compare_ints);
+
+  return n;
+}
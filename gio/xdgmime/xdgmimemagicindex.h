@@ -0,0 +1,55 @@
+/* -*- mode: C; c-file-style: "gnu" -*- */
+/* xdgmimemagicindex.h: Index of magic rules by the bytes they expect.
+ *
+ * More info can be found at http://www.freedesktop.org/standards/
+ *
+ * Licensed under the Academic Free License version 2.0
+ * Or under the following terms:
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+
+#ifndef __XDG_MIME_MAGIC_INDEX_H__
+#define __XDG_MIME_MAGIC_INDEX_H__
+
+#include "xdgmime.h"
+
+typedef struct XdgMimeMagicIndex XdgMimeMagicIndex;
+
+#ifdef XDG_PREFIX
+#define _xdg_mime_magic_index_new              XDG_RESERVED_ENTRY(magic_index_new)
+#define _xdg_mime_magic_index_free             XDG_RESERVED_ENTRY(magic_index_free)
+#define _xdg_mime_magic_index_add_matchlet     XDG_RESERVED_ENTRY(magic_index_add_matchlet)
+#define _xdg_mime_magic_index_build            XDG_RESERVED_ENTRY(magic_index_build)
+#define _xdg_mime_magic_index_lookup           XDG_RESERVED_ENTRY(magic_index_lookup)
+#endif
+
+XdgMimeMagicIndex *_xdg_mime_magic_index_new          (int                  n_matches);
+void               _xdg_mime_magic_index_free         (XdgMimeMagicIndex   *index);
+void               _xdg_mime_magic_index_add_matchlet (XdgMimeMagicIndex   *index,
+                                                       int                  match,
+                                                       unsigned int         offset,
+                                                       unsigned int         range_length,
+                                                       const unsigned char *value,
+                                                       const unsigned char *mask,
+                                                       unsigned int         value_length);
+void               _xdg_mime_magic_index_build        (XdgMimeMagicIndex   *index);
+int                _xdg_mime_magic_index_lookup       (XdgMimeMagicIndex   *index,
+                                                       const void          *data,
+                                                       size_t               len,
+                                                       int                 *candidates);
+
+#endif /* __XDG_MIME_MAGIC_INDEX_H__ */
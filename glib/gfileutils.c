@@ -1121,14 +1121,13 @@ fd_should_be_fsynced (int                    fd,
 #endif  /* !HAVE_FSYNC */
 }
 
-/* closes @fd once it’s finished (on success or error) */
+/* leaves @fd open, whether it succeeds or not */
 static gboolean
-write_to_file (const gchar  *contents,
-               gsize         length,
-               int           fd,
-               const gchar  *dest_file,
-               gboolean      do_fsync,
-               GError      **err)
+write_contents (const gchar  *contents,
+                gsize         length,
+                int           fd,
+                const gchar  *dest_file,
+                GError      **err)
 {
 #ifdef HAVE_FALLOCATE
   if (length > 0)
@@ -1155,7 +1154,6 @@ write_to_file (const gchar  *contents,
             set_file_error (err,
                             dest_file, _("Failed to write file “%s”: write() failed: %s"),
                             saved_errno);
-          close (fd);
 
           return FALSE;
         }
@@ -1166,6 +1164,23 @@ write_to_file (const gchar  *contents,
       length -= s;
     }
 
+  return TRUE;
+}
+
+/* closes @fd once it’s finished (on success or error) */
+static gboolean
+write_to_file (const gchar  *contents,
+               gsize         length,
+               int           fd,
+               const gchar  *dest_file,
+               gboolean      do_fsync,
+               GError      **err)
+{
+  if (!write_contents (contents, length, fd, dest_file, err))
+    {
+      close (fd);
+      return FALSE;
+    }
 
 #ifdef HAVE_FSYNC
   errno = 0;
@@ -1460,6 +1475,216 @@ consistent_out:
   return TRUE;
 }
 
+/**
+ * g_file_set_contents_multiple:
+ * @filenames: (array length=n_files) (element-type filename): names of the
+ *   files to write, in the GLib file name encoding
+ * @contents: (array length=n_files): the contents to write to each file
+ * @lengths: (array length=n_files) (nullable): the length of each of
+ *   @contents, or -1 for a nul-terminated string; %NULL if all of @contents
+ *   are nul-terminated strings
+ * @n_files: number of files to write
+ * @flags: flags controlling the safety vs speed of the operation
+ * @mode: file mode, as passed to `open()`; typically this will be `0666`
+ * @error: return location for a #GError, or %NULL
+ *
+ * Writes several files at once, as if by calling g_file_set_contents_full()
+ * on each of them with the same @flags and @mode, but more efficiently.
+ *
+ * If %G_FILE_SET_CONTENTS_CONSISTENT is set in @flags, all the temporary
+ * files are written first, then they are all flushed to disk together, and
+ * only then are they all renamed over their final names. This way the cost
+ * of waiting for the disk is paid once for the whole set, rather than once
+ * per file, which makes a big difference when saving many small files. Each
+ * file gets the same guarantees as with g_file_set_contents_full(), and the
+ * directory containing several of them is only flushed once.
+ *
+ * If writing or flushing any of the files fails, none of them is replaced.
+ * If renaming one of them fails, the ones before it in @filenames have
+ * already been replaced and the others are left untouched.
+ *
+ * Without %G_FILE_SET_CONTENTS_CONSISTENT, and on Windows, the files are
+ * simply written one after the other, stopping at the first error.
+ *
+ * Returns: %TRUE on success, %FALSE if an error occurred
+ *
+ * Since: 2.76
+ */
+gboolean
+g_file_set_contents_multiple (const gchar * const    *filenames,
+                              const gchar * const    *contents,
+                              const gssize           *lengths,
+                              gsize                   n_files,
+                              GFileSetContentsFlags   flags,
+                              int                     mode,
+                              GError                **error)
+{
+  gchar **tmp_filenames;
+  int *fds;
+  gboolean *do_fsync;
+  GHashTable *synced_dirs = NULL;
+  gsize n_created = 0, n_renamed = 0;
+  gboolean retval = FALSE;
+  gsize i;
+
+  g_return_val_if_fail (filenames != NULL || n_files == 0, FALSE);
+  g_return_val_if_fail (contents != NULL || n_files == 0, FALSE);
+  g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
+
+  for (i = 0; i < n_files; i++)
+    {
+      g_return_val_if_fail (filenames[i] != NULL, FALSE);
+      g_return_val_if_fail (contents[i] != NULL || (lengths != NULL && lengths[i] == 0), FALSE);
+      g_return_val_if_fail (lengths == NULL || lengths[i] >= -1, FALSE);
+    }
+
+#ifndef G_OS_WIN32
+  if (!(flags & G_FILE_SET_CONTENTS_CONSISTENT))
+#endif
+    {
+      for (i = 0; i < n_files; i++)
+        if (!g_file_set_contents_full (filenames[i], contents[i],
+                                       lengths != NULL ? lengths[i] : -1,
+                                       flags, mode, error))
+          return FALSE;
+
+      return TRUE;
+    }
+
+  tmp_filenames = g_new0 (gchar *, n_files);
+  fds = g_new (int, n_files);
+  do_fsync = g_new0 (gboolean, n_files);
+
+  /* Write all the temporary files, without waiting for the disk */
+  for (i = 0; i < n_files; i++)
+    {
+      gssize length = lengths != NULL ? lengths[i] : -1;
+
+      if (length < 0)
+        length = strlen (contents[i]);
+
+      tmp_filenames[i] = g_strdup_printf ("%s.XXXXXX", filenames[i]);
+
+      errno = 0;
+      fds[i] = g_mkstemp_full (tmp_filenames[i], O_RDWR | O_BINARY, mode);
+      if (fds[i] == -1)
+        {
+          int saved_errno = errno;
+          if (error)
+            set_file_error (error,
+                            tmp_filenames[i], _("Failed to create file “%s”: %s"),
+                            saved_errno);
+          g_clear_pointer (&tmp_filenames[i], g_free);
+          goto out;
+        }
+      n_created++;
+
+      do_fsync[i] = fd_should_be_fsynced (fds[i], filenames[i], flags);
+      if (!write_contents (contents[i], length, fds[i], tmp_filenames[i], error))
+        goto out;
+
+#ifdef HAVE_SYNC_FILE_RANGE
+      /* Start writing this file out now, so that the disk works on all of
+       * them at once while we write the others */
+      if (do_fsync[i])
+        (void) sync_file_range (fds[i], 0, 0, SYNC_FILE_RANGE_WRITE);
+#endif
+    }
+
+  /* Then wait for all of them to be on disk before renaming any */
+  for (i = 0; i < n_files; i++)
+    {
+#ifdef HAVE_FSYNC
+      errno = 0;
+      if (do_fsync[i] && g_fsync (fds[i]) != 0)
+        {
+          int saved_errno = errno;
+          if (error)
+            set_file_error (error,
+                            tmp_filenames[i], _("Failed to write file “%s”: fsync() failed: %s"),
+                            saved_errno);
+          goto out;
+        }
+#endif
+
+      if (!g_close (fds[i], error))
+        {
+          fds[i] = -1;
+          goto out;
+        }
+      fds[i] = -1;
+    }
+
+  for (i = 0; i < n_files; i++)
+    {
+      errno = 0;
+      if (g_rename (tmp_filenames[i], filenames[i]) == -1)
+        {
+          int save_errno = errno;
+          gchar *display_old_name = g_filename_display_name (tmp_filenames[i]);
+          gchar *display_new_name = g_filename_display_name (filenames[i]);
+
+          g_set_error (error,
+                       G_FILE_ERROR,
+                       g_file_error_from_errno (save_errno),
+                       _("Failed to rename file “%s” to “%s”: g_rename() failed: %s"),
+                       display_old_name,
+                       display_new_name,
+                       g_strerror (save_errno));
+
+          g_free (display_old_name);
+          g_free (display_new_name);
+          goto out;
+        }
+      n_renamed++;
+    }
+
+#ifdef HAVE_FSYNC
+  /* As in rename_file(), make sure the new names are on disk too, flushing
+   * each directory only once */
+  synced_dirs = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+
+  for (i = 0; i < n_files; i++)
+    {
+      gchar *dir;
+
+      if (!do_fsync[i])
+        continue;
+
+      dir = g_path_get_dirname (filenames[i]);
+      if (g_hash_table_add (synced_dirs, dir))
+        {
+          int dir_fd = g_open (dir, O_RDONLY, 0);
+
+          if (dir_fd >= 0)
+            {
+              g_fsync (dir_fd);
+              g_close (dir_fd, NULL);
+            }
+        }
+    }
+#endif  /* HAVE_FSYNC */
+
+  retval = TRUE;
+
+out:
+  for (i = 0; i < n_created; i++)
+    {
+      if (i >= n_renamed && fds[i] >= 0)
+        close (fds[i]);
+      if (i >= n_renamed)
+        g_unlink (tmp_filenames[i]);
+      g_free (tmp_filenames[i]);
+    }
+
+  g_clear_pointer (&synced_dirs, g_hash_table_unref);
+  g_free (tmp_filenames);
+  g_free (fds);
+  g_free (do_fsync);
+
+  return retval;
+}
+
 /*
  * get_tmp_file based on the mkstemp implementation from the GNU C library.
  * Copyright (C) 1991,92,93,94,95,96,97,98,99 Free Software Foundation, Inc.
@@ -134,6 +134,14 @@ gboolean g_file_set_contents_full (const gchar            *filename,
                                    GFileSetContentsFlags   flags,
                                    int                     mode,
                                    GError                **error);
+GLIB_AVAILABLE_IN_2_76
+gboolean g_file_set_contents_multiple (const gchar * const    *filenames,
+                                       const gchar * const    *contents,
+                                       const gssize           *lengths,
+                                       gsize                   n_files,
+                                       GFileSetContentsFlags   flags,
+                                       int                     mode,
+                                       GError                **error);
 G_GNUC_END_IGNORE_DEPRECATIONS
 GLIB_AVAILABLE_IN_ALL
 gchar   *g_file_read_link    (const gchar  *filename,
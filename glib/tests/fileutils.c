@@ -1837,6 +1837,160 @@ test_set_contents_full_read_only_directory (void)
 #endif
 }
 
+static void
+test_set_contents_multiple (void)
+{
+  const gchar *contents[] = { "one", "two", "three\0with a nul", "four" };
+  const gssize lengths[] = { -1, -1, 17, 4 };
+  gchar *names[G_N_ELEMENTS (contents)];
+  const gchar *replacements[G_N_ELEMENTS (contents)] = { "A", "B", "C", "D" };
+  const gchar *longer_contents[] = { "first", "second" };
+  GError *error = NULL;
+  gchar *dir, *buf;
+  gsize len;
+  GDir *d;
+  guint n_entries;
+  gsize i;
+  gboolean ret;
+
+  g_test_summary ("Test g_file_set_contents_multiple() replaces all the files, "
+                  "or none of them if one can’t be written");
+
+  dir = g_dir_make_tmp ("set-contents-multiple-XXXXXX", &error);
+  g_assert_no_error (error);
+
+  for (i = 0; i < G_N_ELEMENTS (names); i++)
+    names[i] = g_strdup_printf ("%s" G_DIR_SEPARATOR_S "file-%" G_GSIZE_FORMAT, dir, i);
+
+  /* One of the files exists already, and is non-empty */
+  ret = g_file_set_contents (names[1], "old", -1, &error);
+  g_assert_no_error (error);
+  g_assert_true (ret);
+
+  ret = g_file_set_contents_multiple ((const gchar * const *) names, contents, lengths,
+                                      G_N_ELEMENTS (names),
+                                      G_FILE_SET_CONTENTS_CONSISTENT | G_FILE_SET_CONTENTS_DURABLE,
+                                      0644, &error);
+  g_assert_no_error (error);
+  g_assert_true (ret);
+
+  for (i = 0; i < G_N_ELEMENTS (names); i++)
+    {
+      ret = g_file_get_contents (names[i], &buf, &len, &error);
+      g_assert_no_error (error);
+      g_assert_true (ret);
+      g_assert_cmpmem (buf, len, contents[i], lengths[i] >= 0 ? (gsize) lengths[i] : strlen (contents[i]));
+      g_free (buf);
+    }
+
+  /* If one of the files can’t be created, none is replaced */
+  g_assert_no_errno (g_remove (names[2]));
+  g_free (names[2]);
+  names[2] = g_build_filename (dir, "missing", "file-2", NULL);
+
+  ret = g_file_set_contents_multiple ((const gchar * const *) names, replacements, NULL,
+                                      G_N_ELEMENTS (names), G_FILE_SET_CONTENTS_CONSISTENT,
+                                      0644, &error);
+  g_assert_error (error, G_FILE_ERROR, G_FILE_ERROR_NOENT);
+  g_assert_false (ret);
+  g_clear_error (&error);
+
+  ret = g_file_get_contents (names[0], &buf, &len, &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (buf, ==, "one");
+  g_free (buf);
+
+  /* …and no temporary files are left behind */
+  d = g_dir_open (dir, 0, &error);
+  g_assert_no_error (error);
+  for (n_entries = 0; g_dir_read_name (d) != NULL; n_entries++);
+  g_dir_close (d);
+  g_assert_cmpuint (n_entries, ==, G_N_ELEMENTS (names) - 1);
+
+  /* Without G_FILE_SET_CONTENTS_CONSISTENT, the files are written in turn */
+  ret = g_file_set_contents_multiple ((const gchar * const *) names, longer_contents, NULL,
+                                      2, G_FILE_SET_CONTENTS_NONE, 0644, &error);
+  g_assert_no_error (error);
+  g_assert_true (ret);
+  ret = g_file_get_contents (names[1], &buf, &len, &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (buf, ==, "second");
+  g_free (buf);
+
+  /* Nothing to do is fine */
+  ret = g_file_set_contents_multiple (NULL, NULL, NULL, 0, G_FILE_SET_CONTENTS_CONSISTENT, 0644, &error);
+  g_assert_no_error (error);
+  g_assert_true (ret);
+
+  for (i = 0; i < G_N_ELEMENTS (names); i++)
+    {
+      /* names[2] is in a directory which doesn’t exist */
+      if (i != 2)
+        g_assert_no_errno (g_remove (names[i]));
+      g_free (names[i]);
+    }
+  g_assert_no_errno (g_remove (dir));
+  g_free (dir);
+}
+
+static void
+test_set_contents_multiple_perf (void)
+{
+  const guint n_files = 200;
+  gchar **names;
+  const gchar **contents;
+  GError *error = NULL;
+  gchar *dir;
+  gdouble one_by_one, batched;
+  guint i;
+
+  if (!g_test_perf ())
+    {
+      g_test_skip ("Performance tests not enabled");
+      return;
+    }
+
+  /* Use the build directory rather than the temporary directory, which is
+   * often on tmpfs where syncing costs nothing */
+  dir = g_build_filename (g_test_get_dir (G_TEST_BUILT), "set-contents-multiple-perf", NULL);
+  g_assert_cmpint (g_mkdir_with_parents (dir, 0755), ==, 0);
+
+  names = g_new0 (gchar *, n_files + 1);
+  contents = g_new (const gchar *, n_files);
+  for (i = 0; i < n_files; i++)
+    {
+      names[i] = g_strdup_printf ("%s" G_DIR_SEPARATOR_S "file-%u.ini", dir, i);
+      contents[i] = "[Group]\nkey=value\n";
+      g_file_set_contents (names[i], "old", -1, &error);
+      g_assert_no_error (error);
+    }
+
+  g_test_timer_start ();
+  for (i = 0; i < n_files; i++)
+    {
+      g_file_set_contents_full (names[i], contents[i], -1, G_FILE_SET_CONTENTS_CONSISTENT, 0644, &error);
+      g_assert_no_error (error);
+    }
+  one_by_one = g_test_timer_elapsed ();
+
+  g_test_timer_start ();
+  g_file_set_contents_multiple ((const gchar * const *) names, contents, NULL, n_files,
+                                G_FILE_SET_CONTENTS_CONSISTENT, 0644, &error);
+  g_assert_no_error (error);
+  batched = g_test_timer_elapsed ();
+
+  g_test_message ("Replacing %u files: %.1f ms one by one, %.1f ms batched",
+                  n_files, one_by_one * 1000, batched * 1000);
+  g_test_minimized_result (batched, "%.1f ms to replace %u files", batched * 1000, n_files);
+
+  for (i = 0; i < n_files; i++)
+    g_remove (names[i]);
+  g_remove (dir);
+  g_strfreev (names);
+  g_free (contents);
+  g_free (dir);
+}
+
 static void
 test_read_link (void)
 {
@@ -2651,6 +2805,8 @@ main (int   argc,
   g_test_add_func ("/fileutils/set-contents-full", test_set_contents_full);
   g_test_add_func ("/fileutils/set-contents-full/read-only-file", test_set_contents_full_read_only_file);
   g_test_add_func ("/fileutils/set-contents-full/read-only-directory", test_set_contents_full_read_only_directory);
+  g_test_add_func ("/fileutils/set-contents-multiple", test_set_contents_multiple);
+  g_test_add_func ("/fileutils/perf/set-contents-multiple", test_set_contents_multiple_perf);
   g_test_add_func ("/fileutils/read-link", test_read_link);
   g_test_add_func ("/fileutils/stdio-wrappers", test_stdio_wrappers);
   g_test_add_func ("/fileutils/fopen-modes", test_fopen_modes);